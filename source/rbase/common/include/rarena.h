@@ -0,0 +1,105 @@
+/**
+ * Copyright (c) 2014 ray
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the MIT license. See LICENSE for details.
+ *
+ * @author: Ray
+ */
+
+#ifndef RARENA_H
+#define RARENA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "rcommon.h"
+
+/**
+ * 帧内临时内存，从大块内存顺序切分，不单独释放；
+ * 帧结束 rarena_reset 整体回收，局部用 rarena_mark/rarena_rewind 回退
+ */
+
+/* ------------------------------- Macros ------------------------------------*/
+
+#define rarena_chunk_size_default (64 * 1024)
+#define rarena_align_default 8
+
+#define rarena_init(d, chunk_size) \
+    do { \
+        rassert((d) == NULL, ""); \
+        (d) = rarena_create((chunk_size)); \
+        rassert((d) != NULL, ""); \
+    } while(0)
+
+#define rarena_free(d) \
+    if (d) { \
+        rarena_release(d); \
+        d = NULL; \
+    }
+
+#define rarena_new(d, T) ((T*)rarena_alloc((d), sizeof(T)))
+#define rarena_new_array(d, T, count) ((T*)rarena_alloc((d), sizeof(T) * (count)))
+
+/** arena为NULL时退回普通堆内存，释放也对应区分 */
+#define rarena_new_size(d, size) ((d) ? rarena_alloc((d), (size)) : rdata_new_size((size)))
+#define rarena_free_size(d, data) \
+    do { \
+        if ((d) == NULL && (data) != NULL) { \
+            rdata_free(char, (data)); \
+        } \
+        (data) = NULL; \
+    } while(0)
+
+/* ------------------------------- Structs ------------------------------------*/
+
+typedef struct rarena_chunk_s rarena_chunk_t;
+struct rarena_chunk_s {
+    rarena_chunk_t* next;
+    size_t capacity;
+    size_t pos;
+    size_t reserved;
+    char data[0];
+};
+
+typedef struct rarena_s {
+    rarena_chunk_t* head;
+    rarena_chunk_t* current;
+    size_t chunk_size;
+    size_t used;//当前已分配字节数
+    size_t peak;
+    size_t capacity;
+    int64_t alloc_count;
+    int chunk_count;
+} rarena_t;
+
+typedef struct rarena_mark_s {
+    rarena_chunk_t* chunk;
+    size_t pos;
+    size_t used;
+} rarena_mark_t;
+
+/* ------------------------------- APIs ------------------------------------*/
+
+R_API rarena_t* rarena_create(size_t chunk_size);
+R_API void rarena_release(rarena_t* d);
+
+R_API void* rarena_alloc(rarena_t* d, size_t size);
+R_API void* rarena_alloc_align(rarena_t* d, size_t size, size_t align);
+
+/** d为NULL时不处理，便于和 rarena_new_size 的堆内存退路配合 */
+R_API rarena_mark_t rarena_mark(rarena_t* d);
+R_API void rarena_rewind(rarena_t* d, rarena_mark_t mark);
+/** 回到第一块，超过 chunk_size 的大块释放，之前的mark失效 */
+R_API void rarena_reset(rarena_t* d);
+
+/** 当前线程默认arena，首次调用时创建，线程退出前调 rarena_thread_release */
+R_API rarena_t* rarena_thread_default();
+R_API void rarena_thread_release();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //RARENA_H
@@ -15,6 +15,7 @@ extern "C" {
 #endif
 
 #include "rcommon.h"
+#include "rdict.h"
 
 /* ------------------------------- Macros ------------------------------------*/
 #define rarray_size_t uint32_t
@@ -25,6 +26,12 @@ extern "C" {
 #define rarray_scale_factor 2
 
 #define rarray_size(ar) ((ar)->size)
+#define rarray_index_none rarray_size_max
+
+/** 元素地址，按值存储和回调模式都适用 */
+#define rarray_ptr_at(ar, index) ((void*)((char*)(ar)->items + (size_t)(index) * (ar)->value_size))
+/** 按值存储模式下直接按类型访问，不走 get_value_func */
+#define rarray_at_value(ar, T, index) (((T*)(ar)->items)[(index)])
 
 #define rarray_declare_alloc_array_func(T) T* rarray_alloc_array_##T(size)
 
@@ -48,7 +55,7 @@ extern "C" {
         T##_inner_type* dest_ptr = (T##_inner_type*)((ar)->items) + (index); \
         size_t copy_len = (ar)->size - (index) - 1; \
         if (copy_len > 0) { \
-            memcpy(dest_ptr, dest_ptr + 1, copy_len * (ar)->value_size); \
+            memmove(dest_ptr, dest_ptr + 1, copy_len * (ar)->value_size); \
         } \
         dest_ptr = (T##_inner_type*)((ar)->items) + (ar)->size - 1; \
         *dest_ptr = 0; \
@@ -68,6 +75,17 @@ extern "C" {
         (ar)->free_value_func = (rarray_type_free_value_func)rarray_free_value_func_##T; \
     } while(0)
 
+/**
+ * 按值连续存储任意类型(结构体等)，没有set/get回调；
+ * rarray_add/rarray_exist/rarray_remove 的参数为元素地址，默认按memcmp判等
+ */
+#define rarray_init_value(ar, T, size) \
+    do { \
+        rassert((ar) == NULL, ""); \
+        (ar) = rarray_create(sizeof(T), (size)); \
+        rassert((ar) != NULL, ""); \
+    } while(0)
+
     //rarray_iterator* rarray_it(rarray* d);
 #define rarray_it(ar) \
     { \
@@ -114,6 +132,7 @@ extern "C" {
         rarray_type_free_value_func free_value_func;
 
         void** items;
+        rdict_t* index;//元素值 -> 下标，rarray_enable_index 开启，要求元素唯一
     } rarray_t;
 
     typedef struct rarray_iterator_t {
@@ -141,6 +160,26 @@ extern "C" {
 
     void* rarray_next(rarray_iterator_t* it);
 
+    /* 批量操作按元素原始字节拷贝(memmove)，不走set_value_func和copy_value_func */
+    int rarray_reserve(rarray_t* d, rarray_size_t capacity);
+    int rarray_append_n(rarray_t* d, const void* vals, rarray_size_t count);
+    int rarray_insert_range(rarray_t* d, rarray_size_t index, const void* vals, rarray_size_t count);
+    int rarray_erase_range(rarray_t* d, rarray_size_t index, rarray_size_t count);
+    /** 末尾元素填到index，O(1)，不保持顺序 */
+    int rarray_swap_remove(rarray_t* d, rarray_size_t index);
+
+    /** compare的参数为元素地址，同qsort */
+    void rarray_sort(rarray_t* d, rcom_compare_func_type compare);
+    /** 要求已按compare排序，key为元素地址；不存在返回 rarray_index_none */
+    rarray_size_t rarray_bsearch(rarray_t* d, const void* key, rcom_compare_func_type compare);
+    /** 第一个 >= key 的下标，都小于key时返回size */
+    rarray_size_t rarray_lower_bound(rarray_t* d, const void* key, rcom_compare_func_type compare);
+
+    /** 按元素原始值(不超过8字节)建hash索引，rarray_exist/rarray_remove变为O(1)查找 */
+    int rarray_enable_index(rarray_t* d);
+    /** 不存在返回 rarray_index_none */
+    rarray_size_t rarray_index_of(rarray_t* d, const void* data);
+
 #ifdef __cplusplus
 }
 #endif
@@ -63,17 +63,25 @@ extern "C" {
 #define rnull NULL
 #endif
 
-#define rtrace(format, ...) rlog_printf(rnull, rlog_level_trace, "[%ld] %s:%s:%d "format"\n", rthread_cur_id(), get_filename(__FILE__), __FUNCTION__, __LINE__, ##__VA_ARGS__)
-#define rdebug(format, ...) rlog_printf(rnull, rlog_level_debug, "[%ld] %s:%s:%d "format"\n", rthread_cur_id(), get_filename(__FILE__), __FUNCTION__, __LINE__, ##__VA_ARGS__)
-#define rinfo(format, ...) rlog_printf(rnull, rlog_level_info, "[%ld] %s:%s:%d "format"\n", rthread_cur_id(), get_filename(__FILE__), __FUNCTION__, __LINE__, ##__VA_ARGS__)
-#define rwarn(format, ...) rlog_printf(rnull, rlog_level_warn, "[%ld] %s:%s:%d "format"\n", rthread_cur_id(), get_filename(__FILE__), __FUNCTION__, __LINE__, ##__VA_ARGS__)
-#define rerror(format, ...) rlog_printf(rnull, rlog_level_error, "[%ld] %s:%s:%d "format"\n", rthread_cur_id(), get_filename(__FILE__), __FUNCTION__, __LINE__, ##__VA_ARGS__)
+#define rtrace(format, ...) rlog_site_printf(rnull, rlog_level_trace, format, ##__VA_ARGS__)
+#define rdebug(format, ...) rlog_site_printf(rnull, rlog_level_debug, format, ##__VA_ARGS__)
+#define rinfo(format, ...) rlog_site_printf(rnull, rlog_level_info, format, ##__VA_ARGS__)
+#define rwarn(format, ...) rlog_site_printf(rnull, rlog_level_warn, format, ##__VA_ARGS__)
+#define rerror(format, ...) rlog_site_printf(rnull, rlog_level_error, format, ##__VA_ARGS__)
 #define rfatal(format, ...) \
 do { \
-	rlog_printf(rnull, rlog_level_fatal, "[%ld] %s:%s:%d "format"\n", rthread_cur_id(), get_filename(__FILE__), __FUNCTION__, __LINE__, ##__VA_ARGS__); \
+	rlog_site_printf(rnull, rlog_level_fatal, format, ##__VA_ARGS__); \
 	abort(); \
 } while (0)
 
+//对端异常时可能每包一条的日志用限速或采样版本
+#define rwarn_limit(format, ...) \
+    rlog_site_printf_limit(rnull, rlog_level_warn, rlog_limit_rate_default, rlog_limit_burst_default, format, ##__VA_ARGS__)
+#define rerror_limit(format, ...) \
+    rlog_site_printf_limit(rnull, rlog_level_error, rlog_limit_rate_default, rlog_limit_burst_default, format, ##__VA_ARGS__)
+#define rwarn_sample(n, format, ...) rlog_site_printf_sample(rnull, rlog_level_warn, (n), format, ##__VA_ARGS__)
+#define rerror_sample(n, format, ...) rlog_site_printf_sample(rnull, rlog_level_error, (n), format, ##__VA_ARGS__)
+
 #define rdebug_trace(...) rinfo(__VA_ARGS__)
 // #define rdebug_trace(...)
 
@@ -142,6 +150,7 @@ typedef enum {
 #define rdata_type_long_double_inner_type long double
 #define rdata_type_string_inner_type char*
 #define rdata_type_ptr_inner_type void**
+#define rdata_type_hkey_inner_type rstr_hkey_t*
 
 #define rdata_type_unknown_copy_func rnull
 #define rdata_type_bool_copy_func rnull
@@ -160,6 +169,7 @@ typedef enum {
 #define rdata_type_long_double_copy_func rnull
 #define rdata_type_string_copy_func rstr_cpy_full
 #define rdata_type_ptr_copy_func rnull
+#define rdata_type_hkey_copy_func rstr_hkey_copy
 
 #define rdata_type_unknown_copy(val)
 #define rdata_type_bool_copy(val) (val)
@@ -178,6 +188,7 @@ typedef enum {
 #define rdata_type_long_double_copy(val) (val)
 #define rdata_type_string_copy(val) rstr_cpy_full(val)
 #define rdata_type_ptr_copy(val) (val)
+#define rdata_type_hkey_copy(val) rstr_hkey_copy(val)
 
 #define rdata_type_unknown_free_func rnull
 #define rdata_type_bool_free_func rnull
@@ -196,6 +207,7 @@ typedef enum {
 #define rdata_type_long_double_free_func rnull
 #define rdata_type_string_free_func rstr_free_func
 #define rdata_type_ptr_free_func rnull
+#define rdata_type_hkey_free_func rstr_hkey_free
 
 #define rdata_type_unknown_free(val)
 #define rdata_type_bool_free(val)
@@ -214,6 +226,7 @@ typedef enum {
 #define rdata_type_long_double_free(val)
 #define rdata_type_string_free(val) rstr_free_func(val)
 #define rdata_type_ptr_free(val)
+#define rdata_type_hkey_free(val) rstr_hkey_free(val)
 
 #define rdata_type_unknown_compare_func rnull
 #define rdata_type_bool_compare_func rnull
@@ -232,6 +245,7 @@ typedef enum {
 #define rdata_type_long_double_compare_func rnull
 #define rdata_type_string_compare_func rstr_compare_func
 #define rdata_type_ptr_compare_func rnull
+#define rdata_type_hkey_compare_func rstr_hkey_compare
 
 #define rdata_type_unknown_compare(val1, val2) rcode_eq
 #define rdata_type_bool_compare(val1, val2) (val1) == (val2) ? rcode_eq : ((val1) < (val2) ? rcode_lt : rcode_gt)
@@ -250,6 +264,7 @@ typedef enum {
 #define rdata_type_long_double_compare(val1, val2) (val1) == (val2) ? rcode_eq : ((val1) < (val2) ? rcode_lt : rcode_gt)
 #define rdata_type_string_compare(val1, val2) rstr_compare_func(val1, val2)
 #define rdata_type_ptr_compare(val1, val2) (val1) == (val2) ? rcode_eq : ((val1) < (val2) ? rcode_lt : rcode_gt)
+#define rdata_type_hkey_compare(val1, val2) rstr_hkey_compare(val1, val2)
 
 #define rdata_type_unknown_hash_func rnull
 #define rdata_type_bool_hash_func rnull
@@ -266,8 +281,9 @@ typedef enum {
 #define rdata_type_float_hash_func rnull
 #define rdata_type_double_hash_func rnull
 #define rdata_type_long_double_hash_func rnull
-#define rdata_type_string_hash_func rhash_func_murmur
+#define rdata_type_string_hash_func rhash_func_string
 #define rdata_type_ptr_hash_func rnull
+#define rdata_type_hkey_hash_func rstr_hkey_hash
 
 #define rdata_type_unknown_hash(val)
 #define rdata_type_bool_hash(val) (val)
@@ -284,8 +300,9 @@ typedef enum {
 #define rdata_type_float_hash(val) (val)
 #define rdata_type_double_hash(val) (val)
 #define rdata_type_long_double_hash(val) (val)
-#define rdata_type_string_hash(val) rhash_func_murmur(val)
+#define rdata_type_string_hash(val) rhash_func_string(val)
 #define rdata_type_ptr_hash(val) (val)
+#define rdata_type_hkey_hash(val) rstr_hkey_hash(val)
 
 
 #define rdata_copy_func_define(T, val) \
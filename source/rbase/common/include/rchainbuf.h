@@ -0,0 +1,147 @@
+/**
+ * Copyright (c) 2014 ray
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the MIT license. See LICENSE for details.
+ *
+ * @author: Ray
+ */
+
+#ifndef RCHAINBUF_H
+#define RCHAINBUF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "rcommon.h"
+#include "rringbuf.h"
+
+/**
+ * 链式缓冲区，由固定大小的slab(4K/64K，线程内rdata_pool分配)串成，按需增长，读空的slab立即归还，空闲时不占slab
+ * slab带引用计数，rchainbuf_slice 可把一段数据零拷贝地交给上层，上层释放slice后slab才回池
+ * 池是线程本地的，同一个chainbuf及其slice只能在创建它的线程里使用和释放；非线程安全
+ */
+
+/* ------------------------------- Macros ------------------------------------*/
+
+#define rchainbuf_size_t uint32_t
+#define rchainbuf_slab_small_size 4096
+#define rchainbuf_slab_large_size 65536
+#define rchainbuf_slab_pool_init_elems 64
+#define rchainbuf_slab_large_block_items 3 //64K slab池每块3个，块加头不超过256K对齐
+#define rchainbuf_iov_max 16
+
+#define rchainbuf_init(d, size_max) \
+    do { \
+        rassert((d) == NULL, ""); \
+        (d) = rchainbuf_create((size_max)); \
+        rassert((d) != NULL, ""); \
+    } while(0)
+
+#define rchainbuf_free(d) \
+    if (d) { \
+        rchainbuf_release(d); \
+        d = NULL; \
+    }
+
+#define rchainbuf_size(d) ((d)->size)
+#define rchainbuf_size_max(d) ((d)->size_max)
+#define rchainbuf_left(d) ((d)->size_max - (d)->size)
+#define rchainbuf_empty(d) ((d)->size == 0)
+#define rchainbuf_slab_count(d) ((d)->slab_count)
+/** 只追加64K slab且读空后保留一个，用于收包的共享缓冲，一次readv尽量多读 */
+#define rchainbuf_set_slab_large(d) ((d)->slab_large = true)
+
+/* ------------------------------- Structs ------------------------------------*/
+
+typedef enum rchainbuf_code_t {
+    rchainbuf_code_ok = 0,
+    rchainbuf_code_error = 1,
+    rchainbuf_code_full,
+} rchainbuf_code_t;
+
+typedef rringbuf_iov_t rchainbuf_iov_t;
+
+typedef enum rchainbuf_slab_type_t {
+    rchainbuf_slab_small = 0,
+    rchainbuf_slab_large,
+    rchainbuf_slab_huge,//超过large的连续slice，直接分配
+} rchainbuf_slab_type_t;
+
+typedef struct rchainbuf_slab_s {
+    struct rchainbuf_slab_s* next;
+    rchainbuf_slab_type_t type;
+    int32_t ref_count;//chain持有1，每个slice持有1
+    rchainbuf_size_t capacity;
+    rchainbuf_size_t start;//读位置
+    rchainbuf_size_t end;//写位置
+    char data[0];
+} rchainbuf_slab_t;
+
+typedef struct rchainbuf_s {
+    rchainbuf_slab_t* head;
+    rchainbuf_slab_t* tail;
+    rchainbuf_slab_t* write_slab;//write_iov预留的起始slab，write_ext提交后清空
+    rchainbuf_size_t size;
+    rchainbuf_size_t size_max;
+    rchainbuf_size_t slab_count;
+    bool slab_large;
+} rchainbuf_t;
+
+/** 连续只读数据，持有slab引用 */
+typedef struct rchainbuf_slice_s {
+    char* data;
+    rchainbuf_size_t len;
+    rchainbuf_slab_t* slab;
+} rchainbuf_slice_t;
+
+/** 当前线程slab占用 */
+typedef struct rchainbuf_stats_s {
+    int64_t slab_small_used;
+    int64_t slab_large_used;
+    int64_t slab_huge_used;
+    int64_t bytes_used;
+} rchainbuf_stats_t;
+
+/* ------------------------------- APIs ------------------------------------*/
+
+/** size_max为可缓存字节上限，0为不限制 */
+R_API rchainbuf_t* rchainbuf_create(rchainbuf_size_t size_max);
+R_API void rchainbuf_release(rchainbuf_t* d);
+/** 丢弃数据，归还所有slab */
+R_API void rchainbuf_clear(rchainbuf_t* d);
+
+/** 超过size_max返回rchainbuf_code_full，不做部分写入 */
+R_API int rchainbuf_write(rchainbuf_t* d, const char* val, rchainbuf_size_t size);
+/** 返回实际读出字节数 */
+R_API rchainbuf_size_t rchainbuf_read(rchainbuf_t* d, char* val, rchainbuf_size_t size);
+R_API rchainbuf_size_t rchainbuf_peek(rchainbuf_t* d, char* val, rchainbuf_size_t size);
+/** 丢弃len字节，读空的slab归还 */
+R_API int rchainbuf_read_ext(rchainbuf_t* d, rchainbuf_size_t len);
+/** 撤销最后写入的len字节 */
+R_API int rchainbuf_write_revert(rchainbuf_t* d, rchainbuf_size_t len);
+
+/** 可读数据的分段，最多iov_max段，返回段数 */
+R_API int rchainbuf_read_iov(rchainbuf_t* d, rchainbuf_iov_t* iov, int iov_max);
+/** 预留可写空间给readv，尾slab剩余不足时追加新slab，返回段数(1-2)，满了返回0 */
+R_API int rchainbuf_write_iov(rchainbuf_t* d, rchainbuf_iov_t* iov);
+/** readv后提交实际写入的len字节，write_iov和write_ext之间不能有其他读写操作 */
+R_API int rchainbuf_write_ext(rchainbuf_t* d, rchainbuf_size_t len);
+
+/** src的数据整体接到dest尾部，src清空；不超过4K时拷贝进dest的小slab，否则直接转移slab，超过dest上限返回full */
+R_API int rchainbuf_splice(rchainbuf_t* dest, rchainbuf_t* src);
+
+/** 取出size字节为连续slice；在同一slab内零拷贝，跨slab时拷贝到新slab */
+R_API int rchainbuf_slice(rchainbuf_t* d, rchainbuf_size_t size, rchainbuf_slice_t* slice);
+R_API void rchainbuf_slice_release(rchainbuf_slice_t* slice);
+
+R_API void rchainbuf_thread_stats(rchainbuf_stats_t* stats);
+/** 线程退出前调用，释放slab池；此前须释放本线程所有chainbuf和slice */
+R_API void rchainbuf_thread_release();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //RCHAINBUF_H
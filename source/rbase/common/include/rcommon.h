@@ -138,12 +138,12 @@ extern "C" {
 //#define RAY_USE_POOL
 
 #ifdef RAY_USE_POOL
-#define rdata_new(T) rcheck_value(true, rpool_get(T, rget_pool(T)))
-#define rdata_new_size(size) raymalloc((size))
+#define rdata_new(T) (T*)rmem_class_alloc(sizeof(T))
+#define rdata_new_size(size) rmem_class_alloc((size))
 #define rdata_free(T, data) \
     do { \
-        rpool_free(T, data, rget_pool(T)); \
-        data = NULL; \
+        rmem_class_free((data)); \
+        (data) = NULL; \
     } while(0)
 
 #else //RAY_USE_POOL
@@ -166,6 +166,8 @@ extern "C" {
 
 #define rmacro_min(a, b) ((a)<(b)?(a):(b))
 #define rmacro_max(a, b) ((a)>(b)?(a):(b))
+/** 由成员地址取回所在结构体，侵入式容器用 */
+#define rcontainer_of(ptr, T, member) ((T*)((char*)(ptr) - offsetof(T, member)))
 
 /** 只支持带显式类型的原生数组，如：int[] **/
 #define rcount_array(ptr, count) \
@@ -15,6 +15,11 @@
 #include "rcommon.h"
 #include "rtools.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define rdict_swiss_sse2
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -30,6 +35,11 @@ extern "C" {
 #define rdict_expand_factor 2
 #define rdict_hill_expand_capacity (10240000 / sizeof(rdict_entry_t))
 #define rdict_hill_add_capacity (1024000 / sizeof(rdict_entry_t))
+#define rdict_group_width 16
+#define rdict_rehash_step_slots 64 //每次增删顺带迁移的旧表slot数
+#ifndef rdict_engine_default
+#define rdict_engine_default rdict_engine_swiss
+#endif
 
 typedef enum rdict_code_t {
     rdict_code_ok = 0,
@@ -37,6 +47,16 @@ typedef enum rdict_code_t {
     rdict_code_not_exist = 2,
 } rdict_code_t;
 
+/**
+ * bucket: 定长桶线性扫描；swiss: 开放寻址，每个slot一个控制字节，按16个slot一组比较
+ * compact: 稀疏索引数组指向按插入顺序存放的稠密entry数组，遍历只扫有效数据，删除过半时压缩
+ */
+typedef enum rdict_engine_t {
+    rdict_engine_bucket = 0,
+    rdict_engine_swiss = 1,
+    rdict_engine_compact = 2,
+} rdict_engine_t;
+
 /* ------------------------------- Structs ------------------------------------*/
 
 typedef struct rdict_entry_t {
@@ -84,6 +104,19 @@ typedef struct rdict_t {//非线程安全，扩容为浅拷贝
     float scale_factor;
     void* data_ext;
 
+    rdict_engine_t engine;
+    uint8_t* ctrl;//swiss, capacity + rdict_group_width，尾部镜像头部一组
+    rdict_size_t growth_left;//swiss, 不扩容还能占用的空slot数
+
+    rdict_entry_t* rehash_entry;//swiss渐进迁移中的旧表，entry/ctrl为新表
+    uint8_t* rehash_ctrl;
+    rdict_size_t rehash_capacity;
+    int64_t rehash_index;//旧表迁移进度，-1为不在迁移
+
+    int32_t* indices;//compact, entry下标，2的幂长度
+    rdict_size_t indices_capacity;
+    rdict_size_t entry_used;//compact, 稠密数组已用长度，含删除留下的空洞
+
     rdict_malloc_func_type malloc_func; //内存管理相关
     rdict_calloc_func_type calloc_func; //内存管理相关
     rdict_free_func_type free_func; //内存管理相关
@@ -101,6 +134,7 @@ typedef struct rdict_t {//非线程安全，扩容为浅拷贝
 typedef struct rdict_iterator_t {
     rdict_t* d;
     rdict_entry_t *entry, *next;
+    int table;//swiss迁移中，1为正在遍历旧表
 } rdict_iterator_t;
 
 typedef void (rdict_scan_func)(void* data_ext, const rdict_entry_t *de);
@@ -208,17 +242,18 @@ void rdict_free_value_func_##V(void* data_ext, V##_inner_type obj) { \
 #define rdict_get_value(entry) ((entry)->value.ptr)
 #define rdict_exists(d, key) ((bool)(rdict_find((d), (key)) != NULL))
 #define rdict_size(d) ((d)->size)
-#define rdict_rehashing(d) ((d)->rehash_id != 0)
+#define rdict_rehashing(d) ((d)->rehash_index >= 0)
 
 //rdict_iterator* rdict_it(rdict* d);
 #define rdict_it(d) \
     { \
-        (d), (d)->entry, (d)->entry_null \
+        (d), (d)->entry, (d)->entry_null, 0 \
     }
 #define rdict_it_first(it) \
     do { \
         (it)->entry = (it)->d->entry; \
         (it)->next = (it)->d->entry_null; \
+        (it)->table = 0; \
     } while(0)
 
 #define rdict_free(d) \
@@ -227,12 +262,124 @@ void rdict_free_value_func_##V(void* data_ext, V##_inner_type obj) { \
         d = NULL; \
     }
 
+/** swiss控制字节，0为empty，calloc出来不需要再初始化 */
+#define rdict_ctrl_empty ((uint8_t)0x00)
+#define rdict_ctrl_deleted ((uint8_t)0x01)
+#define rdict_ctrl_full(h2) ((uint8_t)(0x80 | (h2)))
+#define rdict_ctrl_is_full(c) (((c) & 0x80) != 0)
+#define rdict_swiss_h1(hash) ((hash) >> 7)
+#define rdict_swiss_h2(hash) ((uint8_t)((hash) & 0x7F))
+#define rdict_swiss_max_load(capacity) ((capacity) - (capacity) / 8)
+
+/** compact索引，非负为entry下标 */
+#define rdict_compact_index_empty (-1)
+#define rdict_compact_index_deleted (-2)
+#define rdict_compact_indices_min 8
+#define rdict_compact_shrink_min 64 //稠密数组短于此不压缩
+#define rdict_compact_usable(indices_capacity) ((indices_capacity) * 2 / 3)
+
+/** 键类型自带的hash多为原值，混合后高低位都可用 */
+static inline uint64_t rdict_hash_mix(uint64_t hash) {
+    hash *= 0x9E3779B97F4A7C15ull;
+    return hash ^ (hash >> 32);
+}
+
+/** 返回16位掩码，第i位表示组内第i个控制字节等于value */
+static inline uint32_t rdict_group_match(const uint8_t* ctrl, uint8_t value) {
+#ifdef rdict_swiss_sse2
+    __m128i group = _mm_loadu_si128((const __m128i*)ctrl);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)value)));
+#else
+    uint32_t mask = 0;
+    for (int i = 0; i < rdict_group_width; i++) {
+        mask |= (uint32_t)(ctrl[i] == value) << i;
+    }
+    return mask;
+#endif //rdict_swiss_sse2
+}
+
+/** 最高位为1，即有数据的slot */
+static inline uint32_t rdict_group_match_full(const uint8_t* ctrl) {
+#ifdef rdict_swiss_sse2
+    return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)ctrl));
+#else
+    uint32_t mask = 0;
+    for (int i = 0; i < rdict_group_width; i++) {
+        mask |= (uint32_t)(ctrl[i] >> 7) << i;
+    }
+    return mask;
+#endif //rdict_swiss_sse2
+}
+
+static inline void rdict_ctrl_set(uint8_t* ctrl, rdict_size_t capacity, rdict_size_t index, uint8_t value) {
+    ctrl[index] = value;
+    if (index < rdict_group_width) {
+        ctrl[capacity + index] = value;//镜像，组读取不用处理回绕
+    }
+}
+
+/** 探测序列上第一个empty或deleted的slot */
+static inline rdict_size_t rdict_ctrl_find_free(const uint8_t* ctrl, rdict_size_t capacity, uint64_t hash) {
+    rdict_size_t mask = capacity - 1;
+    rdict_size_t pos = (rdict_size_t)rdict_swiss_h1(hash) & mask;
+    rdict_size_t stride = 0;
+
+    while (true) {
+        uint32_t match = ~rdict_group_match_full(ctrl + pos) & 0xFFFF;
+        if (match != 0) {
+            return (pos + rtools_ctz64(match)) & mask;
+        }
+        stride += rdict_group_width;
+        pos = (pos + stride) & mask;
+    }
+}
+
+/** 从start起第一个有数据的slot，没有返回capacity */
+static inline rdict_size_t rdict_ctrl_next_full(const uint8_t* ctrl, rdict_size_t capacity, rdict_size_t start) {
+    while (start < capacity) {//镜像字节保证越过capacity的读取合法
+        uint32_t match = rdict_group_match_full(ctrl + start);
+        if (match != 0) {
+            start += rtools_ctz64(match);
+            return start < capacity ? start : capacity;
+        }
+        start += rdict_group_width;
+    }
+    return capacity;
+}
+
+/** 删除时前后相邻的空slot跨度不足一组，说明没有探测序列经过这里，可直接置empty */
+static inline bool rdict_ctrl_can_empty(const uint8_t* ctrl, rdict_size_t capacity, rdict_size_t index) {
+    uint32_t empty_before = rdict_group_match(ctrl + ((index - rdict_group_width) & (capacity - 1)), rdict_ctrl_empty);
+    uint32_t empty_after = rdict_group_match(ctrl + index, rdict_ctrl_empty);
+    return empty_before != 0 && empty_after != 0 &&
+        rtools_ctz64(empty_after) + (rtools_clz64(empty_before) - (64 - rdict_group_width)) < rdict_group_width;
+}
+
+/** 容纳count个元素的2的幂容量，超出返回0 */
+static inline rdict_size_t rdict_swiss_capacity_for(rdict_size_t count) {
+    uint64_t need = (uint64_t)count + count / 7 + 1;
+    uint64_t capacity = rdict_group_width;
+    while (capacity < need) {
+        capacity <<= 1;
+    }
+    return capacity > rdict_size_max ? 0 : (rdict_size_t)capacity;
+}
+
 /* ------------------------------- APIs ------------------------------------*/
 
 rdict_t* rdict_create(rdict_size_t init_capacity, rdict_size_t bucket_capacity, void* data_ext, 
     rdict_malloc_func_type malloc_func, rdict_calloc_func_type calloc_func, rdict_free_func_type free_func);
 int rdict_expand(rdict_t* d, rdict_size_t capacity);
+/** 只能在空表上切换 **/
+int rdict_set_engine(rdict_t* d, rdict_engine_t engine);
+/** 
+ * swiss扩容时新旧两表并存，增删各顺带迁移 rdict_rehash_step_slots 个旧slot；
+ * 空闲时调用本函数在 budget_us 内继续迁移，返回旧表剩余slot数，0为迁移完成
+ * find只读不迁移，返回的entry和遍历中的迭代器在下次增删或调用本函数前有效
+ **/
+int64_t rdict_rehash_step(rdict_t* d, int64_t budget_us);
 int rdict_add(rdict_t* d, void* key, void* val);
+/** compact删除可能触发压缩，遍历中不要删除 **/
 int rdict_remove(rdict_t* d, const void* key);
 /** 只置空数据，不释放entry内存 **/
 void rdict_clear(rdict_t* d);
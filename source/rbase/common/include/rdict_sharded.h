@@ -0,0 +1,94 @@
+/**
+ * Copyright (c) 2014 ray
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the MIT license. See LICENSE for details.
+ *
+ * @author: Ray
+ */
+
+#ifndef RDICT_SHARDED_H
+#define RDICT_SHARDED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "rcommon.h"
+#include "rthread.h"
+#include "rdict.h"
+
+/**
+ * 线程安全的分片rdict，按key的hash高位分到2的幂个分片，每片一把读写锁、一个独立rdict；
+ * 扩容只发生在单个分片内，不阻塞其它分片
+ * rdict的find只读不迁移，查询只加读锁，同一分片的查询之间不互斥；只返回value拷贝，不暴露entry
+ */
+
+/* ------------------------------- Macros ------------------------------------*/
+
+#define rdict_sharded_count_default 16
+#define rdict_sharded_count_max 1024
+#define rdict_shard_stride 128 //分片间隔，避免相邻分片的锁落在同一缓存行
+
+#define rdict_sharded_init_full(inst, K, V, count, capacity, malloc_f, calloc_f, free_f) \
+    do { \
+        rassert((inst) == NULL, ""); \
+        (inst) = rdict_sharded_create((count), (malloc_f), (free_f)); \
+        rassert((inst) != NULL, ""); \
+        for (uint32_t _shard_i = 0; _shard_i < (inst)->shard_count; _shard_i++) { \
+            rdict_init_full((inst)->shards[_shard_i].shard.dict, K, V, \
+                ((capacity) + (inst)->shard_count - 1) / (inst)->shard_count, 0, (malloc_f), (calloc_f), (free_f), \
+                NULL, NULL, NULL, NULL, NULL, NULL); \
+        } \
+    } while(0)
+#define rdict_sharded_init(inst, K, V, count, capacity) \
+    rdict_sharded_init_full(inst, K, V, count, capacity, NULL, NULL, NULL)
+
+#define rdict_sharded_free(d) \
+    if (d) { \
+        rdict_sharded_release(d); \
+        d = NULL; \
+    }
+
+/* ------------------------------- Structs ------------------------------------*/
+
+typedef struct rdict_shard_s {
+    rrwlock_t lock;
+    rdict_t* dict;
+} rdict_shard_t;
+
+typedef union rdict_shard_padded_u {
+    rdict_shard_t shard;
+    char pad[rdict_shard_stride];
+} rdict_shard_padded_t;
+
+typedef struct rdict_sharded_s {
+    rdict_shard_padded_t* shards;
+    uint32_t shard_count;
+    uint32_t shard_shift;//hash右移位数，取高位选分片，低位留给分片内部
+    rdict_free_func_type free_func;
+} rdict_sharded_t;
+
+/* ------------------------------- APIs ------------------------------------*/
+
+/** shard_count向上取2的幂，分片内rdict由 rdict_sharded_init 创建 */
+R_API rdict_sharded_t* rdict_sharded_create(uint32_t shard_count, rdict_malloc_func_type malloc_func, rdict_free_func_type free_func);
+R_API void rdict_sharded_release(rdict_sharded_t* d);
+
+R_API int rdict_sharded_add(rdict_sharded_t* d, void* key, void* val);
+R_API int rdict_sharded_remove(rdict_sharded_t* d, const void* key);
+/** 存在时value写入拷贝，value可为NULL只判断存在 */
+R_API int rdict_sharded_find(rdict_sharded_t* d, const void* key, void** value);
+/** 查到即移除，value交给调用者，不执行free_value_func */
+R_API int rdict_sharded_take(rdict_sharded_t* d, const void* key, void** value);
+R_API void rdict_sharded_clear(rdict_sharded_t* d);
+/** 各分片加锁后累加，只是近似值 */
+R_API rdict_size_t rdict_sharded_size(rdict_sharded_t* d);
+/** 逐个分片加锁遍历，回调内不能再操作本表 */
+R_API void rdict_sharded_scan(rdict_sharded_t* d, rdict_scan_func* func, void* data_ext);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //RDICT_SHARDED_H
@@ -0,0 +1,224 @@
+/**
+ * Copyright (c) 2014 ray
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the MIT license. See LICENSE for details.
+ *
+ * @author: Ray
+ */
+
+#ifndef RDICT_TYPED_H
+#define RDICT_TYPED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "rcommon.h"
+#include "rdict.h"
+
+/**
+ * 编译期特化的swiss表，key/value按原类型存储，hash、比较内联，没有回调；
+ * 不管理key/value内存，不做渐进rehash，非线程安全
+ *
+ * rdict_define_typed(rtest_map, uint64_t, void*) 生成：
+ *   rtest_map_t, rtest_map_entry_t
+ *   rtest_map_init/uninit/create/release/clear/reserve
+ *   rtest_map_add/find/remove/next
+ * rdict_define_typed_full 可以指定 hash_f(key) 和 equal_f(key1, key2)
+ */
+
+/* ------------------------------- Macros ------------------------------------*/
+
+#define rdict_typed_hash_int(key) ((uint64_t)(key))
+#define rdict_typed_equal_int(key1, key2) ((key1) == (key2))
+#define rdict_typed_hash_string(key) rhash_func_string((key))
+#define rdict_typed_equal_string(key1, key2) (strcmp((key1), (key2)) == 0)
+
+#define rdict_typed_foreach(name, d, entry_var) \
+    for (rdict_size_t entry_var##_index = 0; ((entry_var) = name##_next((d), &entry_var##_index)) != NULL; )
+
+#define rdict_define_typed(name, K, V) \
+    rdict_define_typed_full(name, K, V, rdict_typed_hash_int, rdict_typed_equal_int)
+
+#define rdict_define_typed_full(name, K, V, hash_f, equal_f) \
+typedef struct name##_entry_s { \
+    K key; \
+    V value; \
+} name##_entry_t; \
+\
+typedef struct name##_s { \
+    name##_entry_t* entry; \
+    uint8_t* ctrl; \
+    rdict_size_t size; \
+    rdict_size_t capacity; \
+    rdict_size_t growth_left; \
+} name##_t; \
+\
+static inline int name##_resize(name##_t* d, rdict_size_t capacity) { \
+    if (capacity == 0 || rdict_swiss_max_load(capacity) <= d->size) { \
+        return rdict_code_error; \
+    } \
+    name##_entry_t* new_entry = rdata_new_type_array(name##_entry_t, capacity); \
+    uint8_t* new_ctrl = rdata_new_type_array(uint8_t, capacity + rdict_group_width); \
+    if (new_entry == NULL || new_ctrl == NULL) { \
+        if (new_entry != NULL) { \
+            rdata_free_array(new_entry); \
+        } \
+        if (new_ctrl != NULL) { \
+            rdata_free_array(new_ctrl); \
+        } \
+        return rdict_code_error; \
+    } \
+    for (rdict_size_t i = 0; d->entry != NULL && i < d->capacity; i++) { \
+        if (!rdict_ctrl_is_full(d->ctrl[i])) { \
+            continue; \
+        } \
+        uint64_t hash = rdict_hash_mix(hash_f(d->entry[i].key)); \
+        rdict_size_t index = rdict_ctrl_find_free(new_ctrl, capacity, hash); \
+        rdict_ctrl_set(new_ctrl, capacity, index, rdict_ctrl_full(rdict_swiss_h2(hash))); \
+        new_entry[index] = d->entry[i]; \
+    } \
+    if (d->entry != NULL) { \
+        rdata_free_array(d->entry); \
+        rdata_free_array(d->ctrl); \
+    } \
+    d->entry = new_entry; \
+    d->ctrl = new_ctrl; \
+    d->capacity = capacity; \
+    d->growth_left = rdict_swiss_max_load(capacity) - d->size; \
+    return rdict_code_ok; \
+} \
+\
+static inline int name##_init(name##_t* d, rdict_size_t capacity) { \
+    rdata_init(d, sizeof(name##_t)); \
+    return name##_resize(d, rdict_swiss_capacity_for(capacity)); \
+} \
+\
+static inline void name##_uninit(name##_t* d) { \
+    if (d->entry != NULL) { \
+        rdata_free_array(d->entry); \
+        rdata_free_array(d->ctrl); \
+    } \
+    rdata_init(d, sizeof(name##_t)); \
+} \
+\
+static inline name##_t* name##_create(rdict_size_t capacity) { \
+    name##_t* d = rdata_new(name##_t); \
+    if (d == NULL) { \
+        return NULL; \
+    } \
+    if (name##_init(d, capacity) != rdict_code_ok) { \
+        rdata_free(name##_t, d); \
+        return NULL; \
+    } \
+    return d; \
+} \
+\
+static inline void name##_release(name##_t* d) { \
+    if (d == NULL) { \
+        return; \
+    } \
+    name##_uninit(d); \
+    rdata_free(name##_t, d); \
+} \
+\
+static inline void name##_clear(name##_t* d) { \
+    memset(d->ctrl, rdict_ctrl_empty, d->capacity + rdict_group_width); \
+    d->size = 0; \
+    d->growth_left = rdict_swiss_max_load(d->capacity); \
+} \
+\
+static inline int name##_reserve(name##_t* d, rdict_size_t count) { \
+    rdict_size_t capacity = rdict_swiss_capacity_for(count); \
+    return capacity > d->capacity ? name##_resize(d, capacity) : rdict_code_ok; \
+} \
+\
+static inline name##_entry_t* name##_find_hash(name##_t* d, K key, uint64_t hash) { \
+    rdict_size_t mask = d->capacity - 1; \
+    rdict_size_t pos = (rdict_size_t)rdict_swiss_h1(hash) & mask; \
+    rdict_size_t stride = 0; \
+    uint8_t h2 = rdict_ctrl_full(rdict_swiss_h2(hash)); \
+    while (true) { \
+        const uint8_t* group = d->ctrl + pos; \
+        uint32_t match = rdict_group_match(group, h2); \
+        while (match != 0) { \
+            name##_entry_t* entry = d->entry + ((pos + rtools_ctz64(match)) & mask); \
+            if (likely(equal_f(entry->key, key))) { \
+                return entry; \
+            } \
+            match &= match - 1; \
+        } \
+        if (likely(rdict_group_match(group, rdict_ctrl_empty) != 0)) { \
+            return NULL; \
+        } \
+        stride += rdict_group_width; \
+        pos = (pos + stride) & mask; \
+    } \
+} \
+\
+static inline name##_entry_t* name##_find(name##_t* d, K key) { \
+    return name##_find_hash(d, key, rdict_hash_mix(hash_f(key))); \
+} \
+\
+/** 已存在则覆盖value */ \
+static inline int name##_add(name##_t* d, K key, V value) { \
+    uint64_t hash = rdict_hash_mix(hash_f(key)); \
+    name##_entry_t* entry = name##_find_hash(d, key, hash); \
+    if (entry != NULL) { \
+        entry->value = value; \
+        return rdict_code_ok; \
+    } \
+    rdict_size_t index = rdict_ctrl_find_free(d->ctrl, d->capacity, hash); \
+    if (unlikely(d->growth_left == 0 && d->ctrl[index] == rdict_ctrl_empty)) { \
+        rdict_size_t capacity = d->size + 1 > rdict_swiss_max_load(d->capacity) / 2 ? d->capacity * 2 : d->capacity; \
+        int code_resize = name##_resize(d, capacity); \
+        if (code_resize != rdict_code_ok) { \
+            return code_resize; \
+        } \
+        index = rdict_ctrl_find_free(d->ctrl, d->capacity, hash); \
+    } \
+    if (d->ctrl[index] == rdict_ctrl_empty) { \
+        d->growth_left--; \
+    } \
+    rdict_ctrl_set(d->ctrl, d->capacity, index, rdict_ctrl_full(rdict_swiss_h2(hash))); \
+    d->entry[index].key = key; \
+    d->entry[index].value = value; \
+    d->size++; \
+    return rdict_code_ok; \
+} \
+\
+static inline int name##_remove(name##_t* d, K key) { \
+    name##_entry_t* entry = name##_find(d, key); \
+    if (entry == NULL) { \
+        return rdict_code_not_exist; \
+    } \
+    rdict_size_t index = (rdict_size_t)(entry - d->entry); \
+    if (rdict_ctrl_can_empty(d->ctrl, d->capacity, index)) { \
+        rdict_ctrl_set(d->ctrl, d->capacity, index, rdict_ctrl_empty); \
+        d->growth_left++; \
+    } else { \
+        rdict_ctrl_set(d->ctrl, d->capacity, index, rdict_ctrl_deleted); \
+    } \
+    d->size--; \
+    return rdict_code_ok; \
+} \
+\
+/** index从0开始，遍历中不能增删 */ \
+static inline name##_entry_t* name##_next(name##_t* d, rdict_size_t* index) { \
+    rdict_size_t pos = rdict_ctrl_next_full(d->ctrl, d->capacity, *index); \
+    if (pos >= d->capacity) { \
+        *index = d->capacity; \
+        return NULL; \
+    } \
+    *index = pos + 1; \
+    return d->entry + pos; \
+}
+
+#define rdict_typed_size(d) ((d)->size)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //RDICT_TYPED_H
@@ -0,0 +1,189 @@
+/**
+ * Copyright (c) 2014 ray
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the MIT license. See LICENSE for details.
+ *
+ * @author: Ray
+ */
+
+#ifndef RILIST_H
+#define RILIST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "rcommon.h"
+
+/**
+ * 侵入式双向链表，rilist_node_t嵌在用户结构体里，rilist_entry取回对象；
+ * 链表不分配也不释放任何内存，节点同一时刻只能在一个链表中；非线程安全
+ *
+ * typedef struct { int id; rilist_node_t link; } item_t;
+ * rilist_push_back(&list, &item->link);
+ * rilist_foreach_safe(&list, node, node_next) { item_t* item = rilist_entry(node, item_t, link); }
+ */
+
+/* ------------------------------- Macros ------------------------------------*/
+
+#define rilist_entry(node, T, member) rcontainer_of((node), T, member)
+
+#define rilist_size(list) ((list)->len)
+#define rilist_empty(list) ((list)->head.next == &(list)->head)
+
+#define rilist_foreach(list, node) \
+    for ((node) = (list)->head.next; (node) != &(list)->head; (node) = (node)->next)
+#define rilist_foreach_reverse(list, node) \
+    for ((node) = (list)->head.prev; (node) != &(list)->head; (node) = (node)->prev)
+/** 遍历中可以移除当前节点 */
+#define rilist_foreach_safe(list, node, node_next) \
+    for ((node) = (list)->head.next, (node_next) = (node)->next; (node) != &(list)->head; \
+        (node) = (node_next), (node_next) = (node)->next)
+
+/* ------------------------------- Structs ------------------------------------*/
+
+typedef struct rilist_node_s {
+    struct rilist_node_s* prev;
+    struct rilist_node_s* next;
+} rilist_node_t;
+
+/** head为哨兵，首尾相连，插入删除没有空表分支 */
+typedef struct rilist_s {
+    rilist_node_t head;
+    unsigned int len;
+} rilist_t;
+
+/* ------------------------------- APIs ------------------------------------*/
+
+static inline void rilist_init(rilist_t* list) {
+    list->head.prev = &list->head;
+    list->head.next = &list->head;
+    list->len = 0;
+}
+
+static inline void rilist_node_init(rilist_node_t* node) {
+    node->prev = NULL;
+    node->next = NULL;
+}
+
+/** 节点用 rilist_node_init 初始化后才能判断 */
+static inline bool rilist_node_linked(const rilist_node_t* node) {
+    return node->next != NULL;
+}
+
+static inline void _rilist_link(rilist_node_t* node, rilist_node_t* prev, rilist_node_t* next) {
+    node->prev = prev;
+    node->next = next;
+    prev->next = node;
+    next->prev = node;
+}
+
+static inline void rilist_push_back(rilist_t* list, rilist_node_t* node) {
+    _rilist_link(node, list->head.prev, &list->head);
+    list->len++;
+}
+
+static inline void rilist_push_front(rilist_t* list, rilist_node_t* node) {
+    _rilist_link(node, &list->head, list->head.next);
+    list->len++;
+}
+
+/** node插到pos之后，pos必须在list中 */
+static inline void rilist_insert_after(rilist_t* list, rilist_node_t* pos, rilist_node_t* node) {
+    _rilist_link(node, pos, pos->next);
+    list->len++;
+}
+
+static inline void rilist_insert_before(rilist_t* list, rilist_node_t* pos, rilist_node_t* node) {
+    _rilist_link(node, pos->prev, pos);
+    list->len++;
+}
+
+static inline void rilist_remove(rilist_t* list, rilist_node_t* node) {
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = NULL;
+    node->next = NULL;
+    list->len--;
+}
+
+static inline rilist_node_t* rilist_first(rilist_t* list) {
+    return rilist_empty(list) ? NULL : list->head.next;
+}
+
+static inline rilist_node_t* rilist_last(rilist_t* list) {
+    return rilist_empty(list) ? NULL : list->head.prev;
+}
+
+/** 到尾返回NULL */
+static inline rilist_node_t* rilist_next(rilist_t* list, rilist_node_t* node) {
+    return node->next == &list->head ? NULL : node->next;
+}
+
+static inline rilist_node_t* rilist_prev(rilist_t* list, rilist_node_t* node) {
+    return node->prev == &list->head ? NULL : node->prev;
+}
+
+static inline rilist_node_t* rilist_pop_front(rilist_t* list) {
+    rilist_node_t* node = rilist_first(list);
+    if (node != NULL) {
+        rilist_remove(list, node);
+    }
+    return node;
+}
+
+static inline rilist_node_t* rilist_pop_back(rilist_t* list) {
+    rilist_node_t* node = rilist_last(list);
+    if (node != NULL) {
+        rilist_remove(list, node);
+    }
+    return node;
+}
+
+/** 移到尾部，LRU淘汰时用 */
+static inline void rilist_move_back(rilist_t* list, rilist_node_t* node) {
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    _rilist_link(node, list->head.prev, &list->head);
+}
+
+/** src整体接到dest尾部，O(1)，src变为空表 */
+static inline void rilist_splice_back(rilist_t* dest, rilist_t* src) {
+    if (rilist_empty(src)) {
+        return;
+    }
+    rilist_node_t* first = src->head.next;
+    rilist_node_t* last = src->head.prev;
+
+    first->prev = dest->head.prev;
+    dest->head.prev->next = first;
+    last->next = &dest->head;
+    dest->head.prev = last;
+    dest->len += src->len;
+
+    rilist_init(src);
+}
+
+/** src整体接到dest头部，O(1)，src变为空表 */
+static inline void rilist_splice_front(rilist_t* dest, rilist_t* src) {
+    if (rilist_empty(src)) {
+        return;
+    }
+    rilist_node_t* first = src->head.next;
+    rilist_node_t* last = src->head.prev;
+
+    last->next = dest->head.next;
+    dest->head.next->prev = last;
+    first->prev = &dest->head;
+    dest->head.next = first;
+    dest->len += src->len;
+
+    rilist_init(src);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //RILIST_H
@@ -27,6 +27,8 @@ extern "C" {
 #endif
 
 /* ------------------------------- Structs ------------------------------------*/
+struct rdata_pool;
+
 typedef void* (*rlist_malloc_node_val_func_type)(void *val);
 typedef void (*rlist_free_node_val_func_type)(void *val);
 
@@ -48,6 +50,7 @@ typedef struct rlist_t {
     rlist_malloc_node_val_func_type malloc_node_val;
     rlist_free_node_val_func_type free_node_val;
     rcom_compare_func_type compare_node_val;
+    struct rdata_pool* node_pool;//非NULL时节点从池里分配，见 rlist_enable_pool
 } rlist_t;
 
 typedef struct rlist_iterator_s {
@@ -80,7 +83,7 @@ typedef struct rlist_iterator_s {
 #define rlist_free_node(self, node) \
     if ((node) != NULL) { \
         if((self) != NULL && (self)->free_node_val) (self)->free_node_val((node)->val); \
-        rdata_free(rlist_node_t, (node)); \
+        rlist_free_node_mem((self), (node)); \
     } \
 
 #define rlist_size(self) (self)->len
@@ -109,6 +112,12 @@ do { \
 
 rlist_t* rlist_create();
 
+/** 只能在空表上开启，之后push的节点从rdata_pool分配，rlist_destroy时一起销毁 */
+int rlist_enable_pool(rlist_t *self, unsigned int init_nodes);
+
+/** 只释放节点内存，不处理val；pop出来的节点用 rlist_free_node 释放 */
+void rlist_free_node_mem(rlist_t *self, rlist_node_t *node);
+
 rlist_node_t* rlist_rpush(rlist_t *self, void* nodeVal);
 
 rlist_node_t* rlist_lpush(rlist_t *self, void* nodeVal);
@@ -14,6 +14,7 @@
 
 #include "rcommon.h"
 #include "rthread.h"
+#include "rmapfile.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -25,6 +26,34 @@ extern "C" {
 //不能小于64
 #define rlog_temp_data_size 2048
 #define rlog_cache_data_size 5120
+//异步模式每线程队列字节数，2的幂
+#define rlog_async_queue_size 262144
+//写线程单次写文件的最大字节数
+#define rlog_async_batch_size 262144
+#define rlog_async_flush_ms 1000
+#define rlog_async_idle_ms 1
+//二进制日志文件头
+#define rlog_binary_magic "RLOGBIN1"
+#define rlog_binary_magic_len 8
+//可登记的调用点数量
+#define rlog_site_max 65536
+//mmap模式每次映射的文件窗口
+#define rlog_mmap_window_size (256 * 1024)
+//按模块设置级别的表大小
+#define rlog_module_max 32
+#define rlog_module_name_size 32
+//rwarn_limit等的默认限速，每个调用点每秒条数和突发条数
+#define rlog_limit_rate_default 10
+#define rlog_limit_burst_default 20
+
+//编译期最低级别，低于它的调用点连同参数求值一起被编译器去掉，release可加-Drlog_level_min=rlog_level_info
+#ifndef rlog_level_min
+#define rlog_level_min rlog_level_verb
+#endif
+//调用点所属的模块标签，在include之前定义；未定义时按文件名匹配模块级别
+#ifndef rlog_module
+#define rlog_module NULL
+#endif
 
 #define log_in_multi_thread
 #define print2file
@@ -48,6 +77,42 @@ if (rlog_all != NULL) { \
     rlog_uninit(); \
 }
 
+#define rlog_site_init(log_level, format) \
+    { 0, (log_level), __LINE__, __FILE__, __FUNCTION__, format"\n", NULL, rlog_module, 0, false, 0, 0, 0 }
+
+/** 带调用点的日志，每个调用点一个静态rlog_site_t，rinfo等宏都走这里；级别不够时不求值参数 */
+#define rlog_site_printf(rlog, log_level, format, ...) \
+do { \
+    static rlog_site_t _rlog_site_ = rlog_site_init((log_level), format); \
+    if ((log_level) >= rlog_level_min && rlog_site_enabled((rlog), &_rlog_site_)) { \
+        rlog_printf_site((rlog), &_rlog_site_, ##__VA_ARGS__); \
+    } \
+} while (0)
+
+/** 调用点限速，每秒rate条，最多突发burst条；丢弃的条数在下一次输出前汇总为一行 */
+#define rlog_site_printf_limit(rlog, log_level, rate, burst, format, ...) \
+do { \
+    static rlog_site_t _rlog_site_ = rlog_site_init((log_level), format); \
+    if ((log_level) >= rlog_level_min && rlog_site_enabled((rlog), &_rlog_site_) && \
+        rlog_site_limit((rlog), &_rlog_site_, (rate), (burst))) { \
+        rlog_printf_site((rlog), &_rlog_site_, ##__VA_ARGS__); \
+    } \
+} while (0)
+
+/** 调用点采样，每n条输出第1条，n小于1按1处理(每条都输出) */
+#define rlog_site_printf_sample(rlog, log_level, n, format, ...) \
+do { \
+    static rlog_site_t _rlog_site_ = rlog_site_init((log_level), format); \
+    if ((log_level) >= rlog_level_min && rlog_site_enabled((rlog), &_rlog_site_) && \
+        ratomic_fetch_add(&_rlog_site_.count, 1) % ((n) > 1 ? (n) : 1) == 0) { \
+        rlog_printf_site((rlog), &_rlog_site_, ##__VA_ARGS__); \
+    } \
+} while (0)
+
+/** 调用点缓存的级别判断，级别设置变化后(version不同)重新计算 */
+#define rlog_site_enabled(rlog, site) \
+    (likely(ratomic_load(&(site)->version) == ratomic_load(&rlog_filter_version)) ? (site)->enabled : rlog_site_check((rlog), (site)))
+
 /* ------------------------------- Structs ------------------------------------*/
 
 typedef enum {
@@ -68,12 +133,48 @@ typedef enum {
     rlog_state_uninit,
 } rlog_state_t;
 
+typedef enum {
+    rlog_overflow_block = 0,//等写线程腾出空间
+    rlog_overflow_drop,//丢弃，队列恢复后写一行丢弃条数
+    rlog_overflow_count,//丢弃，只计入统计
+} rlog_overflow_t;
+
+typedef struct rlog_async_s rlog_async_t;
+typedef struct rlog_path_s rlog_path_t;
+
+/** 调用点，首次打印时登记id；二进制模式下日志只记录id和参数，文件中每个调用点写一次定义 */
+typedef struct rlog_site_s {
+    int64_t id;//0为未登记，-1为超出数量，只能按文本输出
+    rlog_level_t level;
+    int line;
+    const char* file;
+    const char* func;
+    const char* fmt;
+    const char* name;//登记时取文件名
+    const char* module;//rlog_module，NULL时按name匹配
+    int64_t version;//enabled对应的rlog_filter_version
+    bool enabled;
+    int64_t limit_at;//限速的理论到达时间(GCRA)，微秒
+    int64_t suppressed;//限速丢弃、尚未汇总的条数
+    int64_t count;//采样计数
+} rlog_site_t;
+
+typedef struct rlog_async_stats_s {
+    int64_t records;//已写出条数
+    int64_t bytes;
+    int64_t writes;//写文件次数
+    int64_t dropped;
+    int64_t blocked;//队列满时等待的次数
+    int64_t queues;//已注册的线程队列
+} rlog_async_stats_t;
+
 typedef struct rlog_info_s {
     rlog_level_t level;
     int file_size;//volatile
     rmutex_t* item_mutex;
     char* filename;
     FILE* file_ptr;
+    rmapfile_t* map_file;//mmap模式下代替file_ptr
     char* item_buffer;
     char* buffer;
     char* item_fmt;
@@ -86,25 +187,59 @@ typedef struct rlog_s {
     int file_size_max;
     rmutex_t* mutex;
     char* filepath_template;
+    rlog_path_t* filepath;//filepath_template编译后的分段
     rlog_info_t* log_items[rlog_level_all];
+    rlog_async_t* async;//非NULL时为异步模式
+    bool mmap_file;
 } rlog_t;
 
 /* ------------------------------- APIs ------------------------------------*/
 
 // extern rlog_t** rlog_all;
+//级别设置的版本，init、reset和模块级别变化时加1，调用点据此重新判断
+extern int64_t rlog_filter_version;
 
 /** file_size: 单位 m **/
 R_API int rlog_init(const char* log_default_filename, const rlog_level_t log_default_level, const bool log_default_seperate_file, int file_size);
 R_API int rlog_uninit();
 
 R_API int rlog_init_log(rlog_t* rlog, const char* filename, const rlog_level_t level, const bool seperate_file, int file_size);
+/** 运行时修改级别和滚动大小，file_size <= 0 时不改 */
 R_API int rlog_reset(rlog_t* rlog, const rlog_level_t level, int file_size);
 R_API int rlog_uninit_log(rlog_t* rlog);
 
 R_API int rlog_printf_cached(rlog_t* rlog, rlog_level_t level, const char* fmt, ...);
 R_API int rlog_printf(rlog_t* rlog, rlog_level_t evel, const char* fmt, ...);
+/** 文本模式下输出"[线程] 文件:函数:行 "加内容，二进制模式下只记录参数 */
+R_API int rlog_printf_site(rlog_t* rlog, rlog_site_t* site, ...);
+/** 重新计算调用点是否输出并缓存，rlog为NULL时取默认rlog，未初始化时返回true */
+R_API bool rlog_site_check(rlog_t* rlog, rlog_site_t* site);
+/** 令牌桶取一个令牌，没有时计入suppressed返回false；有丢弃时先输出汇总行 */
+R_API bool rlog_site_limit(rlog_t* rlog, rlog_site_t* site, int rate, int burst);
+/**
+ * 模块单独设置级别，优先于rlog的级别；module为调用点文件名(如"ripc.c")或rlog_module标签
+ * 只作用于调用点日志，表满返回rcode_invalid
+ */
+R_API int rlog_set_module_level(const char* module, rlog_level_t level);
+R_API int rlog_remove_module_level(const char* module);
 R_API int rlog_flush_file(rlog_t* rlog, const rlog_level_t level, bool close_file);
 R_API int rlog_rolling_file(rlog_t* rlog, const rlog_level_t level);
+/** 文件改为mmap窗口写入，写日志不再有系统调用；切换时滚动文件，只支持linux和单个文件 */
+R_API int rlog_set_mmap(rlog_t* rlog, bool enable);
+/** 行头"yyyy-mm-dd hh:MM:ss mmm [LEVEL] "写入buffer(至少64字节)，返回长度；日期部分每线程按秒缓存 */
+R_API int rlog_format_head(char* buffer, int64_t time, rlog_level_t level);
+
+/**
+ * 异步模式：每个线程格式化后写入自己的无锁队列，写线程批量写文件、滚动文件和定时flush
+ * 同一时间只支持一个rlog开启；rlog为NULL时取默认rlog
+ * 停止前应确保其他线程不再打日志，停止时写完队列中剩余的日志
+ * binary: 调用点日志不在打印线程格式化，写二进制记录，用rlogdump转回文本；开启和停止时滚动文件，不输出到控制台
+ */
+R_API int rlog_start_async(rlog_t* rlog, rlog_overflow_t overflow, bool binary);
+R_API int rlog_stop_async(rlog_t* rlog);
+R_API int rlog_async_stats(rlog_t* rlog, rlog_async_stats_t* stats);
+/** 二进制日志文件转文本，写到out */
+R_API int rlog_binary_dump(const char* filepath, FILE* out);
 
 
 #ifdef __cplusplus
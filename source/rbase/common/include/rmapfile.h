@@ -0,0 +1,57 @@
+/**
+ * Copyright (c) 2014 ray
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the MIT license. See LICENSE for details.
+ *
+ * @author: Ray
+ */
+
+#ifndef RMAPFILE_H
+#define RMAPFILE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "rcommon.h"
+#include "rthread.h"
+
+/**
+ * 只追加的mmap文件，按窗口fallocate预分配并映射，写入为memcpy，不走系统调用
+ * 窗口写满后映射下一个窗口，关闭时按实际长度truncate；进程崩溃时已写入的数据仍在page cache中
+ * 写入需由调用方串行，size可在其他线程读取；仅支持linux，其他平台open返回NULL
+ */
+
+/* ------------------------------- Macros ------------------------------------*/
+
+#define rmapfile_window_size_default (4 * 1024 * 1024)
+
+#define rmapfile_size(d) ratomic_load(&(d)->size)
+
+/* ------------------------------- Structs ------------------------------------*/
+
+typedef struct rmapfile_s {
+    int fd;
+    char* window;
+    int64_t window_offset;//窗口在文件中的起始位置
+    int64_t window_size;
+    int64_t size;//已写入长度，即写游标
+    int64_t capacity;//已预分配长度
+} rmapfile_t;
+
+/* ------------------------------- APIs ------------------------------------*/
+
+/** 创建或清空文件，window_size按页对齐，0为默认值 */
+R_API rmapfile_t* rmapfile_open(const char* filename, int64_t window_size);
+R_API int rmapfile_write(rmapfile_t* d, const char* data, int64_t len);
+/** 刷到磁盘，sync为false时只发起回写 */
+R_API int rmapfile_flush(rmapfile_t* d, bool sync);
+/** 解除映射，截掉预分配的尾部；截断失败返回非0，不打日志(rlog滚动时持锁调用) */
+R_API int rmapfile_close(rmapfile_t* d);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //RMAPFILE_H
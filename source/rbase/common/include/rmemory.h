@@ -23,6 +23,18 @@ extern "C" {
 
 // #define rmemory_enable_tracer 1
 
+/** align必须是2的幂且为sizeof(void*)的倍数 */
+#ifdef ros_windows
+#define rmem_aligned_alloc(align, size) _aligned_malloc((size), (align))
+#define rmem_aligned_free(ptr) _aligned_free((ptr))
+#else
+static inline void* rmem_aligned_alloc(size_t align, size_t size) {
+    void* ptr = NULL;
+    return posix_memalign(&ptr, align, size) == 0 ? ptr : NULL;
+}
+#define rmem_aligned_free(ptr) free((ptr))
+#endif //ros_windows
+
 #ifndef rmemory_enable_tracer
 
 #define raymalloc(elem_size) malloc((elem_size))
@@ -34,6 +46,12 @@ do { \
     free((ptr)); \
     (ptr) = NULL; \
 } while (0)
+#define raymalloc_aligned(align, size) rmem_aligned_alloc((align), (size))
+#define rayfree_aligned(ptr) \
+do { \
+    rmem_aligned_free((ptr)); \
+    (ptr) = NULL; \
+} while (0)
 
 #else //rmemory_enable_tracer
 
@@ -46,6 +64,12 @@ do { \
     rmem_free((ptr), rthread_cur_id(), get_filename(__FILE__), __FUNCTION__, __LINE__); \
     (ptr) = NULL; \
 } while (0)
+#define raymalloc_aligned(align, size) rmem_malloc_aligned_trace((align), (size), rthread_cur_id(), get_filename(__FILE__), __FUNCTION__, __LINE__)
+#define rayfree_aligned(ptr) \
+do { \
+    rmem_free_aligned((ptr), rthread_cur_id(), get_filename(__FILE__), __FUNCTION__, __LINE__); \
+    (ptr) = NULL; \
+} while (0)
 
 #endif //rmemory_enable_tracer
 
@@ -54,7 +78,7 @@ do { \
 #define rmem_out_filepath_default "./rmem_leak.out"
 
 // extern const 
-extern rdict_t* rmem_trace_map;
+extern struct rdict_sharded_s* rmem_trace_map;
 
 int rmem_init();
 int rmem_uninit();
@@ -63,6 +87,35 @@ int rmem_statistics(char* filepath);
 void* rmem_malloc_trace(size_t size, long thread_id, char* filename, const char* func, int line);
 void* rmem_cmalloc_trace(size_t elem_size, size_t count, long thread_id, char* filename, const char* func, int line);
 int rmem_free(void* ptr, long thread_id, char* filename, const char* func, int line);
+void* rmem_malloc_aligned_trace(size_t align, size_t size, long thread_id, char* filename, const char* func, int line);
+int rmem_free_aligned(void* ptr, long thread_id, char* filename, const char* func, int line);
+
+/**
+ * 分级内存分配(RAY_USE_POOL 时 rdata_new/rdata_new_size/rdata_free 使用)
+ * 小于等于 rmem_class_size_max 的请求按大小分级，从预留地址区间内按 rmem_class_slab_size 对齐的slab分配，
+ * slab头记录分级，free时先判断地址区间，区间内掩码得slab头，区间外(大对象/区间耗尽)走系统堆。
+ * 分级大小都是16的倍数，返回地址16字节对齐。
+ */
+#define rmem_class_count 24
+#define rmem_class_size_max 2048
+#define rmem_class_slab_size (64 * 1024)
+#define rmem_class_region_size ((size_t)1024 * 1024 * 1024)
+
+typedef struct rmem_class_stat_s {
+    size_t size;
+    int64_t hit;//已有slab满足
+    int64_t miss;//需新slab
+    int64_t used;
+    int64_t slabs;
+} rmem_class_stat_t;
+
+int rmem_class_init();
+/** 还有分级内存未释放时不释放区间，返回非0 */
+int rmem_class_uninit();
+void* rmem_class_alloc(size_t size);
+void rmem_class_free(void* ptr);
+/** stats至少 rmem_class_count 个，返回分级数，large_count 为走系统堆的次数 */
+int rmem_class_stat(rmem_class_stat_t* stats, int64_t* large_count);
 
 typedef enum {
     rmem_byte_order_code_unknown = 0,
@@ -4,6 +4,7 @@
 #include "rmemory.h"
 #include "rlog.h"
 #include "rlist.h"
+#include "rtools.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -40,19 +41,44 @@ extern "C" {
 typedef void (*rpool_type_travel_block_func)(void(*do_action)(void* item));
 typedef void (*rpool_type_destroy_pool_func)(void* pool);
 
+/**
+ * 位图slab池，运行时指定元素大小，每块默认 pool_block_item_count(64) 个槽，大元素可用 rdata_pool_create_ext 减少，
+ * 超出 block_items 的位常置1；used_bits 的 ctz 定位空闲槽；
+ * nonfull_bits 每块一位(有空槽)，summary_bits 每个nonfull字一位，两次ctz找到未满块(4096块以内O(1))；
+ * 块按 block_align 对齐，free 地址取掩码得块头；完全空闲的块(常驻的初始块除外)保留一个备用，再有空块才释放，
+ * 避免在块边界来回分配释放时反复malloc/free整块。
+ */
+typedef struct rdata_pool rdata_pool;
+
 typedef struct rdata_pool_block {
     uint64_t used_bits;//0:free 1:used
+    rdata_pool* pool;
     unsigned int data_total_size;
+    unsigned int size_elem;
+    int index;
+    int reserved;
     char data_buffer[0];
 } rdata_pool_block;
 
-typedef struct rdata_pool {
+struct rdata_pool {
     unsigned int size_elem;
     unsigned int init_elems;
-    unsigned int adjust_elems;
-    rlist_t* full_list;
-    rlist_t* free_list;
-} rdata_pool;
+    int block_keep;//常驻块数，不释放
+    int block_spare;//备用空块下标，-1为无
+    int block_items;//每块槽数，不超过 pool_block_item_count
+    uint64_t block_empty_bits;//空块的used_bits，超出block_items的位为1
+    size_t block_align;
+    int64_t capacity;
+    int64_t total_free;
+    int block_count;
+    int block_top;
+    int block_capacity;
+    rdata_pool_block** blocks;
+    uint64_t* nonfull_bits;
+    uint64_t* summary_bits;
+    int* slot_free;
+    int slot_free_count;
+};
 
 typedef struct rpool_chain_node_t {
     void* pool_self;
@@ -64,6 +90,13 @@ typedef struct rpool_chain_node_t {
 
 extern rpool_chain_node_t* rpool_chain;
 
+/**
+ * 块按 block_align(2的幂) 对齐分配，块头在起始位置，free时地址取掩码即得所属块；
+ * 有空闲的块在 free_head_block 链，满块移入 full_head_block 链，get不扫描满块。
+ */
+#define rpool_block_header_size(TYPE) ((sizeof(rpool_block_##TYPE##_t) + 15) & ~(size_t)15)
+#define rpool_block_of(TYPE, item, align) ((rpool_block_##TYPE##_t*)((uintptr_t)(item) & ~((uintptr_t)(align) - 1)))
+
 #define rpool_declare(TYPE)\
     typedef union rpool_##TYPE##_item_u rpool_##TYPE##_item_t; \
     union rpool_##TYPE##_item_u { \
@@ -73,8 +106,6 @@ extern rpool_chain_node_t* rpool_chain;
     typedef struct rpool_block_##TYPE##_t { \
         int total_count; \
         int free_count; \
-        int64_t item_first; \
-        int64_t item_last; \
         struct rpool_block_##TYPE##_t* next_block; \
         struct rpool_block_##TYPE##_t* prev_block; \
         rpool_##TYPE##_item_t* head; \
@@ -83,7 +114,9 @@ extern rpool_chain_node_t* rpool_chain;
     typedef struct rpool_##TYPE##_t { \
         int64_t capacity; \
         int64_t total_free; \
+        size_t block_align; \
         rpool_block_##TYPE##_t* free_head_block; \
+        rpool_block_##TYPE##_t* full_head_block; \
     } rpool_##TYPE##_t; \
     rpool_##TYPE##_t* rpool_##TYPE##_create(); \
     void rpool_##TYPE##_destroy(rpool_##TYPE##_t* pool); \
@@ -98,23 +131,38 @@ extern rpool_chain_node_t* rpool_chain;
         action_func(rget_pool(TYPE)); \
     } \
   } \
+  static inline void rpool_##TYPE##_unlink(rpool_block_##TYPE##_t** list_head, rpool_block_##TYPE##_t* pool_block) { \
+    if (pool_block->prev_block != NULL) { \
+        pool_block->prev_block->next_block = pool_block->next_block; \
+    } else { \
+        *list_head = pool_block->next_block; \
+    } \
+    if (pool_block->next_block != NULL) { \
+        pool_block->next_block->prev_block = pool_block->prev_block; \
+    } \
+    pool_block->next_block = NULL; \
+    pool_block->prev_block = NULL; \
+  } \
+  static inline void rpool_##TYPE##_link(rpool_block_##TYPE##_t** list_head, rpool_block_##TYPE##_t* pool_block) { \
+    pool_block->prev_block = NULL; \
+    pool_block->next_block = *list_head; \
+    if (*list_head != NULL) { \
+        (*list_head)->prev_block = pool_block; \
+    } \
+    *list_head = pool_block; \
+  } \
   static inline rpool_block_##TYPE##_t* rpool_##TYPE##_expand(rpool_##TYPE##_t* pool, int num) { \
     if (pool == NULL) { \
 	    rinfo(#TYPE" rpool is NULL"); \
         return NULL; \
     } \
-    rpool_block_##TYPE##_t* pool_block = raymalloc(sizeof(rpool_block_##TYPE##_t)); \
+    rpool_block_##TYPE##_t* pool_block = raymalloc_aligned(pool->block_align, \
+        rpool_block_header_size(TYPE) + num * sizeof(rpool_##TYPE##_item_t)); \
     if (pool_block == NULL) { \
 		rerror(#TYPE" pool_block is NULL"); \
         return NULL; /* malloc failed */ \
     } \
-    pool_block->items = raycmalloc_type(num, rpool_##TYPE##_item_t); \
-    if (pool_block->items == NULL) { \
-        rayfree(pool_block); \
-        pool_block = NULL; \
-		rerror(#TYPE" pool_block->items is NULL"); \
-        return NULL; /* calloc failed */ \
-    } \
+    pool_block->items = (rpool_##TYPE##_item_t*)((char*)pool_block + rpool_block_header_size(TYPE)); \
     pool_block->head = &pool_block->items[0]; \
     for (size_t i = 0; i < num - 1; i++) { \
       pool_block->items[i].next = &pool_block->items[i + 1]; \
@@ -122,14 +170,11 @@ extern rpool_chain_node_t* rpool_chain;
     pool_block->items[num - 1].next = NULL; \
     pool_block->total_count = num; \
     pool_block->free_count = num; \
-    pool_block->item_first = (int64_t)pool_block->head; \
-    pool_block->item_last = (int64_t)(&pool_block->items[num - 1]); \
-    pool_block->next_block = NULL; \
-    pool_block->prev_block = NULL; \
+    rpool_##TYPE##_link(&pool->free_head_block, pool_block); \
     pool->capacity += num; \
     pool->total_free += num; \
-    rinfo("expand block "#TYPE"(%"PRId64", %d, %p->%p = [%"PRId64", %"PRId64"]) success, (%p)", \
-		pool->capacity, num, pool_block, pool_block->items, pool_block->item_first, pool_block->item_last, pool); \
+    rinfo("expand block "#TYPE"(%"PRId64", %d, %p->%p) success, (%p)", \
+		pool->capacity, num, pool_block, pool_block->items, pool); \
     return pool_block; \
   } \
   rpool_##TYPE##_t* rpool_##TYPE##_create() { \
@@ -140,13 +185,18 @@ extern rpool_chain_node_t* rpool_chain;
     pool->capacity = 0; \
     pool->total_free = 0; \
     pool->free_head_block = NULL; \
+    pool->full_head_block = NULL; \
+    pool->block_align = 64; \
+    while (pool->block_align < rpool_block_header_size(TYPE) + \
+            rmacro_max(size_init, size_adjust) * sizeof(rpool_##TYPE##_item_t)) { \
+        pool->block_align <<= 1; \
+    } \
     rpool_block_##TYPE##_t* pool_block = rpool_##TYPE##_expand(pool, size_init); \
     if (pool_block == NULL) { \
         rayfree(pool); \
         pool = NULL; \
         return NULL; \
     } \
-    pool->free_head_block = pool_block; \
     rpool_chain_node_t* chain_node = raymalloc(sizeof(rpool_chain_node_t)); \
     if (chain_node == NULL) { \
         rinfo("create rpool "#TYPE"(%d, %d) failed add to chain, (%p)", size_init, size_adjust, pool); \
@@ -158,7 +208,7 @@ extern rpool_chain_node_t* rpool_chain;
     chain_node->rpool_travel_block_func = (rpool_type_travel_block_func)rpool_travel_##TYPE##_info; \
     chain_node->rpool_destroy_pool_func = (rpool_type_destroy_pool_func)rpool_##TYPE##_destroy; \
     rpool_chain->next = chain_node; \
-    rinfo("create rpool "#TYPE"(%d, %d) success, (%p)", size_init, size_adjust, pool); \
+    rinfo("create rpool "#TYPE"(%d, %d) success, align(%zu), (%p)", size_init, size_adjust, pool->block_align, pool); \
     return pool; \
   } \
   void rpool_##TYPE##_destroy(rpool_##TYPE##_t* pool) { \
@@ -167,15 +217,14 @@ extern rpool_chain_node_t* rpool_chain;
         rinfo("destroy "#TYPE"(%d, %d), rpool is NULL, (%p)", size_init, size_adjust, pool); \
         return; \
     } \
-    rpool_block_##TYPE##_t* pool_block = pool->free_head_block; \
-    while (pool_block != NULL) { \
-		rpool_block_##TYPE##_t* next_block = pool_block->next_block; \
-        if (next_block != NULL) { \
-            next_block->prev_block = pool_block->prev_block; \
-        } \
-        rayfree(pool_block->items); \
-        rayfree(pool_block); \
-        pool_block = next_block; \
+    rpool_block_##TYPE##_t* pool_block = NULL; \
+    while ((pool_block = pool->free_head_block) != NULL) { \
+        pool->free_head_block = pool_block->next_block; \
+        rayfree_aligned(pool_block); \
+    } \
+    while ((pool_block = pool->full_head_block) != NULL) { \
+        pool->full_head_block = pool_block->next_block; \
+        rayfree_aligned(pool_block); \
     } \
 	if (rpool_chain != NULL) { \
 		rpool_chain_node_t* chain_node_temp = rpool_chain; \
@@ -205,33 +254,21 @@ extern rpool_chain_node_t* rpool_chain;
         return NULL; \
     } \
     rpool_block_##TYPE##_t* pool_block = pool->free_head_block; \
-    rpool_##TYPE##_item_t* item = pool_block->head; \
-    if(item == NULL) { \
-        while (pool_block->next_block != NULL) { \
-            pool_block = pool_block->next_block; \
-            item = pool_block->head; \
-            if(item != NULL) \
-                break; \
-        } \
-        if(item == NULL) { \
-            pool_block = rpool_##TYPE##_expand(pool, size_adjust); \
-            if (pool_block == NULL) { \
-                rinfo("malloc from rpool "#TYPE"(%d, %d) failed.", size_init, size_adjust); \
-                return NULL; \
-            } \
-            rpool_block_##TYPE##_t* block_second = pool->free_head_block->next_block; \
-            pool->free_head_block->next_block = pool_block;/*空的插入头部后面*/ \
-            if (block_second != NULL) { \
-                block_second->prev_block = pool_block; \
-            } \
-            pool_block->prev_block = pool->free_head_block; \
-            pool_block->next_block = block_second; \
-            item = pool_block->head; \
+    if (pool_block == NULL) { \
+        pool_block = rpool_##TYPE##_expand(pool, size_adjust); \
+        if (pool_block == NULL) { \
+            rinfo("malloc from rpool "#TYPE"(%d, %d) failed.", size_init, size_adjust); \
+            return NULL; \
         } \
     } \
+    rpool_##TYPE##_item_t* item = pool_block->head; \
     pool_block->head = item->next; \
     pool_block->free_count -= 1; \
     pool->total_free -= 1; \
+    if (pool_block->head == NULL) { \
+        rpool_##TYPE##_unlink(&pool->free_head_block, pool_block); \
+        rpool_##TYPE##_link(&pool->full_head_block, pool_block); \
+    } \
     /** rinfo("malloc, "#TYPE"(%p)", item); **/ \
     return &(item->data); \
   } \
@@ -240,56 +277,332 @@ extern rpool_chain_node_t* rpool_chain;
         rerror("free to "#TYPE"(%d, %d), rpool is NULL, (%p)", size_init, size_adjust, pool); \
         return -1; \
     } \
-    rpool_block_##TYPE##_t* pool_block = pool->free_head_block; \
     rpool_##TYPE##_item_t* item_data = (rpool_##TYPE##_item_t*)data;\
-	/** rinfo("free from pool "#TYPE" block[%p, [%p], %p), %s", pool_block->items, data, (pool_block->items + pool_block->total_count), __FUNCTION__); **/ \
-    if((item_data < pool_block->items) || (item_data >= (pool_block->items + pool_block->total_count))) { \
-        while ((pool_block = pool_block->next_block) != NULL) { \
-			/** rinfo("free to "#TYPE" pool block(%d,%d) [%p, {%p}, %p)", \
-				pool_block->total_count, pool_block->free_count, pool_block->items, data, (pool_block->items + pool_block->total_count)); **/ \
-            if((item_data >= pool_block->items) && (item_data < (pool_block->items + pool_block->total_count))) { \
-                break; \
-            } \
-        } \
-        if (pool_block == NULL) { \
-            rerror("free to pool "#TYPE"(%d, %d) failed, %p", size_init, size_adjust, data); \
-            return -1; \
-        } \
+    rpool_block_##TYPE##_t* pool_block = rpool_block_of(TYPE, item_data, pool->block_align); \
+    if (unlikely((item_data < pool_block->items) || (item_data >= (pool_block->items + pool_block->total_count)))) { \
+        rerror("free to pool "#TYPE"(%d, %d) failed, %p", size_init, size_adjust, data); \
+        return -1; \
+    } \
+    if (pool_block->head == NULL) { \
+        rpool_##TYPE##_unlink(&pool->full_head_block, pool_block); \
+        rpool_##TYPE##_link(&pool->free_head_block, pool_block); \
     } \
     item_data->next = pool_block->head; \
     pool_block->head = item_data; \
     pool_block->free_count++; \
     pool->total_free++; \
-    /** rinfo("free success: (%d,%d) [%p, {%p}, %p)", \
-			pool_block->total_count, pool_block->free_count, pool_block->items, data, pool_block->items + pool_block->total_count); **/ \
-    if (pool->free_head_block != pool_block) { \
-        if (pool->total_free > 2 * pool_block->free_count) { \
-            if (unlikely(pool_block->total_count == pool_block->free_count)) { \
-                rinfo("free block: "#TYPE"(%"PRId64", %"PRId64") [%p, %d]", pool->capacity, pool->total_free, pool_block, pool_block->total_count); \
-                pool->capacity -= pool_block->total_count; \
-                pool->total_free -= pool_block->total_count; \
-                pool_block->prev_block->next_block = pool_block->next_block; \
-                if (pool_block->next_block != NULL) { \
-                    pool_block->next_block->prev_block = pool_block->prev_block; \
-                } \
-                rayfree(pool_block->items); \
-                rayfree(pool_block); \
-/**        } else { **if ((pool->capacity - pool->total_free) < (pool->capacity / RAY_PROFILER_POOL_SHRINK)) { **\
-                if (pool_block = pool_block->next_block) { \
-                    if (pool_block->prev_block->free_count > pool_block->free_count) { \
-                        ** rinfo("change block: "#TYPE"(%"PRId64", %"PRId64") [%p, %d] ", pool->capacity, pool->total_free, pool_block, pool_block->total_count); ** \
-                        rpool_block_##TYPE##_t* b1 = pool_block->prev_block; \
-                        b1->next_block = pool_block->next_block; \
-                        pool_block->next_block = b1; \
-                        pool_block->prev_block = b1->prev_block; \
-                        b1->prev_block = pool_block; \
-                    } \
+    if (unlikely(pool_block->total_count == pool_block->free_count) && pool->free_head_block != pool_block && \
+            pool->total_free > 2 * pool_block->free_count) { \
+        rinfo("free block: "#TYPE"(%"PRId64", %"PRId64") [%p, %d]", pool->capacity, pool->total_free, pool_block, pool_block->total_count); \
+        pool->capacity -= pool_block->total_count; \
+        pool->total_free -= pool_block->total_count; \
+        rpool_##TYPE##_unlink(&pool->free_head_block, pool_block); \
+        rayfree_aligned(pool_block); \
+    } \
+    return rcode_ok; \
+  } \
+  rattribute_unused(static TYPE* malloc_##TYPE##_data (size_t size) { \
+    return rdata_new(TYPE); \
+  }) \
+  rattribute_unused(static void free_##TYPE##_data (TYPE* data) { \
+    rdata_free(TYPE, data); \
+  })
+
+/**
+ * 线程安全池，接口同 rpool_init，使用 rpool_declare_ts/rdefine_pool_ts 定义
+ * 每个线程独占一个heap(块链和空闲链)，get和本线程free不加锁也不用原子操作；
+ * 其他线程free的数据以无锁方式压入所属heap的remote链，所属线程在本地耗尽或积累到 rpool_remote_batch 个时批量回收。
+ * 线程退出后heap保留到pool销毁，destroy须在所有线程停止使用后调用；capacity/total_free 需 rpool_sync_stat 后读取。
+ */
+#define rpool_remote_batch 64
+
+#define rdefine_pool_ts(T, size_init, size_adjust) rpool_init_ts(T, size_init, size_adjust)
+#define rpool_sync_stat(T) rpool_##T##_sync(rget_pool(T))
+
+#define rpool_declare_ts(TYPE)\
+    typedef struct rpool_block_##TYPE##_t rpool_block_##TYPE##_t; \
+    typedef struct rpool_heap_##TYPE##_t rpool_heap_##TYPE##_t; \
+    typedef struct rpool_##TYPE##_item_s rpool_##TYPE##_item_t; \
+    struct rpool_##TYPE##_item_s { \
+        rpool_block_##TYPE##_t* block; \
+        union { \
+            rpool_##TYPE##_item_t* next; \
+            TYPE data; \
+        } u; \
+    }; \
+    struct rpool_block_##TYPE##_t { \
+        int total_count; \
+        int free_count; \
+        rpool_heap_##TYPE##_t* heap; \
+        struct rpool_block_##TYPE##_t* next_block; \
+        struct rpool_block_##TYPE##_t* prev_block; \
+        rpool_##TYPE##_item_t* head; \
+        rpool_##TYPE##_item_t* items; \
+    }; \
+    struct rpool_heap_##TYPE##_t { \
+        long thread_id; \
+        int64_t capacity; \
+        int64_t total_free; \
+        rpool_block_##TYPE##_t* free_head_block; \
+        rpool_##TYPE##_item_t* remote_head;/*其他线程释放，多生产单消费*/ \
+        int64_t remote_count; \
+        struct rpool_##TYPE##_t* pool; \
+        rpool_heap_##TYPE##_t* next_heap; \
+    }; \
+    typedef struct rpool_##TYPE##_t { \
+        int64_t capacity; \
+        int64_t total_free; \
+        int64_t epoch; \
+        rpool_heap_##TYPE##_t* heaps; \
+    } rpool_##TYPE##_t; \
+    rpool_##TYPE##_t* rpool_##TYPE##_create(); \
+    void rpool_##TYPE##_destroy(rpool_##TYPE##_t* pool); \
+    TYPE* rpool_##TYPE##_get(rpool_##TYPE##_t* pool); \
+    int rpool_##TYPE##_free(TYPE* data, rpool_##TYPE##_t* pool); \
+    int64_t rpool_##TYPE##_sync(rpool_##TYPE##_t* pool)
+
+#define rpool_init_ts(TYPE, size_init, size_adjust) \
+  rdeclare_pool(TYPE) = NULL; \
+  static int64_t rpool_##TYPE##_epoch = 0; \
+  static rthread_local rpool_heap_##TYPE##_t* rpool_##TYPE##_local_heap = NULL; \
+  static rthread_local int64_t rpool_##TYPE##_local_epoch = 0; \
+  static void rpool_travel_##TYPE##_info(void (*action_func)(void* item)) { \
+    rpool_##TYPE##_sync(rget_pool(TYPE)); \
+    rinfo("pool "#TYPE": [%"PRId64", %"PRId64"]", rget_pool(TYPE)->capacity, rget_pool(TYPE)->total_free); \
+    if (action_func != NULL) { \
+        action_func(rget_pool(TYPE)); \
+    } \
+  } \
+  static inline rpool_block_##TYPE##_t* rpool_##TYPE##_expand(rpool_heap_##TYPE##_t* heap, int num) { \
+    rpool_block_##TYPE##_t* pool_block = raymalloc(sizeof(rpool_block_##TYPE##_t)); \
+    if (pool_block == NULL) { \
+        rerror(#TYPE" pool_block is NULL"); \
+        return NULL; /* malloc failed */ \
+    } \
+    pool_block->items = raycmalloc_type(num, rpool_##TYPE##_item_t); \
+    if (pool_block->items == NULL) { \
+        rayfree(pool_block); \
+        rerror(#TYPE" pool_block->items is NULL"); \
+        return NULL; /* calloc failed */ \
+    } \
+    pool_block->head = &pool_block->items[0]; \
+    for (int i = 0; i < num; i++) { \
+        pool_block->items[i].block = pool_block; \
+        pool_block->items[i].u.next = i < num - 1 ? &pool_block->items[i + 1] : NULL; \
+    } \
+    pool_block->total_count = num; \
+    pool_block->free_count = num; \
+    pool_block->heap = heap; \
+    if (heap->free_head_block == NULL) { \
+        pool_block->prev_block = NULL; \
+        pool_block->next_block = NULL; \
+        heap->free_head_block = pool_block; \
+    } else {/*空的插入头部后面*/ \
+        pool_block->prev_block = heap->free_head_block; \
+        pool_block->next_block = heap->free_head_block->next_block; \
+        if (pool_block->next_block != NULL) { \
+            pool_block->next_block->prev_block = pool_block; \
+        } \
+        heap->free_head_block->next_block = pool_block; \
+    } \
+    heap->capacity += num; \
+    heap->total_free += num; \
+    rinfo("expand block "#TYPE"(%"PRId64", %d, %p->%p) success, thread(%ld)", \
+        heap->capacity, num, pool_block, pool_block->items, heap->thread_id); \
+    return pool_block; \
+  } \
+  static inline rpool_heap_##TYPE##_t* rpool_##TYPE##_heap(rpool_##TYPE##_t* pool) { \
+    rpool_heap_##TYPE##_t* heap = rpool_##TYPE##_local_heap; \
+    if (likely(heap != NULL && rpool_##TYPE##_local_epoch == pool->epoch)) { \
+        return heap; \
+    } \
+    heap = raymalloc(sizeof(rpool_heap_##TYPE##_t)); \
+    if (heap == NULL) { \
+        rerror(#TYPE" heap is NULL"); \
+        return NULL; \
+    } \
+    heap->thread_id = rthread_cur_id(); \
+    heap->capacity = 0; \
+    heap->total_free = 0; \
+    heap->free_head_block = NULL; \
+    heap->remote_head = NULL; \
+    heap->remote_count = 0; \
+    heap->pool = pool; \
+    do { \
+        heap->next_heap = ratomic_load_ptr(&pool->heaps); \
+    } while (!ratomic_cas_ptr(&pool->heaps, heap->next_heap, heap)); \
+    rpool_##TYPE##_local_heap = heap; \
+    rpool_##TYPE##_local_epoch = pool->epoch; \
+    rinfo("create heap of rpool "#TYPE" success, thread(%ld), (%p)", heap->thread_id, pool); \
+    return heap; \
+  } \
+  static inline void rpool_##TYPE##_release(rpool_heap_##TYPE##_t* heap, rpool_##TYPE##_item_t* item) { \
+    rpool_block_##TYPE##_t* pool_block = item->block; \
+    item->u.next = pool_block->head; \
+    pool_block->head = item; \
+    pool_block->free_count++; \
+    heap->total_free++; \
+    if (heap->free_head_block != pool_block && unlikely(pool_block->total_count == pool_block->free_count) && \
+            heap->total_free > 2 * pool_block->free_count) { \
+        heap->capacity -= pool_block->total_count; \
+        heap->total_free -= pool_block->total_count; \
+        pool_block->prev_block->next_block = pool_block->next_block; \
+        if (pool_block->next_block != NULL) { \
+            pool_block->next_block->prev_block = pool_block->prev_block; \
+        } \
+        rayfree(pool_block->items); \
+        rayfree(pool_block); \
+    } \
+  } \
+  static inline void rpool_##TYPE##_collect(rpool_heap_##TYPE##_t* heap) { \
+    rpool_##TYPE##_item_t* item = ratomic_xchg_ptr(&heap->remote_head, NULL); \
+    rpool_##TYPE##_item_t* item_next = NULL; \
+    int64_t count = 0; \
+    while (item != NULL) { \
+        item_next = item->u.next; \
+        rpool_##TYPE##_release(heap, item); \
+        item = item_next; \
+        count++; \
+    } \
+    ratomic_fetch_add(&heap->remote_count, -count); \
+  } \
+  rpool_##TYPE##_t* rpool_##TYPE##_create() { \
+    rpool_##TYPE##_t* pool = raymalloc(sizeof(rpool_##TYPE##_t)); \
+    if (pool == NULL) { \
+      return NULL; /* memory malloc failed */ \
+    } \
+    pool->capacity = 0; \
+    pool->total_free = 0; \
+    pool->epoch = ratomic_fetch_add(&rpool_##TYPE##_epoch, 1) + 1; \
+    pool->heaps = NULL; \
+    rpool_chain_node_t* chain_node = raymalloc(sizeof(rpool_chain_node_t)); \
+    if (chain_node == NULL) { \
+        rinfo("create rpool "#TYPE"(%d, %d) failed add to chain, (%p)", size_init, size_adjust, pool); \
+        rayfree(pool); \
+        return NULL; \
+    } \
+    chain_node->next = rpool_chain->next; \
+    chain_node->prev = rpool_chain; \
+    chain_node->pool_self = pool; \
+    chain_node->rpool_travel_block_func = (rpool_type_travel_block_func)rpool_travel_##TYPE##_info; \
+    chain_node->rpool_destroy_pool_func = (rpool_type_destroy_pool_func)rpool_##TYPE##_destroy; \
+    rpool_chain->next = chain_node; \
+    rinfo("create rpool "#TYPE"(%d, %d) success, (%p)", size_init, size_adjust, pool); \
+    return pool; \
+  } \
+  void rpool_##TYPE##_destroy(rpool_##TYPE##_t* pool) { \
+    pool = pool == NULL ? rget_pool(TYPE) : pool; \
+    if (pool == NULL || rget_pool(TYPE) == NULL) { \
+        rinfo("destroy "#TYPE"(%d, %d), rpool is NULL, (%p)", size_init, size_adjust, pool); \
+        return; \
+    } \
+    rpool_heap_##TYPE##_t* heap = pool->heaps; \
+    while (heap != NULL) { \
+        rpool_heap_##TYPE##_t* next_heap = heap->next_heap; \
+        rpool_block_##TYPE##_t* pool_block = heap->free_head_block; \
+        while (pool_block != NULL) { \
+            rpool_block_##TYPE##_t* next_block = pool_block->next_block; \
+            rayfree(pool_block->items); \
+            rayfree(pool_block); \
+            pool_block = next_block; \
+        } \
+        rayfree(heap); \
+        heap = next_heap; \
+    } \
+	if (rpool_chain != NULL) { \
+		rpool_chain_node_t* chain_node_temp = rpool_chain; \
+		while ((chain_node_temp = chain_node_temp->next) != NULL) { \
+			if (chain_node_temp->pool_self == pool) { \
+				if (chain_node_temp->prev != NULL) { \
+					chain_node_temp->prev->next = chain_node_temp->next; \
+				} else { \
+					rpool_chain = chain_node_temp->next; \
+				} \
+				if (chain_node_temp->next != NULL) { \
+					chain_node_temp->next->prev = chain_node_temp->prev; \
+				} \
+				rayfree(chain_node_temp); \
+				chain_node_temp = NULL; \
+				break; \
+			} \
+		} \
+	} \
+    rinfo("destroy rpool "#TYPE"(%d, %d) success, (%p)", size_init, size_adjust, pool); \
+    rayfree(pool); \
+    rget_pool(TYPE) = NULL; \
+  } \
+  TYPE* rpool_##TYPE##_get(rpool_##TYPE##_t* pool) { \
+    if (rget_pool(TYPE) == NULL) { \
+        rerror("get from "#TYPE"(%d, %d), rpool is NULL, (%p)", size_init, size_adjust, pool); \
+        return NULL; \
+    } \
+    rpool_heap_##TYPE##_t* heap = rpool_##TYPE##_heap(pool); \
+    if (heap == NULL) { \
+        return NULL; \
+    } \
+    if (heap->total_free == 0 || unlikely(ratomic_load(&heap->remote_count) >= rpool_remote_batch)) { \
+        rpool_##TYPE##_collect(heap); \
+    } \
+    rpool_block_##TYPE##_t* pool_block = heap->free_head_block; \
+    rpool_##TYPE##_item_t* item = pool_block == NULL ? NULL : pool_block->head; \
+    if (item == NULL) { \
+        if (heap->total_free > 0) { \
+            while ((pool_block = pool_block->next_block) != NULL) { \
+                if ((item = pool_block->head) != NULL) { \
+                    break; \
                 } \
-**/        } \
+            } \
+        } \
+        if (item == NULL) { \
+            pool_block = rpool_##TYPE##_expand(heap, heap->free_head_block == NULL ? size_init : size_adjust); \
+            if (pool_block == NULL) { \
+                rinfo("malloc from rpool "#TYPE"(%d, %d) failed.", size_init, size_adjust); \
+                return NULL; \
+            } \
+            item = pool_block->head; \
         } \
     } \
+    pool_block->head = item->u.next; \
+    pool_block->free_count -= 1; \
+    heap->total_free -= 1; \
+    return &(item->u.data); \
+  } \
+  int rpool_##TYPE##_free(TYPE* data, rpool_##TYPE##_t* pool) { \
+    if (rget_pool(TYPE) == NULL) { \
+        rerror("free to "#TYPE"(%d, %d), rpool is NULL, (%p)", size_init, size_adjust, pool); \
+        return -1; \
+    } \
+    rpool_##TYPE##_item_t* item = (rpool_##TYPE##_item_t*)((char*)data - offsetof(rpool_##TYPE##_item_t, u)); \
+    rpool_heap_##TYPE##_t* heap = item->block->heap; \
+    if (unlikely(heap->pool != pool)) { \
+        rerror("free to pool "#TYPE"(%d, %d) failed, %p", size_init, size_adjust, data); \
+        return -1; \
+    } \
+    if (heap == rpool_##TYPE##_local_heap && rpool_##TYPE##_local_epoch == pool->epoch) { \
+        rpool_##TYPE##_release(heap, item); \
+        return rcode_ok; \
+    } \
+    do { \
+        item->u.next = ratomic_load_ptr(&heap->remote_head); \
+    } while (!ratomic_cas_ptr(&heap->remote_head, item->u.next, item)); \
+    ratomic_fetch_add(&heap->remote_count, 1); \
     return rcode_ok; \
   } \
+  int64_t rpool_##TYPE##_sync(rpool_##TYPE##_t* pool) { \
+    if (pool == NULL) { \
+        return 0; \
+    } \
+    int64_t capacity = 0; \
+    int64_t total_free = 0; \
+    rpool_heap_##TYPE##_t* heap = ratomic_load_ptr(&pool->heaps); \
+    for (; heap != NULL; heap = heap->next_heap) { \
+        capacity += heap->capacity; \
+        total_free += heap->total_free + ratomic_load(&heap->remote_count); \
+    } \
+    pool->capacity = capacity; \
+    pool->total_free = total_free; \
+    return total_free; \
+  } \
   rattribute_unused(static TYPE* malloc_##TYPE##_data (size_t size) { \
     return rdata_new(TYPE); \
   }) \
@@ -297,24 +610,25 @@ extern rpool_chain_node_t* rpool_chain;
     rdata_free(TYPE, data); \
   })
 
-
 #define pool_block_item_count 64
 #define dada_from_block(block, T, datasize, index) (T)(((rdata_pool_block*)(block))->data_buffer + index * datasize * sizeof(char))
 #define dada_check_block(block, ptr) (ptr && ((int64_t)(ptr - ((rdata_pool_block*)(block))->data_buffer) < ((rdata_pool_block*)(block))->data_total_size))
 #define dada_free_flag_block(block, T, index) ((rdata_pool_block*)(block))->used_bits = (((rdata_pool_block*)(block))->used_bits & (~(1ull << index)))
 #define dada_used_flag_block(block, T, index) ((rdata_pool_block*)(block))->used_bits = (((rdata_pool_block*)(block))->used_bits | (1ull << index))
 #define dada_full_block(block) (~(((rdata_pool_block*)(block))->used_bits) == 0)
-#define dada_empty_block(block) ((((rdata_pool_block*)(block))->used_bits) == 0)
+#define dada_empty_block(block) ((((rdata_pool_block*)(block))->used_bits) == ((rdata_pool_block*)(block))->pool->block_empty_bits)
 #define data_index_block(block, used_bits, index) \
         do { \
-            index = rtools_startindex1(used_bits); \
-            index += 1; \
-            if (index > pool_block_item_count - 1) { \
-                    index = rtools_endindex1(used_bits); \
-                    index -= 1; \
-            } \
+            index = (~(used_bits)) == 0 ? -1 : rtools_ctz64(~(used_bits)); \
         } while(0)
 
+R_API rdata_pool* rdata_pool_create(unsigned int size_elem, unsigned int init_elems);
+/** block_items 为每块槽数(1-64)，元素很大时减小，避免单块过大 */
+R_API rdata_pool* rdata_pool_create_ext(unsigned int size_elem, unsigned int init_elems, unsigned int block_items);
+R_API void rdata_pool_destroy(rdata_pool* pool);
+R_API void* rdata_pool_alloc(rdata_pool* pool);
+R_API int rdata_pool_free(rdata_pool* pool, void* data);
+
 #define rmacro_concat(PRE, NEXT0) PRE##NEXT0
 //ELE_SIZE不小于8字节，需要至少放下一个指针空间用于初始化
 #define def_ranonymous_pool(ELE_SIZE)	\
@@ -0,0 +1,107 @@
+/**
+ * Copyright (c) 2014 ray
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the MIT license. See LICENSE for details.
+ *
+ * @author: Ray
+ */
+
+#ifndef RRANK_H
+#define RRANK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "rcommon.h"
+#include "rdict.h"
+
+/**
+ * 排行榜，带跨度的跳表，按(score, id)排序，id唯一；rdict索引id -> 节点
+ * 名次从1开始，更新分数、查名次、按名次取、分页都是O(log n)；非线程安全
+ * 同分按id升序，rrank_order_desc为分高在前
+ */
+
+/* ------------------------------- Macros ------------------------------------*/
+
+#define rrank_size_t uint32_t
+#define rrank_level_max 32
+#define rrank_init_capacity_default 1024
+
+#define rrank_free(d) \
+    if (d) { \
+        rrank_release(d); \
+        d = NULL; \
+    }
+
+#define rrank_size(d) ((d)->size)
+#define rrank_first(d) ((d)->header->levels[0].forward)
+#define rrank_last(d) ((d)->tail)
+#define rrank_next(node) ((node)->levels[0].forward)
+#define rrank_prev(node) ((node)->backward)
+
+/* ------------------------------- Structs ------------------------------------*/
+
+typedef enum rrank_code_t {
+    rrank_code_ok = 0,
+    rrank_code_error = 1,
+    rrank_code_not_exist = 2,
+} rrank_code_t;
+
+typedef enum rrank_order_t {
+    rrank_order_desc = 0,
+    rrank_order_asc = 1,
+} rrank_order_t;
+
+typedef struct rrank_node_s rrank_node_t;
+
+typedef struct rrank_level_s {
+    rrank_node_t* forward;
+    rrank_size_t span;//到forward跨过的节点数
+} rrank_level_t;
+
+struct rrank_node_s {
+    uint64_t id;
+    int64_t score;
+    rrank_node_t* backward;
+    int level;
+    rrank_level_t levels[0];
+};
+
+typedef struct rrank_s {
+    rrank_node_t* header;
+    rrank_node_t* tail;
+    rrank_size_t size;
+    int level;
+    rrank_order_t order;
+    uint64_t random_state;
+    rdict_t* index;//id -> rrank_node_t*
+} rrank_t;
+
+/** rank为node的名次 */
+typedef void (*rrank_range_func_type)(void* data_ext, rrank_node_t* node, rrank_size_t rank);
+
+/* ------------------------------- APIs ------------------------------------*/
+
+R_API rrank_t* rrank_create(rrank_order_t order, rrank_size_t init_capacity);
+R_API void rrank_release(rrank_t* d);
+R_API void rrank_clear(rrank_t* d);
+
+/** 不存在则插入；位置不变时原地改分 */
+R_API int rrank_update(rrank_t* d, uint64_t id, int64_t score);
+R_API int rrank_remove(rrank_t* d, uint64_t id);
+R_API rrank_node_t* rrank_find(rrank_t* d, uint64_t id);
+
+/** 不存在返回0 */
+R_API rrank_size_t rrank_rank_of(rrank_t* d, uint64_t id);
+/** rank从1开始，越界返回NULL */
+R_API rrank_node_t* rrank_at(rrank_t* d, rrank_size_t rank);
+/** 从rank开始顺序取count个，返回实际个数；top-K为 rrank_range(d, 1, K, ...) */
+R_API rrank_size_t rrank_range(rrank_t* d, rrank_size_t rank, rrank_size_t count, rrank_range_func_type func, void* data_ext);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //RRANK_H
@@ -15,11 +15,118 @@ extern "C" {
 #endif
 
 #include "rcommon.h"
+#include "rpool.h"
+
+/**
+ * 有序map(红黑树)，key唯一，节点从rdata_pool分配；非线程安全
+ * compare_key_func为NULL时key按int64直接比较(定时器、id等)，不走函数指针
+ * 删除只改指针不搬数据，遍历中删除当前节点前先取 rrbtree_next
+ */
 
 /* ------------------------------- Macros ------------------------------------*/
 
+#define rrbtree_size_t uint32_t
+#define rrbtree_init_capacity_default 64
+
+#define rrbtree_red 0
+#define rrbtree_black 1
+
+#define rrbtree_init_full(inst, K, V, capacity, compare_key_f, copy_key_f, free_key_f, copy_value_f, free_value_f) \
+    do { \
+        rassert((inst) == NULL, ""); \
+        (inst) = rrbtree_create((capacity), NULL); \
+        rassert((inst) != NULL, ""); \
+        (inst)->compare_key_func = (rrbtree_compare_key_func_type)(compare_key_f ? compare_key_f : rdict_compare_key_func_##K); \
+        (inst)->copy_key_func = (rrbtree_copy_func_type)(copy_key_f ? copy_key_f : rdict_copy_key_func_##K); \
+        (inst)->free_key_func = (rrbtree_free_func_type)(free_key_f ? free_key_f : rdict_free_key_func_##K); \
+        (inst)->copy_value_func = (rrbtree_copy_func_type)(copy_value_f ? copy_value_f : rdict_copy_value_func_##V); \
+        (inst)->free_value_func = (rrbtree_free_func_type)(free_value_f ? free_value_f : rdict_free_value_func_##V); \
+    } while(0)
+/** int64 key直接用 rrbtree_create，比较内联 */
+#define rrbtree_init(inst, K, V, capacity) \
+    rrbtree_init_full(inst, K, V, capacity, NULL, NULL, NULL, NULL, NULL)
+
+#define rrbtree_free(d) \
+    if (d) { \
+        rrbtree_release(d); \
+        d = NULL; \
+    }
+
+#define rrbtree_size(d) ((d)->size)
+#define rrbtree_first(d) ((d)->first)
+
+#define rrbtree_foreach(d, node) \
+    for ((node) = rrbtree_first(d); (node) != NULL; (node) = rrbtree_next(node))
+
+/* ------------------------------- Structs ------------------------------------*/
+
+typedef enum rrbtree_code_t {
+    rrbtree_code_ok = 0,
+    rrbtree_code_error = 1,
+    rrbtree_code_not_exist = 2,
+} rrbtree_code_t;
+
+typedef union rrbtree_data_u {
+    void* ptr;
+    uint64_t u64;
+    int64_t s64;
+    float f;
+    double d;
+} rrbtree_data_t;
+
+typedef struct rrbtree_node_s rrbtree_node_t;
+struct rrbtree_node_s {
+    rrbtree_node_t* left;
+    rrbtree_node_t* right;
+    rrbtree_node_t* parent;
+    int color;
+    rrbtree_data_t key;
+    rrbtree_data_t value;
+};
+
+/** 返回 rcode_lt/rcode_eq/rcode_gt */
+typedef int (*rrbtree_compare_key_func_type)(void* data_ext, const void* key1, const void* key2);
+typedef void* (*rrbtree_copy_func_type)(void* data_ext, const void* obj);
+typedef void (*rrbtree_free_func_type)(void* data_ext, void* obj);
+
+typedef struct rrbtree_s {
+    rrbtree_node_t* root;
+    rrbtree_node_t* first;//最小节点，定时器取到期不用下探
+    rrbtree_size_t size;
+    rdata_pool* pool;
+    void* data_ext;
+
+    rrbtree_compare_key_func_type compare_key_func;
+    rrbtree_copy_func_type copy_key_func;
+    rrbtree_free_func_type free_key_func; //在remove和clear的时候都会执行
+    rrbtree_copy_func_type copy_value_func;
+    rrbtree_free_func_type free_value_func; //在remove和clear的时候都会执行
+} rrbtree_t;
+
 /* ------------------------------- APIs ------------------------------------*/
 
+R_API rrbtree_t* rrbtree_create(rrbtree_size_t init_capacity, void* data_ext);
+R_API void rrbtree_release(rrbtree_t* d);
+R_API void rrbtree_clear(rrbtree_t* d);
+
+/** 已存在则覆盖value */
+R_API int rrbtree_add(rrbtree_t* d, const void* key, const void* value);
+R_API int rrbtree_remove(rrbtree_t* d, const void* key);
+/** node必须属于d，调用后node失效 */
+R_API void rrbtree_remove_node(rrbtree_t* d, rrbtree_node_t* node);
+R_API rrbtree_node_t* rrbtree_find(rrbtree_t* d, const void* key);
+
+/** 第一个 >= key 的节点 */
+R_API rrbtree_node_t* rrbtree_lower_bound(rrbtree_t* d, const void* key);
+/** 第一个 > key 的节点 */
+R_API rrbtree_node_t* rrbtree_upper_bound(rrbtree_t* d, const void* key);
+R_API rrbtree_node_t* rrbtree_last(rrbtree_t* d);
+R_API rrbtree_node_t* rrbtree_next(rrbtree_node_t* node);
+R_API rrbtree_node_t* rrbtree_prev(rrbtree_node_t* node);
+
+/** [key_from, key_to) 顺序回调，返回访问个数；回调内不能增删 */
+R_API rrbtree_size_t rrbtree_scan_range(rrbtree_t* d, const void* key_from, const void* key_to,
+    void (*func)(void* data_ext, rrbtree_node_t* node), void* data_ext);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,115 @@
+/**
+ * Copyright (c) 2014 ray
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the MIT license. See LICENSE for details.
+ *
+ * @author: Ray
+ */
+
+#ifndef RRINGBUF_H
+#define RRINGBUF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "rcommon.h"
+
+/**
+ * 环形缓冲区，容量为2的幂，read_index/write_index只增不减（溢出回绕），位置为 index & mask
+ * 读写都不搬移数据；可读/可写区域最多两段，以iov形式给readv/writev/uv_write直接使用；非线程安全
+ * 镜像模式(linux memfd)把同一段内存连续映射两次，任意不超过容量的窗口都是一段连续地址，不可用时退回拷贝模式
+ */
+
+/* ------------------------------- Macros ------------------------------------*/
+
+#define rringbuf_size_t uint32_t
+#define rringbuf_size_max 0x80000000U
+#define rringbuf_init_capacity_default 1024
+#define rringbuf_iov_max 2
+
+#define rringbuf_init(d, size) \
+    do { \
+        rassert((d) == NULL, ""); \
+        (d) = rringbuf_create((size)); \
+        rassert((d) != NULL, ""); \
+    } while(0)
+
+#define rringbuf_init_mirror(d, size) \
+    do { \
+        rassert((d) == NULL, ""); \
+        (d) = rringbuf_create_mirror((size)); \
+        rassert((d) != NULL, ""); \
+    } while(0)
+
+#define rringbuf_free(d) \
+    if (d) { \
+        rringbuf_release(d); \
+        d = NULL; \
+    }
+
+#define rringbuf_capacity(d) ((d)->capacity)
+#define rringbuf_size(d) ((rringbuf_size_t)((d)->write_index - (d)->read_index))
+#define rringbuf_left(d) ((d)->capacity - rringbuf_size(d))
+#define rringbuf_full(d) (rringbuf_size(d) == (d)->capacity)
+#define rringbuf_empty(d) ((d)->write_index == (d)->read_index)
+#define rringbuf_mirrored(d) ((d)->mirrored)
+#define rringbuf_read_start_dest(d) ((d)->data + ((d)->read_index & (d)->mask))
+#define rringbuf_write_start_dest(d) ((d)->data + ((d)->write_index & (d)->mask))
+
+/* ------------------------------- Structs ------------------------------------*/
+
+typedef enum rringbuf_code_t {
+    rringbuf_code_ok = 0,
+    rringbuf_code_error = 1,
+} rringbuf_code_t;
+
+/** 布局与posix struct iovec一致，linux下可直接强转；uv_buf_t按字段赋值 */
+typedef struct rringbuf_iov_s {
+    void* base;
+    size_t len;
+} rringbuf_iov_t;
+
+typedef struct rringbuf_s {
+    char* data;
+    rringbuf_size_t capacity;
+    rringbuf_size_t mask;
+    rringbuf_size_t read_index;
+    rringbuf_size_t write_index;
+    bool mirrored;//data映射长度为2 * capacity
+} rringbuf_t;
+
+/* ------------------------------- APIs ------------------------------------*/
+
+/** init_capacity向上取2的幂 */
+R_API rringbuf_t* rringbuf_create(rringbuf_size_t init_capacity);
+/** 镜像模式，容量至少一页；memfd/mmap不可用时返回拷贝模式的ringbuf */
+R_API rringbuf_t* rringbuf_create_mirror(rringbuf_size_t init_capacity);
+R_API void rringbuf_release(rringbuf_t* d);
+R_API void rringbuf_clear(rringbuf_t* d);
+
+/** 返回实际读写字节数，空间/数据不足时部分读写 */
+R_API rringbuf_size_t rringbuf_write(rringbuf_t* d, const char* val, rringbuf_size_t size);
+R_API rringbuf_size_t rringbuf_read(rringbuf_t* d, char* val, rringbuf_size_t size);
+/** 只拷贝不消费 */
+R_API rringbuf_size_t rringbuf_peek(rringbuf_t* d, char* val, rringbuf_size_t size);
+
+/** read_index前移，len<0为撤销刚读出的数据，不越过write_index和已被覆盖的区域 */
+R_API int rringbuf_read_ext(rringbuf_t* d, int len);
+/** 外部已按write_iov写入后提交len，len<0为撤销未读出的写入 */
+R_API int rringbuf_write_ext(rringbuf_t* d, int len);
+
+/** 前size个可读字节的连续地址，数据不足或拷贝模式下跨越回绕返回NULL；镜像模式下总是连续 */
+R_API char* rringbuf_read_ptr(rringbuf_t* d, rringbuf_size_t size);
+
+/** 可读区域，返回段数(0-2，镜像模式最多1段)，iov至少rringbuf_iov_max个 */
+R_API int rringbuf_read_iov(rringbuf_t* d, rringbuf_iov_t* iov);
+/** 可写区域，返回段数(0-2，镜像模式最多1段)，iov至少rringbuf_iov_max个 */
+R_API int rringbuf_write_iov(rringbuf_t* d, rringbuf_iov_t* iov);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //RRINGBUF_H
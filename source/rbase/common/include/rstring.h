@@ -18,6 +18,7 @@ extern "C" {
 
 #include "rcommon.h"
 #include "rarray.h"
+#include "rarena.h"
 
 extern char* rstr_empty_const;
 
@@ -34,11 +35,11 @@ extern char* rstr_empty_const;
 
 #define rstr_number_max_bytes 32
 
-#define rstr_new(size) (char*)raymalloc((size) + 1u)
+#define rstr_new(size) (char*)rdata_new_size((size) + 1u)
 #define rstr_init(rstr) ((char*)(rstr))[0] = rstr_end
 #define rstr_uninit(rstr) ((char*)(rstr))[0] = rstr_end
 #define rstr_reset(rstr) rstr_init((rstr))
-#define rstr_free(rstr) if ((rstr) != NULL && (rstr) != rstr_empty_const) rayfree(rstr)
+#define rstr_free(rstr) if ((rstr) != NULL && (rstr) != rstr_empty_const) rdata_free(char, rstr)
 #define rstr_is_empty(rstr) ((rstr) == NULL || (rstr) == rstr_empty)
 #define rstr_sizeof(rstr) sizeof(rstr)
 
@@ -155,6 +156,24 @@ typedef struct rstring_s {
     char data[0];
 } rstring_t;
 
+/**
+ * 预先算好hash的字符串key，查询用 rstr_hkey_make 在栈上构造(不拷贝字符串)，
+ * 入表时 rstr_hkey_copy 成一块连续内存，扩容、rehash直接取hash不再扫字符串
+ */
+typedef struct rstr_hkey_s {
+    uint64_t hash;
+    uint32_t len;
+    const char* str;
+} rstr_hkey_t;
+
+static inline rstr_hkey_t rstr_hkey_make(const char* str) {
+    rstr_hkey_t key;
+    key.len = (uint32_t)strlen(str);
+    key.hash = rhash_func_bytes(str, key.len, rhash_seed());
+    key.str = str;
+    return key;
+}
+
 /* ------------------------------- APIs ------------------------------------*/
 
 R_API void rstr_free_func(char* dest);
@@ -167,6 +186,8 @@ R_API size_t rstr_cat(char* dest, const char* src, const size_t sizeof_dest);
 R_API char* rstr_concat_array(const char** src, const char* delim, bool suffix);
 /** rstr_array_end结尾 **/
 R_API char* rstr_join(const char* src, ...);
+/** rstr_array_end结尾，结果在arena上分配，arena为NULL时同rstr_join，用rarena_free_size释放 **/
+R_API char* rstr_join_arena(rarena_t* arena, const char* src, ...);
 
 R_API char* rstr_fmt(char* dest, const char* fmt, int max_len, ...);
 R_API int rstr_fmt_num(char* ret_num_str, void* num, const char* fmt);
@@ -174,6 +195,14 @@ R_API int rstr_fmt_num(char* ret_num_str, void* num, const char* fmt);
 R_API char* rstr_cpy(const void *src, size_t len);
 R_API char* rstr_cpy_full(const void *key);
 
+R_API rstr_hkey_t* rstr_hkey_copy(const rstr_hkey_t* key);
+R_API void rstr_hkey_free(rstr_hkey_t* key);
+/** 先比hash和长度，相等才比字符串 **/
+R_API int rstr_hkey_compare(const rstr_hkey_t* key1, const rstr_hkey_t* key2);
+R_API uint64_t rstr_hkey_hash(const rstr_hkey_t* key);
+/** rdict_init(d, rdata_type_hkey, V, ...) 使用，定义在rdict.c **/
+rdict_block_declare_type_key_func(rdata_type_hkey);
+
 /** -1: 无子串 **/
 R_API int rstr_index(const char* src, const char* key);
 /** -1: 无子串 **/
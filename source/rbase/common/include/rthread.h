@@ -35,6 +35,15 @@ typedef void *(*rthread_func)(void *);
 #define rmutex_unlock(rmutexObj) \
     LeaveCriticalSection(rmutexObj)
 
+//读写锁，读之间不互斥
+#define rrwlock_t SRWLOCK
+#define rrwlock_init(rwlockObj) InitializeSRWLock(rwlockObj)
+#define rrwlock_uninit(rwlockObj)
+#define rrwlock_read_lock(rwlockObj) AcquireSRWLockShared(rwlockObj)
+#define rrwlock_read_unlock(rwlockObj) ReleaseSRWLockShared(rwlockObj)
+#define rrwlock_write_lock(rwlockObj) AcquireSRWLockExclusive(rwlockObj)
+#define rrwlock_write_unlock(rwlockObj) ReleaseSRWLockExclusive(rwlockObj)
+
 #else /* defined(_WIN32) || defined(_WIN64) */
 
 #define rmutex_t pthread_mutex_t
@@ -61,6 +70,46 @@ typedef void *(*rthread_func)(void *);
 #define rmutex_unlock(rmutexObj) \
     pthread_mutex_unlock(rmutexObj) 
 
+//读写锁，读之间不互斥
+#define rrwlock_t pthread_rwlock_t
+#define rrwlock_init(rwlockObj) pthread_rwlock_init(rwlockObj, NULL)
+#define rrwlock_uninit(rwlockObj) pthread_rwlock_destroy(rwlockObj)
+#define rrwlock_read_lock(rwlockObj) pthread_rwlock_rdlock(rwlockObj)
+#define rrwlock_read_unlock(rwlockObj) pthread_rwlock_unlock(rwlockObj)
+#define rrwlock_write_lock(rwlockObj) pthread_rwlock_wrlock(rwlockObj)
+#define rrwlock_write_unlock(rwlockObj) pthread_rwlock_unlock(rwlockObj)
+
+#endif /* defined(_WIN32) || defined(_WIN64) */
+
+/** 线程局部存储和原子操作，ptr均为被操作变量的地址 */
+#if defined(_WIN32) || defined(_WIN64)
+
+#define rthread_local __declspec(thread)
+
+#define ratomic_load(ptr) InterlockedCompareExchange64((volatile LONG64*)(ptr), 0, 0)
+#define ratomic_store(ptr, value) InterlockedExchange64((volatile LONG64*)(ptr), (LONG64)(value))
+#define ratomic_fetch_add(ptr, value) InterlockedExchangeAdd64((volatile LONG64*)(ptr), (LONG64)(value))
+#define ratomic_load_ptr(ptr) InterlockedCompareExchangePointer((PVOID volatile*)(ptr), NULL, NULL)
+#define ratomic_xchg_ptr(ptr, value) InterlockedExchangePointer((PVOID volatile*)(ptr), (PVOID)(value))
+#define ratomic_cas(ptr, expected, desired) \
+    (InterlockedCompareExchange64((volatile LONG64*)(ptr), (LONG64)(desired), (LONG64)(expected)) == (LONG64)(expected))
+#define ratomic_cas_ptr(ptr, expected, desired) \
+    (InterlockedCompareExchangePointer((PVOID volatile*)(ptr), (PVOID)(desired), (PVOID)(expected)) == (PVOID)(expected))
+
+#else /* defined(_WIN32) || defined(_WIN64) */
+
+#define rthread_local __thread
+
+#define ratomic_load(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define ratomic_store(ptr, value) __atomic_store_n((ptr), (value), __ATOMIC_RELEASE)
+#define ratomic_fetch_add(ptr, value) __atomic_fetch_add((ptr), (value), __ATOMIC_ACQ_REL)
+#define ratomic_load_ptr(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#define ratomic_xchg_ptr(ptr, value) __atomic_exchange_n((ptr), (value), __ATOMIC_ACQ_REL)
+#define ratomic_cas(ptr, expected, desired) \
+    __sync_bool_compare_and_swap((ptr), (expected), (desired))
+#define ratomic_cas_ptr(ptr, expected, desired) \
+    __sync_bool_compare_and_swap((ptr), (expected), (desired))
+
 #endif /* defined(_WIN32) || defined(_WIN64) */
 
 /* ------------------------------- APIs ------------------------------------*/
@@ -27,6 +27,8 @@ int rtime_gettimeofdayfix(struct timeval *tp, void *tzp);
 R_API int64_t rtime_nanosec();
 R_API int64_t rtime_microsec();
 R_API int64_t rtime_millisec();
+/** 粗粒度毫秒时间戳，linux下读CLOCK_REALTIME_COARSE，精度为一个tick(1-4ms)，日志行头用 */
+R_API int64_t rtime_millisec_coarse();
 
 R_API void rtime_set_inc(int64_t millisec, int64_t microsec, int64_t nanosec);
 R_API int64_t rtime_nanosec_inc();
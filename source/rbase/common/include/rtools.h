@@ -14,6 +14,35 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
+#if defined(_WIN32) || defined(_WIN64)
+#include <intrin.h>
+#endif
+
+/* rdict.h经rcommon.h间接包含本文件，位运算需在rcommon.h之前定义 */
+
+/** 最低位1的下标(单条tzcnt/bsf)，val不能为0 */
+static inline int rtools_ctz64(uint64_t val) {
+#if defined(_WIN32) || defined(_WIN64)
+    unsigned long index = 0;
+    _BitScanForward64(&index, val);
+    return (int)index;
+#else
+    return __builtin_ctzll(val);
+#endif
+}
+
+/** 最高位1之前0的个数，val不能为0 */
+static inline int rtools_clz64(uint64_t val) {
+#if defined(_WIN32) || defined(_WIN64)
+    unsigned long index = 0;
+    _BitScanReverse64(&index, val);
+    return 63 - (int)index;
+#else
+    return __builtin_clzll(val);
+#endif
+}
+
 #include "rcommon.h"
 
 /* ------------------------------- Macros ------------------------------------*/
@@ -37,8 +66,13 @@ int rtools_startindex1(uint64_t val);
 /** 1bits */
 int rtools_popcount1(uint64_t val);
 
-
 uint64_t rhash_func_murmur(const char *key);
+/** wyhash，同一输入和seed结果跨平台一致 */
+uint64_t rhash_func_bytes(const void* data, size_t len, uint64_t seed);
+/** 进程随机种子，首次调用时生成，外部输入的key无法预先构造冲突 */
+uint64_t rhash_seed();
+/** rhash_func_bytes + rhash_seed，字符串表默认hash */
+uint64_t rhash_func_string(const char* key);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,176 @@
+/**
+ * Copyright (c) 2014 ray
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the MIT license. See LICENSE for details.
+ *
+ * @author: Ray
+ */
+
+#include "rarena.h"
+#include "rthread.h"
+#include "rlog.h"
+
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunknown-pragmas"
+#endif //__GNUC__
+
+static rthread_local rarena_t* rarena_local = NULL;
+
+/** 按实际地址对齐，返回块内偏移 */
+static inline size_t rarena_align_pos(rarena_chunk_t* chunk, size_t pos, size_t align) {
+    uintptr_t addr = ((uintptr_t)(chunk->data + pos) + align - 1) & ~((uintptr_t)align - 1);
+    return (size_t)(addr - (uintptr_t)chunk->data);
+}
+
+static rarena_chunk_t* rarena_chunk_new(size_t capacity) {
+    rarena_chunk_t* chunk = (rarena_chunk_t*)raymalloc(sizeof(rarena_chunk_t) + capacity);
+    if (chunk == NULL) {
+        rerror("new chunk of rarena failed, capacity = %zu", capacity);
+        return NULL;
+    }
+    chunk->next = NULL;
+    chunk->capacity = capacity;
+    chunk->pos = 0;
+    chunk->reserved = 0;
+    return chunk;
+}
+
+R_API rarena_t* rarena_create(size_t chunk_size) {
+    if (chunk_size == 0) {
+        chunk_size = rarena_chunk_size_default;
+    }
+
+    rarena_t* d = rdata_new(rarena_t);
+    if (d == NULL) {
+        return NULL;
+    }
+    rdata_init(d, sizeof(rarena_t));
+
+    d->chunk_size = chunk_size;
+    d->head = rarena_chunk_new(chunk_size);
+    if (d->head == NULL) {
+        rdata_free(rarena_t, d);
+        return NULL;
+    }
+    d->current = d->head;
+    d->capacity = chunk_size;
+    d->chunk_count = 1;
+
+    return d;
+}
+
+R_API void rarena_release(rarena_t* d) {
+    if (d == NULL) {
+        return;
+    }
+
+    rarena_chunk_t* chunk = d->head;
+    rarena_chunk_t* next = NULL;
+    while (chunk != NULL) {
+        next = chunk->next;
+        rayfree(chunk);
+        chunk = next;
+    }
+    rdata_free(rarena_t, d);
+}
+
+R_API void* rarena_alloc_align(rarena_t* d, size_t size, size_t align) {
+    rarena_chunk_t* chunk = d->current;
+    size_t pos = rarena_align_pos(chunk, chunk->pos, align);
+
+    if (unlikely(pos + size > chunk->capacity)) {
+        //后续块已被rewind/reset腾空，能放下就复用
+        if (chunk->next != NULL && size + align <= chunk->next->capacity) {
+            chunk = chunk->next;
+        } else {
+            size_t capacity = size + align > d->chunk_size ? size + align : d->chunk_size;
+            rarena_chunk_t* chunk_new = rarena_chunk_new(capacity);
+            if (chunk_new == NULL) {
+                return NULL;
+            }
+            chunk_new->next = chunk->next;
+            chunk->next = chunk_new;
+            chunk = chunk_new;
+            d->capacity += capacity;
+            d->chunk_count++;
+        }
+        chunk->pos = 0;
+        d->current = chunk;
+        pos = rarena_align_pos(chunk, 0, align);
+    }
+
+    chunk->pos = pos + size;
+    d->used += size;
+    d->alloc_count++;
+    if (d->used > d->peak) {
+        d->peak = d->used;
+    }
+
+    return chunk->data + pos;
+}
+
+R_API void* rarena_alloc(rarena_t* d, size_t size) {
+    return rarena_alloc_align(d, size, rarena_align_default);
+}
+
+R_API rarena_mark_t rarena_mark(rarena_t* d) {
+    rarena_mark_t mark;
+    if (d == NULL) {
+        rdata_init(&mark, sizeof(rarena_mark_t));
+        return mark;
+    }
+    mark.chunk = d->current;
+    mark.pos = d->current->pos;
+    mark.used = d->used;
+    return mark;
+}
+
+R_API void rarena_rewind(rarena_t* d, rarena_mark_t mark) {
+    if (d == NULL) {
+        return;
+    }
+    d->current = mark.chunk;
+    d->current->pos = mark.pos;
+    d->used = mark.used;
+}
+
+R_API void rarena_reset(rarena_t* d) {
+    if (d == NULL) {
+        return;
+    }
+    rarena_chunk_t* prev = d->head;
+    rarena_chunk_t* chunk = d->head->next;
+
+    while (chunk != NULL) {
+        if (chunk->capacity > d->chunk_size) {
+            prev->next = chunk->next;
+            d->capacity -= chunk->capacity;
+            d->chunk_count--;
+            rayfree(chunk);
+        } else {
+            prev = chunk;
+        }
+        chunk = prev->next;
+    }
+
+    d->head->pos = 0;
+    d->current = d->head;
+    d->used = 0;
+}
+
+R_API rarena_t* rarena_thread_default() {
+    if (unlikely(rarena_local == NULL)) {
+        rarena_local = rarena_create(rarena_chunk_size_default);
+    }
+    return rarena_local;
+}
+
+R_API void rarena_thread_release() {
+    rarena_free(rarena_local);
+}
+
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif //__GNUC__
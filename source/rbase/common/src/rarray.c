@@ -27,6 +27,9 @@ static int compare_func_default(const void* obj1, const void* obj2) {
     return rcode_neq;
 }
 
+/** 没有get_value_func即按值存储，元素通过地址访问 */
+#define _value_mode(ar) ((ar)->get_value_func == NULL)
+
 static int _rarray_alloc(rarray_t* ar, rarray_size_t capacity) {
     void** dest_ptr = rdata_new_array(ar->value_size, capacity);
     if (dest_ptr == NULL) {
@@ -51,6 +54,75 @@ static int _rarray_alloc(rarray_t* ar, rarray_size_t capacity) {
     return rcode_ok;
 }
 
+static int _rarray_ensure(rarray_t* ar, rarray_size_t size_need) {
+    if (size_need <= ar->capacity) {
+        return rcode_ok;
+    }
+    rarray_size_t capacity = ar->capacity;
+    while (capacity < size_need) {
+        capacity = (rarray_size_t)(capacity * ar->scale_factor);
+    }
+    return _rarray_alloc(ar, capacity);
+}
+
+/** 元素原始值，按value_size宽度无符号读取 */
+static uint64_t _index_key_of(rarray_t* ar, const void* elem) {
+    switch (ar->value_size) {
+    case 1:
+        return *(const uint8_t*)elem;
+    case 2:
+        return *(const uint16_t*)elem;
+    case 4:
+        return *(const uint32_t*)elem;
+    case 8:
+        return *(const uint64_t*)elem;
+    default: {//3/5/6/7字节只读value_size个字节，末尾元素不越界
+        uint64_t key = 0;
+        memcpy(&key, elem, ar->value_size);
+        return key;
+    }
+    }
+}
+
+/** 回调模式下参数就是元素值，按值存储模式下是元素地址 */
+static uint64_t _index_key_of_data(rarray_t* ar, const void* data) {
+    if (_value_mode(ar)) {
+        return _index_key_of(ar, data);
+    }
+    uint64_t raw = (uint64_t)(uintptr_t)data;
+    return ar->value_size >= 8 ? raw : raw & ((1ULL << (ar->value_size * 8)) - 1);
+}
+
+static void _index_set_range(rarray_t* ar, rarray_size_t from, rarray_size_t to) {
+    if (ar->index == NULL) {
+        return;
+    }
+    for (rarray_size_t i = from; i < to; i++) {
+        rdict_add(ar->index, (void*)(uintptr_t)_index_key_of(ar, rarray_ptr_at(ar, i)), (void*)(uintptr_t)i);
+    }
+}
+
+static void _index_remove_range(rarray_t* ar, rarray_size_t from, rarray_size_t to) {
+    if (ar->index == NULL) {
+        return;
+    }
+    for (rarray_size_t i = from; i < to; i++) {
+        rdict_remove(ar->index, (const void*)(uintptr_t)_index_key_of(ar, rarray_ptr_at(ar, i)));
+    }
+}
+
+static void _free_range(rarray_t* ar, rarray_size_t from, rarray_size_t to) {
+    if (ar->free_value_func == NULL) {
+        return;
+    }
+    for (rarray_size_t i = from; i < to; i++) {
+        void* obj = _value_mode(ar) ? rarray_ptr_at(ar, i) : ar->get_value_func(ar, i);
+        if (obj != NULL) {
+            ar->free_value_func(obj);
+        }
+    }
+}
+
 rarray_t* rarray_create(rarray_size_t value_size, rarray_size_t init_capacity) {
     rarray_t* ar = rdata_new(rarray_t);
 
@@ -68,6 +140,7 @@ rarray_t* rarray_create(rarray_size_t value_size, rarray_size_t init_capacity) {
     ar->remove_value_func = NULL;
     ar->compare_value_func = (rcom_compare_func_type)compare_func_default;
     ar->free_value_func = NULL;
+    ar->index = NULL;
 
     rassert(_rarray_alloc(ar, ar->capacity) == rcode_ok, "oom");
 
@@ -83,8 +156,14 @@ int rarray_add(rarray_t* ar, void* val) {
         rassert(_rarray_alloc(ar, (rarray_size_t)(ar->capacity * ar->scale_factor)) == rcode_ok, "oom");
     }
 
-    int code = ar->set_value_func(ar, ar->size, val);
+    int code = rcode_ok;
+    if (ar->set_value_func == NULL) {
+        memcpy(rarray_ptr_at(ar, ar->size), val, ar->value_size);
+    } else {
+        code = ar->set_value_func(ar, ar->size, val);
+    }
     ar->size ++;
+    _index_set_range(ar, ar->size - 1, ar->size);
 
     return code;
 }
@@ -94,15 +173,11 @@ int rarray_remove(rarray_t* ar, const void* val) {
         return rcode_ok;
     }
 
-    rarray_iterator_t it = rarray_it(ar);
-    void* temp = NULL;
-    for (rarray_size_t index = 0; temp = rarray_next(&it), rarray_has_next(&it); index ++) {
-        if (ar->compare_value_func(temp, val) == rcode_eq) {
-            ar->remove_value_func(ar, index);
-            return rcode_ok;
-        }
+    rarray_size_t index = rarray_index_of(ar, val);
+    if (index == rarray_index_none) {
+        return rarray_code_not_exist;
     }
-    return rarray_code_not_exist;
+    return rarray_remove_at(ar, index);
 }
 
 int rarray_remove_at(rarray_t* ar, rarray_size_t index) {
@@ -114,7 +189,15 @@ int rarray_remove_at(rarray_t* ar, rarray_size_t index) {
         return rarray_code_index_out4_size;
     }
 
-    return ar->remove_value_func(ar, index);
+    if (ar->remove_value_func == NULL) {
+        return rarray_erase_range(ar, index, 1);
+    }
+
+    _index_remove_range(ar, index, index + 1);
+    int code = ar->remove_value_func(ar, index);
+    _index_set_range(ar, index, ar->size);
+
+    return code;
 }
 
 void** rarray_get_all(rarray_t* ar) {
@@ -149,6 +232,10 @@ void rarray_clear(rarray_t* ar) {
     }
     rdata_clear_array(ar->items, ar->value_size * ar->capacity);
     ar->size = 0;
+
+    if (ar->index != NULL) {
+        rdict_clear(ar->index);
+    }
 }
 
 void rarray_release(rarray_t* ar) {
@@ -157,6 +244,7 @@ void rarray_release(rarray_t* ar) {
     }
 
     rarray_clear(ar);
+    rdict_free(ar->index);
 
     if (ar->items != NULL) {
         rdata_free_array(ar->items);
@@ -169,14 +257,7 @@ bool rarray_exist(rarray_t* ar, const void* data) {
         return false;
     }
 
-    rarray_iterator_t it = rarray_it(ar);
-    void* temp = NULL;
-    for (; temp = rarray_next(&it), rarray_has_next(&it);) {
-        if (ar->compare_value_func(temp, data) == rcode_eq) {
-            return true;
-        }
-    }
-    return false;
+    return rarray_index_of(ar, data) != rarray_index_none;
 }
 
 void* rarray_at(rarray_t* ar, rarray_size_t index) {
@@ -186,7 +267,7 @@ void* rarray_at(rarray_t* ar, rarray_size_t index) {
     }
     //temp = ar->get_value_func(ar->items, index);
 
-    return ar->get_value_func(ar, index);
+    return _value_mode(ar) ? rarray_ptr_at(ar, index) : ar->get_value_func(ar, index);
 }
 
 void* rarray_next(rarray_iterator_t* it) {
@@ -194,6 +275,173 @@ void* rarray_next(rarray_iterator_t* it) {
     return rarray_at(it->d, it->index ++);
 }
 
+int rarray_reserve(rarray_t* ar, rarray_size_t capacity) {
+    if (ar == NULL) {
+        return rarray_code_error;
+    }
+
+    return capacity > ar->capacity ? _rarray_alloc(ar, capacity) : rcode_ok;
+}
+
+int rarray_append_n(rarray_t* ar, const void* vals, rarray_size_t count) {
+    if (ar == NULL) {
+        return rarray_code_error;
+    }
+
+    return rarray_insert_range(ar, ar->size, vals, count);
+}
+
+int rarray_insert_range(rarray_t* ar, rarray_size_t index, const void* vals, rarray_size_t count) {
+    if (ar == NULL || vals == NULL) {
+        return rarray_code_error;
+    }
+    if (index > ar->size) {
+        return rarray_code_index_out4_size;
+    }
+    if (count == 0) {
+        return rcode_ok;
+    }
+    if (_rarray_ensure(ar, ar->size + count) != rcode_ok) {
+        return rarray_code_error;
+    }
+
+    if (index < ar->size) {
+        memmove(rarray_ptr_at(ar, index + count), rarray_ptr_at(ar, index), (size_t)(ar->size - index) * ar->value_size);
+    }
+    memcpy(rarray_ptr_at(ar, index), vals, (size_t)count * ar->value_size);
+    ar->size += count;
+    _index_set_range(ar, index, ar->size);
+
+    return rcode_ok;
+}
+
+int rarray_erase_range(rarray_t* ar, rarray_size_t index, rarray_size_t count) {
+    if (ar == NULL) {
+        return rarray_code_error;
+    }
+    if (index > ar->size || count > ar->size - index) {
+        return rarray_code_index_out4_size;
+    }
+    if (count == 0) {
+        return rcode_ok;
+    }
+
+    _index_remove_range(ar, index, index + count);
+    _free_range(ar, index, index + count);
+
+    rarray_size_t tail = ar->size - index - count;
+    if (tail > 0) {
+        memmove(rarray_ptr_at(ar, index), rarray_ptr_at(ar, index + count), (size_t)tail * ar->value_size);
+    }
+    ar->size -= count;
+    memset(rarray_ptr_at(ar, ar->size), 0, (size_t)count * ar->value_size);//空位清零，ptr的set_value_func会释放非空位置
+    _index_set_range(ar, index, ar->size);
+
+    return rcode_ok;
+}
+
+int rarray_swap_remove(rarray_t* ar, rarray_size_t index) {
+    if (ar == NULL) {
+        return rarray_code_error;
+    }
+    if (index >= ar->size) {
+        return rarray_code_index_out4_size;
+    }
+
+    _index_remove_range(ar, index, index + 1);
+    _free_range(ar, index, index + 1);
+
+    rarray_size_t last = ar->size - 1;
+    if (index != last) {
+        memcpy(rarray_ptr_at(ar, index), rarray_ptr_at(ar, last), ar->value_size);
+    }
+    memset(rarray_ptr_at(ar, last), 0, ar->value_size);
+    ar->size--;
+    if (index < ar->size) {
+        _index_set_range(ar, index, index + 1);
+    }
+
+    return rcode_ok;
+}
+
+void rarray_sort(rarray_t* ar, rcom_compare_func_type compare) {
+    if (ar == NULL || compare == NULL || ar->size < 2) {
+        return;
+    }
+
+    qsort(ar->items, ar->size, ar->value_size, compare);
+    _index_set_range(ar, 0, ar->size);
+}
+
+rarray_size_t rarray_lower_bound(rarray_t* ar, const void* key, rcom_compare_func_type compare) {
+    if (ar == NULL || compare == NULL) {
+        return 0;
+    }
+
+    rarray_size_t low = 0;
+    rarray_size_t high = ar->size;
+    while (low < high) {
+        rarray_size_t mid = low + ((high - low) >> 1);
+        if (compare(rarray_ptr_at(ar, mid), key) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+rarray_size_t rarray_bsearch(rarray_t* ar, const void* key, rcom_compare_func_type compare) {
+    rarray_size_t index = rarray_lower_bound(ar, key, compare);
+    if (ar == NULL || index >= ar->size || compare(rarray_ptr_at(ar, index), key) != 0) {
+        return rarray_index_none;
+    }
+    return index;
+}
+
+int rarray_enable_index(rarray_t* ar) {
+    if (ar == NULL || ar->value_size > sizeof(uint64_t)) {
+        return rarray_code_error;
+    }
+    if (ar->index != NULL) {
+        return rcode_ok;
+    }
+
+    rdict_init(ar->index, rdata_type_uint64, rdata_type_uint64, ar->capacity, 0);
+    _index_set_range(ar, 0, ar->size);
+
+    return rcode_ok;
+}
+
+rarray_size_t rarray_index_of(rarray_t* ar, const void* data) {
+    if (ar == NULL) {
+        return rarray_index_none;
+    }
+
+    if (ar->index != NULL) {
+        rdict_entry_t* entry = rdict_find(ar->index, (const void*)(uintptr_t)_index_key_of_data(ar, data));
+        return entry != NULL ? (rarray_size_t)entry->value.u64 : rarray_index_none;
+    }
+
+    if (_value_mode(ar)) {
+        bool compare_default = ar->compare_value_func == (rcom_compare_func_type)compare_func_default;
+        for (rarray_size_t i = 0; i < ar->size; i++) {
+            void* elem = rarray_ptr_at(ar, i);
+            if (compare_default ? memcmp(elem, data, ar->value_size) == 0 : ar->compare_value_func(elem, data) == rcode_eq) {
+                return i;
+            }
+        }
+        return rarray_index_none;
+    }
+
+    for (rarray_size_t i = 0; i < ar->size; i++) {
+        if (ar->compare_value_func(ar->get_value_func(ar, i), data) == rcode_eq) {
+            return i;
+        }
+    }
+    return rarray_index_none;
+}
+
 
 
 int rarray_set_value_func_rdata_type_ptr(rarray_t* ar, const rarray_size_t offset, rdata_type_ptr_inner_type obj) {
@@ -222,7 +470,7 @@ int rarray_remove_value_func_rdata_type_ptr(rarray_t* ar, const rarray_size_t in
 
     int copy_len = (ar)->size - (index) - 1;
     if (copy_len > 0) {
-        memcpy(dest_ptr, dest_ptr + 1, copy_len * (ar)->value_size);
+        memmove(dest_ptr, dest_ptr + 1, copy_len * (ar)->value_size);
     }
 
     dest_ptr = (void**)(ar)->items + (ar)->size - 1;
@@ -253,7 +501,7 @@ int rarray_remove_value_func_rdata_type_string(rarray_t* ar, const rarray_size_t
 
     int copy_len = (ar)->size - (index) - 1;
     if (copy_len > 0) {
-        memcpy(dest_ptr, dest_ptr + 1, copy_len * (ar)->value_size);
+        memmove(dest_ptr, dest_ptr + 1, copy_len * (ar)->value_size);
     }
 
     dest_ptr = (char**)(ar)->items + (ar)->size - 1;
@@ -0,0 +1,482 @@
+/**
+ * Copyright (c) 2014 ray
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the MIT license. See LICENSE for details.
+ *
+ * @author: Ray
+ */
+
+#include "rpool.h"
+#include "rthread.h"
+#include "rlog.h"
+#include "rchainbuf.h"
+
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunknown-pragmas"
+#endif //__GNUC__
+
+#define rchainbuf_slab_spare_min 1024 //尾slab剩余小于此值时write_iov多给一个新slab
+
+static rthread_local rdata_pool* rchainbuf_pool_small = NULL;
+static rthread_local rdata_pool* rchainbuf_pool_large = NULL;
+static rthread_local rchainbuf_stats_t rchainbuf_stats_local;
+
+static rchainbuf_slab_t* _slab_new(rchainbuf_slab_type_t type, rchainbuf_size_t size) {
+    rchainbuf_slab_t* slab = NULL;
+    rchainbuf_size_t capacity = 0;
+
+    if (type == rchainbuf_slab_small) {
+        if (unlikely(rchainbuf_pool_small == NULL)) {
+            rchainbuf_pool_small = rdata_pool_create(sizeof(rchainbuf_slab_t) + rchainbuf_slab_small_size,
+                rchainbuf_slab_pool_init_elems);
+            if (rchainbuf_pool_small == NULL) {
+                return NULL;
+            }
+        }
+        slab = (rchainbuf_slab_t*)rdata_pool_alloc(rchainbuf_pool_small);
+        capacity = rchainbuf_slab_small_size;
+    } else if (type == rchainbuf_slab_large) {
+        if (unlikely(rchainbuf_pool_large == NULL)) {
+            rchainbuf_pool_large = rdata_pool_create_ext(sizeof(rchainbuf_slab_t) + rchainbuf_slab_large_size, 0,
+                rchainbuf_slab_large_block_items);//大块不常驻，空闲即归还
+            if (rchainbuf_pool_large == NULL) {
+                return NULL;
+            }
+        }
+        slab = (rchainbuf_slab_t*)rdata_pool_alloc(rchainbuf_pool_large);
+        capacity = rchainbuf_slab_large_size;
+    } else {
+        slab = (rchainbuf_slab_t*)raymalloc(sizeof(rchainbuf_slab_t) + size);
+        capacity = size;
+    }
+    if (slab == NULL) {
+        rerror("new slab of rchainbuf failed, type = %d, size = %u", type, size);
+        return NULL;
+    }
+
+    slab->next = NULL;
+    slab->type = type;
+    slab->ref_count = 1;
+    slab->capacity = capacity;
+    slab->start = slab->end = 0;
+
+    if (type == rchainbuf_slab_small) {
+        rchainbuf_stats_local.slab_small_used++;
+    } else if (type == rchainbuf_slab_large) {
+        rchainbuf_stats_local.slab_large_used++;
+    } else {
+        rchainbuf_stats_local.slab_huge_used++;
+    }
+    rchainbuf_stats_local.bytes_used += capacity;
+
+    return slab;
+}
+
+/** 池是线程本地的，别的线程分配的slab还不回去，只能泄漏 */
+static bool _slab_pool_free(rdata_pool* pool, rchainbuf_slab_t* slab) {
+    if (unlikely(rdata_pool_free(pool, slab) != rcode_ok)) {
+        rerror("free slab of rchainbuf failed, not from this thread, slab = %p, type = %d", slab, slab->type);
+        rassert(false, "rchainbuf slab freed on another thread");
+        return false;
+    }
+    return true;
+}
+
+static void _slab_unref(rchainbuf_slab_t* slab) {
+    if (--slab->ref_count > 0) {
+        return;
+    }
+
+    rchainbuf_size_t capacity = slab->capacity;//归还后不能再读slab
+    if (slab->type == rchainbuf_slab_small) {
+        if (_slab_pool_free(rchainbuf_pool_small, slab)) {
+            rchainbuf_stats_local.bytes_used -= capacity;
+            rchainbuf_stats_local.slab_small_used--;
+        }
+    } else if (slab->type == rchainbuf_slab_large) {
+        if (_slab_pool_free(rchainbuf_pool_large, slab)) {
+            rchainbuf_stats_local.bytes_used -= capacity;
+            rchainbuf_stats_local.slab_large_used--;
+        }
+    } else {
+        rchainbuf_stats_local.bytes_used -= capacity;
+        rchainbuf_stats_local.slab_huge_used--;
+        rayfree(slab);
+    }
+}
+
+/** 第一个slab用4K，已经不止一个slab(大消息)时用64K */
+static rchainbuf_slab_t* _slab_append(rchainbuf_t* d, rchainbuf_size_t hint) {
+    rchainbuf_slab_type_t type = (d->slab_large || d->slab_count > 0 || hint > rchainbuf_slab_small_size) ?
+        rchainbuf_slab_large : rchainbuf_slab_small;
+    rchainbuf_slab_t* slab = _slab_new(type, 0);
+    if (slab == NULL) {
+        return NULL;
+    }
+
+    if (d->tail == NULL) {
+        d->head = d->tail = slab;
+    } else {
+        d->tail->next = slab;
+        d->tail = slab;
+    }
+    d->slab_count++;
+    return slab;
+}
+
+static void _slab_pop_head(rchainbuf_t* d) {
+    rchainbuf_slab_t* slab = d->head;
+    d->head = slab->next;
+    if (d->head == NULL) {
+        d->tail = NULL;
+    }
+    d->slab_count--;
+    _slab_unref(slab);
+}
+
+/** 读空后归还slab；slab_large的共享缓冲留一个没有slice引用的slab，避免每次收包都向池申请 */
+static void _slab_drain(rchainbuf_t* d) {
+    while (d->head != NULL && (!d->slab_large || d->head != d->tail || d->head->ref_count > 1)) {
+        _slab_pop_head(d);
+    }
+    if (d->head != NULL) {
+        d->head->start = d->head->end = 0;
+    }
+    d->size = 0;
+    d->write_slab = NULL;
+}
+
+R_API rchainbuf_t* rchainbuf_create(rchainbuf_size_t size_max) {
+    rchainbuf_t* d = rdata_new(rchainbuf_t);
+    if (d == NULL) {
+        return NULL;
+    }
+    d->head = d->tail = d->write_slab = NULL;
+    d->size = 0;
+    d->size_max = size_max == 0 ? UINT32_MAX : size_max;
+    d->slab_count = 0;
+    d->slab_large = false;
+
+    return d;
+}
+
+R_API void rchainbuf_release(rchainbuf_t* d) {
+    if (d != NULL) {
+        rchainbuf_clear(d);
+        rdata_free(rchainbuf_t, d);
+    }
+}
+
+R_API void rchainbuf_clear(rchainbuf_t* d) {
+    if (d == NULL) {
+        return;
+    }
+
+    while (d->head != NULL) {
+        _slab_pop_head(d);
+    }
+    d->size = 0;
+    d->write_slab = NULL;
+}
+
+R_API int rchainbuf_write(rchainbuf_t* d, const char* val, rchainbuf_size_t size) {
+    if (d == NULL || val == NULL) {
+        return rchainbuf_code_error;
+    }
+    if (size > rchainbuf_left(d)) {
+        return rchainbuf_code_full;
+    }
+
+    d->write_slab = NULL;
+    while (size > 0) {
+        rchainbuf_slab_t* slab = d->tail;
+        if (slab == NULL || slab->end == slab->capacity) {
+            slab = _slab_append(d, size);
+            if (slab == NULL) {
+                return rchainbuf_code_error;
+            }
+        }
+
+        rchainbuf_size_t count = slab->capacity - slab->end;
+        count = count > size ? size : count;
+        memcpy(slab->data + slab->end, val, count);
+        slab->end += count;
+        d->size += count;
+        val += count;
+        size -= count;
+    }
+
+    return rchainbuf_code_ok;
+}
+
+R_API rchainbuf_size_t rchainbuf_peek(rchainbuf_t* d, char* val, rchainbuf_size_t size) {
+    if (d == NULL || val == NULL) {
+        return 0;
+    }
+
+    size = size > d->size ? d->size : size;
+    rchainbuf_size_t copied = 0;
+    for (rchainbuf_slab_t* slab = d->head; slab != NULL && copied < size; slab = slab->next) {
+        rchainbuf_size_t count = slab->end - slab->start;
+        count = count > size - copied ? size - copied : count;
+        memcpy(val + copied, slab->data + slab->start, count);
+        copied += count;
+    }
+    return copied;
+}
+
+R_API rchainbuf_size_t rchainbuf_read(rchainbuf_t* d, char* val, rchainbuf_size_t size) {
+    size = rchainbuf_peek(d, val, size);
+    if (size > 0) {
+        rchainbuf_read_ext(d, size);
+    }
+    return size;
+}
+
+R_API int rchainbuf_read_ext(rchainbuf_t* d, rchainbuf_size_t len) {
+    if (d == NULL) {
+        return rcode_invalid;
+    }
+
+    len = len > d->size ? d->size : len;
+    while (len > 0) {
+        rchainbuf_slab_t* slab = d->head;
+        rchainbuf_size_t count = slab->end - slab->start;
+        count = count > len ? len : count;
+        slab->start += count;
+        d->size -= count;
+        len -= count;
+        if (slab->start == slab->end && (slab->next != NULL || !d->slab_large)) {//共享缓冲的最后一个slab由_slab_drain决定是否保留
+            if (slab == d->write_slab) {
+                d->write_slab = NULL;
+            }
+            _slab_pop_head(d);
+        }
+    }
+    if (d->size == 0) {
+        _slab_drain(d);//尾部预留的空slab也归还
+    }
+    return rcode_ok;
+}
+
+R_API int rchainbuf_write_revert(rchainbuf_t* d, rchainbuf_size_t len) {
+    if (d == NULL) {
+        return rcode_invalid;
+    }
+
+    len = len > d->size ? d->size : len;
+    rchainbuf_size_t keep = d->size - len;
+    if (keep == 0) {
+        _slab_drain(d);
+        return rcode_ok;
+    }
+
+    rchainbuf_slab_t* slab = d->head;
+    rchainbuf_size_t counted = 0;
+    while (counted + (slab->end - slab->start) < keep) {
+        counted += slab->end - slab->start;
+        slab = slab->next;
+    }
+    slab->end = slab->start + (keep - counted);
+
+    while (slab->next != NULL) {
+        rchainbuf_slab_t* next = slab->next;
+        slab->next = next->next;
+        d->slab_count--;
+        _slab_unref(next);
+    }
+    d->tail = slab;
+    d->size = keep;
+    d->write_slab = NULL;
+    return rcode_ok;
+}
+
+R_API int rchainbuf_read_iov(rchainbuf_t* d, rchainbuf_iov_t* iov, int iov_max) {
+    if (d == NULL) {
+        return 0;
+    }
+
+    int count = 0;
+    for (rchainbuf_slab_t* slab = d->head; slab != NULL && count < iov_max; slab = slab->next) {
+        if (slab->end > slab->start) {
+            iov[count].base = slab->data + slab->start;
+            iov[count].len = slab->end - slab->start;
+            count++;
+        }
+    }
+    return count;
+}
+
+R_API int rchainbuf_write_iov(rchainbuf_t* d, rchainbuf_iov_t* iov) {
+    if (d == NULL) {
+        return 0;
+    }
+
+    rchainbuf_size_t left = rchainbuf_left(d);
+    if (left == 0) {
+        return 0;
+    }
+
+    int count = 0;
+    rchainbuf_slab_t* slab = d->tail;
+    if (slab != NULL && slab->end < slab->capacity) {
+        d->write_slab = slab;
+        iov[count].base = slab->data + slab->end;
+        iov[count].len = slab->capacity - slab->end;
+        iov[count].len = iov[count].len > left ? left : iov[count].len;
+        left -= (rchainbuf_size_t)iov[count].len;
+        count++;
+    }
+    if (left > 0 && (count == 0 || iov[0].len < rchainbuf_slab_spare_min)) {
+        slab = _slab_append(d, 0);
+        if (slab == NULL) {
+            return count;
+        }
+        if (count == 0) {
+            d->write_slab = slab;
+        }
+        iov[count].base = slab->data;
+        iov[count].len = slab->capacity > left ? left : slab->capacity;
+        count++;
+    }
+    return count;
+}
+
+R_API int rchainbuf_write_ext(rchainbuf_t* d, rchainbuf_size_t len) {
+    if (d == NULL) {
+        return rcode_invalid;
+    }
+
+    rchainbuf_slab_t* slab = d->write_slab;
+    if (slab == NULL && len > 0) {
+        rerror("rchainbuf write_ext without write_iov, len = %u", len);
+        return rcode_invalid;
+    }
+    rchainbuf_size_t left = rchainbuf_left(d);
+    len = len > left ? left : len;
+    while (len > 0 && slab != NULL) {
+        rchainbuf_size_t count = slab->capacity - slab->end;
+        count = count > len ? len : count;
+        slab->end += count;
+        d->size += count;
+        len -= count;
+        slab = slab->next;
+    }
+    d->write_slab = NULL;
+    if (d->size == 0) {
+        _slab_drain(d);
+    }
+    return rcode_ok;
+}
+
+R_API int rchainbuf_splice(rchainbuf_t* dest, rchainbuf_t* src) {
+    if (dest == NULL || src == NULL || dest == src) {
+        return rchainbuf_code_error;
+    }
+    if (src->size > rchainbuf_left(dest)) {
+        return rchainbuf_code_full;
+    }
+    if (src->size == 0) {
+        _slab_drain(src);
+        return rchainbuf_code_ok;
+    }
+
+    if (src->size <= rchainbuf_slab_small_size) {//少量残留拷贝，大slab留给src继续用
+        for (rchainbuf_slab_t* slab = src->head; slab != NULL; slab = slab->next) {
+            if (slab->end > slab->start &&
+                rchainbuf_write(dest, slab->data + slab->start, slab->end - slab->start) != rchainbuf_code_ok) {
+                return rchainbuf_code_error;
+            }
+        }
+        _slab_drain(src);
+        return rchainbuf_code_ok;
+    }
+
+    if (dest->tail == NULL) {
+        dest->head = src->head;
+    } else {
+        dest->tail->next = src->head;
+    }
+    dest->tail = src->tail;
+    dest->size += src->size;
+    dest->slab_count += src->slab_count;
+    dest->write_slab = NULL;
+
+    src->head = src->tail = src->write_slab = NULL;
+    src->size = 0;
+    src->slab_count = 0;
+    return rchainbuf_code_ok;
+}
+
+R_API int rchainbuf_slice(rchainbuf_t* d, rchainbuf_size_t size, rchainbuf_slice_t* slice) {
+    if (d == NULL || slice == NULL || size > d->size) {
+        return rchainbuf_code_error;
+    }
+
+    slice->data = NULL;
+    slice->len = size;
+    slice->slab = NULL;
+    if (size == 0) {
+        return rchainbuf_code_ok;
+    }
+
+    rchainbuf_slab_t* slab = d->head;
+    if (slab->end - slab->start >= size) {
+        slab->ref_count++;
+        slice->data = slab->data + slab->start;
+        slice->slab = slab;
+    } else {
+        rchainbuf_slab_type_t type = size <= rchainbuf_slab_small_size ? rchainbuf_slab_small :
+            (size <= rchainbuf_slab_large_size ? rchainbuf_slab_large : rchainbuf_slab_huge);
+        slab = _slab_new(type, size);
+        if (slab == NULL) {
+            return rchainbuf_code_error;
+        }
+        slab->end = rchainbuf_peek(d, slab->data, size);
+        slice->data = slab->data;
+        slice->slab = slab;
+    }
+
+    rchainbuf_read_ext(d, size);
+    return rchainbuf_code_ok;
+}
+
+R_API void rchainbuf_slice_release(rchainbuf_slice_t* slice) {
+    if (slice == NULL) {
+        return;
+    }
+    if (slice->slab != NULL) {
+        _slab_unref(slice->slab);
+    }
+    slice->data = NULL;
+    slice->len = 0;
+    slice->slab = NULL;
+}
+
+R_API void rchainbuf_thread_stats(rchainbuf_stats_t* stats) {
+    if (stats != NULL) {
+        *stats = rchainbuf_stats_local;
+    }
+}
+
+R_API void rchainbuf_thread_release() {
+    if (rchainbuf_stats_local.bytes_used > 0) {
+        rwarn("rchainbuf slabs still in use, small = %"PRId64", large = %"PRId64", huge = %"PRId64,
+            rchainbuf_stats_local.slab_small_used, rchainbuf_stats_local.slab_large_used,
+            rchainbuf_stats_local.slab_huge_used);
+    }
+    if (rchainbuf_pool_small != NULL) {
+        rdata_pool_destroy(rchainbuf_pool_small);
+        rchainbuf_pool_small = NULL;
+    }
+    if (rchainbuf_pool_large != NULL) {
+        rdata_pool_destroy(rchainbuf_pool_large);
+        rchainbuf_pool_large = NULL;
+    }
+}
+
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif //__GNUC__
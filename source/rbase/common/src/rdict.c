@@ -42,6 +42,384 @@ static void set_value_func_default(void* data_ext, rdict_entry_t* entry, const v
     entry->value.ptr = (void*)obj;
 }
 
+/* ------------------------------- swiss engine ------------------------------------*/
+
+/** 键类型自带的hash多为原值，混合后高低位都可用 */
+static inline uint64_t _swiss_hash(rdict_t* d, const void* key) {
+    return rdict_hash_mix(rdict_hash_key(d, key));
+}
+
+static void _swiss_free_table(rdict_t* d, rdict_entry_t* entry, uint8_t* ctrl) {
+    if likely(d->free_func == NULL) {
+        if (entry != NULL) {
+            rdata_free_array(entry);
+        }
+        if (ctrl != NULL) {
+            rdata_free_array(ctrl);
+        }
+    }
+    else {
+        if (entry != NULL) {
+            d->free_func(entry);
+        }
+        if (ctrl != NULL) {
+            d->free_func(ctrl);
+        }
+    }
+}
+
+/** skip_below之前的slot已迁走，控制字节保留只为不截断其它key的探测序列 */
+static rdict_entry_t* _swiss_find_in(rdict_t* d, rdict_entry_t* entry, uint8_t* ctrl, rdict_size_t capacity,
+    rdict_size_t skip_below, const void* key, uint64_t hash) {
+    rdict_size_t mask = capacity - 1;
+    rdict_size_t pos = (rdict_size_t)rdict_swiss_h1(hash) & mask;
+    rdict_size_t stride = 0;
+    uint8_t h2 = rdict_ctrl_full(rdict_swiss_h2(hash));
+
+    while (true) {
+        const uint8_t* group = ctrl + pos;
+        uint32_t match = rdict_group_match(group, h2);
+        while (match != 0) {
+            rdict_size_t index = (pos + rtools_ctz64(match)) & mask;
+            if (likely(index >= skip_below && rdict_is_key_equal(d, entry[index].key.ptr, key))) {
+                return entry + index;
+            }
+            match &= match - 1;
+        }
+        if (likely(rdict_group_match(group, rdict_ctrl_empty) != 0)) {
+            return NULL;
+        }
+        stride += rdict_group_width;
+        pos = (pos + stride) & mask;
+    }
+}
+
+/** 迁移旧表 [rehash_index, rehash_index + count) 的slot，全部迁完释放旧表 */
+static void _swiss_rehash_slots(rdict_t* d, rdict_size_t count) {
+    int64_t end = d->rehash_index + count;
+    if (end > d->rehash_capacity) {
+        end = d->rehash_capacity;
+    }
+
+    for (int64_t i = d->rehash_index; i < end; i++) {
+        if (!rdict_ctrl_is_full(d->rehash_ctrl[i])) {
+            continue;
+        }
+        uint64_t hash = _swiss_hash(d, d->rehash_entry[i].key.ptr);
+        rdict_size_t index = rdict_ctrl_find_free(d->ctrl, d->capacity, hash);
+        if (d->ctrl[index] == rdict_ctrl_empty) {
+            d->growth_left--;
+        }
+        rdict_ctrl_set(d->ctrl, d->capacity, index, rdict_ctrl_full(rdict_swiss_h2(hash)));
+        memcpy(d->entry + index, d->rehash_entry + i, sizeof(rdict_entry_t));//浅拷贝
+    }
+    d->rehash_index = end;
+
+    if (d->rehash_index >= d->rehash_capacity) {
+        _swiss_free_table(d, d->rehash_entry, d->rehash_ctrl);
+        d->rehash_entry = NULL;
+        d->rehash_ctrl = NULL;
+        d->rehash_capacity = 0;
+        d->rehash_index = -1;
+    }
+}
+
+/** 换新表，旧表有数据时转入渐进迁移 */
+static int _swiss_resize(rdict_t* d, rdict_size_t capacity) {
+    if (rdict_rehashing(d)) {
+        _swiss_rehash_slots(d, d->rehash_capacity);
+    }
+
+    rdict_size_t used = d->size - (d->entry_null ? 1 : 0);
+    if (capacity == 0 || rdict_swiss_max_load(capacity) <= used) {
+        rerror("invalid size: "rdict_size_t_format, capacity);
+        if (d->expand_failed_func) {
+            d->expand_failed_func(d->data_ext);
+        }
+        return rdict_code_error;
+    }
+
+    rdict_entry_t* new_entry = d->calloc_func == NULL ? rdata_new_type_array(rdict_entry_t, capacity) : d->calloc_func(capacity, sizeof(rdict_entry_t));
+    uint8_t* new_ctrl = d->calloc_func == NULL ? rdata_new_type_array(uint8_t, capacity + rdict_group_width) : d->calloc_func(capacity + rdict_group_width, 1);
+    if (new_entry == NULL || new_ctrl == NULL) {
+        rerror("invalid malloc.");
+        _swiss_free_table(d, new_entry, new_ctrl);
+        return rdict_code_error;
+    }
+
+    if (d->entry != NULL) {
+        rdebug("expand map, size : capacity = %"rdict_size_t_format" : %"rdict_size_t_format" -> %"rdict_size_t_format,
+            d->size, d->capacity, capacity);
+
+        if (used > 0) {
+            d->rehash_entry = d->entry;
+            d->rehash_ctrl = d->ctrl;
+            d->rehash_capacity = d->capacity;
+            d->rehash_index = 0;
+        } else {
+            _swiss_free_table(d, d->entry, d->ctrl);
+        }
+    }
+
+    d->entry = new_entry;
+    d->ctrl = new_ctrl;
+    d->capacity = capacity;
+    d->buckets = capacity / rdict_group_width;
+    d->growth_left = rdict_swiss_max_load(capacity);
+
+    return rdict_code_ok;
+}
+
+/** 先查新表，迁移中再查旧表未迁移部分 */
+static inline rdict_entry_t* _swiss_find(rdict_t* d, const void* key, uint64_t hash) {
+    rdict_entry_t* entry = _swiss_find_in(d, d->entry, d->ctrl, d->capacity, 0, key, hash);
+    if (entry == NULL && rdict_rehashing(d)) {
+        entry = _swiss_find_in(d, d->rehash_entry, d->rehash_ctrl, d->rehash_capacity, (rdict_size_t)d->rehash_index, key, hash);
+    }
+    return entry;
+}
+
+static int _swiss_add(rdict_t* d, void* key, void* val) {
+    if (rdict_rehashing(d)) {
+        _swiss_rehash_slots(d, rdict_rehash_step_slots);
+    }
+
+    uint64_t hash = _swiss_hash(d, key);
+    rdict_entry_t* entry = _swiss_find(d, key, hash);
+
+    if (entry != NULL) {
+        rdict_free_value(d, entry);
+        rdict_set_value(d, entry, val);
+        return rdict_code_ok;
+    }
+
+    rdict_size_t index = rdict_ctrl_find_free(d->ctrl, d->capacity, hash);
+    if (unlikely(d->growth_left == 0 && d->ctrl[index] == rdict_ctrl_empty)) {
+        rdict_size_t used = d->size - (d->entry_null ? 1 : 0);
+        //deleted占了大半时原大小重建即可
+        rdict_size_t capacity = used + 1 > rdict_swiss_max_load(d->capacity) / 2 ? rdict_swiss_capacity_for(d->capacity) : d->capacity;
+        int code_expand = _swiss_resize(d, capacity);
+        if (code_expand != rdict_code_ok) {
+            return code_expand;
+        }
+        if (rdict_rehashing(d)) {
+            _swiss_rehash_slots(d, rdict_rehash_step_slots);
+        }
+        index = rdict_ctrl_find_free(d->ctrl, d->capacity, hash);
+    }
+
+    if (d->ctrl[index] == rdict_ctrl_empty) {
+        d->growth_left--;
+    }
+    rdict_ctrl_set(d->ctrl, d->capacity, index, rdict_ctrl_full(rdict_swiss_h2(hash)));
+    entry = d->entry + index;
+    d->size += 1;
+    rdict_set_key(d, entry, key);
+    rdict_set_value(d, entry, val); //支持 NULL 元素
+
+    return rdict_code_ok;
+}
+
+static int _swiss_remove(rdict_t* d, const void* key) {
+    if (rdict_rehashing(d)) {
+        _swiss_rehash_slots(d, rdict_rehash_step_slots);
+    }
+
+    rdict_entry_t* entry = _swiss_find(d, key, _swiss_hash(d, key));
+    if (entry == NULL) {
+        return rdict_code_not_exist;
+    }
+
+    rdict_free_key(d, entry);
+    rdict_free_value(d, entry);
+    rdict_init_entry(entry, NULL, NULL);
+    d->size -= 1;
+
+    if (entry < d->entry || entry >= d->entry + d->capacity) {//旧表上的直接标记删除
+        rdict_ctrl_set(d->rehash_ctrl, d->rehash_capacity, (rdict_size_t)(entry - d->rehash_entry), rdict_ctrl_deleted);
+        return rdict_code_ok;
+    }
+
+    rdict_size_t index = (rdict_size_t)(entry - d->entry);
+    if (rdict_ctrl_can_empty(d->ctrl, d->capacity, index)) {
+        rdict_ctrl_set(d->ctrl, d->capacity, index, rdict_ctrl_empty);
+        d->growth_left++;
+    } else {
+        rdict_ctrl_set(d->ctrl, d->capacity, index, rdict_ctrl_deleted);
+    }
+
+    return rdict_code_ok;
+}
+
+/* ------------------------------- compact engine ------------------------------------*/
+
+static void _compact_free_block(rdict_t* d, void* data) {
+    if (data == NULL) {
+        return;
+    }
+    if likely(d->free_func == NULL) {
+        rdata_free_array(data);
+    }
+    else {
+        d->free_func(data);
+    }
+}
+
+/** 探测序列同CPython，perturb逐步引入hash高位 */
+#define _compact_probe_next(pos, perturb, mask) \
+    do { \
+        (perturb) >>= 5; \
+        (pos) = ((pos) * 5 + (perturb) + 1) & (mask); \
+    } while(0)
+
+/** 返回索引数组中的位置，不存在返回-1 */
+static int64_t _compact_lookup(rdict_t* d, const void* key, uint64_t hash) {
+    rdict_size_t mask = d->indices_capacity - 1;
+    uint64_t perturb = hash;
+    rdict_size_t pos = (rdict_size_t)hash & mask;
+
+    while (true) {
+        int32_t index = d->indices[pos];
+        if (index == rdict_compact_index_empty) {
+            return -1;
+        }
+        if (index >= 0 && rdict_is_key_equal(d, d->entry[index].key.ptr, key)) {
+            return pos;
+        }
+        _compact_probe_next(pos, perturb, mask);
+    }
+}
+
+/** 探测序列上第一个empty或deleted的位置 */
+static rdict_size_t _compact_find_free(int32_t* indices, rdict_size_t indices_capacity, uint64_t hash) {
+    rdict_size_t mask = indices_capacity - 1;
+    uint64_t perturb = hash;
+    rdict_size_t pos = (rdict_size_t)hash & mask;
+
+    while (indices[pos] >= 0) {
+        _compact_probe_next(pos, perturb, mask);
+    }
+    return pos;
+}
+
+/** 按count重新分配，有效entry按原顺序压到数组头部，容量可大可小 */
+static int _compact_resize(rdict_t* d, rdict_size_t count) {
+    rdict_size_t used = d->size - (d->entry_null ? 1 : 0);
+    if (count < used) {
+        count = used;
+    }
+    uint64_t indices_capacity = rdict_compact_indices_min;
+    while (rdict_compact_usable(indices_capacity) < count) {
+        indices_capacity <<= 1;
+    }
+    if (indices_capacity > INT32_MAX) {
+        rerror("invalid size: "rdict_size_t_format, count);
+        if (d->expand_failed_func) {
+            d->expand_failed_func(d->data_ext);
+        }
+        return rdict_code_error;
+    }
+    rdict_size_t capacity = rdict_compact_usable((rdict_size_t)indices_capacity);
+
+    rdict_entry_t* new_entry = d->calloc_func == NULL ? rdata_new_type_array(rdict_entry_t, capacity) : d->calloc_func(capacity, sizeof(rdict_entry_t));
+    int32_t* new_indices = d->malloc_func == NULL ? rdata_new_type_array(int32_t, indices_capacity) : d->malloc_func(indices_capacity * sizeof(int32_t));
+    if (new_entry == NULL || new_indices == NULL) {
+        rerror("invalid malloc.");
+        _compact_free_block(d, new_entry);
+        _compact_free_block(d, new_indices);
+        return rdict_code_error;
+    }
+    memset(new_indices, 0xFF, indices_capacity * sizeof(int32_t));//全部置为 rdict_compact_index_empty
+
+    if (d->entry != NULL) {
+        rdebug("resize compact map, size : capacity = %"rdict_size_t_format" : %"rdict_size_t_format" -> %"rdict_size_t_format,
+            d->size, d->capacity, capacity);
+    }
+
+    rdict_size_t entry_used = 0;
+    for (rdict_size_t i = 0; i < d->entry_used; i++) {
+        if (d->entry[i].key.ptr == NULL) {
+            continue;
+        }
+        uint64_t hash = _swiss_hash(d, d->entry[i].key.ptr);
+        new_indices[_compact_find_free(new_indices, (rdict_size_t)indices_capacity, hash)] = (int32_t)entry_used;
+        memcpy(new_entry + entry_used, d->entry + i, sizeof(rdict_entry_t));//浅拷贝
+        entry_used++;
+    }
+
+    _compact_free_block(d, d->entry);
+    _compact_free_block(d, d->indices);
+    d->entry = new_entry;
+    d->indices = new_indices;
+    d->capacity = capacity;
+    d->indices_capacity = (rdict_size_t)indices_capacity;
+    d->entry_used = entry_used;
+
+    return rdict_code_ok;
+}
+
+static int _compact_add(rdict_t* d, void* key, void* val) {
+    uint64_t hash = _swiss_hash(d, key);
+    int64_t pos = _compact_lookup(d, key, hash);
+
+    if (pos >= 0) {//已存在覆盖value，顺序不变
+        rdict_entry_t* entry = d->entry + d->indices[pos];
+        rdict_free_value(d, entry);
+        rdict_set_value(d, entry, val);
+        return rdict_code_ok;
+    }
+
+    if (unlikely(d->entry_used >= d->capacity)) {//空洞多时原大小重建即可
+        int code_resize = _compact_resize(d, (d->size - (d->entry_null ? 1 : 0)) * 2);
+        if (code_resize != rdict_code_ok) {
+            return code_resize;
+        }
+    }
+
+    rdict_size_t index = d->entry_used++;
+    d->indices[_compact_find_free(d->indices, d->indices_capacity, hash)] = (int32_t)index;
+    rdict_entry_t* entry = d->entry + index;
+    d->size += 1;
+    rdict_set_key(d, entry, key);
+    rdict_set_value(d, entry, val); //支持 NULL 元素
+
+    return rdict_code_ok;
+}
+
+static int _compact_remove(rdict_t* d, const void* key) {
+    int64_t pos = _compact_lookup(d, key, _swiss_hash(d, key));
+    if (pos < 0) {
+        return rdict_code_not_exist;
+    }
+
+    rdict_entry_t* entry = d->entry + d->indices[pos];
+    d->indices[pos] = rdict_compact_index_deleted;
+    rdict_free_key(d, entry);
+    rdict_free_value(d, entry);
+    rdict_init_entry(entry, NULL, NULL);//留空洞，后面的entry不移动
+    d->size -= 1;
+
+    rdict_size_t used = d->size - (d->entry_null ? 1 : 0);
+    if (d->entry_used - used > used && d->entry_used >= rdict_compact_shrink_min) {//空洞过半，压缩并缩容
+        _compact_resize(d, used * 2 > rdict_init_capacity_default ? used * 2 : rdict_init_capacity_default);
+    }
+
+    return rdict_code_ok;
+}
+
+int64_t rdict_rehash_step(rdict_t* d, int64_t budget_us) {
+    if (d == NULL || !rdict_rehashing(d)) {
+        return 0;
+    }
+
+    int64_t time_end = rtime_microsec() + budget_us;
+    do {
+        _swiss_rehash_slots(d, rdict_rehash_step_slots * 16);
+    } while (rdict_rehashing(d) && rtime_microsec() < time_end);
+
+    return rdict_rehashing(d) ? d->rehash_capacity - d->rehash_index : 0;
+}
+
 rdict_t *rdict_create(rdict_size_t init_capacity, rdict_size_t bucket_capacity, void* data_ext,
     rdict_malloc_func_type malloc_func, rdict_calloc_func_type calloc_func, rdict_free_func_type free_func) {
     rdict_t* d = malloc_func == NULL ? rdata_new(rdict_t) : malloc_func(sizeof(rdict_t));
@@ -69,11 +447,64 @@ rdict_t *rdict_create(rdict_size_t init_capacity, rdict_size_t bucket_capacity,
     d->free_value_func = NULL;
     d->expand_failed_func = expand_failed_func_default;
 
-    _expand_buckets(d, d->capacity);
+    d->engine = rdict_engine_default;
+    d->ctrl = NULL;
+    d->growth_left = 0;
+    d->rehash_entry = NULL;
+    d->rehash_ctrl = NULL;
+    d->rehash_capacity = 0;
+    d->rehash_index = -1;
+    d->indices = NULL;
+    d->indices_capacity = 0;
+    d->entry_used = 0;
+
+    if (d->engine == rdict_engine_swiss) {
+        _swiss_resize(d, rdict_swiss_capacity_for(d->capacity));
+    } else if (d->engine == rdict_engine_compact) {
+        _compact_resize(d, d->capacity);
+    } else {
+        _expand_buckets(d, d->capacity);
+    }
 
     return d;
 }
 
+int rdict_set_engine(rdict_t* d, rdict_engine_t engine) {
+    if (d == NULL || d->size > 0) {
+        return rdict_code_error;
+    }
+    if (d->engine == engine) {
+        return rdict_code_ok;
+    }
+
+    if (rdict_rehashing(d)) {
+        _swiss_rehash_slots(d, d->rehash_capacity);
+    }
+    rdict_size_t capacity = d->capacity;
+    if (d->engine == rdict_engine_swiss) {
+        capacity = rdict_swiss_max_load(d->capacity);
+    } else if (d->engine == rdict_engine_bucket) {
+        capacity = (rdict_size_t)(d->capacity * d->scale_factor);
+    }
+    _swiss_free_table(d, d->entry, d->ctrl);
+    _compact_free_block(d, d->indices);
+    d->entry = NULL;
+    d->ctrl = NULL;
+    d->growth_left = 0;
+    d->indices = NULL;
+    d->indices_capacity = 0;
+    d->entry_used = 0;
+    d->engine = engine;
+
+    if (engine == rdict_engine_swiss) {
+        return _swiss_resize(d, rdict_swiss_capacity_for(capacity));
+    }
+    if (engine == rdict_engine_compact) {
+        return _compact_resize(d, capacity);
+    }
+    return _expand_buckets(d, capacity);
+}
+
 static int _expand_buckets(rdict_t* d, rdict_size_t capacity) {
     if (d == NULL) {
         return rdict_code_error;
@@ -173,6 +604,14 @@ int rdict_expand(rdict_t* d, rdict_size_t capacity) {
         return rcode_invalid;
     }
 
+    if (d->engine == rdict_engine_swiss) {
+        rdict_size_t capacity_new = rdict_swiss_capacity_for(capacity);
+        return capacity_new > d->capacity ? _swiss_resize(d, capacity_new) : rdict_code_ok;
+    }
+    if (d->engine == rdict_engine_compact) {
+        return capacity > d->capacity ? _compact_resize(d, capacity) : rdict_code_ok;
+    }
+
     rdict_size_t real_capacity = capacity;
     if (real_capacity < rdict_hill_expand_capacity) {//小于峰值，按倍数扩容
         real_capacity *= rdict_expand_factor;
@@ -201,6 +640,13 @@ int rdict_add(rdict_t* d, void* key, void* val) {
         return rdict_code_ok;
     }
 
+    if (d->engine == rdict_engine_swiss) {
+        return _swiss_add(d, key, val);
+    }
+    if (d->engine == rdict_engine_compact) {
+        return _compact_add(d, key, val);
+    }
+
     rdict_entry_t *entry_cur = NULL;
     rdict_entry_t *entry_start = entry_cur  = _find_bucket(d, key, d->buckets, d->bucket_capacity);
 
@@ -259,6 +705,13 @@ int rdict_remove(rdict_t* d, const void* key) {
         return rdict_code_ok;
     }
 
+    if (d->engine == rdict_engine_swiss) {
+        return _swiss_remove(d, key);
+    }
+    if (d->engine == rdict_engine_compact) {
+        return _compact_remove(d, key);
+    }
+
     rdict_entry_t* entry_cur = NULL;
     rdict_entry_t* entry_start = entry_cur = _find_bucket(d, key, d->buckets, d->bucket_capacity);
     rdict_entry_t* entry_end = entry_start + (d->bucket_capacity - 1);
@@ -326,6 +779,21 @@ void rdict_clear(rdict_t* d) {
     if (d->entry) {
        memset(d->entry, 0, sizeof(rdict_entry_t) * d->capacity);
     }
+    if (d->ctrl) {
+        memset(d->ctrl, rdict_ctrl_empty, d->capacity + rdict_group_width);
+        d->growth_left = rdict_swiss_max_load(d->capacity);
+    }
+    if (d->indices) {
+        memset(d->indices, 0xFF, d->indices_capacity * sizeof(int32_t));
+        d->entry_used = 0;
+    }
+    if (rdict_rehashing(d)) {
+        _swiss_free_table(d, d->rehash_entry, d->rehash_ctrl);
+        d->rehash_entry = NULL;
+        d->rehash_ctrl = NULL;
+        d->rehash_capacity = 0;
+        d->rehash_index = -1;
+    }
 }
 
 void rdict_release(rdict_t* d) {
@@ -340,12 +808,24 @@ void rdict_release(rdict_t* d) {
         if (entry) {
             rdata_free(rdict_entry_t, entry);
         }
+        if (d->ctrl) {
+            rdata_free_array(d->ctrl);
+        }
+        if (d->indices) {
+            rdata_free_array(d->indices);
+        }
         rdata_free(rdict_t, d);
     }
     else {
         if (entry) {
             d->free_func(entry);
         }
+        if (d->ctrl) {
+            d->free_func(d->ctrl);
+        }
+        if (d->indices) {
+            d->free_func(d->indices);
+        }
         d->free_func(d);
     }
 }
@@ -359,6 +839,14 @@ rdict_entry_t * rdict_find(rdict_t* d, const void* key) {
         return d->entry_null;
     }
 
+    if (d->engine == rdict_engine_swiss) {//只查新旧两表，不迁移
+        return _swiss_find(d, key, _swiss_hash(d, key));
+    }
+    if (d->engine == rdict_engine_compact) {
+        int64_t pos = _compact_lookup(d, key, _swiss_hash(d, key));
+        return pos < 0 ? NULL : d->entry + d->indices[pos];
+    }
+
     rdict_entry_t* entry = _find_bucket(d, key, d->buckets, d->bucket_capacity);
     //rdebug("find bucket, entry(%p) key.ptr(%p) - key(%p)", entry, entry->key.ptr, key);
     while (entry->key.ptr != NULL) {
@@ -381,6 +869,7 @@ rdict_iterator_t* rdict_it_heap(rdict_t* d) {
 
     it->d = d;
     it->entry = it->next = d->entry;
+    it->table = 0;
 
     return it;
 }
@@ -394,6 +883,45 @@ rdict_entry_t* rdict_next(rdict_iterator_t* it) {
         }
     }
     
+    if (it->d->engine == rdict_engine_swiss) {
+        rdict_t* d = it->d;
+        if (it->table == 0) {
+            rdict_size_t index = rdict_ctrl_next_full(d->ctrl, d->capacity, (rdict_size_t)(it->next - it->entry));
+            if (index < d->capacity) {
+                it->next = it->entry + index + 1;
+                return it->entry + index;
+            }
+            if (!rdict_rehashing(d)) {
+                it->next = it->entry + d->capacity;
+                return NULL;
+            }
+            it->table = 1;//迁移中，继续遍历旧表未迁移部分
+            it->entry = d->rehash_entry;
+            it->next = d->rehash_entry + d->rehash_index;
+        }
+        if (it->entry != d->rehash_entry) {
+            return NULL;
+        }
+        rdict_size_t index = rdict_ctrl_next_full(d->rehash_ctrl, d->rehash_capacity, (rdict_size_t)(it->next - it->entry));
+        if (index < d->rehash_capacity) {
+            it->next = it->entry + index + 1;
+            return it->entry + index;
+        }
+        it->next = it->entry + d->rehash_capacity;
+        return NULL;
+    }
+
+    if (it->d->engine == rdict_engine_compact) {//按插入顺序，跳过删除留下的空洞
+        rdict_entry_t* entry_end = it->entry + it->d->entry_used;
+        while (it->next < entry_end) {
+            rdict_entry_t* entry = it->next++;
+            if (entry->key.ptr != NULL) {
+                return entry;
+            }
+        }
+        return NULL;
+    }
+
     if (likely(it->next < it->entry + it->d->capacity)) {
         if (it->next->key.ptr) {
             return it->next++;
@@ -430,6 +958,7 @@ rdict_block_define_type_key_func(rdata_type_int64)
 rdict_block_define_type_key_func(rdata_type_uint64)
 rdict_block_define_type_key_func(rdata_type_string)
 rdict_block_define_type_key_func(rdata_type_ptr)
+rdict_block_define_type_key_func(rdata_type_hkey)
 
 rdict_block_define_type_value_func(rdata_type_int)
 rdict_block_define_type_value_func(rdata_type_float)
@@ -0,0 +1,199 @@
+/**
+ * Copyright (c) 2014 ray
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the MIT license. See LICENSE for details.
+ *
+ * @author: Ray
+ */
+
+#include "rdict_sharded.h"
+#include "rlog.h"
+
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunknown-pragmas"
+#endif //__GNUC__
+
+static inline rdict_shard_t* _shard_of(rdict_sharded_t* d, const void* key) {
+    if (d->shard_count == 1 || key == NULL) {
+        return &d->shards[0].shard;
+    }
+    uint64_t hash = rdict_hash_mix(d->shards[0].shard.dict->hash_func(key));
+    return &d->shards[hash >> d->shard_shift].shard;
+}
+
+R_API rdict_sharded_t* rdict_sharded_create(uint32_t shard_count, rdict_malloc_func_type malloc_func, rdict_free_func_type free_func) {
+    if (shard_count == 0) {
+        shard_count = rdict_sharded_count_default;
+    }
+    if (shard_count > rdict_sharded_count_max) {
+        rerror("invalid shard count: %u", shard_count);
+        return NULL;
+    }
+
+    uint32_t count = 1;
+    uint32_t shift = 64;
+    while (count < shard_count) {
+        count <<= 1;
+        shift--;
+    }
+
+    rdict_sharded_t* d = malloc_func == NULL ? rdata_new(rdict_sharded_t) : malloc_func(sizeof(rdict_sharded_t));
+    if (d == NULL) {
+        return NULL;
+    }
+    d->shards = malloc_func == NULL ? rdata_new_type_array(rdict_shard_padded_t, count) : malloc_func(count * sizeof(rdict_shard_padded_t));
+    if (d->shards == NULL) {
+        if (free_func == NULL) {
+            rdata_free(rdict_sharded_t, d);
+        } else {
+            free_func(d);
+        }
+        return NULL;
+    }
+    d->shard_count = count;
+    d->shard_shift = shift;
+    d->free_func = free_func;
+
+    for (uint32_t i = 0; i < count; i++) {
+        rrwlock_init(&d->shards[i].shard.lock);
+        d->shards[i].shard.dict = NULL;
+    }
+
+    return d;
+}
+
+R_API void rdict_sharded_release(rdict_sharded_t* d) {
+    if (d == NULL) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < d->shard_count; i++) {
+        rdict_shard_t* shard = &d->shards[i].shard;
+        rdict_free(shard->dict);
+        rrwlock_uninit(&shard->lock);
+    }
+
+    if (d->free_func == NULL) {
+        rdata_free_array(d->shards);
+        rdata_free(rdict_sharded_t, d);
+    } else {
+        d->free_func(d->shards);
+        d->free_func(d);
+    }
+}
+
+R_API int rdict_sharded_add(rdict_sharded_t* d, void* key, void* val) {
+    if (d == NULL) {
+        return rdict_code_error;
+    }
+
+    rdict_shard_t* shard = _shard_of(d, key);
+    rrwlock_write_lock(&shard->lock);
+    int ret_code = rdict_add(shard->dict, key, val);
+    rrwlock_write_unlock(&shard->lock);
+
+    return ret_code;
+}
+
+R_API int rdict_sharded_remove(rdict_sharded_t* d, const void* key) {
+    if (d == NULL) {
+        return rdict_code_error;
+    }
+
+    rdict_shard_t* shard = _shard_of(d, key);
+    rrwlock_write_lock(&shard->lock);
+    int ret_code = rdict_remove(shard->dict, key);
+    rrwlock_write_unlock(&shard->lock);
+
+    return ret_code;
+}
+
+R_API int rdict_sharded_find(rdict_sharded_t* d, const void* key, void** value) {
+    if (d == NULL) {
+        return rdict_code_error;
+    }
+
+    rdict_shard_t* shard = _shard_of(d, key);
+    rrwlock_read_lock(&shard->lock);
+    rdict_entry_t* entry = rdict_find(shard->dict, key);
+    if (entry != NULL && value != NULL) {
+        *value = entry->value.ptr;
+    }
+    rrwlock_read_unlock(&shard->lock);
+
+    return entry != NULL ? rdict_code_ok : rdict_code_not_exist;
+}
+
+R_API int rdict_sharded_take(rdict_sharded_t* d, const void* key, void** value) {
+    if (d == NULL) {
+        return rdict_code_error;
+    }
+
+    int ret_code = rdict_code_not_exist;
+    rdict_shard_t* shard = _shard_of(d, key);
+    rrwlock_write_lock(&shard->lock);
+    rdict_entry_t* entry = rdict_find(shard->dict, key);
+    if (entry != NULL) {
+        if (value != NULL) {
+            *value = entry->value.ptr;
+        }
+        rdict_free_value_func_type free_value_func = shard->dict->free_value_func;
+        shard->dict->free_value_func = NULL;//value已交出
+        ret_code = rdict_remove(shard->dict, key);
+        shard->dict->free_value_func = free_value_func;
+    }
+    rrwlock_write_unlock(&shard->lock);
+
+    return ret_code;
+}
+
+R_API void rdict_sharded_clear(rdict_sharded_t* d) {
+    if (d == NULL) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < d->shard_count; i++) {
+        rdict_shard_t* shard = &d->shards[i].shard;
+        rrwlock_write_lock(&shard->lock);
+        rdict_clear(shard->dict);
+        rrwlock_write_unlock(&shard->lock);
+    }
+}
+
+R_API rdict_size_t rdict_sharded_size(rdict_sharded_t* d) {
+    if (d == NULL) {
+        return 0;
+    }
+
+    rdict_size_t size = 0;
+    for (uint32_t i = 0; i < d->shard_count; i++) {
+        rdict_shard_t* shard = &d->shards[i].shard;
+        rrwlock_read_lock(&shard->lock);
+        size += rdict_size(shard->dict);
+        rrwlock_read_unlock(&shard->lock);
+    }
+
+    return size;
+}
+
+R_API void rdict_sharded_scan(rdict_sharded_t* d, rdict_scan_func* func, void* data_ext) {
+    if (d == NULL || func == NULL) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < d->shard_count; i++) {
+        rdict_shard_t* shard = &d->shards[i].shard;
+        rrwlock_read_lock(&shard->lock);
+        rdict_iterator_t it = rdict_it(shard->dict);
+        for (rdict_entry_t *de = NULL; (de = rdict_next(&it)) != NULL; ) {
+            func(data_ext, de);
+        }
+        rrwlock_read_unlock(&shard->lock);
+    }
+}
+
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif //__GNUC__
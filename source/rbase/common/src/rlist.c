@@ -8,6 +8,14 @@
  */
 
 #include "rlist.h"
+#include "rpool.h"
+
+static inline rlist_node_t* _rlist_node_new(rlist_t *self) {
+    if (self->node_pool != NULL) {
+        return (rlist_node_t*)rdata_pool_alloc(self->node_pool);
+    }
+    return rdata_new(rlist_node_t);
+}
 
 rlist_t* rlist_create() {
     rlist_t* self = rdata_new(rlist_t);
@@ -15,10 +23,37 @@ rlist_t* rlist_create() {
     self->head = NULL;
     self->tail = NULL;
     self->len = 0;
+    self->malloc_node_val = NULL;
+    self->free_node_val = NULL;
+    self->compare_node_val = NULL;
+    self->node_pool = NULL;
 
     return self;
 }
 
+int rlist_enable_pool(rlist_t *self, unsigned int init_nodes) {
+    if (self == NULL) {
+        return rcode_invalid;
+    }
+    if (self->node_pool != NULL) {
+        return rcode_ok;
+    }
+    if (self->len > 0) {//已有节点是malloc出来的，不能混用
+        return rcode_invalid;
+    }
+
+    self->node_pool = rdata_pool_create(sizeof(rlist_node_t), init_nodes);
+    return self->node_pool != NULL ? rcode_ok : rcode_invalid;
+}
+
+void rlist_free_node_mem(rlist_t *self, rlist_node_t *node) {
+    if (self != NULL && self->node_pool != NULL) {
+        rdata_pool_free(self->node_pool, node);
+        return;
+    }
+    rdata_free(rlist_node_t, node);
+}
+
 void rlist_clear(rlist_t *self) {
     if (self == NULL || self->len <= 0) {
         return;
@@ -56,6 +91,9 @@ void rlist_destroy(rlist_t *self) {
         curr = next;
     }
 
+    if (self->node_pool != NULL) {
+        rdata_pool_destroy(self->node_pool);
+    }
     rdata_free(rlist_t, self);
 }
 
@@ -70,7 +108,7 @@ rlist_node_t* rlist_rpush(rlist_t *self, void* node_val) {
 
     if (!node_val) return NULL;//不支持空节点
 
-    rlist_node_t* node = rdata_new(rlist_node_t);
+    rlist_node_t* node = _rlist_node_new(self);
     if (!node) {
         return NULL;
     }
@@ -154,7 +192,7 @@ rlist_node_t* rlist_lpush(rlist_t *self, void* node_val) {
 
     if (!node_val) return NULL;//不支持空节点
 
-    rlist_node_t* node = rdata_new(rlist_node_t);
+    rlist_node_t* node = _rlist_node_new(self);
     if (!node) {
         return NULL;
     }
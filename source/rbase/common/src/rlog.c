@@ -11,6 +11,7 @@
 #include "rstring.h"
 #include "rfile.h"
 #include "rtime.h"
+#include "rtools.h"
 #include "rlog.h"
 
 #ifdef __GNUC__
@@ -54,6 +55,304 @@ static char* rlog_param_file_suffix_gap = ".";// "."
 static char* rlog_param_file_index_gap = "_";//"_" 形如：xxx_0.log
 static char* rlog_param_file_index_default = "";//"" 形如：xxx_.log
 
+#define rlog_head_reserve 64//行头最大长度
+#define rlog_binary_record_max (rlog_temp_data_size * 2)
+#define rlog_binary_fallback 2//参数不能按二进制记录，改用文本
+#define rlog_site_chunk_size 1024
+
+typedef enum {
+    rlog_binary_event = 1,//调用点日志，内容为参数
+    rlog_binary_site,//调用点定义，内容为行号和文件名、函数名、格式串
+    rlog_binary_text,//已格式化的文本
+} rlog_binary_type_t;
+
+/** 二进制记录头，len包括头；文件中不保证对齐，按memcpy读写 */
+typedef struct rlog_binary_head_s {
+    uint32_t len;
+    uint8_t type;
+    uint8_t level;
+    uint16_t reserved;
+    int32_t site_id;
+    int32_t thread_id;
+    int64_t time;
+} rlog_binary_head_t;
+
+/** 队列中的一条日志，头部8字节对齐，内容可能绕回队列头 */
+typedef struct rlog_async_record_s {
+    uint32_t len;
+    uint32_t level;
+} rlog_async_record_t;
+
+/** 单生产者(所属线程)单消费者(写线程)环形队列 */
+typedef struct rlog_async_queue_s {
+    struct rlog_async_queue_s* next;
+    long thread_id;
+    char* data;
+    int64_t write_index;
+    int64_t read_index;
+    int64_t dropped;
+    int64_t dropped_reported;
+} rlog_async_queue_t;
+
+struct rlog_async_s {
+    int64_t epoch;
+    rlog_overflow_t overflow;
+    int64_t running;
+    rmutex_t mutex;//注册队列
+    rlog_async_queue_t* queues;
+    rthread_t thread;
+    char* batch;
+    int batch_len;
+    rlog_level_t batch_level;
+    int64_t flush_last;
+    int64_t blocked;
+    rlog_async_stats_t stats;//写线程维护records/bytes/writes
+    bool binary;
+    int32_t file_seq;//写线程每打开一个新文件加1
+    int32_t* site_file_seq;//调用点定义最后写入的文件
+};
+
+static rlog_t* rlog_async_owner = NULL;
+static int64_t rlog_async_epoch = 0;
+static rthread_local rlog_async_queue_t* rlog_async_queue_local = NULL;
+static rthread_local int64_t rlog_async_epoch_local = 0;
+static rthread_local char rlog_buffer_local[rlog_temp_data_size + rlog_head_reserve];//格式化缓冲，每线程一份
+static rthread_local char rlog_binary_local[rlog_binary_record_max];
+static rthread_local long rlog_thread_id_local = 0;
+static rthread_local int64_t rlog_head_second_local = -1;
+static rthread_local char rlog_head_date_local[32];
+static rthread_local int rlog_head_date_len_local = 0;
+
+//调用点表，按id分块，块一旦分配不再移动，写线程无锁读取；进程内不释放
+static int64_t rlog_site_lock = 0;
+static int64_t rlog_site_count = 0;
+static rlog_site_t** rlog_site_chunks[rlog_site_max / rlog_site_chunk_size];
+
+typedef struct rlog_module_level_s {
+    char name[rlog_module_name_size];
+    rlog_level_t level;
+} rlog_module_level_t;
+
+//模块级别表，只在调用点重新判断时查，和调用点表一样用自旋锁
+int64_t rlog_filter_version = 1;
+static int64_t rlog_module_lock = 0;
+static int rlog_module_count = 0;
+static rlog_module_level_t rlog_modules[rlog_module_max];
+
+static int _rlog_async_text(rlog_async_t* ctx, rlog_level_t level, char* text, int len);
+static int _rlog_binary_vprintf(rlog_async_t* ctx, rlog_site_t* site, va_list ap);
+static int _rlog_binary_prepare(rlog_async_t* ctx, rlog_info_t* rlog_info);
+static int _rlog_async_head(char* buffer, rlog_level_t level);
+
+//异步模式下打印线程不碰文件，写线程滚动文件时也可以继续入队
+static inline bool _rlog_accepting(rlog_t* rlog) {
+    return rlog->state == rlog_state_working || (rlog->state == rlog_state_roll_file && rlog->async != NULL);
+}
+
+static inline long _rlog_thread_id() {
+    if (unlikely(rlog_thread_id_local == 0)) {
+        rlog_thread_id_local = rthread_cur_id();
+    }
+    return rlog_thread_id_local;
+}
+
+static void _rlog_site_register(rlog_site_t* site) {
+    while (!ratomic_cas(&rlog_site_lock, 0, 1)) {//rlog_init之前也可能打日志，不用rmutex
+    }
+
+    if (site->id == 0) {
+        site->name = get_filename((char*)site->file);
+
+        int64_t id = rlog_site_count + 1;//0表示未登记
+        rlog_site_t** chunk = NULL;
+        if (id < rlog_site_max) {
+            chunk = rlog_site_chunks[id / rlog_site_chunk_size];
+            if (chunk == NULL) {
+                chunk = (rlog_site_t**)calloc(rlog_site_chunk_size, sizeof(rlog_site_t*));
+                rlog_site_chunks[id / rlog_site_chunk_size] = chunk;
+            }
+        }
+        if (chunk != NULL) {
+            chunk[id % rlog_site_chunk_size] = site;
+            rlog_site_count = id;
+            ratomic_store(&site->id, id);
+        } else {
+            ratomic_store(&site->id, -1);
+        }
+    }
+
+    ratomic_store(&rlog_site_lock, 0);
+}
+
+static rlog_site_t* _rlog_site_get(int64_t id) {
+    if (id <= 0 || id >= rlog_site_max) {
+        return NULL;
+    }
+    rlog_site_t** chunk = rlog_site_chunks[id / rlog_site_chunk_size];
+    return chunk != NULL ? chunk[id % rlog_site_chunk_size] : NULL;
+}
+
+static int _rlog_module_find(const char* module) {
+    for (int i = 0; i < rlog_module_count; i++) {
+        if (strcmp(rlog_modules[i].name, module) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool rlog_site_check(rlog_t* rlog, rlog_site_t* site) {
+    rlog = rlog != NULL ? rlog : (rlog_all != NULL ? rlog_all[0] : NULL);
+
+    if (unlikely(ratomic_load(&site->id) == 0)) {
+        _rlog_site_register(site);
+    }
+    if (rlog == NULL) {
+        return true;//不缓存，由rlog_printf_site输出到控制台
+    }
+
+    int64_t version = ratomic_load(&rlog_filter_version);
+    rlog_level_t level = rlog->level;
+    while (!ratomic_cas(&rlog_module_lock, 0, 1)) {
+    }
+    int index = site->module != NULL ? _rlog_module_find(site->module) : -1;
+    index = index < 0 && site->name != NULL ? _rlog_module_find(site->name) : index;
+    if (index >= 0) {
+        level = rlog_modules[index].level;
+    }
+    ratomic_store(&rlog_module_lock, 0);
+
+    bool enabled = site->level >= level;
+    site->enabled = enabled;
+    ratomic_store(&site->version, version);//先写enabled
+    return enabled;
+}
+
+bool rlog_site_limit(rlog_t* rlog, rlog_site_t* site, int rate, int burst) {
+    int64_t now = rtime_millisec_coarse() * 1000;
+    int64_t interval = 1000000 / (rate > 0 ? rate : 1);
+    int64_t tolerance = interval * (burst > 1 ? burst - 1 : 0);//同一时刻可连续通过burst条
+
+    int64_t limit_at = ratomic_load(&site->limit_at);
+    while (true) {
+        int64_t arrival = limit_at > now ? limit_at : now;
+        if (arrival - now > tolerance) {
+            ratomic_fetch_add(&site->suppressed, 1);
+            return false;
+        }
+        if (ratomic_cas(&site->limit_at, limit_at, arrival + interval)) {
+            break;
+        }
+        limit_at = ratomic_load(&site->limit_at);
+    }
+
+    int64_t suppressed = ratomic_load(&site->suppressed);
+    while (suppressed > 0 && !ratomic_cas(&site->suppressed, suppressed, 0)) {
+        suppressed = ratomic_load(&site->suppressed);
+    }
+    if (suppressed > 0) {
+        rlog_printf(rlog, site->level, "[%ld] %s:%s:%d suppressed %"PRId64" similar messages\n", _rlog_thread_id(),
+            site->name != NULL ? site->name : site->file, site->func, site->line, suppressed);
+    }
+    return true;
+}
+
+int rlog_set_module_level(const char* module, rlog_level_t level) {
+    if (module == NULL || rstr_len(module) >= rlog_module_name_size) {
+        return rcode_invalid;
+    }
+
+    int code_ret = rcode_ok;
+    while (!ratomic_cas(&rlog_module_lock, 0, 1)) {
+    }
+    int index = _rlog_module_find(module);
+    if (index < 0 && rlog_module_count < rlog_module_max) {
+        index = rlog_module_count++;
+        strcpy(rlog_modules[index].name, module);
+    }
+    if (index >= 0) {
+        rlog_modules[index].level = level;
+        ratomic_fetch_add(&rlog_filter_version, 1);
+    } else {
+        code_ret = rcode_invalid;
+    }
+    ratomic_store(&rlog_module_lock, 0);
+
+    return code_ret;
+}
+
+int rlog_remove_module_level(const char* module) {
+    if (module == NULL) {
+        return rcode_invalid;
+    }
+
+    while (!ratomic_cas(&rlog_module_lock, 0, 1)) {
+    }
+    int index = _rlog_module_find(module);
+    if (index >= 0) {
+        rlog_modules[index] = rlog_modules[--rlog_module_count];
+        ratomic_fetch_add(&rlog_filter_version, 1);
+    }
+    ratomic_store(&rlog_module_lock, 0);
+
+    return index >= 0 ? rcode_ok : rcode_invalid;
+}
+
+//"[线程] 文件:函数:行 "加内容，和原来宏里拼的格式相同
+static int _rlog_site_vformat(char* buffer, int size, rlog_site_t* site, va_list ap) {
+    int head_len = snprintf(buffer, size, "[%ld] %s:%s:%d ", _rlog_thread_id(),
+        site->name != NULL ? site->name : site->file, site->func, site->line);
+    if (head_len >= size) {
+        return head_len;
+    }
+    return head_len + vsnprintf(buffer + head_len, size - head_len, site->fmt, ap);
+}
+
+/* 文件写入，mmap模式下写map_file，否则写file_ptr；不合并多个文件时各级别共用同一个 */
+#define rlog_file_of(rlog_info) ((rlog_info)->map_file != NULL ? (void*)(rlog_info)->map_file : (void*)(rlog_info)->file_ptr)
+
+static inline void _rlog_file_write(rlog_info_t* rlog_info, const char* data, int len) {
+    if (rlog_info->map_file != NULL) {
+        rmapfile_write(rlog_info->map_file, data, len);
+    } else if (rlog_info->file_ptr != NULL) {
+        fwrite(data, 1, len, rlog_info->file_ptr);
+    }
+}
+
+static inline void _rlog_file_puts(rlog_info_t* rlog_info, const char* data) {
+    _rlog_file_write(rlog_info, data, (int)strlen(data));
+}
+
+static int64_t _rlog_file_tell(rlog_info_t* rlog_info) {
+    if (rlog_info->map_file != NULL) {
+        return rmapfile_size(rlog_info->map_file);
+    }
+    return rlog_info->file_ptr != NULL ? (int64_t)ftell(rlog_info->file_ptr) : 0;
+}
+
+static void _rlog_file_flush(rlog_info_t* rlog_info) {
+    if (rlog_info->map_file != NULL) {
+        rmapfile_flush(rlog_info->map_file, false);//数据已在page cache，只发起回写
+    } else if (rlog_info->file_ptr != NULL) {
+        fflush(rlog_info->file_ptr);
+    }
+}
+
+//持锁调用，不能打日志，失败由调用方解锁后输出
+static int _rlog_file_close(rlog_info_t* rlog_info) {
+    int code_ret = rcode_ok;
+
+    if (rlog_info->map_file != NULL) {
+        code_ret = rmapfile_close(rlog_info->map_file);
+    } else if (rlog_info->file_ptr != NULL) {
+        fflush(rlog_info->file_ptr);
+        fclose(rlog_info->file_ptr);
+    }
+    rlog_info->map_file = NULL;
+    rlog_info->file_ptr = NULL;
+    return code_ret;
+}
+
 static char* _rlog_format_filepath_template(const char* filepath_template) {
     char* rlog_filepath_format = rstr_cpy(filepath_template, 0);
     
@@ -85,82 +384,168 @@ static char* _rlog_format_filepath_template(const char* filepath_template) {
 
     return rlog_filepath_format;
 }
-static char* _rlog_get_filepath(char* rlog_filepath_template, char* log_level_str, bool need_file_index) {
-	char date_str_temp[16];
-    char time_str_temp[16];
-    char* filepath_str_temp = NULL;
-    char* fileidx_str_temp = NULL;
-    char* ret_str = NULL;
-    //int fileidx_index = 0;
-    int suffix_index = 0;
+/* ------------------------------- path ------------------------------------*/
+
+#define rlog_path_segment_max 16
+
+typedef enum {
+    rlog_path_text = 0,
+    rlog_path_date,
+    rlog_path_time,
+    rlog_path_level,
+    rlog_path_index,
+} rlog_path_type_t;
+
+typedef struct rlog_path_segment_s {
+    rlog_path_type_t type;
+    int len;
+    const char* text;//指向filepath_template
+} rlog_path_segment_t;
+
+/** filepath_template按${xxx}切分，init时编译一次，滚动时直接拼接 */
+struct rlog_path_s {
+    int count;
+    rlog_path_segment_t segments[rlog_path_segment_max];
+};
+
+static bool _rlog_path_add(rlog_path_t* path, rlog_path_type_t type, const char* text, int len) {
+    if (path->count >= rlog_path_segment_max) {
+        return false;
+    }
+    path->segments[path->count].type = type;
+    path->segments[path->count].text = text;
+    path->segments[path->count].len = len;
+    path->count++;
+    return true;
+}
+
+static rlog_path_t* _rlog_path_compile(const char* filepath_template) {
+    const char* params[] = { NULL, rlog_param_date, rlog_param_time, rlog_param_level, rlog_param_file_index };
+    rlog_path_t* path = rdata_new(rlog_path_t);
+    if (path == NULL) {
+        return NULL;
+    }
+    memset(path, 0, sizeof(rlog_path_t));
+
+    const char* text = filepath_template;
+    const char* p = filepath_template;
+    while (*p != '\0') {
+        int type = rlog_path_date;
+        if (p[0] == '$' && p[1] == '{') {
+            for (; type <= rlog_path_index; type++) {
+                if (strncmp(p, params[type], strlen(params[type])) == 0) {
+                    break;
+                }
+            }
+        }
+        if (p[0] != '$' || p[1] != '{' || type > rlog_path_index) {
+            p++;
+            continue;
+        }
+
+        if ((p > text && !_rlog_path_add(path, rlog_path_text, text, (int)(p - text))) ||
+            !_rlog_path_add(path, (rlog_path_type_t)type, NULL, 0)) {
+            rdata_free(rlog_path_t, path);
+            return NULL;
+        }
+        p += strlen(params[type]);
+        text = p;
+    }
+    if (p > text && !_rlog_path_add(path, rlog_path_text, text, (int)(p - text))) {
+        rdata_free(rlog_path_t, path);
+        return NULL;
+    }
+
+    return path;
+}
+
+//拼出路径，index_pos为index段的起始位置，没有时为-1
+static int _rlog_path_build(rlog_path_t* path, char* buffer, int size, const char* date_str, const char* time_str,
+    const char* level_str, const char* index_str, int* index_pos) {
+    int len = 0;
+    *index_pos = -1;
+
+    for (int i = 0; i < path->count; i++) {
+        rlog_path_segment_t* segment = &path->segments[i];
+        const char* value = segment->text;
+        int value_len = segment->len;
+        switch (segment->type) {
+        case rlog_path_date: value = date_str; break;
+        case rlog_path_time: value = time_str; break;
+        case rlog_path_level: value = level_str; break;
+        case rlog_path_index: value = index_str; *index_pos = len; break;
+        default: break;
+        }
+        if (segment->type != rlog_path_text) {
+            value_len = (int)strlen(value);
+        }
+        if (len + value_len >= size) {
+            return -1;
+        }
+        memcpy(buffer + len, value, value_len);
+        len += value_len;
+    }
+    buffer[len] = '\0';
 
-    rformat_time_s_yyyymmdd(date_str_temp, 0, 0);
-    rformat_time_s_hhMMss(time_str_temp, 0, 0);
+    return len;
+}
 
-    filepath_str_temp = rstr_repl(rlog_filepath_template, rlog_param_date, date_str_temp);
+static char* _rlog_get_filepath(rlog_path_t* path, char* log_level_str, bool need_file_index) {
+    char filepath[rlog_filename_length + 64];
+    char date_str[16];
+    char time_str[16];
+    int time_datas[7];
+    int index_pos = -1;
 
-    ret_str = rstr_repl(filepath_str_temp, rlog_param_time, time_str_temp);
-    rstr_free(filepath_str_temp);
-    filepath_str_temp = ret_str;
+    rtime_from_time_millis_security(rtime_millisec(), time_datas);
+    snprintf(date_str, sizeof(date_str), "%.4d%.2d%.2d", time_datas[0], time_datas[1], time_datas[2]);
+    snprintf(time_str, sizeof(time_str), "%.2d%.2d%.2d", time_datas[3], time_datas[4], time_datas[5]);
 
-    ret_str = rstr_repl(filepath_str_temp, rlog_param_level, log_level_str);
-    rstr_free(filepath_str_temp);
-    filepath_str_temp = ret_str;
+    int len = _rlog_path_build(path, filepath, sizeof(filepath), date_str, time_str, log_level_str,
+        rlog_param_file_index_default, &index_pos);
+    rassert(len > 0, "filepath too long");
 
-    //index，取当前目录同前缀文件下标，默认无
-    int file_index_gap_len = (int)rstr_len(rlog_param_file_index_gap);
-    char* path_name = rdir_get_path_dir(ret_str);
-    char* file_name = rdir_get_path_filename(ret_str);
-    char* file_prefix = rstr_sub(file_name, 0, rstr_last_index(file_name, rlog_param_file_index_gap) + file_index_gap_len, true);
-    int file_prefix_len = (int)rstr_len(file_prefix);
-    int file_id_max = -1;
+    char* path_name = rdir_get_path_dir(filepath);
+    char* file_name = filepath + rstr_last_index(filepath, rfile_seperator) + 1;
 
     rassert(rdir_make(path_name, true) == rcode_ok, path_name);//确保目录存在
 
-    if (need_file_index) {
+    //index，取当前目录同前缀文件下标，默认无
+    int file_prefix_len = index_pos - (int)(file_name - filepath);
+    if (need_file_index && file_prefix_len >= 0) {
         rlist_t* file_list = rdir_list(path_name, true, false);//dir_path
         rlist_iterator_t it = rlist_it(file_list, rlist_dir_tail);
         rlist_node_t* node = NULL;
-
-		char* temp_file_name = NULL;
-		int prefix_index = 0;
-		int file_id = 0;
+        char* temp_file_name = NULL;
+        int file_id_max = -1;
+        int suffix_index = 0;
 
         while ((node = rlist_next(&it))) {
             temp_file_name = (char*)(node->val);
-            prefix_index = rstr_index(temp_file_name, file_prefix);
-            file_id = 0;
-            if (prefix_index != 0) {//start with
+            if (strncmp(temp_file_name, file_name, file_prefix_len) != 0) {//start with
                 continue;
             }
             file_id_max = file_id_max == -1 ? 0 : file_id_max;
 
             suffix_index = rstr_index(temp_file_name + file_prefix_len, rlog_param_file_suffix_gap);//文件名后缀开始位置
-
             if (suffix_index > 0 && rstr_is_digit((const char*)(temp_file_name + file_prefix_len), suffix_index)) {
-                temp_file_name[suffix_index] = rstr_end;
-                file_id = rstr_2int(temp_file_name + file_prefix_len);
+                temp_file_name[file_prefix_len + suffix_index] = rstr_end;
+                int file_id = rstr_2int(temp_file_name + file_prefix_len);
                 file_id_max = file_id_max < file_id ? file_id : file_id_max;
             }
         }
         rlist_destroy(file_list);
-    }
 
-    if (file_id_max > -1) {
-        rnum2str(fileidx_str_temp, file_id_max + 1, "%d");
-    }
-    else {
-        fileidx_str_temp = rlog_param_file_index_default;
+        if (file_id_max > -1) {
+            char index_str[16];
+            snprintf(index_str, sizeof(index_str), "%d", file_id_max + 1);
+            _rlog_path_build(path, filepath, sizeof(filepath), date_str, time_str, log_level_str, index_str, &index_pos);
+        }
     }
-    
-    ret_str = rstr_repl(filepath_str_temp, rlog_param_file_index, fileidx_str_temp);
-    rstr_free(filepath_str_temp);
 
     rstr_free(path_name);
-    rstr_free(file_name);
-    rstr_free(file_prefix);
-    
-    return ret_str;
+
+    return rstr_cpy(filepath, 0);
 }
 
 static int _rlog_build_items(rlog_t* rlog, bool is_init, const rlog_level_t level, bool file_separated) {
@@ -206,25 +591,33 @@ static int _rlog_build_items(rlog_t* rlog, bool is_init, const rlog_level_t leve
         }
         rassert(log_item != NULL, "");
 
-        log_item->filename = _rlog_get_filepath(rlog->filepath_template, log_level_str, false);//初始都不带递增后缀
+        if (log_item->filename != NULL) {//滚动时重建
+            rstr_free(log_item->filename);
+        }
+        log_item->filename = _rlog_get_filepath(rlog->filepath, log_level_str, false);//初始都不带递增后缀
         rfile_format_path(log_item->filename);
 
         rinfo("build log item, filename = '%s'", log_item->filename);
 
         if (rstr_eq(last_filepath, rstr_empty) || !rstr_eq(last_filepath, log_item->filename)) {
             if (rfile_exists(log_item->filename)) {
-                roll_filepath = _rlog_get_filepath(rlog->filepath_template, log_level_str, true);
+                roll_filepath = _rlog_get_filepath(rlog->filepath, log_level_str, true);
                 rfile_rename(log_item->filename, roll_filepath);
                 rstr_free(roll_filepath);
             }
 
             last_filepath = log_item->filename;
-            log_item->file_ptr = fopen(log_item->filename, "w+");//,ccs=UTF-8
+            if (rlog->mmap_file) {
+                log_item->map_file = rmapfile_open(log_item->filename, rlog_mmap_window_size);
+            } else {
+                log_item->file_ptr = fopen(log_item->filename, "w+");//,ccs=UTF-8
+            }
         } else {
             log_item->file_ptr = rlog->log_items[cur_level - 1]->file_ptr;
+            log_item->map_file = rlog->log_items[cur_level - 1]->map_file;
         }
 
-        if (log_item->file_ptr == NULL) {
+        if (log_item->file_ptr == NULL && log_item->map_file == NULL) {
             rinfo("Cannot open file [%s], check file is opening or not!", log_item->filename);
             code_ret = 1;
             rgoto(1);
@@ -266,6 +659,7 @@ int rlog_init(const char* log_default_filename, const rlog_level_t log_default_l
     rlog_all = (rlog_t**)rdata_new_array(sizeof(rlog_t*), 2);
     rlog_all[0] = rlog;
     rlog_all[1] = NULL;
+    ratomic_fetch_add(&rlog_filter_version, 1);
 
     rmutex_unlock(&rlog_mutex);
     
@@ -317,6 +711,7 @@ int rlog_init_log(rlog_t* rlog, const char* filename, const rlog_level_t level,
     rlog->mutex = rdata_new(rmutex_t);
     rmutex_init(rlog->mutex);
     rlog->level = level == rlog_level_all ? rlog_level_verb : level;
+    ratomic_fetch_add(&rlog_filter_version, 1);
     rlog->file_separated = file_separated;
     rlog->file_size_max = file_size < rlog_rollback_size ? rlog_rollback_size * 1024000 : file_size * 1024000;
 
@@ -332,6 +727,12 @@ int rlog_init_log(rlog_t* rlog, const char* filename, const rlog_level_t level,
 	}
 
     rlog->filepath_template = _rlog_format_filepath_template(filename);
+    rlog->filepath = _rlog_path_compile(rlog->filepath_template);
+    if (rlog->filepath == NULL) {
+        rinfo("rlog_init filename has too many params.");
+        code_ret = 1;
+        rgoto(1);
+    }
 
     code_ret = _rlog_build_items(rlog, true, rlog_level_all, file_separated);
 
@@ -356,6 +757,16 @@ exit1:
 }
 
 int rlog_reset(rlog_t* rlog, const rlog_level_t level, int file_size) {
+    rlog = rlog != NULL ? rlog : (rlog_all != NULL ? rlog_all[0] : NULL);
+    if (rlog == NULL) {
+        return rcode_invalid;
+    }
+
+    rlog->level = level == rlog_level_all ? rlog_level_verb : level;
+    if (file_size > 0) {
+        rlog->file_size_max = file_size < rlog_rollback_size ? rlog_rollback_size * 1024000 : file_size * 1024000;
+    }
+    ratomic_fetch_add(&rlog_filter_version, 1);
 
     return rcode_ok;
 }
@@ -363,41 +774,47 @@ int rlog_reset(rlog_t* rlog, const rlog_level_t level, int file_size) {
 int rlog_uninit_log(rlog_t* rlog) {
 	rinfo("uninit rlog (%p - %s).", rlog, rlog->filepath_template);
 
+    if (rlog->async != NULL) {
+        rlog_stop_async(rlog);
+    }
+
 	rmutex_lock(&rlog_mutex);
 
 	rlog->state = rlog_state_uninit;
+    ratomic_fetch_add(&rlog_filter_version, 1);
 
-    FILE* last_file = NULL;//只支持两种，全散和单独一个文件
+    void* last_file = NULL;//只支持两种，全散和单独一个文件
 
 	for (int cur_level = rlog_level_verb; cur_level < rlog_level_all; ++cur_level) {
         if (rlog->log_items[cur_level] != NULL) {
-            if (rlog->log_items[cur_level]->file_ptr) {
-                if (rlog->log_items[cur_level]->file_ptr != NULL && last_file != rlog->log_items[cur_level]->file_ptr) {
-                    last_file = rlog->log_items[cur_level]->file_ptr;
-                    fflush(rlog->log_items[cur_level]->file_ptr);
-                    fclose(rlog->log_items[cur_level]->file_ptr);
+            void* cur_file = rlog_file_of(rlog->log_items[cur_level]);
+            if (cur_file != NULL) {
+                if (last_file != cur_file) {
+                    last_file = cur_file;
+                    _rlog_file_close(rlog->log_items[cur_level]);
                 }
                 rlog->log_items[cur_level]->file_ptr = NULL;
+                rlog->log_items[cur_level]->map_file = NULL;
             }
 
             if (rlog->log_items[cur_level]->filename) {
                 //rinfo("rlog_uninit free filename, p = %p, filename = %s", rlog->log_items[cur_level]->filename, rlog->log_items[cur_level]->filename);
-                rayfree(rlog->log_items[cur_level]->filename);
+                rstr_free(rlog->log_items[cur_level]->filename);
                 rlog->log_items[cur_level]->filename = NULL;
             }
 
             if (rlog->log_items[cur_level]->item_buffer) {
-                rayfree(rlog->log_items[cur_level]->item_buffer);
+                rdata_free(char, rlog->log_items[cur_level]->item_buffer);
                 rlog->log_items[cur_level]->item_buffer = NULL;
             }
 
             if (rlog->log_items[cur_level]->buffer) {
-                rayfree(rlog->log_items[cur_level]->buffer);
+                rdata_free(char, rlog->log_items[cur_level]->buffer);
                 rlog->log_items[cur_level]->buffer = NULL;
             }
 
             if (rlog->log_items[cur_level]->item_fmt) {
-                rayfree(rlog->log_items[cur_level]->item_fmt);
+                rdata_free(char, rlog->log_items[cur_level]->item_fmt);
                 rlog->log_items[cur_level]->item_fmt = NULL;
             }
 
@@ -409,6 +826,9 @@ int rlog_uninit_log(rlog_t* rlog) {
 		}
 	}
 
+    if (rlog->filepath != NULL) {
+        rdata_free(rlog_path_t, rlog->filepath);
+    }
     rstr_free(rlog->filepath_template);
 
     rmutex_uninit(rlog->mutex);
@@ -421,35 +841,30 @@ int rlog_uninit_log(rlog_t* rlog) {
     return rcode_ok;
 }
 
-int rlog_flush_file(rlog_t* rlog, const rlog_level_t level, bool close_file) {
+//调用前持有rlog->mutex，返回关闭文件的错误
+static int _rlog_flush_items(rlog_t* rlog, const rlog_level_t level, bool close_file) {
     rlog_info_t* rlog_info = NULL;
-
-    rmutex_lock(rlog->mutex);
-
-    if (rlog->state != rlog_state_working && rlog->state != rlog_state_roll_file) {
-        rinfo("flush failed, invalid state = %d.", rlog->state);
-        return rcode_invalid;
-    }
-
-    rinfo("log file flush.");
-
-    FILE* last_file = NULL;
+    void* last_file = NULL;
+    int code_ret = rcode_ok;
+    int code_close = rcode_ok;
 
     if (level == rlog_level_all || !rlog->file_separated) {
     	for (int cur_level = rlog_level_verb; cur_level < rlog_level_all; ++cur_level) {
             rlog_info = rlog->log_items[cur_level];
-    		if (rlog_info != NULL && rlog_info->file_ptr != NULL) {
-                if (rlog_info->file_ptr != last_file) {
-                    fflush(rlog_info->file_ptr);
+    		if (rlog_info != NULL && rlog_file_of(rlog_info) != NULL) {
+                if (rlog_file_of(rlog_info) != last_file) {
                     if (close_file) {
-                        fclose(rlog_info->file_ptr);
-                        last_file = rlog_info->file_ptr;
-                        rlog_info->file_ptr = NULL;
+                        last_file = rlog_file_of(rlog_info);
+                        code_close = _rlog_file_close(rlog_info);
+                        code_ret = code_ret != rcode_ok ? code_ret : code_close;
                         rlog_info->file_size = 0;
+                    } else {
+                        _rlog_file_flush(rlog_info);
                     }
                 } else {
                     if (close_file) {
                         rlog_info->file_ptr = NULL;
+                        rlog_info->map_file = NULL;
                         rlog_info->file_size = 0;
                     }
                 }
@@ -457,53 +872,68 @@ int rlog_flush_file(rlog_t* rlog, const rlog_level_t level, bool close_file) {
     	}
     } else {
         rlog_info = rlog->log_items[level];
-        if (rlog_info != NULL && rlog_info->file_ptr != NULL) {
-            fflush(rlog_info->file_ptr);
+        if (rlog_info != NULL && rlog_file_of(rlog_info) != NULL) {
             if (close_file) {
-                fclose(rlog_info->file_ptr);
-                rlog_info->file_ptr = NULL;
+                code_ret = _rlog_file_close(rlog_info);
                 rlog_info->file_size = 0;
+            } else {
+                _rlog_file_flush(rlog_info);
             }
         }
     }
+    return code_ret;
+}
+
+int rlog_flush_file(rlog_t* rlog, const rlog_level_t level, bool close_file) {
+    rinfo("log file flush.");//持有锁时打日志会重入
+
+    rmutex_lock(rlog->mutex);
+
+    if (rlog->state != rlog_state_working && rlog->state != rlog_state_roll_file) {
+        rmutex_unlock(rlog->mutex);
+        rinfo("flush failed, invalid state = %d.", rlog->state);
+        return rcode_invalid;
+    }
+
+    int code_ret = _rlog_flush_items(rlog, level, close_file);
 
     rmutex_unlock(rlog->mutex);
 
-    return rcode_ok;
+    if (code_ret != rcode_ok) {
+        rerror("close log file failed, code = %d.", code_ret);
+    }
+    return code_ret;
 }
 
-int rlog_rolling_file(rlog_t* rlog, const rlog_level_t level) {
+//调用前持有rlog->mutex
+static int _rlog_rolling(rlog_t* rlog, const rlog_level_t level) {
     int code_ret = 0;
 
-	rmutex_lock(rlog->mutex);
-
     if (rlog->state != rlog_state_working) {
         rinfo("rolling rlog failed, state = %d", rlog->state);
-        goto exit1;
+        return 1;
     }
 
     rlog->state = rlog_state_roll_file;
 
-    // rlog_info_t* rlog_info = rlog->log_items[level];
-	code_ret = rlog_flush_file(rlog, level, true);//已经关闭了filepath对应的文件
-
-    if (code_ret != rcode_ok) {
-        rgoto(1);
-    }
+    int code_close = _rlog_flush_items(rlog, level, true);//已经关闭了filepath对应的文件
 
     code_ret = _rlog_build_items(rlog, false, level, rlog->file_separated);
 
-    if (code_ret != rcode_ok) {
-        rgoto(1);
-    }
-    
-	rinfo("rolling rlog finished.");
+    rlog->state = rlog_state_working;//恢复后不能在锁内打日志
 
-exit1:
-    rlog->state = rlog_state_working;
+    return code_ret != rcode_ok ? code_ret : code_close;//关闭旧文件失败也返回，调用方解锁后打日志
+}
+
+int rlog_rolling_file(rlog_t* rlog, const rlog_level_t level) {
+	rmutex_lock(rlog->mutex);
+
+    int code_ret = _rlog_rolling(rlog, level);
 
 	rmutex_unlock(rlog->mutex);
 
+    rinfo("rolling rlog finished, code = %d.", code_ret);
+
 	return code_ret;
 }
 
@@ -564,8 +994,12 @@ int rlog_printf_cached(rlog_t* rlog, rlog_level_t level, const char* fmt, ...) {
 		item_buffer[rlog_temp_data_size - 4] = '.';
 		item_buffer[rlog_temp_data_size - 5] = '.';
 #ifdef print2file
-		fprintf(rlog->log_items[level]->file_ptr, "%s%s\nlog item data exceed of max len(%d - %d).\n", buffer, item_buffer, rlog_temp_data_size, writeLen);
-		fflush(rlog->log_items[level]->file_ptr);
+		char exceed_str[64];
+		snprintf(exceed_str, sizeof(exceed_str), "\nlog item data exceed of max len(%d - %d).\n", rlog_temp_data_size, writeLen);
+		_rlog_file_puts(rlog->log_items[level], buffer);
+		_rlog_file_puts(rlog->log_items[level], item_buffer);
+		_rlog_file_puts(rlog->log_items[level], exceed_str);
+		_rlog_file_flush(rlog->log_items[level]);
 #else
 		printf("%s%s\nlog item data exceed of max len(%d - %d).\n", buffer, item_buffer, rlog_temp_data_size, writeLen);
 #endif // print2file
@@ -582,8 +1016,9 @@ int rlog_printf_cached(rlog_t* rlog, rlog_level_t level, const char* fmt, ...) {
     //printf("%%"PRId64" ms, len(%d - %d - %d) [%s]\n", (timeNow - rlogFlushLast), (int)strlen(buffer), (int)freeLen, (int)strlen(item_buffer), item_buffer);
     if (rlog_force_flush || ((timeNow - rlogFlushLast) > rlog_flush_max) || strlen(item_buffer) >= freeLen) {
 #ifdef print2file
-        fprintf(rlog->log_items[level]->file_ptr, "%s%s", buffer, item_buffer);
-        fflush(rlog->log_items[level]->file_ptr);
+        _rlog_file_puts(rlog->log_items[level], buffer);
+        _rlog_file_puts(rlog->log_items[level], item_buffer);
+        _rlog_file_flush(rlog->log_items[level]);
 #else
         printf("%s%s", buffer, item_buffer);
 #endif // print2file
@@ -601,57 +1036,40 @@ int rlog_printf_cached(rlog_t* rlog, rlog_level_t level, const char* fmt, ...) {
     return rcode_ok;
 }
 
-int rlog_printf(rlog_t* rlog, rlog_level_t level, const char* fmt, ...) {
-    rlog = rlog != NULL ? rlog : (rlog_all != NULL ? rlog_all[0] : NULL);
-
-    if (unlikely(rlog == NULL || (rlog->state != rlog_state_working))) {
-        char* buffer_temp = (char*)malloc(rlog_temp_data_size);
-        va_list print_params;
-        va_start(print_params, fmt);
-        int len_temp = vsnprintf(buffer_temp, rlog_temp_data_size - 1, fmt, print_params);
-        rassert(len_temp < rlog_temp_data_size, "");
-        va_end(print_params);
-        printf("(rlog not ready) - %s", buffer_temp);
-        free(buffer_temp);
-        return 1;
-    }
-    if (level < rlog->level) {
-        return rcode_ok;
+//site不为NULL时加上调用点的前缀；异步二进制模式下只记录参数，遇到不支持的格式时退回文本
+static int _rlog_vprintf(rlog_t* rlog, rlog_level_t level, rlog_info_t* rlog_info, rlog_site_t* site, const char* fmt, va_list ap) {
+    rlog_async_t* ctx = rlog->async;
+    if (ctx != NULL && ctx->binary && site != NULL && site->id > 0) {
+        va_list ap_binary;
+        va_copy(ap_binary, ap);
+        int ret_binary = _rlog_binary_vprintf(ctx, site, ap_binary);
+        va_end(ap_binary);
+        if (ret_binary != rlog_binary_fallback) {
+            return ret_binary;
+        }
     }
 
-    rlog_info_t* rlog_info = rlog->log_items[level];
-    if (unlikely(rlog_info == NULL)) {
-        char* buffer_temp1 = (char*)malloc(rlog_temp_data_size);
-        va_list print_params1;
-        va_start(print_params1, fmt);
-        int len_temp1 = vsnprintf(buffer_temp1, rlog_temp_data_size - 1, fmt, print_params1);
-        rassert(len_temp1 < rlog_temp_data_size, "");
-        va_end(print_params1);
-        printf("(rlog item not ready, error!!!) - %s", buffer_temp1);
-        free(buffer_temp1);
-        return -1;
+    char* item_buffer = rlog_buffer_local + rlog_head_reserve;//前面留给行头，异步模式下一次拷贝进队列
+    int write_len = 0;
+    if (site != NULL) {
+        write_len = _rlog_site_vformat(item_buffer, rlog_temp_data_size - 1, site, ap);
+    } else {
+        write_len = vsnprintf(item_buffer, rlog_temp_data_size - 1, fmt, ap);
     }
+    rassert(write_len < rlog_temp_data_size, "overflow of buffer");
 
-    char* item_buffer = rlog_info->item_buffer;
-    //char* buffer = rlog_info->buffer;
-    //char* item_fmt = rlog_info->item_fmt;
-    char item_fmt[64] = { 0 };
-    char* log_level_str = rlog_level_2str(level);
-    char time_str[32];
-    int64_t time_now = rtime_millisec();
-    rformat_time_s_full(time_str, time_now, 0);
-    strcat(item_fmt, time_str);
-    strcat(item_fmt, " [");
-    strcat(item_fmt, log_level_str);//strupr(log_level_str)
-    strcat(item_fmt, "] %s");
+    if (ctx != NULL) {
+        return _rlog_async_text(ctx, level, item_buffer, write_len);
+    }
 
-    va_list ap;
-    va_start(ap, fmt);
-    int write_len = vsnprintf(item_buffer, rlog_temp_data_size - 1, fmt, ap);
-    va_end(ap);
-    rassert(write_len < rlog_temp_data_size, "overflow of buffer");
+    char head[rlog_head_reserve];//和异步模式一样把行头补在前面，整行一次写入
+    int head_len = _rlog_async_head(head, level);
+    char* line = item_buffer - head_len;
+    memcpy(line, head, head_len);
+    write_len += head_len;
 
 #ifdef print2file
+    int code_roll = rcode_ok;
 
 #ifdef log_in_multi_thread
     if (unlikely(rlog->file_separated)) {
@@ -661,11 +1079,15 @@ int rlog_printf(rlog_t* rlog, rlog_level_t level, const char* fmt, ...) {
     }
 #endif // log_in_multi_thread
 
-    fprintf(rlog_info->file_ptr, item_fmt, item_buffer);//暂时直接文件，优化其他ipc，管道/共享内存/socket
+    _rlog_file_write(rlog_info, line, write_len);//mmap模式下只是内存拷贝
 
     rlog_info->file_size += write_len;
     if (unlikely((rlog_info->file_size > rlog->file_size_max) && (rlog->state == rlog_state_working))) {
-        rlog_rolling_file(rlog, level);
+        if (rlog->file_separated) {
+            rlog_rolling_file(rlog, level);
+        } else {
+            code_roll = _rlog_rolling(rlog, level);//已持有rlog->mutex
+        }
     }
 
 #ifdef log_in_multi_thread
@@ -676,6 +1098,10 @@ int rlog_printf(rlog_t* rlog, rlog_level_t level, const char* fmt, ...) {
     }
 #endif // log_in_multi_thread
 
+    if (unlikely(code_roll != rcode_ok)) {
+        rerror("rolling rlog failed, code = %d.", code_roll);
+    }
+
 #endif // print2file
 
 #ifdef print2stdout
@@ -690,9 +1116,9 @@ int rlog_printf(rlog_t* rlog, rlog_level_t level, const char* fmt, ...) {
         SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), FOREGROUND_INTENSITY | FOREGROUND_RED);
     }
     //WriteConsoleW(GetStdHandle(STD_OUTPUT_HANDLE), item_buffer, (DWORD)convert_str), NULL, NULL);
-    printf(item_fmt, item_buffer);
+    fwrite(line, 1, write_len, stdout);
 #else
-    printf(item_fmt, item_buffer);//todo Ray 控制台
+    fwrite(line, 1, write_len, stdout);//todo Ray 控制台
 #endif
 
     rmutex_unlock(rlog->mutex);
@@ -703,6 +1129,1000 @@ int rlog_printf(rlog_t* rlog, rlog_level_t level, const char* fmt, ...) {
     return rcode_ok;
 }
 
+int rlog_printf(rlog_t* rlog, rlog_level_t level, const char* fmt, ...) {
+    rlog = rlog != NULL ? rlog : (rlog_all != NULL ? rlog_all[0] : NULL);
+
+    if (unlikely(rlog == NULL || !_rlog_accepting(rlog))) {
+        char* buffer_temp = (char*)malloc(rlog_temp_data_size);
+        va_list print_params;
+        va_start(print_params, fmt);
+        int len_temp = vsnprintf(buffer_temp, rlog_temp_data_size - 1, fmt, print_params);
+        rassert(len_temp < rlog_temp_data_size, "");
+        va_end(print_params);
+        printf("(rlog not ready) - %s", buffer_temp);
+        free(buffer_temp);
+        return 1;
+    }
+    if (level < rlog->level) {
+        return rcode_ok;
+    }
+
+    rlog_info_t* rlog_info = rlog->log_items[level];
+    if (unlikely(rlog_info == NULL)) {
+        char* buffer_temp1 = (char*)malloc(rlog_temp_data_size);
+        va_list print_params1;
+        va_start(print_params1, fmt);
+        int len_temp1 = vsnprintf(buffer_temp1, rlog_temp_data_size - 1, fmt, print_params1);
+        rassert(len_temp1 < rlog_temp_data_size, "");
+        va_end(print_params1);
+        printf("(rlog item not ready, error!!!) - %s", buffer_temp1);
+        free(buffer_temp1);
+        return -1;
+    }
+
+    va_list ap;
+    va_start(ap, fmt);
+    int ret_code = _rlog_vprintf(rlog, level, rlog_info, NULL, fmt, ap);
+    va_end(ap);
+
+    return ret_code;
+}
+
+int rlog_printf_site(rlog_t* rlog, rlog_site_t* site, ...) {
+    rlog = rlog != NULL ? rlog : (rlog_all != NULL ? rlog_all[0] : NULL);
+
+    if (unlikely(ratomic_load(&site->id) == 0)) {
+        _rlog_site_register(site);
+    }
+
+    if (unlikely(rlog == NULL || !_rlog_accepting(rlog) || rlog->log_items[site->level] == NULL)) {
+        char* buffer_temp = (char*)malloc(rlog_temp_data_size);
+        va_list print_params;
+        va_start(print_params, site);
+        int len_temp = _rlog_site_vformat(buffer_temp, rlog_temp_data_size - 1, site, print_params);
+        rassert(len_temp < rlog_temp_data_size, "");
+        va_end(print_params);
+        printf("(rlog not ready) - %s", buffer_temp);
+        free(buffer_temp);
+        return 1;
+    }
+    if (!rlog_site_enabled(rlog, site)) {
+        return rcode_ok;
+    }
+
+    va_list ap;
+    va_start(ap, site);
+    int ret_code = _rlog_vprintf(rlog, site->level, rlog->log_items[site->level], site, site->fmt, ap);
+    va_end(ap);
+
+    return ret_code;
+}
+
+/* ------------------------------- async ------------------------------------*/
+
+#define rlog_async_record_align(len) (((int64_t)sizeof(rlog_async_record_t) + (len) + 7) & ~(int64_t)7)
+
+static rlog_async_queue_t* _rlog_async_queue(rlog_async_t* ctx) {
+    if (likely(rlog_async_epoch_local == ctx->epoch)) {
+        return rlog_async_queue_local;
+    }
+
+    rlog_async_queue_t* queue = rdata_new(rlog_async_queue_t);
+    if (queue == NULL) {
+        return NULL;
+    }
+    memset(queue, 0, sizeof(rlog_async_queue_t));
+    queue->data = rdata_new_size(rlog_async_queue_size);
+    if (queue->data == NULL) {
+        rdata_free(rlog_async_queue_t, queue);
+        return NULL;
+    }
+    queue->thread_id = rthread_cur_id();
+
+    rmutex_lock(&ctx->mutex);
+    queue->next = ctx->queues;
+    (void)ratomic_xchg_ptr(&ctx->queues, queue);//写线程无锁遍历
+    rmutex_unlock(&ctx->mutex);
+
+    rlog_async_queue_local = queue;
+    rlog_async_epoch_local = ctx->epoch;
+    return queue;
+}
+
+static int _rlog_async_push(rlog_async_t* ctx, rlog_async_queue_t* queue, rlog_level_t level, const char* data, int len) {
+    int64_t need = rlog_async_record_align(len);
+    int64_t write_index = queue->write_index;
+    bool blocked = false;
+
+    while (rlog_async_queue_size - (write_index - ratomic_load(&queue->read_index)) < need) {
+        if (ctx->overflow != rlog_overflow_block || ratomic_load(&ctx->running) == 0) {
+            ratomic_fetch_add(&queue->dropped, 1);
+            return 1;
+        }
+        if (!blocked) {
+            blocked = true;
+            ratomic_fetch_add(&ctx->blocked, 1);
+        }
+        rtools_wait_mills(rlog_async_idle_ms);
+    }
+
+    int64_t pos = write_index & (rlog_async_queue_size - 1);
+    rlog_async_record_t* record = (rlog_async_record_t*)(queue->data + pos);//8字节对齐，头部不会跨越队尾
+    record->len = (uint32_t)len;
+    record->level = (uint32_t)level;
+
+    pos = (pos + sizeof(rlog_async_record_t)) & (rlog_async_queue_size - 1);
+    int64_t first = rlog_async_queue_size - pos;
+    if (first >= len) {
+        memcpy(queue->data + pos, data, len);
+    } else {
+        memcpy(queue->data + pos, data, first);
+        memcpy(queue->data, data + first, len - first);
+    }
+
+    ratomic_store(&queue->write_index, write_index + need);
+    return rcode_ok;
+}
+
+//"yyyy-mm-dd hh:MM:ss mmm [LEVEL] "，日期部分每线程缓存，同一秒内只改毫秒
+int rlog_format_head(char* buffer, int64_t time, rlog_level_t level) {
+    int64_t second = time / 1000;
+    if (unlikely(second != rlog_head_second_local)) {
+        int time_datas[7];
+        rtime_from_time_millis_security(time, time_datas);
+        rlog_head_date_len_local = snprintf(rlog_head_date_local, sizeof(rlog_head_date_local), "%.4d-%.2d-%.2d %.2d:%.2d:%.2d ",
+            time_datas[0], time_datas[1], time_datas[2], time_datas[3], time_datas[4], time_datas[5]);
+        rlog_head_second_local = second;
+    }
+
+    int len = rlog_head_date_len_local;
+    int mills = (int)(time % 1000);
+    const char* level_str = rlog_level_2str(level);
+    int level_len = (int)strlen(level_str);
+
+    memcpy(buffer, rlog_head_date_local, len);
+    buffer[len++] = (char)('0' + mills / 100);
+    buffer[len++] = (char)('0' + mills / 10 % 10);
+    buffer[len++] = (char)('0' + mills % 10);
+    buffer[len++] = ' ';
+    buffer[len++] = '[';
+    memcpy(buffer + len, level_str, level_len);
+    len += level_len;
+    buffer[len++] = ']';
+    buffer[len++] = ' ';
+    buffer[len] = '\0';
+    return len;
+}
+
+static int _rlog_async_head(char* buffer, rlog_level_t level) {
+    return rlog_format_head(buffer, rtime_millisec_coarse(), level);
+}
+
+static void _rlog_binary_head(char* buffer, rlog_binary_type_t type, rlog_level_t level, int32_t site_id, int len) {
+    rlog_binary_head_t head;
+    head.len = (uint32_t)len;
+    head.type = (uint8_t)type;
+    head.level = (uint8_t)level;
+    head.reserved = 0;
+    head.site_id = site_id;
+    head.thread_id = (int32_t)_rlog_thread_id();
+    head.time = rtime_millisec_coarse();
+    memcpy(buffer, &head, sizeof(rlog_binary_head_t));
+}
+
+//text前面有rlog_head_reserve字节的空间，补上行头后一次拷贝进队列
+static int _rlog_async_text(rlog_async_t* ctx, rlog_level_t level, char* text, int len) {
+    rlog_async_queue_t* queue = _rlog_async_queue(ctx);
+    if (unlikely(queue == NULL)) {
+        return -1;
+    }
+
+    if (ctx->binary) {
+        char* record = text - sizeof(rlog_binary_head_t);
+        _rlog_binary_head(record, rlog_binary_text, level, 0, (int)sizeof(rlog_binary_head_t) + len);
+        return _rlog_async_push(ctx, queue, level, record, (int)sizeof(rlog_binary_head_t) + len);
+    }
+
+    char head[rlog_head_reserve];
+    int head_len = _rlog_async_head(head, level);
+    memcpy(text - head_len, head, head_len);
+    return _rlog_async_push(ctx, queue, level, text - head_len, head_len + len);
+}
+
+static void _rlog_async_write(rlog_t* rlog, rlog_async_t* ctx) {
+    if (ctx->batch_len == 0) {
+        return;
+    }
+
+    rlog_info_t* rlog_info = rlog->log_items[ctx->batch_level];
+
+    rmutex_lock(rlog->mutex);//和flush/rolling互斥
+
+    if (rlog_file_of(rlog_info) != NULL) {
+        if (ctx->binary) {
+            rlog_info->file_size += _rlog_binary_prepare(ctx, rlog_info);
+        }
+        _rlog_file_write(rlog_info, ctx->batch, ctx->batch_len);
+    }
+#ifdef print2stdout
+    if (!ctx->binary) {
+        fwrite(ctx->batch, 1, ctx->batch_len, stdout);
+    }
+#endif // print2stdout
+
+    int code_roll = rcode_ok;
+    rlog_info->file_size += ctx->batch_len;
+    if (unlikely(rlog_info->file_size > rlog->file_size_max)) {
+        code_roll = _rlog_rolling(rlog, ctx->batch_level);
+    }
+
+    rmutex_unlock(rlog->mutex);
+
+    if (unlikely(code_roll != rcode_ok)) {
+        rerror("rolling rlog failed, code = %d.", code_roll);//写线程自己的队列，下一轮写出
+    }
+
+    ratomic_store(&ctx->stats.writes, ctx->stats.writes + 1);//只有写线程修改
+    ctx->batch_len = 0;
+}
+
+//batch放不下或者换了文件时先写出，返回写入位置
+static char* _rlog_async_reserve(rlog_t* rlog, rlog_async_t* ctx, rlog_level_t level, int len) {
+    if (ctx->batch_len > 0 && (ctx->batch_len + len > rlog_async_batch_size ||
+        rlog_file_of(rlog->log_items[level]) != rlog_file_of(rlog->log_items[ctx->batch_level]))) {
+        _rlog_async_write(rlog, ctx);
+    }
+    char* dest = ctx->batch + ctx->batch_len;
+    ctx->batch_len += len;
+    ctx->batch_level = level;
+    return dest;
+}
+
+//写线程，返回本次取出的条数
+static int64_t _rlog_async_drain(rlog_t* rlog, rlog_async_t* ctx) {
+    int64_t count = 0;
+    int64_t bytes = 0;
+    rlog_async_queue_t* queue = (rlog_async_queue_t*)ratomic_load_ptr(&ctx->queues);
+
+    for (; queue != NULL; queue = queue->next) {
+        int64_t read_index = queue->read_index;
+        int64_t write_index = ratomic_load(&queue->write_index);
+
+        while (read_index < write_index) {
+            int64_t pos = read_index & (rlog_async_queue_size - 1);
+            rlog_async_record_t* record = (rlog_async_record_t*)(queue->data + pos);
+            int len = (int)record->len;
+            rlog_level_t level = (rlog_level_t)record->level;
+
+            char* dest = _rlog_async_reserve(rlog, ctx, level, len);
+            pos = (pos + sizeof(rlog_async_record_t)) & (rlog_async_queue_size - 1);
+            int64_t first = rlog_async_queue_size - pos;
+            if (first >= len) {
+                memcpy(dest, queue->data + pos, len);
+            } else {
+                memcpy(dest, queue->data + pos, first);
+                memcpy(dest + first, queue->data, len - first);
+            }
+
+            read_index += rlog_async_record_align(len);
+            bytes += len;
+            count++;
+        }
+        ratomic_store(&queue->read_index, read_index);
+
+        int64_t dropped = ratomic_load(&queue->dropped);
+        if (ctx->overflow == rlog_overflow_drop && dropped > queue->dropped_reported) {
+            char line[160];
+            int len = ctx->binary ? (int)sizeof(rlog_binary_head_t) : _rlog_async_head(line, rlog_level_warn);
+            len += snprintf(line + len, sizeof(line) - len, "[%ld] rlog queue full, dropped %"PRId64" records.\n",
+                queue->thread_id, dropped - queue->dropped_reported);
+            if (ctx->binary) {
+                _rlog_binary_head(line, rlog_binary_text, rlog_level_warn, 0, len);
+            }
+            memcpy(_rlog_async_reserve(rlog, ctx, rlog_level_warn, len), line, len);
+            queue->dropped_reported = dropped;
+        }
+    }
+
+    _rlog_async_write(rlog, ctx);
+    if (count > 0) {
+        ratomic_store(&ctx->stats.records, ctx->stats.records + count);
+        ratomic_store(&ctx->stats.bytes, ctx->stats.bytes + bytes);
+    }
+    return count;
+}
+
+static void* _rlog_async_run(void* arg) {
+    rlog_t* rlog = (rlog_t*)arg;
+    rlog_async_t* ctx = rlog->async;
+
+    while (true) {
+        int64_t running = ratomic_load(&ctx->running);
+        int64_t count = _rlog_async_drain(rlog, ctx);
+
+        int64_t time_now = rtime_millisec();
+        if (time_now - ctx->flush_last >= rlog_async_flush_ms) {
+            rmutex_lock(rlog->mutex);
+            _rlog_flush_items(rlog, rlog_level_all, false);
+            rmutex_unlock(rlog->mutex);
+            ctx->flush_last = time_now;
+        }
+
+        if (count == 0) {
+            if (running == 0) {
+                break;//停止后再取一轮为空才退出
+            }
+            rtools_wait_mills(rlog_async_idle_ms);
+        }
+    }
+
+    rmutex_lock(rlog->mutex);
+    _rlog_flush_items(rlog, rlog_level_all, false);
+    rmutex_unlock(rlog->mutex);
+
+    return NULL;
+}
+
+//二进制文件只放一种格式，启停时如果当前文件已有内容就换新文件
+static void _rlog_binary_rolling(rlog_t* rlog) {
+    rlog_info_t* rlog_info = rlog->log_items[rlog_level_verb];
+    if (rlog_info != NULL && _rlog_file_tell(rlog_info) > 0) {
+        _rlog_rolling(rlog, rlog_level_all);
+    }
+}
+
+int rlog_set_mmap(rlog_t* rlog, bool enable) {
+    rlog = rlog != NULL ? rlog : (rlog_all != NULL ? rlog_all[0] : NULL);
+
+    if (rlog == NULL || rlog->state != rlog_state_working) {
+        return rcode_invalid;
+    }
+#if !defined(__linux__)
+    if (enable) {
+        rerror("rlog mmap only supports linux (%p).", rlog);
+        return rcode_invalid;
+    }
+#endif
+    if (enable && rlog->file_separated) {
+        rerror("rlog mmap not support separated files (%p).", rlog);
+        return rcode_invalid;
+    }
+
+    rmutex_lock(rlog->mutex);
+    if (rlog->mmap_file == enable) {
+        rmutex_unlock(rlog->mutex);
+        return rcode_ok;
+    }
+    rlog->mmap_file = enable;
+    int code_ret = _rlog_rolling(rlog, rlog_level_all);//换新文件，按新的方式打开
+    rmutex_unlock(rlog->mutex);
+
+    rinfo("rlog mmap = %d (%p), code = %d.", enable, rlog, code_ret);
+    return code_ret == rcode_ok ? rcode_ok : rcode_invalid;
+}
+
+int rlog_start_async(rlog_t* rlog, rlog_overflow_t overflow, bool binary) {
+    rlog = rlog != NULL ? rlog : (rlog_all != NULL ? rlog_all[0] : NULL);
+
+    if (rlog == NULL || rlog->state != rlog_state_working || rlog->async != NULL) {
+        return rcode_invalid;
+    }
+    if (rlog_async_owner != NULL) {
+        rerror("rlog async already started by (%p).", rlog_async_owner);
+        return rcode_invalid;
+    }
+    if (binary && rlog->file_separated) {
+        rerror("rlog binary not support separated files (%p).", rlog);
+        return rcode_invalid;
+    }
+
+    rlog_async_t* ctx = rdata_new(rlog_async_t);
+    if (ctx == NULL) {
+        return rcode_invalid;
+    }
+    memset(ctx, 0, sizeof(rlog_async_t));
+    ctx->batch = rdata_new_size(rlog_async_batch_size);
+    if (ctx->batch == NULL) {
+        rdata_free(rlog_async_t, ctx);
+        return rcode_invalid;
+    }
+    ctx->epoch = ratomic_fetch_add(&rlog_async_epoch, 1) + 1;
+    ctx->overflow = overflow;
+    ctx->running = 1;
+    ctx->flush_last = rtime_millisec();
+    ctx->binary = binary;
+    if (binary) {
+        ctx->file_seq = 1;
+        ctx->site_file_seq = rdata_new_array(sizeof(int32_t), rlog_site_max);
+        if (ctx->site_file_seq == NULL) {
+            rdata_free(char, ctx->batch);
+            rdata_free(rlog_async_t, ctx);
+            return rcode_invalid;
+        }
+    }
+    rmutex_init(&ctx->mutex);
+
+    rmutex_lock(rlog->mutex);
+    _rlog_flush_items(rlog, rlog_level_all, false);//同步模式的输出先落盘
+    if (binary) {
+        _rlog_binary_rolling(rlog);
+    }
+    rlog->async = ctx;
+    rmutex_unlock(rlog->mutex);
+
+    rthread_init(&ctx->thread);
+    if (rthread_start(&ctx->thread, _rlog_async_run, rlog) != 0) {
+        rlog->async = NULL;
+        rmutex_uninit(&ctx->mutex);
+        if (ctx->site_file_seq != NULL) {
+            rdata_free_array(ctx->site_file_seq);
+        }
+        rdata_free(char, ctx->batch);
+        rdata_free(rlog_async_t, ctx);
+        rerror("start rlog async thread failed.");
+        return rcode_invalid;
+    }
+    rlog_async_owner = rlog;
+
+    rinfo("rlog async started (%p), overflow = %d, binary = %d.", rlog, overflow, binary);
+    return rcode_ok;
+}
+
+int rlog_stop_async(rlog_t* rlog) {
+    rlog = rlog != NULL ? rlog : (rlog_all != NULL ? rlog_all[0] : NULL);
+
+    if (rlog == NULL || rlog->async == NULL) {
+        return rcode_invalid;
+    }
+
+    rlog_async_t* ctx = rlog->async;
+    rlog_async_stats_t stats;
+
+    ratomic_store(&ctx->running, 0);
+    rthread_join(&ctx->thread, NULL);
+    rlog_async_stats(rlog, &stats);
+    rmutex_lock(rlog->mutex);
+    if (ctx->binary) {
+        _rlog_binary_rolling(rlog);
+    }
+    rlog->async = NULL;//之后回到同步模式
+    rmutex_unlock(rlog->mutex);
+    rlog_async_owner = NULL;
+
+    rlog_async_queue_t* queue = ctx->queues;
+    rlog_async_queue_t* queue_next = NULL;
+    while (queue != NULL) {
+        queue_next = queue->next;
+        rdata_free(char, queue->data);
+        rdata_free(rlog_async_queue_t, queue);
+        queue = queue_next;
+    }
+    rmutex_uninit(&ctx->mutex);
+    if (ctx->site_file_seq != NULL) {
+        rdata_free_array(ctx->site_file_seq);
+    }
+    rdata_free(char, ctx->batch);
+    rdata_free(rlog_async_t, ctx);
+
+    rinfo("rlog async stopped (%p), records = %"PRId64", writes = %"PRId64", dropped = %"PRId64", blocked = %"PRId64".",
+        rlog, stats.records, stats.writes, stats.dropped, stats.blocked);
+    return rcode_ok;
+}
+
+int rlog_async_stats(rlog_t* rlog, rlog_async_stats_t* stats) {
+    rlog = rlog != NULL ? rlog : (rlog_all != NULL ? rlog_all[0] : NULL);
+
+    memset(stats, 0, sizeof(rlog_async_stats_t));
+    if (rlog == NULL || rlog->async == NULL) {
+        return rcode_invalid;
+    }
+
+    rlog_async_t* ctx = rlog->async;
+    stats->records = ratomic_load(&ctx->stats.records);
+    stats->bytes = ratomic_load(&ctx->stats.bytes);
+    stats->writes = ratomic_load(&ctx->stats.writes);
+    stats->blocked = ratomic_load(&ctx->blocked);
+
+    rmutex_lock(&ctx->mutex);
+    for (rlog_async_queue_t* queue = ctx->queues; queue != NULL; queue = queue->next) {
+        stats->dropped += ratomic_load(&queue->dropped);
+        stats->queues++;
+    }
+    rmutex_unlock(&ctx->mutex);
+
+    return rcode_ok;
+}
+
+/* ------------------------------- binary ------------------------------------*/
+
+typedef enum {
+    rlog_arg_none = 0,//不支持，退回文本
+    rlog_arg_int,
+    rlog_arg_uint,
+    rlog_arg_double,
+    rlog_arg_str,
+    rlog_arg_ptr,
+} rlog_arg_type_t;
+
+/** 格式串中的一个转换说明，记录和解码共用 */
+typedef struct rlog_arg_spec_s {
+    const char* start;//'%'
+    const char* modifier;//长度修饰符
+    const char* end;//转换字符之后
+    int star_count;//宽度、精度中'*'的个数
+    bool precision_star;
+    int precision;//-1为未指定
+    char length;//0, 'H'(hh), 'h', 'l', 'q'(ll), 'L', 'j', 'z', 't'
+    char conversion;
+    rlog_arg_type_t type;
+} rlog_arg_spec_t;
+
+static bool _rlog_arg_spec_next(const char** fmt, rlog_arg_spec_t* spec) {
+    const char* p = *fmt;
+    while (*p != '\0' && (*p != '%' || p[1] == '%')) {
+        p += *p == '%' ? 2 : 1;
+    }
+    if (*p == '\0') {
+        *fmt = p;
+        return false;
+    }
+
+    memset(spec, 0, sizeof(rlog_arg_spec_t));
+    spec->start = p++;
+    spec->precision = -1;
+    while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0' || *p == '\'') {
+        p++;
+    }
+    if (*p == '*') {
+        spec->star_count++;
+        p++;
+    } else {
+        while (*p >= '0' && *p <= '9') {
+            p++;
+        }
+    }
+    if (*p == '.') {
+        p++;
+        if (*p == '*') {
+            spec->star_count++;
+            spec->precision_star = true;
+            p++;
+        } else {
+            spec->precision = 0;
+            while (*p >= '0' && *p <= '9') {
+                spec->precision = spec->precision * 10 + (*p++ - '0');
+            }
+        }
+    }
+
+    spec->modifier = p;
+    switch (*p) {
+    case 'h':
+        spec->length = p[1] == 'h' ? 'H' : 'h';
+        p += p[1] == 'h' ? 2 : 1;
+        break;
+    case 'l':
+        spec->length = p[1] == 'l' ? 'q' : 'l';
+        p += p[1] == 'l' ? 2 : 1;
+        break;
+    case 'q': case 'L': case 'j': case 'z': case 't':
+        spec->length = *p++;
+        break;
+    case 'I'://msvc的I64/I32/I
+        if (p[1] == '6' && p[2] == '4') {
+            spec->length = 'q';
+            p += 3;
+        } else if (p[1] == '3' && p[2] == '2') {
+            p += 3;
+        } else {
+            spec->length = 'z';
+            p++;
+        }
+        break;
+    default:
+        break;
+    }
+
+    spec->conversion = *p;
+    if (*p != '\0') {
+        p++;
+    }
+    spec->end = p;
+
+    switch (spec->conversion) {
+    case 'c':
+        spec->type = spec->length == 0 ? rlog_arg_int : rlog_arg_none;
+        break;
+    case 'd': case 'i':
+        spec->type = rlog_arg_int;
+        break;
+    case 'u': case 'o': case 'x': case 'X':
+        spec->type = rlog_arg_uint;
+        break;
+    case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+        spec->type = rlog_arg_double;
+        break;
+    case 's':
+        spec->type = spec->length == 0 ? rlog_arg_str : rlog_arg_none;
+        break;
+    case 'p':
+        spec->type = rlog_arg_ptr;
+        break;
+    default://%n、宽字符等
+        spec->type = rlog_arg_none;
+        break;
+    }
+
+    *fmt = p;
+    return true;
+}
+
+//按格式串取参数，整数/指针扩展成8字节，字符串为4字节长度加内容(NULL长度为UINT32_MAX)；不支持的格式或者超长返回-1
+static int _rlog_binary_args(char* buffer, int size, const char* fmt, va_list ap) {
+    rlog_arg_spec_t spec;
+    int pos = 0;
+    int64_t value = 0;
+    int64_t star_value = -1;
+    double value_double = 0;
+
+    while (_rlog_arg_spec_next(&fmt, &spec)) {
+        if (spec.type == rlog_arg_none || pos + (spec.star_count + 1) * 8 > size) {
+            return -1;
+        }
+
+        for (int i = 0; i < spec.star_count; i++) {
+            star_value = va_arg(ap, int);
+            memcpy(buffer + pos, &star_value, 8);
+            pos += 8;
+        }
+
+        switch (spec.type) {
+        case rlog_arg_int:
+            switch (spec.length) {
+            case 'l': value = va_arg(ap, long); break;
+            case 'q': case 'L': value = va_arg(ap, long long); break;
+            case 'j': value = (int64_t)va_arg(ap, intmax_t); break;
+            case 'z': value = (int64_t)va_arg(ap, size_t); break;
+            case 't': value = (int64_t)va_arg(ap, ptrdiff_t); break;
+            default: value = va_arg(ap, int); break;
+            }
+            memcpy(buffer + pos, &value, 8);
+            pos += 8;
+            break;
+        case rlog_arg_uint:
+            switch (spec.length) {
+            case 'l': value = (int64_t)va_arg(ap, unsigned long); break;
+            case 'q': case 'L': value = (int64_t)va_arg(ap, unsigned long long); break;
+            case 'j': value = (int64_t)va_arg(ap, uintmax_t); break;
+            case 'z': value = (int64_t)va_arg(ap, size_t); break;
+            case 't': value = (int64_t)va_arg(ap, ptrdiff_t); break;
+            default: value = (int64_t)va_arg(ap, unsigned int); break;
+            }
+            memcpy(buffer + pos, &value, 8);
+            pos += 8;
+            break;
+        case rlog_arg_double:
+            value_double = spec.length == 'L' ? (double)va_arg(ap, long double) : va_arg(ap, double);
+            memcpy(buffer + pos, &value_double, 8);
+            pos += 8;
+            break;
+        case rlog_arg_ptr:
+            value = (int64_t)(intptr_t)va_arg(ap, void*);
+            memcpy(buffer + pos, &value, 8);
+            pos += 8;
+            break;
+        case rlog_arg_str: {
+            const char* str = va_arg(ap, const char*);
+            uint32_t str_len = UINT32_MAX;
+            if (str != NULL) {
+                int precision = spec.precision_star ? (int)star_value : spec.precision;//负的精度视为未指定
+                str_len = (uint32_t)(precision >= 0 ? strnlen(str, precision) : strlen(str));
+                if ((int64_t)pos + 4 + str_len > size) {
+                    return -1;
+                }
+            }
+            memcpy(buffer + pos, &str_len, 4);
+            pos += 4;
+            if (str != NULL) {
+                memcpy(buffer + pos, str, str_len);
+                pos += str_len;
+            }
+            break;
+        }
+        default:
+            return -1;
+        }
+    }
+
+    return pos;
+}
+
+static int _rlog_binary_vprintf(rlog_async_t* ctx, rlog_site_t* site, va_list ap) {
+    char* buffer = rlog_binary_local;
+    int head_len = (int)sizeof(rlog_binary_head_t);
+    int args_len = _rlog_binary_args(buffer + head_len, rlog_binary_record_max - head_len, site->fmt, ap);
+    if (args_len < 0) {
+        return rlog_binary_fallback;
+    }
+
+    rlog_async_queue_t* queue = _rlog_async_queue(ctx);
+    if (unlikely(queue == NULL)) {
+        return -1;
+    }
+
+    _rlog_binary_head(buffer, rlog_binary_event, site->level, (int32_t)site->id, head_len + args_len);
+    return _rlog_async_push(ctx, queue, site->level, buffer, head_len + args_len);
+}
+
+//写线程持有rlog->mutex，新文件先写magic，batch中本文件还没有定义的调用点先写定义，返回写入字节数
+static int _rlog_binary_prepare(rlog_async_t* ctx, rlog_info_t* rlog_info) {
+    int written = 0;
+    if (_rlog_file_tell(rlog_info) == 0) {
+        _rlog_file_write(rlog_info, rlog_binary_magic, rlog_binary_magic_len);
+        written += rlog_binary_magic_len;
+        ctx->file_seq++;
+    }
+
+    rlog_binary_head_t head;
+    for (int pos = 0; pos + (int)sizeof(rlog_binary_head_t) <= ctx->batch_len; pos += head.len) {
+        memcpy(&head, ctx->batch + pos, sizeof(rlog_binary_head_t));
+        if (head.type != rlog_binary_event || ctx->site_file_seq[head.site_id] == ctx->file_seq) {
+            continue;
+        }
+        rlog_site_t* site = _rlog_site_get(head.site_id);
+        if (site == NULL) {
+            continue;
+        }
+
+        int name_len = (int)strlen(site->name) + 1;
+        int func_len = (int)strlen(site->func) + 1;
+        int fmt_len = (int)strlen(site->fmt) + 1;
+        int32_t line = site->line;
+        char head_site[sizeof(rlog_binary_head_t)];
+        int len = (int)sizeof(rlog_binary_head_t) + 4 + name_len + func_len + fmt_len;
+        _rlog_binary_head(head_site, rlog_binary_site, site->level, head.site_id, len);
+
+        _rlog_file_write(rlog_info, head_site, sizeof(rlog_binary_head_t));
+        _rlog_file_write(rlog_info, (const char*)&line, 4);
+        _rlog_file_write(rlog_info, site->name, name_len);
+        _rlog_file_write(rlog_info, site->func, func_len);
+        _rlog_file_write(rlog_info, site->fmt, fmt_len);
+        written += len;
+        ctx->site_file_seq[head.site_id] = ctx->file_seq;
+    }
+
+    return written;
+}
+
+/** 解码用的调用点定义 */
+typedef struct rlog_binary_def_s {
+    int32_t line;
+    char* data;//name\0func\0fmt\0
+    const char* func;
+    const char* fmt;
+} rlog_binary_def_t;
+
+//输出[from, to)之间的普通字符，"%%"输出'%'
+static void _rlog_binary_literal(FILE* out, const char* from, const char* to) {
+    for (const char* p = from; p < to; p++) {
+        fputc(*p, out);
+        if (*p == '%' && p + 1 < to && p[1] == '%') {
+            p++;
+        }
+    }
+}
+
+#define rlog_binary_snprintf_arg(buffer, size, fmt, stars, star_count, value) \
+    ((star_count) == 0 ? snprintf((buffer), (size), (fmt), (value)) : \
+    ((star_count) == 1 ? snprintf((buffer), (size), (fmt), (int)(stars)[0], (value)) : \
+    snprintf((buffer), (size), (fmt), (int)(stars)[0], (int)(stars)[1], (value))))
+
+//按原格式串还原消息，整数统一用ll输出，数据不足时截断
+static void _rlog_binary_message(FILE* out, const char* fmt, const char* data, int len, char* buffer, int size) {
+    rlog_arg_spec_t spec;
+    const char* literal = fmt;
+    char spec_fmt[64];
+    int pos = 0;
+
+    while (_rlog_arg_spec_next(&fmt, &spec)) {
+        _rlog_binary_literal(out, literal, spec.start);
+        literal = spec.end;
+
+        int64_t stars[2] = { 0, 0 };
+        int64_t value = 0;
+        int spec_len = (int)(spec.modifier - spec.start);
+        int need = spec.star_count * 8 + (spec.type == rlog_arg_str ? 4 : 8);
+        if (spec.type == rlog_arg_none || spec_len + 4 > (int)sizeof(spec_fmt) || pos + need > len) {
+            fputs("<?>", out);
+            break;
+        }
+        for (int i = 0; i < spec.star_count; i++) {
+            memcpy(&stars[i], data + pos, 8);
+            pos += 8;
+        }
+        memcpy(spec_fmt, spec.start, spec_len);
+
+        int write_len = 0;
+        if (spec.type == rlog_arg_str) {
+            uint32_t str_len = 0;
+            char* str = NULL;
+            memcpy(&str_len, data + pos, 4);
+            pos += 4;
+            if (str_len != UINT32_MAX) {
+                if (str_len > (uint32_t)(len - pos)) {
+                    fputs("<?>", out);
+                    break;
+                }
+                if ((int)str_len >= size / 2) {
+                    fwrite(data + pos, 1, str_len, out);//超长时忽略宽度
+                    pos += str_len;
+                    continue;
+                }
+                str = buffer + size / 2;
+                memcpy(str, data + pos, str_len);
+                str[str_len] = '\0';
+                pos += str_len;
+            }
+            spec_fmt[spec_len] = 's';
+            spec_fmt[spec_len + 1] = '\0';
+            write_len = rlog_binary_snprintf_arg(buffer, size / 2, spec_fmt, stars, spec.star_count, str);
+            write_len = write_len < size / 2 ? write_len : size / 2 - 1;
+            fwrite(buffer, 1, write_len, out);
+            continue;
+        }
+
+        memcpy(&value, data + pos, 8);
+        pos += 8;
+        switch (spec.type) {
+        case rlog_arg_int:
+            if (spec.conversion == 'c') {
+                spec_fmt[spec_len] = 'c';
+                spec_fmt[spec_len + 1] = '\0';
+                write_len = rlog_binary_snprintf_arg(buffer, size, spec_fmt, stars, spec.star_count, (int)value);
+                break;
+            }
+            switch (spec.length) {
+            case 'H': value = (signed char)value; break;
+            case 'h': value = (short)value; break;
+            case 0: value = (int)value; break;
+            case 'l': value = (long)value; break;
+            default: break;
+            }
+            spec_fmt[spec_len] = 'l';
+            spec_fmt[spec_len + 1] = 'l';
+            spec_fmt[spec_len + 2] = spec.conversion;
+            spec_fmt[spec_len + 3] = '\0';
+            write_len = rlog_binary_snprintf_arg(buffer, size, spec_fmt, stars, spec.star_count, (long long)value);
+            break;
+        case rlog_arg_uint: {
+            unsigned long long value_unsigned = (unsigned long long)value;
+            switch (spec.length) {
+            case 'H': value_unsigned = (unsigned char)value; break;
+            case 'h': value_unsigned = (unsigned short)value; break;
+            case 0: value_unsigned = (unsigned int)value; break;
+            case 'l': value_unsigned = (unsigned long)value; break;
+            default: break;
+            }
+            spec_fmt[spec_len] = 'l';
+            spec_fmt[spec_len + 1] = 'l';
+            spec_fmt[spec_len + 2] = spec.conversion;
+            spec_fmt[spec_len + 3] = '\0';
+            write_len = rlog_binary_snprintf_arg(buffer, size, spec_fmt, stars, spec.star_count, value_unsigned);
+            break;
+        }
+        case rlog_arg_double: {
+            double value_double = 0;
+            memcpy(&value_double, &value, 8);
+            spec_fmt[spec_len] = spec.conversion;
+            spec_fmt[spec_len + 1] = '\0';
+            write_len = rlog_binary_snprintf_arg(buffer, size, spec_fmt, stars, spec.star_count, value_double);
+            break;
+        }
+        case rlog_arg_ptr:
+            spec_fmt[spec_len] = 'p';
+            spec_fmt[spec_len + 1] = '\0';
+            write_len = rlog_binary_snprintf_arg(buffer, size, spec_fmt, stars, spec.star_count, (void*)(intptr_t)value);
+            break;
+        default:
+            break;
+        }
+        write_len = write_len < size ? write_len : size - 1;
+        fwrite(buffer, 1, write_len, out);
+    }
+
+    if (*fmt == '\0') {
+        _rlog_binary_literal(out, literal, fmt);
+    }
+}
+
+int rlog_binary_dump(const char* filepath, FILE* out) {
+    FILE* file_ptr = fopen(filepath, "rb");
+    if (file_ptr == NULL) {
+        return rcode_invalid;
+    }
+
+    char magic[rlog_binary_magic_len];
+    if (fread(magic, 1, rlog_binary_magic_len, file_ptr) != rlog_binary_magic_len ||
+        memcmp(magic, rlog_binary_magic, rlog_binary_magic_len) != 0) {
+        fclose(file_ptr);
+        return rcode_invalid;
+    }
+
+    int ret_code = rcode_ok;
+    int body_size = rlog_binary_record_max;
+    char* body = (char*)malloc(body_size);
+    char* buffer = (char*)malloc(rlog_binary_record_max);
+    rlog_binary_def_t* defs = (rlog_binary_def_t*)calloc(rlog_site_max, sizeof(rlog_binary_def_t));
+    char head_str[rlog_head_reserve];
+    rlog_binary_head_t head;
+
+    while (fread(&head, 1, sizeof(rlog_binary_head_t), file_ptr) == sizeof(rlog_binary_head_t)) {
+        if (head.len == 0) {
+            break;//mmap文件崩溃时没有截断，尾部为0
+        }
+        int body_len = (int)head.len - (int)sizeof(rlog_binary_head_t);
+        if (head.len < sizeof(rlog_binary_head_t) || head.len > rlog_temp_data_size * 64 || (head.type == rlog_binary_site && body_len < 5) ||
+            head.level >= rlog_level_all || head.site_id < 0 || head.site_id >= rlog_site_max) {
+            ret_code = rcode_invalid;
+            break;
+        }
+        if (body_len >= body_size) {
+            body_size = body_len + 1;
+            char* body_new = (char*)realloc(body, body_size);
+            if (body_new == NULL) {
+                ret_code = rcode_invalid;
+                break;
+            }
+            body = body_new;
+        }
+        if (body_len > 0 && fread(body, 1, body_len, file_ptr) != (size_t)body_len) {
+            ret_code = rcode_invalid;//写到一半的尾部记录
+            break;
+        }
+        body[body_len] = '\0';
+
+        int head_len = rlog_format_head(head_str, head.time, (rlog_level_t)head.level);
+        if (head.type == rlog_binary_site) {
+            rlog_binary_def_t* def = &defs[head.site_id];
+            if (def->data != NULL) {
+                free(def->data);
+            }
+            memcpy(&def->line, body, 4);
+            def->data = (char*)malloc(body_len);
+            memcpy(def->data, body + 4, body_len - 4);
+            char* data_end = def->data + body_len - 4;
+            data_end[-1] = '\0';
+            def->func = def->data + strlen(def->data) + 1;
+            def->fmt = def->func < data_end ? def->func + strlen(def->func) + 1 : data_end;
+            if (def->fmt >= data_end) {
+                def->func = def->fmt = "";
+            }
+        } else if (head.type == rlog_binary_text) {
+            fwrite(head_str, 1, head_len, out);
+            fwrite(body, 1, body_len, out);
+        } else if (head.type == rlog_binary_event) {
+            rlog_binary_def_t* def = &defs[head.site_id];
+            fwrite(head_str, 1, head_len, out);
+            if (def->data == NULL) {
+                fprintf(out, "[%d] unknown site %d.\n", head.thread_id, head.site_id);
+                continue;
+            }
+            fprintf(out, "[%d] %s:%s:%d ", head.thread_id, def->data, def->func, def->line);
+            _rlog_binary_message(out, def->fmt, body, body_len, buffer, rlog_binary_record_max);
+        }
+    }
+
+    for (int i = 0; i < rlog_site_max; i++) {
+        if (defs[i].data != NULL) {
+            free(defs[i].data);
+        }
+    }
+    free(defs);
+    free(buffer);
+    free(body);
+    fclose(file_ptr);
+    return ret_code;
+}
 
 #ifdef __GNUC__
 #pragma GCC diagnostic pop
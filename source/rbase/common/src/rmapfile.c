@@ -0,0 +1,158 @@
+/**
+ * Copyright (c) 2014 ray
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the MIT license. See LICENSE for details.
+ *
+ * @author: Ray
+ */
+
+#include "rlog.h"
+#include "rmapfile.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif //__linux__
+
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunknown-pragmas"
+#endif //__GNUC__
+
+#if defined(__linux__)
+
+//预分配到end，文件系统不支持时退回ftruncate
+static int _rmapfile_reserve(rmapfile_t* d, int64_t end) {
+    if (end <= d->capacity) {
+        return rcode_ok;
+    }
+    if (posix_fallocate(d->fd, d->capacity, end - d->capacity) != 0 && ftruncate(d->fd, end) != 0) {
+        return rcode_invalid;
+    }
+    d->capacity = end;
+    return rcode_ok;
+}
+
+//映射offset所在的窗口，offset按窗口对齐
+static int _rmapfile_map(rmapfile_t* d, int64_t offset) {
+    if (d->window != NULL) {
+        munmap(d->window, d->window_size);
+        d->window = NULL;
+    }
+
+    int64_t window_offset = offset - offset % d->window_size;
+    if (_rmapfile_reserve(d, window_offset + d->window_size) != rcode_ok) {
+        return rcode_invalid;
+    }
+
+    char* window = (char*)mmap(NULL, d->window_size, PROT_READ | PROT_WRITE, MAP_SHARED, d->fd, window_offset);
+    if (window == MAP_FAILED) {
+        return rcode_invalid;
+    }
+    d->window = window;
+    d->window_offset = window_offset;
+    return rcode_ok;
+}
+
+#endif //__linux__
+
+R_API rmapfile_t* rmapfile_open(const char* filename, int64_t window_size) {
+#if defined(__linux__)
+    int64_t page_size = (int64_t)sysconf(_SC_PAGESIZE);
+    window_size = window_size > 0 ? window_size : rmapfile_window_size_default;
+    window_size = (window_size + page_size - 1) / page_size * page_size;
+
+    int fd = open(filename, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    rmapfile_t* d = rdata_new(rmapfile_t);
+    if (d == NULL) {
+        close(fd);
+        return NULL;
+    }
+    memset(d, 0, sizeof(rmapfile_t));
+    d->fd = fd;
+    d->window_size = window_size;
+
+    if (_rmapfile_map(d, 0) != rcode_ok) {
+        close(fd);
+        rdata_free(rmapfile_t, d);
+        return NULL;
+    }
+    return d;
+#else
+    (void)filename;
+    (void)window_size;
+    return NULL;
+#endif
+}
+
+R_API int rmapfile_write(rmapfile_t* d, const char* data, int64_t len) {
+#if defined(__linux__)
+    int64_t size = d->size;
+
+    while (len > 0) {
+        int64_t pos = size - d->window_offset;
+        if (unlikely(pos >= d->window_size)) {
+            if (_rmapfile_map(d, size) != rcode_ok) {
+                return rcode_invalid;
+            }
+            pos = size - d->window_offset;
+        }
+
+        int64_t count = d->window_size - pos;
+        count = count < len ? count : len;
+        memcpy(d->window + pos, data, count);
+        data += count;
+        len -= count;
+        size += count;
+        ratomic_store(&d->size, size);//映射失败时已写入的部分仍有效
+    }
+    return rcode_ok;
+#else
+    (void)d;
+    (void)data;
+    (void)len;
+    return rcode_invalid;
+#endif
+}
+
+R_API int rmapfile_flush(rmapfile_t* d, bool sync) {
+#if defined(__linux__)
+    if (d->window == NULL) {
+        return rcode_invalid;
+    }
+    return msync(d->window, d->window_size, sync ? MS_SYNC : MS_ASYNC) == 0 ? rcode_ok : rcode_invalid;
+#else
+    (void)d;
+    (void)sync;
+    return rcode_invalid;
+#endif
+}
+
+R_API int rmapfile_close(rmapfile_t* d) {
+    int code_ret = rcode_ok;
+
+    if (d == NULL) {
+        return code_ret;
+    }
+#if defined(__linux__)
+    if (d->window != NULL) {
+        munmap(d->window, d->window_size);
+    }
+    if (ftruncate(d->fd, d->size) != 0) {
+        code_ret = rcode_invalid;
+    }
+    close(d->fd);
+#endif
+    rdata_free(rmapfile_t, d);
+    return code_ret;
+}
+
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif //__GNUC__
@@ -14,8 +14,13 @@
 #include "rfile.h"
 #include "rthread.h"
 #include "rmemory.h"
+#include "rdict_sharded.h"
 #include "rlog.h"
 
+#ifndef ros_windows
+#include <sys/mman.h>
+#endif //ros_windows
+
 #ifdef __GNUC__
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunknown-pragmas"
@@ -31,13 +36,22 @@ typedef struct rmem_info_s {
     int line;
 } rmem_info_t;
 
-extern rdict_t* rmem_trace_map;
-rdict_t* rmem_trace_map = NULL;
+extern rdict_sharded_t* rmem_trace_map;
+rdict_sharded_t* rmem_trace_map = NULL;
+
 
+#ifdef rmemory_enable_tracer
 static void mem_dict_free_value_func(void* data_ext, rmem_info_t* obj) {
     free(obj); 
 } 
 
+static void mem_dict_output_func(FILE* file_ptr, const rdict_entry_t* de) {
+    rmem_info_t* info = (rmem_info_t*)(de->value.ptr);
+    fprintf(file_ptr, "(%zu * %zu)-%p from %ld, %s:%d-%s"Li, 
+        info->count, info->elem_size, info->ptr, info->thread_id, info->filename, info->line, info->func);
+}
+#endif // rmemory_enable_tracer
+
 int rmem_init() {
     rmem_byte_order_code_t byte_order = rmem_check_host_order();
     if (byte_order == rmem_byte_order_code_big) {
@@ -52,13 +66,18 @@ int rmem_init() {
 
 #ifdef rmemory_enable_tracer
     if (rmem_trace_map == NULL) {
-        rdict_init_full(rmem_trace_map, rdata_type_uint64, rdata_type_ptr, rmemory_dict_size, 0, 
-            malloc, calloc, free, NULL, NULL, NULL, NULL, NULL, NULL);//mem_dict_free_value_func);
-        rassert(rmem_trace_map != NULL, "");
-        rmem_trace_map->free_value_func = (rdict_free_value_func_type)mem_dict_free_value_func;
+        rdict_sharded_init_full(rmem_trace_map, rdata_type_uint64, rdata_type_ptr, rdict_sharded_count_default, rmemory_dict_size,
+            malloc, calloc, free);//各线程并发分配，按分片加锁
+        for (uint32_t i = 0; i < rmem_trace_map->shard_count; i++) {
+            rmem_trace_map->shards[i].shard.dict->free_value_func = (rdict_free_value_func_type)mem_dict_free_value_func;
+        }
     }
 #endif // rmemory_enable_tracer
 
+#ifdef RAY_USE_POOL
+    rmem_class_init();
+#endif //RAY_USE_POOL
+
     return rcode_ok;
 }
 
@@ -71,8 +90,11 @@ int rmem_uninit() {
 
     rmem_statistics(rmem_out_filepath_default);
 
-    rdict_free(rmem_trace_map);
-    rmem_trace_map = NULL;
+#ifdef RAY_USE_POOL
+    rmem_class_uninit();
+#endif //RAY_USE_POOL
+
+    rdict_sharded_free(rmem_trace_map);
 
     return rcode_ok;
 }
@@ -93,7 +115,7 @@ void* rmem_malloc_trace(size_t elem_size, long thread_id, char* filename, const
     info->func = (char*)func;
     info->line = line;
 
-    rdict_add(rmem_trace_map, (void*)((int64_t)ret), info);
+    rdict_sharded_add(rmem_trace_map, (void*)((int64_t)ret), info);
 
     return ret;
 }
@@ -114,7 +136,7 @@ void* rmem_cmalloc_trace(size_t elem_size, size_t count, long thread_id, char* f
     info->func = (char*)func;
     info->line = line;
 
-    rdict_add(rmem_trace_map, (void*)((int64_t)ret), info);
+    rdict_sharded_add(rmem_trace_map, (void*)((int64_t)ret), info);
 
     return ret;
 }
@@ -124,19 +146,61 @@ int rmem_free(void* ptr, long thread_id, char* filename, const char* func, int l
     rdebug("free. %d-%p from %ld, %s:%d-%s", 0, ptr, thread_id, filename, line, func);
 #endif // rmemory_show_detail_realtime
 
-    rdict_entry_t *de = rdict_find(rmem_trace_map, (void*)((int64_t)ptr));
-    if (de == NULL || ((rmem_info_t*)(de->value.ptr))->ptr != ptr) {
+    rmem_info_t* info = NULL;
+    rdict_sharded_take(rmem_trace_map, (void*)((int64_t)ptr), (void**)&info);//查和删在同一把锁内，重复释放只有一个能取到
+    if (info == NULL || info->ptr != ptr) {
         rerror("free error, not exists. %d-%p != (%p->%p) from %ld, %s:%d-%s", 0, ptr, 
-            de, de == NULL ? NULL : ((rmem_info_t*)(de->value.ptr))->ptr, thread_id, filename, line, func);
+            info, info == NULL ? NULL : info->ptr, thread_id, filename, line, func);
+        if (info != NULL) {
+            rdict_sharded_add(rmem_trace_map, (void*)((int64_t)ptr), info);//放回，留给统计输出
+        }
         return 1;
     }
-    rdict_remove(rmem_trace_map, (void*)((int64_t)ptr));
+    free(info);
 
     free(ptr);
 
     return rcode_ok;
 }
 
+void* rmem_malloc_aligned_trace(size_t align, size_t size, long thread_id, char* filename, const char* func, int line) {
+    void* ret = rmem_aligned_alloc(align, size);
+#ifdef rmemory_show_detail_realtime
+    rdebug("malloc aligned. %zu(%zu)-%p from %ld, %s:%d-%s", size, align, ret, thread_id, filename, line, func);
+#endif // rmemory_show_detail_realtime
+
+    rmem_info_t* info = malloc(sizeof(rmem_info_t));
+    rassert(info, "");
+    info->ptr = ret;
+    info->elem_size = size;
+    info->count = 0;
+    info->thread_id = thread_id;
+    info->filename = filename;
+    info->func = (char*)func;
+    info->line = line;
+
+    rdict_sharded_add(rmem_trace_map, (void*)((int64_t)ret), info);
+
+    return ret;
+}
+
+int rmem_free_aligned(void* ptr, long thread_id, char* filename, const char* func, int line) {
+    rmem_info_t* info = NULL;
+    rdict_sharded_take(rmem_trace_map, (void*)((int64_t)ptr), (void**)&info);
+    if (info == NULL || info->ptr != ptr) {
+        rerror("free aligned error, not exists. %p from %ld, %s:%d-%s", ptr, thread_id, filename, line, func);
+        if (info != NULL) {
+            rdict_sharded_add(rmem_trace_map, (void*)((int64_t)ptr), info);
+        }
+        return 1;
+    }
+    free(info);
+
+    rmem_aligned_free(ptr);
+
+    return rcode_ok;
+}
+
 int rmem_statistics(char* filepath) {
 #ifdef rmemory_enable_tracer
     FILE* file_ptr = fopen(filepath, "w");//,ccs=UTF-8
@@ -145,18 +209,13 @@ int rmem_statistics(char* filepath) {
         return 1;
     }
 
-    rinfo("rmemory leak count: %"rdict_size_t_format, rdict_size(rmem_trace_map));
-    if (rdict_size(rmem_trace_map) == 0) {
+    rdict_size_t leak_count = rdict_sharded_size(rmem_trace_map);
+    rinfo("rmemory leak count: %"rdict_size_t_format, leak_count);
+    if (leak_count == 0) {
         fprintf(file_ptr, "nice, no memory leak.");
     }
     else {
-        rmem_info_t* info = NULL;
-        rdict_iterator_t it = rdict_it(rmem_trace_map);
-        for (rdict_entry_t *de = NULL; (de = rdict_next(&it)) != NULL; ) {
-            info = (rmem_info_t*)(de->value.ptr);
-            fprintf(file_ptr, "(%zu * %zu)-%p from %ld, %s:%d-%s"Li, 
-                info->count, info->elem_size, info->ptr, info->thread_id, info->filename, info->line, info->func);
-        }
+        rdict_sharded_scan(rmem_trace_map, (rdict_scan_func*)mem_dict_output_func, file_ptr);
     }
 
     fflush(file_ptr);
@@ -169,6 +228,290 @@ int rmem_statistics(char* filepath) {
 #undef rmem_info_t
 
 
+/* ------------------------------- size class ------------------------------------*/
+
+#define rmem_slab_header_size ((sizeof(rmem_slab_t) + 15) & ~(size_t)15)
+#define rmem_slab_of(ptr) ((rmem_slab_t*)((uintptr_t)(ptr) & ~((uintptr_t)rmem_class_slab_size - 1)))
+
+typedef struct rmem_slab_s rmem_slab_t;
+struct rmem_slab_s {
+    int class_index;
+    int total_count;
+    int free_count;
+    int reserved;
+    void* free_head;
+    char* bump;//未切分部分起点
+    rmem_slab_t* prev;
+    rmem_slab_t* next;
+};
+
+typedef struct rmem_class_s {
+    rmutex_t mutex;
+    size_t size;
+    rmem_slab_t* free_slabs;//有空闲的slab，满的不在链上
+    int64_t hit;
+    int64_t miss;
+    int64_t used;
+    int64_t slabs;
+} rmem_class_t;
+
+//都是16的倍数，和malloc一样保证16字节对齐(SSE、long double)
+static const size_t rmem_class_sizes[rmem_class_count] = {
+    16, 32, 48, 64, 80, 96, 112, 128, 144, 160, 192, 224,
+    256, 320, 384, 448, 512, 640, 768, 1024, 1280, 1536, 1792, 2048
+};
+static uint8_t rmem_class_index[(rmem_class_size_max >> 3) + 1];
+static rmem_class_t rmem_classes[rmem_class_count];
+
+static char* rmem_region_start = NULL;
+static char* rmem_region_end = NULL;
+static char* rmem_region_top = NULL;
+static char* rmem_region_release_ptr = NULL;
+static size_t rmem_region_reserved = 0;
+static rmem_slab_t* rmem_slab_empty = NULL;//完全空闲的slab，各分级复用
+static rmutex_t rmem_region_mutex;
+static int64_t rmem_large_count = 0;
+
+static void* rmem_region_reserve(size_t size) {
+#ifdef ros_windows
+    return VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS);
+#else
+    void* ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    return ptr == MAP_FAILED ? NULL : ptr;
+#endif //ros_windows
+}
+
+static void rmem_region_release(void* ptr, size_t size) {
+#ifdef ros_windows
+    VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+    munmap(ptr, size);
+#endif //ros_windows
+}
+
+/** 不含slab头所在页，头部用于空闲链 */
+static void rmem_slab_decommit(rmem_slab_t* slab) {
+#ifdef ros_windows
+    VirtualFree((char*)slab + 4096, rmem_class_slab_size - 4096, MEM_DECOMMIT);
+#else
+    madvise((char*)slab + 4096, rmem_class_slab_size - 4096, MADV_DONTNEED);
+#endif //ros_windows
+}
+
+static rmem_slab_t* rmem_slab_new(int class_index) {
+    rmem_slab_t* slab = NULL;
+
+    rmutex_lock(&rmem_region_mutex);
+    if (rmem_slab_empty != NULL) {
+        slab = rmem_slab_empty;
+        rmem_slab_empty = slab->next;
+    } else if (rmem_region_top + rmem_class_slab_size <= rmem_region_end) {
+        slab = (rmem_slab_t*)rmem_region_top;
+        rmem_region_top += rmem_class_slab_size;
+    }
+    rmutex_unlock(&rmem_region_mutex);
+
+    if (slab == NULL) {
+        return NULL;
+    }
+#ifdef ros_windows
+    if (VirtualAlloc(slab, rmem_class_slab_size, MEM_COMMIT, PAGE_READWRITE) == NULL) {
+        return NULL;
+    }
+#endif //ros_windows
+
+    rmem_class_t* cls = &rmem_classes[class_index];
+    slab->class_index = class_index;
+    slab->total_count = (int)((rmem_class_slab_size - rmem_slab_header_size) / cls->size);
+    slab->free_count = slab->total_count;
+    slab->reserved = 0;
+    slab->free_head = NULL;
+    slab->bump = (char*)slab + rmem_slab_header_size;
+    slab->prev = NULL;
+    slab->next = cls->free_slabs;
+    if (cls->free_slabs != NULL) {
+        cls->free_slabs->prev = slab;
+    }
+    cls->free_slabs = slab;
+    cls->slabs++;
+
+    return slab;
+}
+
+static void rmem_slab_unlink(rmem_class_t* cls, rmem_slab_t* slab) {
+    if (slab->prev != NULL) {
+        slab->prev->next = slab->next;
+    } else {
+        cls->free_slabs = slab->next;
+    }
+    if (slab->next != NULL) {
+        slab->next->prev = slab->prev;
+    }
+    slab->prev = slab->next = NULL;
+}
+
+int rmem_class_init() {
+    if (rmem_region_start != NULL) {
+        return rcode_ok;
+    }
+
+    rmem_region_reserved = rmem_class_region_size + rmem_class_slab_size;
+    char* region = rmem_region_reserve(rmem_region_reserved);
+    if (region == NULL) {
+        rerror("reserve region of size class failed, size = %zu", rmem_region_reserved);
+        return 1;
+    }
+
+    int class_index = 0;
+    for (size_t i = 0; i <= (rmem_class_size_max >> 3); i++) {
+        while ((i << 3) > rmem_class_sizes[class_index]) {
+            class_index++;
+        }
+        rmem_class_index[i] = (uint8_t)class_index;
+    }
+    for (int i = 0; i < rmem_class_count; i++) {
+        rmutex_init(&rmem_classes[i].mutex);
+        rmem_classes[i].size = rmem_class_sizes[i];
+        rmem_classes[i].free_slabs = NULL;
+        rmem_classes[i].hit = rmem_classes[i].miss = rmem_classes[i].used = rmem_classes[i].slabs = 0;
+    }
+    rmutex_init(&rmem_region_mutex);
+    rmem_slab_empty = NULL;
+    rmem_large_count = 0;
+
+    rmem_region_start = (char*)(((uintptr_t)region + rmem_class_slab_size - 1) & ~((uintptr_t)rmem_class_slab_size - 1));
+    rmem_region_end = rmem_region_start + rmem_class_region_size;
+    rmem_region_top = rmem_region_start;
+    rmem_region_release_ptr = region;
+
+    return rcode_ok;
+}
+
+int rmem_class_uninit() {
+    if (rmem_region_start == NULL) {
+        return rcode_ok;
+    }
+
+    for (int i = 0; i < rmem_class_count; i++) {
+        if (rmem_classes[i].used > 0) {//区间释放后晚到的free会被当成系统堆指针
+            rwarn("size class(%zu) still in use, used = %"PRId64", keep region", rmem_classes[i].size, rmem_classes[i].used);
+            return 1;
+        }
+    }
+
+    for (int i = 0; i < rmem_class_count; i++) {
+        if (rmem_classes[i].hit + rmem_classes[i].miss > 0) {
+            rinfo("size class(%zu): hit = %"PRId64", miss = %"PRId64", used = %"PRId64", slabs = %"PRId64,
+                rmem_classes[i].size, rmem_classes[i].hit, rmem_classes[i].miss, rmem_classes[i].used, rmem_classes[i].slabs);
+        }
+        rmutex_uninit(&rmem_classes[i].mutex);
+    }
+    rinfo("size class large: %"PRId64, rmem_large_count);
+    rmutex_uninit(&rmem_region_mutex);
+
+    rmem_region_release(rmem_region_release_ptr, rmem_region_reserved);
+    rmem_region_start = rmem_region_end = rmem_region_top = NULL;
+    rmem_region_release_ptr = NULL;
+
+    return rcode_ok;
+}
+
+void* rmem_class_alloc(size_t size) {
+    if (unlikely(size > rmem_class_size_max || rmem_region_start == NULL)) {
+        ratomic_fetch_add(&rmem_large_count, 1);
+        return raymalloc(size);
+    }
+
+    int class_index = rmem_class_index[(size + 7) >> 3];
+    rmem_class_t* cls = &rmem_classes[class_index];
+    void* ptr = NULL;
+
+    rmutex_lock(&cls->mutex);
+    rmem_slab_t* slab = cls->free_slabs;
+    if (slab == NULL) {
+        cls->miss++;
+        slab = rmem_slab_new(class_index);
+        if (slab == NULL) {
+            rmutex_unlock(&cls->mutex);
+            ratomic_fetch_add(&rmem_large_count, 1);
+            return raymalloc(size);
+        }
+    } else {
+        cls->hit++;
+    }
+
+    if (slab->free_head != NULL) {
+        ptr = slab->free_head;
+        slab->free_head = *(void**)ptr;
+    } else {
+        ptr = slab->bump;
+        slab->bump += cls->size;
+    }
+    if (--slab->free_count == 0) {
+        rmem_slab_unlink(cls, slab);
+    }
+    cls->used++;
+    rmutex_unlock(&cls->mutex);
+
+    return ptr;
+}
+
+void rmem_class_free(void* ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+    if ((char*)ptr < rmem_region_start || (char*)ptr >= rmem_region_end) {
+        rayfree(ptr);
+        return;
+    }
+
+    rmem_slab_t* slab = rmem_slab_of(ptr);
+    rmem_class_t* cls = &rmem_classes[slab->class_index];
+
+    rmutex_lock(&cls->mutex);
+    if (slab->free_count == 0) {
+        slab->prev = NULL;
+        slab->next = cls->free_slabs;
+        if (cls->free_slabs != NULL) {
+            cls->free_slabs->prev = slab;
+        }
+        cls->free_slabs = slab;
+    }
+    *(void**)ptr = slab->free_head;
+    slab->free_head = ptr;
+    slab->free_count++;
+    cls->used--;
+
+    if (slab->free_count == slab->total_count && cls->free_slabs != slab) {
+        rmem_slab_unlink(cls, slab);
+        cls->slabs--;
+        rmem_slab_decommit(slab);
+
+        rmutex_lock(&rmem_region_mutex);
+        slab->next = rmem_slab_empty;
+        rmem_slab_empty = slab;
+        rmutex_unlock(&rmem_region_mutex);
+    }
+    rmutex_unlock(&cls->mutex);
+}
+
+int rmem_class_stat(rmem_class_stat_t* stats, int64_t* large_count) {
+    for (int i = 0; i < rmem_class_count; i++) {
+        rmutex_lock(&rmem_classes[i].mutex);
+        stats[i].size = rmem_classes[i].size;
+        stats[i].hit = rmem_classes[i].hit;
+        stats[i].miss = rmem_classes[i].miss;
+        stats[i].used = rmem_classes[i].used;
+        stats[i].slabs = rmem_classes[i].slabs;
+        rmutex_unlock(&rmem_classes[i].mutex);
+    }
+    if (large_count != NULL) {
+        *large_count = ratomic_load(&rmem_large_count);
+    }
+
+    return rmem_class_count;
+}
+
 rmem_byte_order_code_t rmem_check_host_order() {
     union {
         uint16_t value;
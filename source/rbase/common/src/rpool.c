@@ -0,0 +1,269 @@
+/**
+ * Copyright (c) 2014 ray
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the MIT license. See LICENSE for details.
+ *
+ * @author: Ray
+ */
+
+#include "rpool.h"
+#include "rtools.h"
+#include "rlog.h"
+
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunknown-pragmas"
+#endif //__GNUC__
+
+#define rdata_pool_header_size ((sizeof(rdata_pool_block) + 15) & ~(size_t)15)
+#define rdata_pool_block_capacity_init 64
+
+static inline void rdata_pool_set_nonfull(rdata_pool* pool, int index) {
+    pool->nonfull_bits[index >> 6] |= 1ull << (index & 63);
+    pool->summary_bits[index >> 12] |= 1ull << ((index >> 6) & 63);
+}
+
+static inline void rdata_pool_clear_nonfull(rdata_pool* pool, int index) {
+    pool->nonfull_bits[index >> 6] &= ~(1ull << (index & 63));
+    if (pool->nonfull_bits[index >> 6] == 0) {
+        pool->summary_bits[index >> 12] &= ~(1ull << ((index >> 6) & 63));
+    }
+}
+
+/** 返回未满块下标，没有返回-1 */
+static inline int rdata_pool_find_nonfull(rdata_pool* pool) {
+    int summary_count = (pool->block_capacity + 4095) >> 12;
+    for (int i = 0; i < summary_count; i++) {
+        if (pool->summary_bits[i] != 0) {
+            int word_index = (i << 6) + rtools_ctz64(pool->summary_bits[i]);
+            return (word_index << 6) + rtools_ctz64(pool->nonfull_bits[word_index]);
+        }
+    }
+    return -1;
+}
+
+static int rdata_pool_grow(rdata_pool* pool) {
+    int capacity_new = pool->block_capacity == 0 ? rdata_pool_block_capacity_init : pool->block_capacity * 2;
+    int words_old = pool->block_capacity >> 6;
+    int words_new = capacity_new >> 6;
+    int summary_old = (pool->block_capacity + 4095) >> 12;
+    int summary_new = (capacity_new + 4095) >> 12;
+
+    rdata_pool_block** blocks = rdata_new_type_array(rdata_pool_block*, capacity_new);
+    uint64_t* nonfull_bits = rdata_new_type_array(uint64_t, words_new);
+    uint64_t* summary_bits = rdata_new_type_array(uint64_t, summary_new);
+    int* slot_free = rdata_new_type_array(int, capacity_new);
+    if (blocks == NULL || nonfull_bits == NULL || summary_bits == NULL || slot_free == NULL) {
+        rerror("grow rdata_pool(%u) failed, capacity = %d", pool->size_elem, capacity_new);
+        if (blocks != NULL) {
+            rdata_free_array(blocks);
+        }
+        if (nonfull_bits != NULL) {
+            rdata_free_array(nonfull_bits);
+        }
+        if (summary_bits != NULL) {
+            rdata_free_array(summary_bits);
+        }
+        if (slot_free != NULL) {
+            rdata_free_array(slot_free);
+        }
+        return -1;
+    }
+
+    if (pool->block_capacity > 0) {
+        memcpy(blocks, pool->blocks, pool->block_capacity * sizeof(rdata_pool_block*));
+        memcpy(nonfull_bits, pool->nonfull_bits, words_old * sizeof(uint64_t));
+        memcpy(summary_bits, pool->summary_bits, summary_old * sizeof(uint64_t));
+        memcpy(slot_free, pool->slot_free, pool->slot_free_count * sizeof(int));
+        rdata_free_array(pool->blocks);
+        rdata_free_array(pool->nonfull_bits);
+        rdata_free_array(pool->summary_bits);
+        rdata_free_array(pool->slot_free);
+    }
+
+    pool->blocks = blocks;
+    pool->nonfull_bits = nonfull_bits;
+    pool->summary_bits = summary_bits;
+    pool->slot_free = slot_free;
+    pool->block_capacity = capacity_new;
+
+    return rcode_ok;
+}
+
+/** 返回新块下标，失败返回-1 */
+static int rdata_pool_new_block(rdata_pool* pool) {
+    int index = -1;
+
+    if (pool->slot_free_count > 0) {
+        index = pool->slot_free[--pool->slot_free_count];
+    } else {
+        if (pool->block_top >= pool->block_capacity && rdata_pool_grow(pool) != rcode_ok) {
+            return -1;
+        }
+        index = pool->block_top++;
+    }
+
+    rdata_pool_block* block = raymalloc_aligned(pool->block_align,
+        rdata_pool_header_size + pool->block_items * pool->size_elem);
+    if (block == NULL) {
+        rerror("new block of rdata_pool(%u) failed.", pool->size_elem);
+        pool->slot_free[pool->slot_free_count++] = index;
+        return -1;
+    }
+    block->used_bits = pool->block_empty_bits;
+    block->pool = pool;
+    block->data_total_size = pool->block_items * pool->size_elem;
+    block->size_elem = pool->size_elem;
+    block->index = index;
+    block->reserved = 0;
+
+    pool->blocks[index] = block;
+    pool->block_count++;
+    pool->capacity += pool->block_items;
+    pool->total_free += pool->block_items;
+    rdata_pool_set_nonfull(pool, index);
+
+    return index;
+}
+
+static void rdata_pool_release_block(rdata_pool* pool, rdata_pool_block* block) {
+    int index = block->index;
+
+    rdata_pool_clear_nonfull(pool, index);
+    pool->blocks[index] = NULL;
+    pool->slot_free[pool->slot_free_count++] = index;
+    pool->block_count--;
+    pool->capacity -= pool->block_items;
+    pool->total_free -= pool->block_items;
+
+    rayfree_aligned(block);
+}
+
+R_API rdata_pool* rdata_pool_create(unsigned int size_elem, unsigned int init_elems) {
+    return rdata_pool_create_ext(size_elem, init_elems, pool_block_item_count);
+}
+
+R_API rdata_pool* rdata_pool_create_ext(unsigned int size_elem, unsigned int init_elems, unsigned int block_items) {
+    if (size_elem == 0) {
+        rerror("size_elem of rdata_pool is 0.");
+        return NULL;
+    }
+    if (block_items == 0 || block_items > pool_block_item_count) {
+        rerror("block_items of rdata_pool is invalid, %u.", block_items);
+        return NULL;
+    }
+
+    rdata_pool* pool = rdata_new(rdata_pool);
+    if (pool == NULL) {
+        return NULL;
+    }
+    rdata_init(pool, sizeof(rdata_pool));
+
+    pool->size_elem = (size_elem + 7) & ~7u;
+    pool->init_elems = init_elems;
+    pool->block_spare = -1;
+    pool->block_items = (int)block_items;
+    pool->block_empty_bits = block_items < pool_block_item_count ? ~0ull << block_items : 0;
+    pool->block_keep = (init_elems + block_items - 1) / block_items;
+    pool->block_align = 64;
+    while (pool->block_align < rdata_pool_header_size + block_items * pool->size_elem) {
+        pool->block_align <<= 1;
+    }
+
+    for (int i = 0; i < pool->block_keep; i++) {
+        if (rdata_pool_new_block(pool) < 0) {
+            rdata_pool_destroy(pool);
+            return NULL;
+        }
+    }
+
+    rinfo("create rdata_pool(%u, %u, %u) success, align(%zu), (%p)", pool->size_elem, init_elems, block_items, pool->block_align, pool);
+    return pool;
+}
+
+R_API void rdata_pool_destroy(rdata_pool* pool) {
+    if (pool == NULL) {
+        return;
+    }
+
+    for (int i = 0; i < pool->block_top; i++) {
+        if (pool->blocks[i] != NULL) {
+            rayfree_aligned(pool->blocks[i]);
+        }
+    }
+    if (pool->block_capacity > 0) {
+        rdata_free_array(pool->blocks);
+        rdata_free_array(pool->nonfull_bits);
+        rdata_free_array(pool->summary_bits);
+        rdata_free_array(pool->slot_free);
+    }
+
+    rinfo("destroy rdata_pool(%u) success, (%p)", pool->size_elem, pool);
+    rdata_free(rdata_pool, pool);
+}
+
+R_API void* rdata_pool_alloc(rdata_pool* pool) {
+    if (pool == NULL) {
+        return NULL;
+    }
+
+    int index = rdata_pool_find_nonfull(pool);
+    if (index < 0) {
+        index = rdata_pool_new_block(pool);
+        if (index < 0) {
+            return NULL;
+        }
+    }
+
+    rdata_pool_block* block = pool->blocks[index];
+    int slot = 0;
+    data_index_block(block, block->used_bits, slot);
+    dada_used_flag_block(block, void*, slot);
+    if (dada_full_block(block)) {
+        rdata_pool_clear_nonfull(pool, index);
+    }
+    pool->total_free--;
+
+    return dada_from_block(block, void*, pool->size_elem, slot);
+}
+
+R_API int rdata_pool_free(rdata_pool* pool, void* data) {
+    if (pool == NULL || data == NULL) {
+        return -1;
+    }
+
+    rdata_pool_block* block = (rdata_pool_block*)((uintptr_t)data & ~((uintptr_t)pool->block_align - 1));
+    int64_t offset = (char*)data - block->data_buffer;
+    if (unlikely(block->pool != pool || offset < 0 || offset >= block->data_total_size || offset % pool->size_elem != 0)) {
+        rerror("free to rdata_pool(%u) failed, invalid data %p", pool->size_elem, data);
+        return -1;
+    }
+
+    int slot = (int)(offset / pool->size_elem);
+    if (unlikely((block->used_bits & (1ull << slot)) == 0)) {
+        rerror("free to rdata_pool(%u) failed, double free %p", pool->size_elem, data);
+        return -1;
+    }
+
+    if (dada_full_block(block)) {
+        rdata_pool_set_nonfull(pool, block->index);
+    }
+    dada_free_flag_block(block, void*, slot);
+    pool->total_free++;
+
+    if (dada_empty_block(block) && block->index >= pool->block_keep) {
+        rdata_pool_block* spare = pool->block_spare >= 0 ? pool->blocks[pool->block_spare] : NULL;
+        if (spare == NULL || spare == block || !dada_empty_block(spare)) {
+            pool->block_spare = block->index;//备用块被用过后不再算空，换成这一块
+        } else {
+            rdata_pool_release_block(pool, block);
+        }
+    }
+
+    return rcode_ok;
+}
+
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif //__GNUC__
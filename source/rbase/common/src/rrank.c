@@ -0,0 +1,301 @@
+/**
+ * Copyright (c) 2014 ray
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the MIT license. See LICENSE for details.
+ *
+ * @author: Ray
+ */
+
+#include "rrank.h"
+#include "rtools.h"
+#include "rlog.h"
+
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunknown-pragmas"
+#endif //__GNUC__
+
+#define _node_size(level) (sizeof(rrank_node_t) + (level) * sizeof(rrank_level_t))
+
+/** (score1, id1) 排在 (score2, id2) 之前 */
+static inline bool _before(rrank_t* d, int64_t score1, uint64_t id1, int64_t score2, uint64_t id2) {
+    if (score1 != score2) {
+        return d->order == rrank_order_desc ? score1 > score2 : score1 < score2;
+    }
+    return id1 < id2;
+}
+
+#define _node_before(d, node1, node2) _before((d), (node1)->score, (node1)->id, (node2)->score, (node2)->id)
+
+/** 每层晋升概率1/4，一次随机数按两位一组数0 */
+static inline int _random_level(rrank_t* d) {
+    uint64_t x = d->random_state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    d->random_state = x;
+
+    int level = 1 + (x == 0 ? rrank_level_max : (int)rtools_ctz64(x) / 2);
+    return level < rrank_level_max ? level : rrank_level_max;
+}
+
+static rrank_node_t* _node_new(int level) {
+    rrank_node_t* node = (rrank_node_t*)rdata_new_size(_node_size(level));
+    if (node == NULL) {
+        return NULL;
+    }
+    rdata_init(node, _node_size(level));
+    node->level = level;
+    return node;
+}
+
+/** update[i]为第i层node的前驱，rank[i]为其名次 */
+static void _link(rrank_t* d, rrank_node_t* node) {
+    rrank_node_t* update[rrank_level_max];
+    rrank_size_t rank[rrank_level_max];
+    rrank_node_t* x = d->header;
+    int i;
+
+    for (i = d->level - 1; i >= 0; i--) {
+        rank[i] = i == d->level - 1 ? 0 : rank[i + 1];
+        while (x->levels[i].forward != NULL && _node_before(d, x->levels[i].forward, node)) {
+            rank[i] += x->levels[i].span;
+            x = x->levels[i].forward;
+        }
+        update[i] = x;
+    }
+
+    if (node->level > d->level) {
+        for (i = d->level; i < node->level; i++) {
+            rank[i] = 0;
+            update[i] = d->header;
+            update[i]->levels[i].span = d->size;
+        }
+        d->level = node->level;
+    }
+
+    for (i = 0; i < node->level; i++) {
+        node->levels[i].forward = update[i]->levels[i].forward;
+        update[i]->levels[i].forward = node;
+        node->levels[i].span = update[i]->levels[i].span - (rank[0] - rank[i]);
+        update[i]->levels[i].span = (rank[0] - rank[i]) + 1;
+    }
+    for (i = node->level; i < d->level; i++) {
+        update[i]->levels[i].span++;
+    }
+
+    node->backward = update[0] == d->header ? NULL : update[0];
+    if (node->levels[0].forward != NULL) {
+        node->levels[0].forward->backward = node;
+    } else {
+        d->tail = node;
+    }
+    d->size++;
+}
+
+/** 只摘链，不释放node，也不动索引 */
+static void _unlink(rrank_t* d, rrank_node_t* node) {
+    rrank_node_t* update[rrank_level_max];
+    rrank_node_t* x = d->header;
+    int i;
+
+    for (i = d->level - 1; i >= 0; i--) {
+        while (x->levels[i].forward != NULL && _node_before(d, x->levels[i].forward, node)) {
+            x = x->levels[i].forward;
+        }
+        update[i] = x;
+    }
+
+    for (i = 0; i < d->level; i++) {
+        if (update[i]->levels[i].forward == node) {
+            update[i]->levels[i].span += node->levels[i].span - 1;
+            update[i]->levels[i].forward = node->levels[i].forward;
+        } else {
+            update[i]->levels[i].span--;
+        }
+    }
+
+    if (node->levels[0].forward != NULL) {
+        node->levels[0].forward->backward = node->backward;
+    } else {
+        d->tail = node->backward;
+    }
+    while (d->level > 1 && d->header->levels[d->level - 1].forward == NULL) {
+        d->level--;
+    }
+    d->size--;
+}
+
+R_API rrank_t* rrank_create(rrank_order_t order, rrank_size_t init_capacity) {
+    rrank_t* d = rdata_new(rrank_t);
+    if (d == NULL) {
+        return NULL;
+    }
+    rdata_init(d, sizeof(rrank_t));
+
+    d->header = _node_new(rrank_level_max);
+    if (d->header == NULL) {
+        rdata_free(rrank_t, d);
+        return NULL;
+    }
+    d->level = 1;
+    d->order = order;
+    d->random_state = 0x9E3779B97F4A7C15ULL ^ (uint64_t)(uintptr_t)d;
+
+    rdict_init(d->index, rdata_type_uint64, rdata_type_ptr,
+        init_capacity > 0 ? init_capacity : rrank_init_capacity_default, 0);
+
+    return d;
+}
+
+R_API void rrank_release(rrank_t* d) {
+    if (d == NULL) {
+        return;
+    }
+
+    rrank_clear(d);
+    rdict_free(d->index);
+    rdata_free(rrank_node_t, d->header);
+    rdata_free(rrank_t, d);
+}
+
+R_API void rrank_clear(rrank_t* d) {
+    if (d == NULL) {
+        return;
+    }
+
+    rrank_node_t* node = rrank_first(d);
+    while (node != NULL) {
+        rrank_node_t* node_next = rrank_next(node);
+        rdata_free(rrank_node_t, node);
+        node = node_next;
+    }
+
+    rdata_init(d->header, _node_size(rrank_level_max));
+    d->header->level = rrank_level_max;
+    d->tail = NULL;
+    d->size = 0;
+    d->level = 1;
+    rdict_clear(d->index);
+}
+
+R_API int rrank_update(rrank_t* d, uint64_t id, int64_t score) {
+    if (d == NULL) {
+        return rrank_code_error;
+    }
+
+    rrank_node_t* node = rrank_find(d, id);
+    if (node != NULL) {
+        if (node->score == score) {
+            return rrank_code_ok;
+        }
+        //前后邻居不变，原地改分
+        if ((node->backward == NULL || _before(d, node->backward->score, node->backward->id, score, id)) &&
+            (node->levels[0].forward == NULL || _before(d, score, id, node->levels[0].forward->score, node->levels[0].forward->id))) {
+            node->score = score;
+            return rrank_code_ok;
+        }
+        _unlink(d, node);
+        node->score = score;
+        _link(d, node);
+        return rrank_code_ok;
+    }
+
+    node = _node_new(_random_level(d));
+    if (node == NULL) {
+        rerror("alloc rrank node failed, size = %u", d->size);
+        return rrank_code_error;
+    }
+    node->id = id;
+    node->score = score;
+
+    if (rdict_add(d->index, (void*)(uintptr_t)id, node) != rdict_code_ok) {
+        rerror("add rrank index failed, id = %"PRIu64, id);
+        rdata_free(rrank_node_t, node);
+        return rrank_code_error;
+    }
+    _link(d, node);
+
+    return rrank_code_ok;
+}
+
+R_API int rrank_remove(rrank_t* d, uint64_t id) {
+    rrank_node_t* node = rrank_find(d, id);
+    if (node == NULL) {
+        return rrank_code_not_exist;
+    }
+
+    _unlink(d, node);
+    rdict_remove(d->index, (const void*)(uintptr_t)id);
+    rdata_free(rrank_node_t, node);
+
+    return rrank_code_ok;
+}
+
+R_API rrank_node_t* rrank_find(rrank_t* d, uint64_t id) {
+    if (d == NULL) {
+        return NULL;
+    }
+
+    rdict_entry_t* entry = rdict_find(d->index, (const void*)(uintptr_t)id);
+    return entry != NULL ? (rrank_node_t*)entry->value.ptr : NULL;
+}
+
+R_API rrank_size_t rrank_rank_of(rrank_t* d, uint64_t id) {
+    rrank_node_t* node = rrank_find(d, id);
+    if (node == NULL) {
+        return 0;
+    }
+
+    rrank_node_t* x = d->header;
+    rrank_size_t rank = 0;
+    for (int i = d->level - 1; i >= 0; i--) {
+        while (x->levels[i].forward != NULL &&
+            (x->levels[i].forward == node || _node_before(d, x->levels[i].forward, node))) {
+            rank += x->levels[i].span;
+            x = x->levels[i].forward;
+        }
+        if (x == node) {
+            return rank;
+        }
+    }
+
+    rerror("rrank index broken, id = %"PRIu64, id);
+    return 0;
+}
+
+R_API rrank_node_t* rrank_at(rrank_t* d, rrank_size_t rank) {
+    if (d == NULL || rank == 0 || rank > d->size) {
+        return NULL;
+    }
+
+    rrank_node_t* x = d->header;
+    rrank_size_t traversed = 0;
+    for (int i = d->level - 1; i >= 0; i--) {
+        while (x->levels[i].forward != NULL && traversed + x->levels[i].span <= rank) {
+            traversed += x->levels[i].span;
+            x = x->levels[i].forward;
+        }
+        if (traversed == rank) {
+            return x;
+        }
+    }
+    return NULL;
+}
+
+R_API rrank_size_t rrank_range(rrank_t* d, rrank_size_t rank, rrank_size_t count, rrank_range_func_type func, void* data_ext) {
+    rrank_size_t visited = 0;
+
+    for (rrank_node_t* node = rrank_at(d, rank); node != NULL && visited < count; node = rrank_next(node)) {
+        if (func != NULL) {
+            func(data_ext, node, rank + visited);
+        }
+        visited++;
+    }
+    return visited;
+}
+
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif //__GNUC__
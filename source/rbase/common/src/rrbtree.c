@@ -0,0 +1,460 @@
+/**
+ * Copyright (c) 2014 ray
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the MIT license. See LICENSE for details.
+ *
+ * @author: Ray
+ */
+
+#include "rrbtree.h"
+#include "rlog.h"
+
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunknown-pragmas"
+#endif //__GNUC__
+
+static inline int _compare(rrbtree_t* d, const void* key1, const void* key2) {
+    if (d->compare_key_func == NULL) {
+        int64_t v1 = (int64_t)(intptr_t)key1;
+        int64_t v2 = (int64_t)(intptr_t)key2;
+        return v1 == v2 ? rcode_eq : (v1 < v2 ? rcode_lt : rcode_gt);
+    }
+    return d->compare_key_func(d->data_ext, key1, key2);
+}
+
+#define _is_red(node) ((node) != NULL && (node)->color == rrbtree_red)
+
+static inline rrbtree_node_t* _min_node(rrbtree_node_t* node) {
+    while (node->left != NULL) {
+        node = node->left;
+    }
+    return node;
+}
+
+static void _rotate_left(rrbtree_t* d, rrbtree_node_t* x) {
+    rrbtree_node_t* y = x->right;
+
+    x->right = y->left;
+    if (y->left != NULL) {
+        y->left->parent = x;
+    }
+    y->parent = x->parent;
+    if (x->parent == NULL) {
+        d->root = y;
+    } else if (x == x->parent->left) {
+        x->parent->left = y;
+    } else {
+        x->parent->right = y;
+    }
+    y->left = x;
+    x->parent = y;
+}
+
+static void _rotate_right(rrbtree_t* d, rrbtree_node_t* x) {
+    rrbtree_node_t* y = x->left;
+
+    x->left = y->right;
+    if (y->right != NULL) {
+        y->right->parent = x;
+    }
+    y->parent = x->parent;
+    if (x->parent == NULL) {
+        d->root = y;
+    } else if (x == x->parent->right) {
+        x->parent->right = y;
+    } else {
+        x->parent->left = y;
+    }
+    y->right = x;
+    x->parent = y;
+}
+
+static void _insert_fixup(rrbtree_t* d, rrbtree_node_t* node) {
+    rrbtree_node_t* parent = NULL;
+
+    while ((parent = node->parent) != NULL && parent->color == rrbtree_red) {
+        rrbtree_node_t* grand = parent->parent;
+        if (parent == grand->left) {
+            rrbtree_node_t* uncle = grand->right;
+            if (_is_red(uncle)) {
+                parent->color = rrbtree_black;
+                uncle->color = rrbtree_black;
+                grand->color = rrbtree_red;
+                node = grand;
+                continue;
+            }
+            if (node == parent->right) {
+                _rotate_left(d, parent);
+                node = parent;
+                parent = node->parent;
+            }
+            parent->color = rrbtree_black;
+            grand->color = rrbtree_red;
+            _rotate_right(d, grand);
+        } else {
+            rrbtree_node_t* uncle = grand->left;
+            if (_is_red(uncle)) {
+                parent->color = rrbtree_black;
+                uncle->color = rrbtree_black;
+                grand->color = rrbtree_red;
+                node = grand;
+                continue;
+            }
+            if (node == parent->left) {
+                _rotate_right(d, parent);
+                node = parent;
+                parent = node->parent;
+            }
+            parent->color = rrbtree_black;
+            grand->color = rrbtree_red;
+            _rotate_left(d, grand);
+        }
+    }
+    d->root->color = rrbtree_black;
+}
+
+/** 用v替换u在父节点中的位置 */
+static inline void _transplant(rrbtree_t* d, rrbtree_node_t* u, rrbtree_node_t* v) {
+    if (u->parent == NULL) {
+        d->root = v;
+    } else if (u == u->parent->left) {
+        u->parent->left = v;
+    } else {
+        u->parent->right = v;
+    }
+    if (v != NULL) {
+        v->parent = u->parent;
+    }
+}
+
+/** node可能为NULL(空叶子)，所以单独传parent */
+static void _remove_fixup(rrbtree_t* d, rrbtree_node_t* node, rrbtree_node_t* parent) {
+    while (node != d->root && !_is_red(node)) {
+        if (node == parent->left) {
+            rrbtree_node_t* sibling = parent->right;
+            if (_is_red(sibling)) {
+                sibling->color = rrbtree_black;
+                parent->color = rrbtree_red;
+                _rotate_left(d, parent);
+                sibling = parent->right;
+            }
+            if (!_is_red(sibling->left) && !_is_red(sibling->right)) {
+                sibling->color = rrbtree_red;
+                node = parent;
+                parent = node->parent;
+                continue;
+            }
+            if (!_is_red(sibling->right)) {
+                sibling->left->color = rrbtree_black;
+                sibling->color = rrbtree_red;
+                _rotate_right(d, sibling);
+                sibling = parent->right;
+            }
+            sibling->color = parent->color;
+            parent->color = rrbtree_black;
+            sibling->right->color = rrbtree_black;
+            _rotate_left(d, parent);
+        } else {
+            rrbtree_node_t* sibling = parent->left;
+            if (_is_red(sibling)) {
+                sibling->color = rrbtree_black;
+                parent->color = rrbtree_red;
+                _rotate_right(d, parent);
+                sibling = parent->left;
+            }
+            if (!_is_red(sibling->left) && !_is_red(sibling->right)) {
+                sibling->color = rrbtree_red;
+                node = parent;
+                parent = node->parent;
+                continue;
+            }
+            if (!_is_red(sibling->left)) {
+                sibling->right->color = rrbtree_black;
+                sibling->color = rrbtree_red;
+                _rotate_left(d, sibling);
+                sibling = parent->left;
+            }
+            sibling->color = parent->color;
+            parent->color = rrbtree_black;
+            sibling->left->color = rrbtree_black;
+            _rotate_right(d, parent);
+        }
+        node = d->root;
+        break;
+    }
+    if (node != NULL) {
+        node->color = rrbtree_black;
+    }
+}
+
+static void _free_node_data(rrbtree_t* d, rrbtree_node_t* node) {
+    if (d->free_key_func != NULL) {
+        d->free_key_func(d->data_ext, node->key.ptr);
+    }
+    if (d->free_value_func != NULL) {
+        d->free_value_func(d->data_ext, node->value.ptr);
+    }
+}
+
+R_API rrbtree_t* rrbtree_create(rrbtree_size_t init_capacity, void* data_ext) {
+    rrbtree_t* d = rdata_new(rrbtree_t);
+    if (d == NULL) {
+        return NULL;
+    }
+    rdata_init(d, sizeof(rrbtree_t));
+
+    d->pool = rdata_pool_create(sizeof(rrbtree_node_t), init_capacity > 0 ? init_capacity : rrbtree_init_capacity_default);
+    if (d->pool == NULL) {
+        rdata_free(rrbtree_t, d);
+        return NULL;
+    }
+    d->data_ext = data_ext;
+
+    return d;
+}
+
+R_API void rrbtree_release(rrbtree_t* d) {
+    if (d == NULL) {
+        return;
+    }
+
+    rrbtree_clear(d);
+    rdata_pool_destroy(d->pool);
+    rdata_free(rrbtree_t, d);
+}
+
+R_API void rrbtree_clear(rrbtree_t* d) {
+    if (d == NULL || d->root == NULL) {
+        return;
+    }
+
+    rrbtree_node_t* node = d->root;
+    while (node != NULL) {//后序释放，不需要栈
+        if (node->left != NULL) {
+            node = node->left;
+            continue;
+        }
+        if (node->right != NULL) {
+            node = node->right;
+            continue;
+        }
+        rrbtree_node_t* parent = node->parent;
+        if (parent != NULL) {
+            if (parent->left == node) {
+                parent->left = NULL;
+            } else {
+                parent->right = NULL;
+            }
+        }
+        _free_node_data(d, node);
+        rdata_pool_free(d->pool, node);
+        node = parent;
+    }
+
+    d->root = NULL;
+    d->first = NULL;
+    d->size = 0;
+}
+
+R_API int rrbtree_add(rrbtree_t* d, const void* key, const void* value) {
+    if (d == NULL) {
+        return rrbtree_code_error;
+    }
+
+    rrbtree_node_t* parent = NULL;
+    rrbtree_node_t** link = &d->root;
+    bool leftmost = true;
+    while (*link != NULL) {
+        parent = *link;
+        int ret = _compare(d, key, parent->key.ptr);
+        if (ret == rcode_lt) {
+            link = &parent->left;
+        } else if (ret == rcode_gt) {
+            link = &parent->right;
+            leftmost = false;
+        } else {
+            if (d->free_value_func != NULL) {
+                d->free_value_func(d->data_ext, parent->value.ptr);
+            }
+            parent->value.ptr = d->copy_value_func != NULL ? d->copy_value_func(d->data_ext, value) : (void*)value;
+            return rrbtree_code_ok;
+        }
+    }
+
+    rrbtree_node_t* node = (rrbtree_node_t*)rdata_pool_alloc(d->pool);
+    if (node == NULL) {
+        rerror("alloc rrbtree node failed, size = %u", d->size);
+        return rrbtree_code_error;
+    }
+    node->left = NULL;
+    node->right = NULL;
+    node->parent = parent;
+    node->color = rrbtree_red;
+    node->key.ptr = d->copy_key_func != NULL ? d->copy_key_func(d->data_ext, key) : (void*)key;
+    node->value.ptr = d->copy_value_func != NULL ? d->copy_value_func(d->data_ext, value) : (void*)value;
+    *link = node;
+
+    if (leftmost) {
+        d->first = node;
+    }
+    d->size++;
+    _insert_fixup(d, node);
+
+    return rrbtree_code_ok;
+}
+
+R_API void rrbtree_remove_node(rrbtree_t* d, rrbtree_node_t* node) {
+    rrbtree_node_t* child = NULL;
+    rrbtree_node_t* parent = NULL;
+    int color_removed = node->color;
+
+    if (node == d->first) {
+        d->first = rrbtree_next(node);
+    }
+
+    if (node->left == NULL) {
+        child = node->right;
+        parent = node->parent;
+        _transplant(d, node, node->right);
+    } else if (node->right == NULL) {
+        child = node->left;
+        parent = node->parent;
+        _transplant(d, node, node->left);
+    } else {//后继节点顶替位置，只改指针，其它节点地址不变
+        rrbtree_node_t* successor = _min_node(node->right);
+        color_removed = successor->color;
+        child = successor->right;
+        if (successor->parent == node) {
+            parent = successor;
+        } else {
+            parent = successor->parent;
+            _transplant(d, successor, successor->right);
+            successor->right = node->right;
+            successor->right->parent = successor;
+        }
+        _transplant(d, node, successor);
+        successor->left = node->left;
+        successor->left->parent = successor;
+        successor->color = node->color;
+    }
+
+    if (color_removed == rrbtree_black) {
+        _remove_fixup(d, child, parent);
+    }
+
+    _free_node_data(d, node);
+    rdata_pool_free(d->pool, node);
+    d->size--;
+}
+
+R_API int rrbtree_remove(rrbtree_t* d, const void* key) {
+    rrbtree_node_t* node = rrbtree_find(d, key);
+    if (node == NULL) {
+        return rrbtree_code_not_exist;
+    }
+
+    rrbtree_remove_node(d, node);
+    return rrbtree_code_ok;
+}
+
+R_API rrbtree_node_t* rrbtree_find(rrbtree_t* d, const void* key) {
+    if (d == NULL) {
+        return NULL;
+    }
+
+    rrbtree_node_t* node = d->root;
+    while (node != NULL) {
+        int ret = _compare(d, key, node->key.ptr);
+        if (ret == rcode_eq) {
+            return node;
+        }
+        node = ret == rcode_lt ? node->left : node->right;
+    }
+    return NULL;
+}
+
+R_API rrbtree_node_t* rrbtree_lower_bound(rrbtree_t* d, const void* key) {
+    rrbtree_node_t* node = d->root;
+    rrbtree_node_t* ret = NULL;
+
+    while (node != NULL) {
+        if (_compare(d, node->key.ptr, key) != rcode_lt) {
+            ret = node;
+            node = node->left;
+        } else {
+            node = node->right;
+        }
+    }
+    return ret;
+}
+
+R_API rrbtree_node_t* rrbtree_upper_bound(rrbtree_t* d, const void* key) {
+    rrbtree_node_t* node = d->root;
+    rrbtree_node_t* ret = NULL;
+
+    while (node != NULL) {
+        if (_compare(d, node->key.ptr, key) == rcode_gt) {
+            ret = node;
+            node = node->left;
+        } else {
+            node = node->right;
+        }
+    }
+    return ret;
+}
+
+R_API rrbtree_node_t* rrbtree_last(rrbtree_t* d) {
+    rrbtree_node_t* node = d->root;
+    while (node != NULL && node->right != NULL) {
+        node = node->right;
+    }
+    return node;
+}
+
+R_API rrbtree_node_t* rrbtree_next(rrbtree_node_t* node) {
+    if (node->right != NULL) {
+        return _min_node(node->right);
+    }
+    rrbtree_node_t* parent = node->parent;
+    while (parent != NULL && node == parent->right) {
+        node = parent;
+        parent = parent->parent;
+    }
+    return parent;
+}
+
+R_API rrbtree_node_t* rrbtree_prev(rrbtree_node_t* node) {
+    if (node->left != NULL) {
+        node = node->left;
+        while (node->right != NULL) {
+            node = node->right;
+        }
+        return node;
+    }
+    rrbtree_node_t* parent = node->parent;
+    while (parent != NULL && node == parent->left) {
+        node = parent;
+        parent = parent->parent;
+    }
+    return parent;
+}
+
+R_API rrbtree_size_t rrbtree_scan_range(rrbtree_t* d, const void* key_from, const void* key_to,
+    void (*func)(void* data_ext, rrbtree_node_t* node), void* data_ext) {
+    rrbtree_size_t count = 0;
+
+    for (rrbtree_node_t* node = rrbtree_lower_bound(d, key_from);
+        node != NULL && _compare(d, node->key.ptr, key_to) == rcode_lt; node = rrbtree_next(node)) {
+        if (func != NULL) {
+            func(data_ext, node);
+        }
+        count++;
+    }
+    return count;
+}
+
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif //__GNUC__
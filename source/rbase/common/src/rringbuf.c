@@ -0,0 +1,287 @@
+/**
+ * Copyright (c) 2014 ray
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the MIT license. See LICENSE for details.
+ *
+ * @author: Ray
+ */
+
+#include "rlog.h"
+#include "rringbuf.h"
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#endif //__linux__
+
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunknown-pragmas"
+#endif //__GNUC__
+
+static inline rringbuf_size_t _capacity_of(rringbuf_size_t size) {
+    rringbuf_size_t capacity = 1;
+    while (capacity < size) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+/** 从index开始拷贝size字节，最多拆成两次memcpy */
+static inline void _copy_out(rringbuf_t* d, rringbuf_size_t index, char* dest, rringbuf_size_t size) {
+    rringbuf_size_t pos = index & d->mask;
+    rringbuf_size_t first = d->capacity - pos;
+
+    if (d->mirrored || first >= size) {
+        memcpy(dest, d->data + pos, size);
+    } else {
+        memcpy(dest, d->data + pos, first);
+        memcpy(dest + first, d->data, size - first);
+    }
+}
+
+static inline int _fill_iov(rringbuf_t* d, rringbuf_size_t index, rringbuf_size_t size, rringbuf_iov_t* iov) {
+    if (size == 0) {
+        return 0;
+    }
+
+    rringbuf_size_t pos = index & d->mask;
+    rringbuf_size_t first = d->capacity - pos;
+
+    iov[0].base = d->data + pos;
+    if (d->mirrored || first >= size) {
+        iov[0].len = size;
+        return 1;
+    }
+    iov[0].len = first;
+    iov[1].base = d->data;
+    iov[1].len = size - first;
+    return 2;
+}
+
+/** 同一个memfd连续映射两次，data[i]和data[i + capacity]是同一字节 */
+static char* _mirror_map(rringbuf_size_t capacity) {
+#if defined(__linux__) && defined(SYS_memfd_create)
+    int fd = (int)syscall(SYS_memfd_create, "rringbuf", MFD_CLOEXEC);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (ftruncate(fd, capacity) != 0) {
+        close(fd);
+        return NULL;
+    }
+
+    char* base = (char*)mmap(NULL, (size_t)capacity * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);//先占住连续地址
+    if (base == MAP_FAILED) {
+        close(fd);
+        return NULL;
+    }
+    if (mmap(base, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+        mmap(base + capacity, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(base, (size_t)capacity * 2);
+        close(fd);
+        return NULL;
+    }
+    close(fd);//映射持有引用
+
+    return base;
+#else
+    return NULL;
+#endif
+}
+
+static void _mirror_unmap(char* data, rringbuf_size_t capacity) {
+#if defined(__linux__)
+    munmap(data, (size_t)capacity * 2);
+#endif
+}
+
+R_API rringbuf_t* rringbuf_create(rringbuf_size_t init_capacity) {
+    if (init_capacity == 0) {
+        init_capacity = rringbuf_init_capacity_default;
+    }
+    if (init_capacity > rringbuf_size_max) {
+        rerror("rringbuf capacity too large: %u", init_capacity);
+        return NULL;
+    }
+
+    rringbuf_t* d = rdata_new(rringbuf_t);
+    if (d == NULL) {
+        return NULL;
+    }
+    d->capacity = _capacity_of(init_capacity);
+    d->mask = d->capacity - 1;
+    d->read_index = d->write_index = 0;
+    d->mirrored = false;
+    d->data = rdata_new_size(d->capacity);
+    if (d->data == NULL) {
+        rdata_free(rringbuf_t, d);
+        return NULL;
+    }
+
+    return d;
+}
+
+R_API rringbuf_t* rringbuf_create_mirror(rringbuf_size_t init_capacity) {
+    rringbuf_size_t page_size = 4096;
+#if defined(__linux__)
+    page_size = (rringbuf_size_t)sysconf(_SC_PAGESIZE);
+#endif
+    if (init_capacity < page_size) {
+        init_capacity = page_size;
+    }
+    if (init_capacity > rringbuf_size_max) {
+        rerror("rringbuf capacity too large: %u", init_capacity);
+        return NULL;
+    }
+
+    rringbuf_size_t capacity = _capacity_of(init_capacity);
+    char* data = _mirror_map(capacity);
+    if (data == NULL) {
+        rwarn("rringbuf mirror map failed, fallback to copy mode, capacity: %u", capacity);
+        return rringbuf_create(capacity);
+    }
+
+    rringbuf_t* d = rdata_new(rringbuf_t);
+    if (d == NULL) {
+        _mirror_unmap(data, capacity);
+        return NULL;
+    }
+    d->data = data;
+    d->capacity = capacity;
+    d->mask = capacity - 1;
+    d->read_index = d->write_index = 0;
+    d->mirrored = true;
+
+    return d;
+}
+
+R_API void rringbuf_release(rringbuf_t* d) {
+    if (d != NULL) {
+        if (d->mirrored) {
+            _mirror_unmap(d->data, d->capacity);
+        } else if (d->data != NULL) {
+            rdata_free(uint8_t, d->data);
+        }
+        rdata_free(rringbuf_t, d);
+    }
+}
+
+R_API void rringbuf_clear(rringbuf_t* d) {
+    if (d == NULL) {
+        return;
+    }
+
+    d->read_index = d->write_index = 0;
+}
+
+R_API rringbuf_size_t rringbuf_write(rringbuf_t* d, const char* val, rringbuf_size_t size) {
+    if (d == NULL || val == NULL) {
+        return 0;
+    }
+
+    rringbuf_size_t left = rringbuf_left(d);
+    size = size > left ? left : size;
+    if (size == 0) {
+        return 0;
+    }
+
+    rringbuf_size_t pos = d->write_index & d->mask;
+    rringbuf_size_t first = d->capacity - pos;
+    if (d->mirrored || first >= size) {
+        memcpy(d->data + pos, val, size);
+    } else {
+        memcpy(d->data + pos, val, first);
+        memcpy(d->data, val + first, size - first);
+    }
+    d->write_index += size;
+
+    return size;
+}
+
+R_API rringbuf_size_t rringbuf_read(rringbuf_t* d, char* val, rringbuf_size_t size) {
+    size = rringbuf_peek(d, val, size);
+    if (size > 0) {
+        d->read_index += size;
+    }
+    return size;
+}
+
+R_API rringbuf_size_t rringbuf_peek(rringbuf_t* d, char* val, rringbuf_size_t size) {
+    if (d == NULL || val == NULL) {
+        return 0;
+    }
+
+    rringbuf_size_t data_size = rringbuf_size(d);
+    size = size > data_size ? data_size : size;
+    if (size > 0) {
+        _copy_out(d, d->read_index, val, size);
+    }
+    return size;
+}
+
+R_API int rringbuf_read_ext(rringbuf_t* d, int len) {
+    if (d == NULL) {
+        return rcode_invalid;
+    }
+
+    if (len >= 0) {
+        rringbuf_size_t data_size = rringbuf_size(d);
+        d->read_index += (rringbuf_size_t)len > data_size ? data_size : (rringbuf_size_t)len;
+    } else {
+        rringbuf_size_t left = rringbuf_left(d);
+        d->read_index -= (rringbuf_size_t)(-len) > left ? left : (rringbuf_size_t)(-len);
+    }
+    return rcode_ok;
+}
+
+R_API int rringbuf_write_ext(rringbuf_t* d, int len) {
+    if (d == NULL) {
+        return rcode_invalid;
+    }
+
+    if (len >= 0) {
+        rringbuf_size_t left = rringbuf_left(d);
+        d->write_index += (rringbuf_size_t)len > left ? left : (rringbuf_size_t)len;
+    } else {
+        rringbuf_size_t data_size = rringbuf_size(d);
+        d->write_index -= (rringbuf_size_t)(-len) > data_size ? data_size : (rringbuf_size_t)(-len);
+    }
+    return rcode_ok;
+}
+
+R_API char* rringbuf_read_ptr(rringbuf_t* d, rringbuf_size_t size) {
+    if (d == NULL || size > rringbuf_size(d)) {
+        return NULL;
+    }
+
+    rringbuf_size_t pos = d->read_index & d->mask;
+    if (!d->mirrored && pos + size > d->capacity) {
+        return NULL;
+    }
+    return d->data + pos;
+}
+
+R_API int rringbuf_read_iov(rringbuf_t* d, rringbuf_iov_t* iov) {
+    if (d == NULL) {
+        return 0;
+    }
+    return _fill_iov(d, d->read_index, rringbuf_size(d), iov);
+}
+
+R_API int rringbuf_write_iov(rringbuf_t* d, rringbuf_iov_t* iov) {
+    if (d == NULL) {
+        return 0;
+    }
+    return _fill_iov(d, d->write_index, rringbuf_left(d), iov);
+}
+
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif //__GNUC__
@@ -102,7 +102,7 @@ int rstr_compare_func(const char* obj1, const char* obj2) {
     int ret = strcmp(obj1, obj2);
     if (ret == 0) {
         return rcode_eq;
-    } else if (ret == 1) {
+    } else if (ret > 0) {
         return rcode_gt;
     } else {
         return rcode_lt;
@@ -203,6 +203,41 @@ char* rstr_cpy_full(const void* data) {
     return rstr_cpy(data, 0);
 }
 
+rstr_hkey_t* rstr_hkey_copy(const rstr_hkey_t* key) {
+    rstr_hkey_t* key_copy = (rstr_hkey_t*)rdata_new_size(sizeof(rstr_hkey_t) + key->len + 1);
+    if (key_copy == NULL) {
+        return NULL;
+    }
+    char* str = (char*)(key_copy + 1);
+    memcpy(str, key->str, key->len);
+    str[key->len] = rstr_end;
+    key_copy->hash = key->hash;
+    key_copy->len = key->len;
+    key_copy->str = str;
+    return key_copy;
+}
+
+void rstr_hkey_free(rstr_hkey_t* key) {
+    if (key != NULL) {
+        rdata_free(rstr_hkey_t, key);
+    }
+}
+
+int rstr_hkey_compare(const rstr_hkey_t* key1, const rstr_hkey_t* key2) {
+    if (key1->hash != key2->hash) {
+        return key1->hash < key2->hash ? rcode_lt : rcode_gt;
+    }
+    if (key1->len != key2->len) {
+        return key1->len < key2->len ? rcode_lt : rcode_gt;
+    }
+    int ret = memcmp(key1->str, key2->str, key1->len);
+    return ret == 0 ? rcode_eq : (ret < 0 ? rcode_lt : rcode_gt);
+}
+
+uint64_t rstr_hkey_hash(const rstr_hkey_t* key) {
+    return key->hash;
+}
+
 char* rstr_sub(const char* src, size_t from, size_t dest_size, bool new) {
     if (!src || from  < 0 || dest_size < 0 || rstr_len(src) < (from + dest_size)) {
         rassert(false, "invalid str.");
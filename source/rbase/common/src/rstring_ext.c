@@ -77,6 +77,45 @@ char* rstr_join(const char* src, ...) {
     return buf_ext;
 }
 
+char* rstr_join_arena(rarena_t* arena, const char* src, ...) {
+    va_list argp;
+    va_list argp_copy;
+    char* temp = NULL;
+    size_t total_len = 0;
+    size_t temp_len = 0;
+    char* dest = NULL;
+
+    va_start(argp, src);
+    va_copy(argp_copy, argp);
+
+    temp = (char*)src;
+    while (temp != rstr_array_end) {
+        total_len += rstr_len(temp);
+        temp = va_arg(argp, char*);
+    }
+    va_end(argp);
+
+    dest = (char*)rarena_new_size(arena, total_len + 1);
+    if (dest == NULL) {
+        va_end(argp_copy);
+        return NULL;
+    }
+
+    total_len = 0;
+    temp = (char*)src;
+    while (temp != rstr_array_end) {
+        temp_len = rstr_len(temp);
+        memcpy(dest + total_len, temp, temp_len);
+        total_len += temp_len;
+        temp = va_arg(argp_copy, char*);
+    }
+    va_end(argp_copy);
+
+    dest[total_len] = rstr_end;
+
+    return dest;
+}
+
 char** rstr_make_array(const int count, ...) {
     va_list argp;
     char** rstr_arr = rstr_array_new(count);
@@ -143,6 +143,16 @@ R_API int64_t rtime_millisec() {
 #endif
 }
 
+R_API int64_t rtime_millisec_coarse() {
+#if defined(CLOCK_REALTIME_COARSE)
+    struct timespec time_now = { 0, 0 };
+    clock_gettime(CLOCK_REALTIME_COARSE, &time_now);//vdso直接读，不进内核
+    return (int64_t)time_now.tv_sec * 1000 + time_now.tv_nsec / 1000000;
+#else
+    return rtime_millisec();
+#endif
+}
+
 //todo Ray 多线程
 static int64_t _inc_millisec;
 static int64_t _inc_microsec;
@@ -14,6 +14,7 @@
 #include "rlist.h"
 #include "rarray.h"
 #include "rdict.h"
+#include "rthread.h"
 
 #ifdef __GNUC__
 #pragma GCC diagnostic push
@@ -26,6 +27,7 @@
 int rtools_init() {
 
     srand((unsigned int)(rtime_millisec()));
+    rhash_seed();//尽早固定种子，之后创建的字符串表都用它
 
     return rcode_ok;
 }
@@ -145,6 +147,134 @@ uint64_t rhash_func_murmur(const char *key)
     return h; // (uint32_t)h;
 }
 
+/* ------------------------------- wyhash ------------------------------------*/
+
+/** wyhash(final4)，短key只读头尾两段，长key每轮48字节三路并行 */
+static const uint64_t rhash_wy_secret[4] = {
+    UINT64_C(0x2d358dccaa6c78a5), UINT64_C(0x8bb84b93962eacc9), UINT64_C(0x4b33a62ed433d4a3), UINT64_C(0x4d5a2da51de1aa47)
+};
+
+static volatile int64_t rhash_seed_value = 0;
+
+static inline void rhash_wy_mum(uint64_t* a, uint64_t* b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = *a;
+    r *= *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    *a = _umul128(*a, *b, b);
+#else
+    uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t)*a, lb = (uint32_t)*b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32), c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+static inline uint64_t rhash_wy_mix(uint64_t a, uint64_t b) {
+    rhash_wy_mum(&a, &b);
+    return a ^ b;
+}
+
+//按小端读，大端机器上交换字节序，保证结果跨平台一致
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define rhash_wy_le64(v) __builtin_bswap64(v)
+#define rhash_wy_le32(v) __builtin_bswap32(v)
+#else
+#define rhash_wy_le64(v) (v)
+#define rhash_wy_le32(v) (v)
+#endif
+
+static inline uint64_t rhash_wy_r8(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return rhash_wy_le64(v);
+}
+
+static inline uint64_t rhash_wy_r4(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return rhash_wy_le32(v);
+}
+
+static inline uint64_t rhash_wy_r3(const uint8_t* p, size_t k) {
+    return (((uint64_t)p[0]) << 16) | (((uint64_t)p[k >> 1]) << 8) | p[k - 1];
+}
+
+uint64_t rhash_func_bytes(const void* data, size_t len, uint64_t seed) {
+    const uint8_t* p = (const uint8_t*)data;
+    const uint64_t* secret = rhash_wy_secret;
+    uint64_t a, b;
+
+    seed ^= rhash_wy_mix(seed ^ secret[0], secret[1]);
+    if (likely(len <= 16)) {
+        if (likely(len >= 4)) {
+            a = (rhash_wy_r4(p) << 32) | rhash_wy_r4(p + ((len >> 3) << 2));
+            b = (rhash_wy_r4(p + len - 4) << 32) | rhash_wy_r4(p + len - 4 - ((len >> 3) << 2));
+        } else if (likely(len > 0)) {
+            a = rhash_wy_r3(p, len);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = len;
+        if (unlikely(i >= 48)) {
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = rhash_wy_mix(rhash_wy_r8(p) ^ secret[1], rhash_wy_r8(p + 8) ^ seed);
+                see1 = rhash_wy_mix(rhash_wy_r8(p + 16) ^ secret[2], rhash_wy_r8(p + 24) ^ see1);
+                see2 = rhash_wy_mix(rhash_wy_r8(p + 32) ^ secret[3], rhash_wy_r8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (likely(i >= 48));
+            seed ^= see1 ^ see2;
+        }
+        while (unlikely(i > 16)) {
+            seed = rhash_wy_mix(rhash_wy_r8(p) ^ secret[1], rhash_wy_r8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = rhash_wy_r8(p + i - 16);
+        b = rhash_wy_r8(p + i - 8);
+    }
+
+    a ^= secret[1];
+    b ^= seed;
+    rhash_wy_mum(&a, &b);
+    return rhash_wy_mix(a ^ secret[0] ^ len, b ^ secret[1]);
+}
+
+uint64_t rhash_seed() {
+    int64_t seed = ratomic_load(&rhash_seed_value);
+    if (likely(seed != 0)) {
+        return (uint64_t)seed;
+    }
+
+    int local = 0;
+#if defined(_WIN32) || defined(_WIN64)
+    uint64_t entropy = (uint64_t)GetCurrentProcessId();
+#else
+    uint64_t entropy = (uint64_t)getpid();
+#endif
+    entropy = entropy << 32 ^ (uint64_t)rtime_nanosec() ^ (uint64_t)(uintptr_t)&local ^ (uint64_t)(uintptr_t)&rhash_seed_value;
+    seed = (int64_t)rhash_func_bytes(&entropy, sizeof(entropy), (uint64_t)rtime_nanosec());
+    if (seed == 0) {
+        seed = 1;
+    }
+    ratomic_cas(&rhash_seed_value, 0, seed);//只有第一次生效，之后所有线程看到同一个种子
+
+    return (uint64_t)ratomic_load(&rhash_seed_value);
+}
+
+uint64_t rhash_func_string(const char* key) {
+    return rhash_func_bytes(key, strlen(key), rhash_seed());
+}
+
 R_API int riterator_reset(riterator_t* it) {
     switch (it->type_id) {
     case rdata_type_rlist:
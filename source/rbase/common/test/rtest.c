@@ -145,6 +145,8 @@ static int run_tests(int output) {
     rtest_add_test_entry(run_rarray_tests);
 	rtest_add_test_entry(run_rcommon_tests);
 	rtest_add_test_entry(run_rdict_tests);
+    rtest_add_test_entry(run_rrbtree_tests);
+    rtest_add_test_entry(run_rrank_tests);
     rtest_add_test_entry(run_rlog_tests);
     rtest_add_test_entry(run_rfile_tests);
     rtest_add_test_entry(run_rtools_tests);
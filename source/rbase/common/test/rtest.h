@@ -33,6 +33,8 @@ int run_rstring_tests(int benchmark_output);
 int run_rthread_tests(int benchmark_output);
 int run_rarray_tests(int benchmark_output);
 int run_rdict_tests(int benchmark_output);
+int run_rrbtree_tests(int benchmark_output);
+int run_rrank_tests(int benchmark_output);
 int run_rcommon_tests(int benchmark_output);
 int run_rlog_tests(int benchmark_output);
 int run_rfile_tests(int benchmark_output);
@@ -12,6 +12,7 @@
 #include "rcommon.h"
 #include "rtime.h"
 #include "rlist.h"
+#include "rilist.h"
 #include "rstring.h"
 
 #include "rbase/common/test/rtest.h"
@@ -22,9 +23,13 @@ static int uninit();
 //rattribute_unused(static int run_test(const char* test, int benchmark_output, int test_count));
 
 static void rlist_test(void **state);
+static void rilist_test(void **state);
+static void rlist_pool_bench_test(void **state);
 
 const static struct CMUnitTest tests[] = {
     cmocka_unit_test(rlist_test),
+    cmocka_unit_test(rilist_test),
+    cmocka_unit_test(rlist_pool_bench_test),
 };
 
 static int init() {
@@ -115,3 +120,139 @@ static void rlist_test(void **state) {
     assert_false(ret_list);
 }
 
+typedef struct rtest_ilist_item_s {
+    int id;
+    rilist_node_t link;
+} rtest_ilist_item_t;
+
+static void rilist_test(void **state) {// 侵入式链表
+    (void)state;
+    int count = 10;
+    rtest_ilist_item_t items[10];
+    rilist_t list;
+    rilist_t list_other;
+    rilist_node_t* node = NULL;
+    rilist_node_t* node_next = NULL;
+    int j;
+
+    rilist_init(&list);
+    rilist_init(&list_other);
+    assert_true(rilist_empty(&list) && rilist_first(&list) == NULL && rilist_pop_front(&list) == NULL);
+
+    for (j = 0; j < count; j++) {
+        items[j].id = j;
+        rilist_node_init(&items[j].link);
+        if (j < 5) {
+            rilist_push_back(&list, &items[j].link);
+        } else {
+            rilist_push_back(&list_other, &items[j].link);
+        }
+    }
+    assert_true(rilist_node_linked(&items[0].link));
+    assert_true(rilist_entry(rilist_last(&list), rtest_ilist_item_t, link)->id == 4);
+
+    rilist_splice_back(&list, &list_other);
+    assert_true(rilist_size(&list) == count && rilist_size(&list_other) == 0 && rilist_empty(&list_other));
+    j = 0;
+    rilist_foreach(&list, node) {
+        assert_true(rilist_entry(node, rtest_ilist_item_t, link)->id == j++);
+    }
+    assert_true(j == count);
+    j = count;
+    rilist_foreach_reverse(&list, node) {
+        assert_true(rilist_entry(node, rtest_ilist_item_t, link)->id == --j);
+    }
+
+    rilist_foreach_safe(&list, node, node_next) {//遍历中删除
+        if (rilist_entry(node, rtest_ilist_item_t, link)->id % 2 == 0) {
+            rilist_remove(&list, node);
+        }
+    }
+    assert_true(rilist_size(&list) == count / 2 && !rilist_node_linked(&items[0].link));
+    assert_true(rilist_entry(rilist_first(&list), rtest_ilist_item_t, link)->id == 1);
+
+    rilist_push_front(&list, &items[0].link);
+    rilist_insert_after(&list, &items[0].link, &items[2].link);
+    rilist_insert_before(&list, &items[0].link, &items[4].link);
+    rilist_move_back(&list, &items[4].link);
+    assert_true(rilist_entry(rilist_first(&list), rtest_ilist_item_t, link)->id == 0);
+    assert_true(rilist_entry(rilist_next(&list, &items[0].link), rtest_ilist_item_t, link)->id == 2);
+    assert_true(rilist_entry(rilist_last(&list), rtest_ilist_item_t, link)->id == 4);
+    assert_true(rilist_next(&list, &items[4].link) == NULL && rilist_prev(&list, &items[0].link) == NULL);
+
+    rilist_push_back(&list_other, &items[8].link);
+    rilist_push_back(&list_other, &items[6].link);
+    rilist_splice_front(&list, &list_other);
+    assert_true(rilist_entry(rilist_first(&list), rtest_ilist_item_t, link)->id == 8);
+    assert_true(rilist_size(&list) == count);
+
+    j = 0;
+    while ((node = rilist_pop_back(&list)) != NULL) {
+        j++;
+    }
+    assert_true(j == count && rilist_empty(&list));
+}
+
+static void rlist_pool_bench_test(void **state) {// 每个元素一次malloc vs 池化节点 vs 侵入式
+    (void)state;
+    int count = 1000000;
+    int j;
+    int64_t sum = 0;
+    rlist_node_t* node = NULL;
+
+    init_benchmark(1024, "test rlist nodes(%d)", count);
+
+    rtest_ilist_item_t* items = rdata_new_type_array(rtest_ilist_item_t, count);
+    for (j = 0; j < count; j++) {
+        items[j].id = j;
+    }
+
+    rlist_t* list_malloc = rlist_create();
+    start_benchmark(0);
+    for (j = 0; j < count; j++) {
+        rlist_rpush(list_malloc, &items[j]);
+    }
+    while ((node = rlist_lpop(list_malloc)) != NULL) {
+        sum += ((rtest_ilist_item_t*)node->val)->id;
+        rlist_free_node(list_malloc, node);
+    }
+    end_benchmark("rlist push and pop, node malloc.");
+    rlist_destroy(list_malloc);
+
+    rlist_t* list_pool = rlist_create();
+    assert_true(rlist_enable_pool(list_pool, count) == rcode_ok);
+    start_benchmark(0);
+    for (j = 0; j < count; j++) {
+        rlist_rpush(list_pool, &items[j]);
+    }
+    while ((node = rlist_lpop(list_pool)) != NULL) {
+        sum -= ((rtest_ilist_item_t*)node->val)->id;
+        rlist_free_node(list_pool, node);
+    }
+    end_benchmark("rlist push and pop, node pool.");
+    assert_true(sum == 0);
+    for (j = 0; j < 100; j++) {//池化节点走正常的remove/destroy
+        rlist_rpush(list_pool, &items[j]);
+    }
+    rlist_remove(list_pool, list_pool->head);
+    assert_true(rlist_enable_pool(list_pool, 0) == rcode_ok);
+    assert_true(rlist_size(list_pool) == 99);
+    rlist_destroy(list_pool);
+
+    rilist_t list_intrusive;
+    rilist_init(&list_intrusive);
+    rilist_node_t* link = NULL;
+    start_benchmark(0);
+    for (j = 0; j < count; j++) {
+        rilist_push_back(&list_intrusive, &items[j].link);
+    }
+    while ((link = rilist_pop_front(&list_intrusive)) != NULL) {
+        sum += rilist_entry(link, rtest_ilist_item_t, link)->id;
+    }
+    end_benchmark("rilist push and pop, intrusive.");
+    assert_true(sum == (int64_t)count * (count - 1) / 2);
+
+    rdata_free_array(items);
+
+    uninit_benchmark();
+}
@@ -24,6 +24,8 @@
 static void rarray_int_test(void **state);
 static void rarray_string_test(void **state);
 static void rarray_ptr_test(void **state);
+static void rarray_value_test(void **state);
+static void rarray_index_test(void **state);
 
 static char* dir_path = NULL;
 
@@ -47,6 +49,8 @@ static struct CMUnitTest test_group2[] = {
     cmocka_unit_test_setup_teardown(rarray_int_test, setup, teardown),
     cmocka_unit_test_setup_teardown(rarray_string_test, setup, teardown),
     cmocka_unit_test_setup_teardown(rarray_ptr_test, setup, teardown),
+    cmocka_unit_test_setup_teardown(rarray_value_test, setup, teardown),
+    cmocka_unit_test_setup_teardown(rarray_index_test, setup, teardown),
 };
 
 int run_rarray_tests(int benchmark_output) {
@@ -307,6 +311,147 @@ static void rarray_ptr_test(void **state) {
     uninit_benchmark();
 }
 
+typedef struct rtest_value_item_s {
+    int64_t key;
+    int32_t value;
+} rtest_value_item_t;
+
+static int rtest_value_item_cmp(const void* obj1, const void* obj2) {
+    int64_t key1 = ((const rtest_value_item_t*)obj1)->key;
+    int64_t key2 = ((const rtest_value_item_t*)obj2)->key;
+    return key1 == key2 ? rcode_eq : (key1 < key2 ? rcode_lt : rcode_gt);
+}
+
+static void rarray_value_test(void **state) {// 按值存储结构体
+    (void)state;
+    int count = 1000;
+    int j;
+    rtest_value_item_t items[10];
+
+    rarray_t* array_ins = NULL;
+    rarray_init_value(array_ins, rtest_value_item_t, 0);
+
+    for (j = 0; j < count; j++) {
+        rtest_value_item_t item = { .key = (j * 7919) % count, .value = j };
+        assert_true(rarray_add(array_ins, &item) == rcode_ok);
+    }
+    assert_true(rarray_size(array_ins) == count);
+    assert_true(rarray_at_value(array_ins, rtest_value_item_t, 1).key == 7919 % count);
+    assert_true(((rtest_value_item_t*)rarray_at(array_ins, 2))->value == 2);
+
+    rarray_sort(array_ins, rtest_value_item_cmp);
+    for (j = 0; j < count; j++) {
+        assert_true(rarray_at_value(array_ins, rtest_value_item_t, j).key == j);
+    }
+    rtest_value_item_t key_item = { .key = 500 };
+    assert_true(rarray_bsearch(array_ins, &key_item, rtest_value_item_cmp) == 500);
+    key_item.key = count;
+    assert_true(rarray_bsearch(array_ins, &key_item, rtest_value_item_cmp) == rarray_index_none);
+    assert_true(rarray_lower_bound(array_ins, &key_item, rtest_value_item_cmp) == (rarray_size_t)count);
+
+    for (j = 0; j < 10; j++) {
+        items[j].key = -10 + j;
+        items[j].value = j;
+    }
+    assert_true(rarray_insert_range(array_ins, 0, items, 10) == rcode_ok);
+    assert_true(rarray_append_n(array_ins, items, 10) == rcode_ok);
+    assert_true(rarray_size(array_ins) == count + 20);
+    assert_true(rarray_at_value(array_ins, rtest_value_item_t, 0).key == -10);
+    assert_true(rarray_at_value(array_ins, rtest_value_item_t, 10).key == 0);
+    assert_true(rarray_at_value(array_ins, rtest_value_item_t, count + 19).key == -1);
+
+    assert_true(rarray_erase_range(array_ins, count + 10, 10) == rcode_ok);
+    assert_true(rarray_erase_range(array_ins, 0, 10) == rcode_ok);
+    assert_true(rarray_erase_range(array_ins, 0, count + 1) == rarray_code_index_out4_size);
+    assert_true(rarray_size(array_ins) == count);
+    assert_true(rarray_at_value(array_ins, rtest_value_item_t, 0).key == 0);
+
+    assert_true(rarray_swap_remove(array_ins, 0) == rcode_ok);//末尾填到0
+    assert_true(rarray_at_value(array_ins, rtest_value_item_t, 0).key == count - 1);
+    assert_true(rarray_size(array_ins) == count - 1);
+
+    key_item = rarray_at_value(array_ins, rtest_value_item_t, 5);
+    assert_true(rarray_exist(array_ins, &key_item));
+    assert_true(rarray_remove(array_ins, &key_item) == rcode_ok);
+    assert_true(!rarray_exist(array_ins, &key_item));
+    assert_true(rarray_remove_at(array_ins, 0) == rcode_ok);
+    assert_true(rarray_size(array_ins) == count - 3);
+
+    rarray_free(array_ins);
+}
+
+static void rarray_index_test(void **state) {// hash索引，ptr数组判重
+    (void)state;
+    int count = 10000;
+    int times = 1000;
+    int j;
+    int found = 0;
+
+    init_benchmark(1024, "test rarray index(%d)", count);
+
+    rarray_t* array_ins = NULL;
+    rarray_t* array_index = NULL;
+    rarray_init(array_ins, rdata_type_ptr, 0);
+    rarray_init(array_index, rdata_type_ptr, 0);
+    assert_true(rarray_enable_index(array_index) == rcode_ok);
+
+    for (j = 1; j <= count; j++) {
+        rarray_add(array_ins, (void*)(intptr_t)(j * 16));
+        rarray_add(array_index, (void*)(intptr_t)(j * 16));
+    }
+
+    start_benchmark(0);
+    for (j = 0; j < times; j++) {
+        found += rarray_exist(array_ins, (void*)(intptr_t)((count - j % 100) * 16)) ? 1 : 0;
+    }
+    end_benchmark("rarray exist, linear scan.");
+
+    start_benchmark(0);
+    for (j = 0; j < times; j++) {
+        found += rarray_exist(array_index, (void*)(intptr_t)((count - j % 100) * 16)) ? 1 : 0;
+    }
+    end_benchmark("rarray exist, hash index.");
+    assert_true(found == times * 2);
+
+    assert_true(rarray_index_of(array_index, (void*)(intptr_t)(16 * 100)) == 99);
+    assert_true(rarray_remove(array_index, (void*)(intptr_t)(16 * 100)) == rcode_ok);//之后的下标前移
+    assert_true(rarray_index_of(array_index, (void*)(intptr_t)(16 * 101)) == 99);
+    assert_true(rarray_swap_remove(array_index, 0) == rcode_ok);
+    assert_true(rarray_index_of(array_index, (void*)(intptr_t)(16 * count)) == 0);
+    assert_true(rarray_index_of(array_index, (void*)(intptr_t)16) == rarray_index_none);
+    assert_true(rarray_erase_range(array_index, 1, 10) == rcode_ok);
+    assert_true(!rarray_exist(array_index, (void*)(intptr_t)(16 * 2)));
+    assert_true(rarray_index_of(array_index, (void*)(intptr_t)(16 * 12)) == 1);
+    for (j = 0; j < (int)rarray_size(array_index); j++) {
+        assert_true(rarray_index_of(array_index, rarray_at(array_index, j)) == (rarray_size_t)j);
+    }
+    rarray_clear(array_index);
+    assert_true(!rarray_exist(array_index, (void*)(intptr_t)(16 * 12)));
+
+    rarray_t* array_int = NULL;
+    rarray_init(array_int, rdata_type_int, 0);
+    assert_true(rarray_enable_index(array_int) == rcode_ok);
+    rarray_add(array_int, 0);
+    rarray_add(array_int, -1);
+    assert_true(rarray_exist(array_int, 0) && rarray_exist(array_int, -1) && !rarray_exist(array_int, 1));
+    assert_true(rarray_index_of(array_int, -1) == 1);
+
+    rarray_t* array_rgb = rarray_create(3, 2);//非1/2/4/8字节的元素只按value_size取键
+    assert_true(rarray_enable_index(array_rgb) == rcode_ok);
+    rarray_add(array_rgb, "\x01\x02\x03");
+    rarray_add(array_rgb, "\x04\x05\x06");
+    assert_true(rarray_exist(array_rgb, "\x04\x05\x06\x07") && rarray_index_of(array_rgb, "\x04\x05\x06") == 1);
+    assert_true(!rarray_exist(array_rgb, "\x04\x05\x07"));
+    assert_true(rarray_remove(array_rgb, "\x04\x05\x06") == rcode_ok && !rarray_exist(array_rgb, "\x04\x05\x06"));
+
+    rarray_free(array_rgb);
+    rarray_free(array_int);
+    rarray_free(array_index);
+    rarray_free(array_ins);
+
+    uninit_benchmark();
+}
+
 #ifdef __GNUC__
 #pragma GCC diagnostic pop
 #endif //__GNUC__
\ No newline at end of file
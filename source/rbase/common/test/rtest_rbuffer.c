@@ -12,6 +12,8 @@
 #include "rcommon.h"
 #include "rtime.h"
 #include "rbuffer.h"
+#include "rringbuf.h"
+#include "rchainbuf.h"
 
 #include "rbase/common/test/rtest.h"
 
@@ -21,6 +23,13 @@
 #endif //__GNUC__
 
 static void rbuffer_full_test(void **state);
+static void rringbuf_full_test(void **state);
+static void rringbuf_mirror_test(void **state);
+static void rringbuf_bench_test(void **state);
+static void rchainbuf_full_test(void **state);
+static void rchainbuf_slice_test(void **state);
+static void rchainbuf_splice_test(void **state);
+static void rchainbuf_bench_test(void **state);
 
 static int setup(void **state) {
     return rcode_ok;
@@ -30,6 +39,13 @@ static int teardown(void **state) {
 }
 static struct CMUnitTest test_group2[] = {
     cmocka_unit_test_setup_teardown(rbuffer_full_test, setup, teardown),
+    cmocka_unit_test_setup_teardown(rringbuf_full_test, setup, teardown),
+    cmocka_unit_test_setup_teardown(rringbuf_mirror_test, setup, teardown),
+    cmocka_unit_test_setup_teardown(rringbuf_bench_test, setup, teardown),
+    cmocka_unit_test_setup_teardown(rchainbuf_full_test, setup, teardown),
+    cmocka_unit_test_setup_teardown(rchainbuf_slice_test, setup, teardown),
+    cmocka_unit_test_setup_teardown(rchainbuf_splice_test, setup, teardown),
+    cmocka_unit_test_setup_teardown(rchainbuf_bench_test, setup, teardown),
 };
 
 int run_rbuffer_tests(int benchmark_output) {
@@ -95,6 +111,551 @@ static void rbuffer_full_test(void **state) {
 }
 
 
+/** 随机读写和线性缓冲对照，覆盖回绕 */
+static void _rringbuf_random_ops(rringbuf_t* buffer_ins, int count) {
+    int j;
+    char* buf_write = rstr_new(256);
+    char* buf_read = rstr_new(256);
+    char* expect = rstr_new(1024 * 1024);
+    int expect_start = 0;
+    int expect_end = 0;
+    rringbuf_iov_t iov[rringbuf_iov_max];
+
+    rringbuf_clear(buffer_ins);
+    buffer_ins->read_index = buffer_ins->write_index = 0xFFFFFF00U;//index溢出回绕
+    for (j = 0; j < count; j++) {
+        int size = rand() % 200;
+        int op = rand() % 5;
+        if (op == 0) {
+            for (int i = 0; i < size; i++) {
+                buf_write[i] = (char)rand();
+            }
+            int left = (int)rringbuf_left(buffer_ins);
+            int written = (int)rringbuf_write(buffer_ins, buf_write, size);
+            assert_true(written == (size > left ? left : size));
+            memcpy(expect + expect_end, buf_write, written);
+            expect_end += written;
+        } else if (op == 1) {//模拟readv直接写入
+            int seg = rringbuf_write_iov(buffer_ins, iov);
+            int written = 0;
+            assert_true(!rringbuf_mirrored(buffer_ins) || seg <= 1);
+            for (int i = 0; i < seg && written < size; i++) {
+                int len = (int)iov[i].len > size - written ? size - written : (int)iov[i].len;
+                for (int k = 0; k < len; k++) {
+                    ((char*)iov[i].base)[k] = expect[expect_end + written + k] = (char)rand();
+                }
+                written += len;
+            }
+            rringbuf_write_ext(buffer_ins, written);
+            expect_end += written;
+        } else if (op == 2) {
+            int read_len = (int)rringbuf_peek(buffer_ins, buf_read, size);
+            assert_true(read_len == (size > expect_end - expect_start ? expect_end - expect_start : size));
+            assert_true(memcmp(buf_read, expect + expect_start, read_len) == 0);
+            assert_true(rringbuf_read(buffer_ins, buf_read, size) == (rringbuf_size_t)read_len);
+            expect_start += read_len;
+        } else if (op == 3) {//模拟writev，部分发送
+            int seg = rringbuf_read_iov(buffer_ins, iov);
+            int sent = 0;
+            for (int i = 0; i < seg && sent < size; i++) {
+                int len = (int)iov[i].len > size - sent ? size - sent : (int)iov[i].len;
+                assert_true(memcmp(iov[i].base, expect + expect_start + sent, len) == 0);
+                sent += len;
+            }
+            rringbuf_read_ext(buffer_ins, sent);
+            expect_start += sent;
+        } else {//原地读
+            char* data = rringbuf_read_ptr(buffer_ins, size);
+            if (size > expect_end - expect_start) {
+                assert_true(data == NULL);
+            } else if (data != NULL) {
+                assert_true(memcmp(data, expect + expect_start, size) == 0);
+            } else {
+                assert_true(!rringbuf_mirrored(buffer_ins));
+            }
+        }
+        assert_true(rringbuf_size(buffer_ins) == (rringbuf_size_t)(expect_end - expect_start));
+        if (expect_end > 1024 * 1024 - 256) {
+            memmove(expect, expect + expect_start, expect_end - expect_start);
+            expect_end -= expect_start;
+            expect_start = 0;
+        }
+    }
+
+    rstr_free(expect);
+    rstr_free(buf_read);
+    rstr_free(buf_write);
+}
+
+static void rringbuf_full_test(void **state) {
+    (void)state;
+    int count = 100000;
+    char* buf_write = rstr_new(256);
+    char* buf_read = rstr_new(256);
+    rringbuf_iov_t iov[rringbuf_iov_max];
+
+    init_benchmark(1024, "test rringbuf full(%d)", count);
+
+    rringbuf_t* buffer_ins = NULL;
+    rringbuf_init(buffer_ins, 100);
+    assert_true(rringbuf_capacity(buffer_ins) == 128 && rringbuf_empty(buffer_ins) && !rringbuf_mirrored(buffer_ins));
+    assert_true(rringbuf_read_iov(buffer_ins, iov) == 0 && rringbuf_write_iov(buffer_ins, iov) == 1 && iov[0].len == 128);
+
+    srand(11);
+    start_benchmark(0);
+    _rringbuf_random_ops(buffer_ins, count);
+    end_benchmark("rringbuf random ops.");
+
+    rringbuf_clear(buffer_ins);
+    for (int i = 0; i < 256; i++) {
+        buf_write[i] = (char)i;
+    }
+    assert_true(rringbuf_write(buffer_ins, buf_write, 200) == 128 && rringbuf_full(buffer_ins));
+    assert_true(rringbuf_write(buffer_ins, buf_write, 1) == 0);
+    assert_true(rringbuf_read_iov(buffer_ins, iov) == 1 && rringbuf_write_iov(buffer_ins, iov) == 0);
+    rringbuf_read(buffer_ins, buf_read, 100);
+    rringbuf_write_ext(buffer_ins, -28);//撤销写入
+    assert_true(rringbuf_size(buffer_ins) == 0);
+    rringbuf_read_ext(buffer_ins, -100);//撤销读出
+    assert_true(rringbuf_size(buffer_ins) == 100 && rringbuf_peek(buffer_ins, buf_read, 100) == 100);
+    assert_true(memcmp(buf_read, buf_write, 100) == 0);
+    rringbuf_write(buffer_ins, buf_write, 50);//跨越回绕
+    assert_true(rringbuf_read_ptr(buffer_ins, 128) != NULL && rringbuf_read_ptr(buffer_ins, 129) == NULL);
+
+    rringbuf_free(buffer_ins);
+    rstr_free(buf_read);
+    rstr_free(buf_write);
+
+    uninit_benchmark();
+}
+
+static void rringbuf_mirror_test(void **state) {// 镜像映射，回绕处仍连续
+    (void)state;
+    int count = 100000;
+    char* buf_write = rstr_new(256);
+
+    init_benchmark(1024, "test rringbuf mirror(%d)", count);
+
+    rringbuf_t* buffer_ins = NULL;
+    rringbuf_init_mirror(buffer_ins, 100);
+    assert_true(rringbuf_capacity(buffer_ins) >= 4096);
+#if defined(__linux__)
+    assert_true(rringbuf_mirrored(buffer_ins));
+#endif
+
+    if (rringbuf_mirrored(buffer_ins)) {
+        rringbuf_size_t capacity = rringbuf_capacity(buffer_ins);
+        buffer_ins->data[capacity + 3] = 'x';//两段映射是同一块内存
+        assert_true(buffer_ins->data[3] == 'x');
+
+        for (int i = 0; i < 256; i++) {
+            buf_write[i] = (char)i;
+        }
+        buffer_ins->read_index = buffer_ins->write_index = capacity - 100;
+        assert_true(rringbuf_write(buffer_ins, buf_write, 256) == 256);
+        char* data = rringbuf_read_ptr(buffer_ins, 256);
+        assert_true(data != NULL && memcmp(data, buf_write, 256) == 0);
+        assert_true(memcmp(buffer_ins->data, buf_write + 100, 156) == 0);
+    }
+
+    srand(13);
+    start_benchmark(0);
+    _rringbuf_random_ops(buffer_ins, count);
+    end_benchmark("rringbuf mirror random ops.");
+
+    rringbuf_free(buffer_ins);
+    rstr_free(buf_write);
+
+    uninit_benchmark();
+}
+
+static void rringbuf_bench_test(void **state) {// 持续部分读，对比rbuffer的rewind搬移
+    (void)state;
+    int count = 200000;
+    int capacity = 64 * 1024;
+    int write_size = 4000;
+    int read_size = 3000;
+    int j;
+    int64_t sum = 0;
+    char* buf_write = rstr_new(write_size);
+    char* buf_read = rstr_new(write_size);
+    memset(buf_write, 1, write_size);
+
+    init_benchmark(1024, "test rringbuf bench(%d)", count);
+
+    rbuffer_t* buffer_ins = NULL;
+    rbuffer_init(buffer_ins, capacity);
+    start_benchmark(0);
+    for (j = 0; j < count; j++) {
+        if (rbuffer_left_write(buffer_ins) >= write_size) {
+            rbuffer_write(buffer_ins, buf_write, write_size);
+        }
+        sum += rbuffer_read(buffer_ins, buf_read, read_size);
+        if (rbuffer_left(buffer_ins) < rbuffer_capacity(buffer_ins) / 2) {//同decode_on_after
+            rbuffer_rewind(buffer_ins);
+        }
+    }
+    end_benchmark("rbuffer write 4000 read 3000 with rewind.");
+    rbuffer_free(buffer_ins);
+
+    rringbuf_t* ring_ins = NULL;
+    rringbuf_init(ring_ins, capacity);
+    start_benchmark(0);
+    for (j = 0; j < count; j++) {
+        if (rringbuf_left(ring_ins) >= (rringbuf_size_t)write_size) {
+            rringbuf_write(ring_ins, buf_write, write_size);
+        }
+        sum -= rringbuf_read(ring_ins, buf_read, read_size);
+    }
+    end_benchmark("rringbuf write 4000 read 3000.");
+    assert_true(sum == 0);
+    rringbuf_free(ring_ins);
+
+    rringbuf_init(ring_ins, capacity);
+    start_benchmark(0);
+    for (j = 0; j < count; j++) {//解码拷贝出整帧
+        rringbuf_write(ring_ins, buf_write, write_size);
+        rringbuf_read(ring_ins, buf_read, write_size);
+        sum += buf_read[write_size - 1];
+    }
+    end_benchmark("rringbuf frame 4000 copy out.");
+    rringbuf_free(ring_ins);
+
+    rringbuf_init_mirror(ring_ins, capacity);
+    start_benchmark(0);
+    for (j = 0; j < count; j++) {//镜像模式原地解码
+        rringbuf_write(ring_ins, buf_write, write_size);
+        char* frame = rringbuf_read_ptr(ring_ins, write_size);
+        sum -= frame != NULL ? frame[write_size - 1] : 0;
+        rringbuf_read_ext(ring_ins, write_size);
+    }
+    end_benchmark("rringbuf mirror frame 4000 in place.");
+    assert_true(sum == 0 || !rringbuf_mirrored(ring_ins));
+    rringbuf_free(ring_ins);
+
+    rstr_free(buf_read);
+    rstr_free(buf_write);
+
+    uninit_benchmark();
+}
+
+static void rchainbuf_full_test(void **state) {// 随机读写，跨越多个slab
+    (void)state;
+    int count = 100000;
+    int j;
+    int size_max = 300 * 1024;
+    char* buf_write = rstr_new(100 * 1024);
+    char* buf_read = rstr_new(100 * 1024);
+    char* expect = rstr_new(4 * 1024 * 1024);
+    int expect_start = 0;
+    int expect_end = 0;
+    rchainbuf_iov_t iov[rchainbuf_iov_max];
+    rchainbuf_stats_t stats;
+
+    init_benchmark(1024, "test rchainbuf full(%d)", count);
+
+    rchainbuf_t* buffer_ins = NULL;
+    rchainbuf_init(buffer_ins, size_max);
+    assert_true(rchainbuf_empty(buffer_ins) && rchainbuf_slab_count(buffer_ins) == 0);
+    assert_true(rchainbuf_read_iov(buffer_ins, iov, rchainbuf_iov_max) == 0);
+
+    srand(13);
+    start_benchmark(0);
+    for (j = 0; j < count; j++) {
+        int size = rand() % (j % 100 == 0 ? 100 * 1024 : 6000);
+        int op = rand() % 5;
+        if (op == 0) {
+            for (int i = 0; i < size; i++) {
+                buf_write[i] = (char)rand();
+            }
+            int left = (int)rchainbuf_left(buffer_ins);
+            int ret = rchainbuf_write(buffer_ins, buf_write, size);
+            if (size > left) {
+                assert_true(ret == rchainbuf_code_full);
+            } else {
+                assert_true(ret == rchainbuf_code_ok);
+                memcpy(expect + expect_end, buf_write, size);
+                expect_end += size;
+            }
+        } else if (op == 1) {//模拟readv直接写入
+            int seg = rchainbuf_write_iov(buffer_ins, iov);
+            int written = 0;
+            for (int i = 0; i < seg && written < size; i++) {
+                int len = (int)iov[i].len > size - written ? size - written : (int)iov[i].len;
+                for (int k = 0; k < len; k++) {
+                    ((char*)iov[i].base)[k] = expect[expect_end + written + k] = (char)rand();
+                }
+                written += len;
+            }
+            rchainbuf_write_ext(buffer_ins, written);
+            expect_end += written;
+        } else if (op == 2) {
+            int read_len = (int)rchainbuf_peek(buffer_ins, buf_read, size);
+            assert_true(read_len == (size > expect_end - expect_start ? expect_end - expect_start : size));
+            assert_true(memcmp(buf_read, expect + expect_start, read_len) == 0);
+            assert_true(rchainbuf_read(buffer_ins, buf_read, size) == (rchainbuf_size_t)read_len);
+            expect_start += read_len;
+        } else if (op == 3) {//模拟writev，部分发送
+            int seg = rchainbuf_read_iov(buffer_ins, iov, rchainbuf_iov_max);
+            int sent = 0;
+            for (int i = 0; i < seg && sent < size; i++) {
+                int len = (int)iov[i].len > size - sent ? size - sent : (int)iov[i].len;
+                assert_true(memcmp(iov[i].base, expect + expect_start + sent, len) == 0);
+                sent += len;
+            }
+            rchainbuf_read_ext(buffer_ins, sent);
+            expect_start += sent;
+        } else {//撤销写入
+            int revert = size % 100;
+            revert = revert > expect_end - expect_start ? expect_end - expect_start : revert;
+            rchainbuf_write_revert(buffer_ins, revert);
+            expect_end -= revert;
+        }
+        assert_true(rchainbuf_size(buffer_ins) == (rchainbuf_size_t)(expect_end - expect_start));
+        assert_true(rchainbuf_size(buffer_ins) <= (rchainbuf_size_t)size_max);
+        if (expect_end > 4 * 1024 * 1024 - 200 * 1024) {
+            memmove(expect, expect + expect_start, expect_end - expect_start);
+            expect_end -= expect_start;
+            expect_start = 0;
+        }
+    }
+    end_benchmark("rchainbuf random ops.");
+
+    rchainbuf_read_ext(buffer_ins, rchainbuf_size(buffer_ins));//读空后不占slab
+    assert_true(rchainbuf_empty(buffer_ins) && rchainbuf_slab_count(buffer_ins) == 0);
+    rchainbuf_thread_stats(&stats);
+    assert_true(stats.bytes_used == 0 && stats.slab_small_used == 0 && stats.slab_large_used == 0);
+
+    assert_true(rchainbuf_write(buffer_ins, buf_write, 100) == rchainbuf_code_ok);
+    assert_true(rchainbuf_slab_count(buffer_ins) == 1 && buffer_ins->head->capacity == rchainbuf_slab_small_size);
+    assert_true(rchainbuf_write_iov(buffer_ins, iov) == 1 && iov[0].len == rchainbuf_slab_small_size - 100);
+    rchainbuf_write_ext(buffer_ins, 0);
+    rchainbuf_write_revert(buffer_ins, 100);
+    assert_true(rchainbuf_slab_count(buffer_ins) == 0);
+
+    rchainbuf_free(buffer_ins);
+    rstr_free(expect);
+    rstr_free(buf_read);
+    rstr_free(buf_write);
+
+    uninit_benchmark();
+}
+
+static void rchainbuf_slice_test(void **state) {// 大消息不受单块容量限制，slice引用计数
+    (void)state;
+    int big_size = 2 * 1024 * 1024;
+    char* buf_write = rstr_new(big_size);
+    rchainbuf_slice_t slice;
+    rchainbuf_slice_t slice_small;
+    rchainbuf_stats_t stats;
+
+    init_benchmark(1024, "test rchainbuf slice(%d)", big_size);
+
+    for (int i = 0; i < big_size; i++) {
+        buf_write[i] = (char)(i * 7);
+    }
+
+    rchainbuf_t* buffer_ins = NULL;
+    rchainbuf_init(buffer_ins, big_size + 1024);
+    assert_true(rchainbuf_write(buffer_ins, buf_write, big_size + 1025) == rchainbuf_code_full);
+    assert_true(rchainbuf_empty(buffer_ins));
+
+    start_benchmark(0);
+    assert_true(rchainbuf_write(buffer_ins, buf_write, 100) == rchainbuf_code_ok);
+    assert_true(rchainbuf_write(buffer_ins, buf_write, big_size) == rchainbuf_code_ok);
+    end_benchmark("rchainbuf write big message.");
+    assert_true(rchainbuf_slab_count(buffer_ins) == 1 + (big_size + 100 - rchainbuf_slab_small_size +
+        rchainbuf_slab_large_size - 1) / rchainbuf_slab_large_size);
+
+    assert_true(rchainbuf_slice(buffer_ins, 50, &slice_small) == rchainbuf_code_ok);//同一slab内，零拷贝
+    rchainbuf_slab_t* head = buffer_ins->head;
+    assert_true(slice_small.slab == head && head->ref_count == 2 && slice_small.data == head->data);
+    assert_true(rchainbuf_slice(buffer_ins, 50, &slice) == rchainbuf_code_ok);
+    assert_true(slice.slab == head && memcmp(slice.data, buf_write + 50, 50) == 0);
+    rchainbuf_slice_release(&slice);
+    rchainbuf_read_ext(buffer_ins, rchainbuf_slab_small_size - 100);//读完首个slab，移出chain，slice仍持有
+    assert_true(buffer_ins->head != head && head->ref_count == 1 && memcmp(slice_small.data, buf_write, 50) == 0);
+    rchainbuf_slice_release(&slice_small);
+    assert_true(slice_small.slab == NULL);
+
+    int left = big_size + 100 - rchainbuf_slab_small_size;
+    assert_true(rchainbuf_slice(buffer_ins, left + 1, &slice) == rchainbuf_code_error);
+    assert_true(rchainbuf_slice(buffer_ins, left, &slice) == rchainbuf_code_ok);//跨slab，拷贝成整块
+    assert_true(slice.len == (rchainbuf_size_t)left && slice.slab->type == rchainbuf_slab_huge);
+    assert_true(memcmp(slice.data, buf_write + rchainbuf_slab_small_size - 100, left) == 0);
+    assert_true(rchainbuf_empty(buffer_ins) && rchainbuf_slab_count(buffer_ins) == 0);
+    rchainbuf_thread_stats(&stats);
+    assert_true(stats.slab_huge_used == 1 && stats.slab_large_used == 0 && stats.slab_small_used == 0);
+    rchainbuf_slice_release(&slice);
+
+    rchainbuf_write(buffer_ins, buf_write, 5000);
+    assert_true(rchainbuf_slice(buffer_ins, 5000, &slice) == rchainbuf_code_ok);
+    assert_true(slice.slab->type == rchainbuf_slab_large && memcmp(slice.data, buf_write, 5000) == 0);
+    rchainbuf_slice_release(&slice);
+
+    rchainbuf_free(buffer_ins);
+    rchainbuf_thread_stats(&stats);
+    assert_true(stats.bytes_used == 0);
+    rstr_free(buf_write);
+
+    uninit_benchmark();
+}
+
+static void rchainbuf_splice_test(void **state) {// 共享收包缓冲，残留半帧转给连接
+    (void)state;
+    int count = 1000;
+    char* buf_write = rstr_new(200 * 1024);
+    char* buf_read = rstr_new(200 * 1024);
+    rchainbuf_iov_t iov[rchainbuf_iov_max];
+    rchainbuf_slice_t slice;
+    rchainbuf_stats_t stats;
+
+    init_benchmark(1024, "test rchainbuf splice(%d)", count);
+
+    for (int i = 0; i < 200 * 1024; i++) {
+        buf_write[i] = (char)(i * 3);
+    }
+
+    rchainbuf_t* shared = NULL;
+    rchainbuf_init(shared, 0);
+    rchainbuf_set_slab_large(shared);
+    rchainbuf_t* sessions[4] = { NULL };
+    for (int i = 0; i < 4; i++) {
+        rchainbuf_init(sessions[i], 100 * 1024);
+    }
+
+    assert_true(rchainbuf_write_iov(shared, iov) == 1 && iov[0].len == rchainbuf_slab_large_size);
+    memcpy(iov[0].base, buf_write, 100);
+    rchainbuf_write_ext(shared, 100);
+    assert_true(rchainbuf_slice(shared, 100, &slice) == rchainbuf_code_ok && slice.slab->type == rchainbuf_slab_large);
+    assert_true(rchainbuf_slab_count(shared) == 0);//有slice引用的slab不保留
+    rchainbuf_slice_release(&slice);
+
+    rchainbuf_write(shared, buf_write, 100);
+    rchainbuf_read_ext(shared, 100);
+    assert_true(rchainbuf_empty(shared) && rchainbuf_slab_count(shared) == 1);//读空后保留一个slab
+
+    assert_true(rchainbuf_splice(sessions[0], shared) == rchainbuf_code_ok && rchainbuf_slab_count(sessions[0]) == 0);
+    rchainbuf_write(shared, buf_write, 100);
+    assert_true(rchainbuf_splice(sessions[0], shared) == rchainbuf_code_ok);//小残留拷贝到4K slab
+    assert_true(rchainbuf_slab_count(sessions[0]) == 1 && sessions[0]->head->type == rchainbuf_slab_small);
+    assert_true(rchainbuf_empty(shared) && rchainbuf_slab_count(shared) == 1);
+    rchainbuf_write(shared, buf_write + 100, 70000);
+    assert_true(rchainbuf_splice(sessions[0], shared) == rchainbuf_code_ok);//大残留直接转移slab
+    assert_true(rchainbuf_slab_count(shared) == 0 && rchainbuf_size(sessions[0]) == 70100);
+    assert_true(rchainbuf_peek(sessions[0], buf_read, 70100) == 70100 && memcmp(buf_read, buf_write, 70100) == 0);
+    rchainbuf_write(shared, buf_write, 40000);
+    assert_true(rchainbuf_splice(sessions[0], shared) == rchainbuf_code_full);
+    rchainbuf_clear(shared);
+    rchainbuf_clear(sessions[0]);
+
+    srand(17);
+    int produced[4] = { 0 };
+    int consumed[4] = { 0 };
+    start_benchmark(0);
+    for (int j = 0; j < count; j++) {//多个连接轮流经共享缓冲收包，残留的半帧留在各自的缓冲里
+        int index = rand() % 4;
+        rchainbuf_t* read_buff = rchainbuf_empty(sessions[index]) ? shared : sessions[index];
+        int size = 1 + rand() % 8000;
+        int seg = rchainbuf_write_iov(read_buff, iov);
+        int written = 0;
+        for (int i = 0; i < seg && written < size; i++) {
+            int len = (int)iov[i].len > size - written ? size - written : (int)iov[i].len;
+            for (int k = 0; k < len; k++) {
+                ((char*)iov[i].base)[k] = (char)((produced[index] + written + k) % 251);
+            }
+            written += len;
+        }
+        rchainbuf_write_ext(read_buff, written);
+        produced[index] += written;
+        while (produced[index] - consumed[index] >= 3000) {//按3000字节一帧消费
+            assert_true(rchainbuf_slice(read_buff, 3000, &slice) == rchainbuf_code_ok);
+            for (int k = 0; k < 3000; k++) {
+                assert_true(slice.data[k] == (char)((consumed[index] + k) % 251));
+            }
+            rchainbuf_slice_release(&slice);
+            consumed[index] += 3000;
+        }
+        if (read_buff == shared) {
+            assert_true(rchainbuf_splice(sessions[index], shared) == rchainbuf_code_ok);
+        }
+        assert_true(rchainbuf_empty(shared));
+        assert_true(rchainbuf_size(sessions[index]) == (rchainbuf_size_t)(produced[index] - consumed[index]));
+        assert_true(!rchainbuf_empty(sessions[index]) || rchainbuf_slab_count(sessions[index]) == 0);
+    }
+    end_benchmark("rchainbuf shared buffer splice.");
+
+    for (int i = 0; i < 4; i++) {
+        rchainbuf_free(sessions[i]);
+    }
+    rchainbuf_free(shared);
+    rchainbuf_thread_stats(&stats);
+    assert_true(stats.bytes_used == 0);
+    rstr_free(buf_read);
+    rstr_free(buf_write);
+
+    uninit_benchmark();
+}
+
+static void rchainbuf_bench_test(void **state) {// 小消息收发，对比rringbuf
+    (void)state;
+    int count = 200000;
+    int write_size = 300;
+    int j;
+    int64_t sum = 0;
+    char* buf_write = rstr_new(write_size);
+    char* buf_read = rstr_new(write_size);
+    rchainbuf_slice_t slice;
+    memset(buf_write, 1, write_size);
+
+    init_benchmark(1024, "test rchainbuf bench(%d)", count);
+
+    rringbuf_t* ring_ins = NULL;
+    rringbuf_init(ring_ins, 64 * 1024);
+    start_benchmark(0);
+    for (j = 0; j < count; j++) {
+        rringbuf_write(ring_ins, buf_write, write_size);
+        rringbuf_write(ring_ins, buf_write, write_size);
+        sum += rringbuf_read(ring_ins, buf_read, write_size);
+        sum += rringbuf_read(ring_ins, buf_read, write_size);
+    }
+    end_benchmark("rringbuf frame 300 copy out.");
+    rringbuf_free(ring_ins);
+
+    rchainbuf_t* chain_ins = NULL;
+    rchainbuf_init(chain_ins, 4 * 1024 * 1024);
+    start_benchmark(0);
+    for (j = 0; j < count; j++) {
+        rchainbuf_write(chain_ins, buf_write, write_size);
+        rchainbuf_write(chain_ins, buf_write, write_size);
+        sum -= rchainbuf_read(chain_ins, buf_read, write_size);
+        sum -= rchainbuf_read(chain_ins, buf_read, write_size);
+    }
+    end_benchmark("rchainbuf frame 300 copy out.");
+    assert_true(sum == 0);
+
+    start_benchmark(0);
+    for (j = 0; j < count; j++) {
+        rchainbuf_write(chain_ins, buf_write, write_size);
+        rchainbuf_write(chain_ins, buf_write, write_size);
+        rchainbuf_slice(chain_ins, write_size, &slice);
+        sum += slice.data[write_size - 1];
+        rchainbuf_slice_release(&slice);
+        rchainbuf_slice(chain_ins, write_size, &slice);
+        sum -= slice.data[write_size - 1];
+        rchainbuf_slice_release(&slice);
+    }
+    end_benchmark("rchainbuf frame 300 slice.");
+    assert_true(sum == 0 && rchainbuf_slab_count(chain_ins) == 0);
+
+    rchainbuf_free(chain_ins);
+    rstr_free(buf_read);
+    rstr_free(buf_write);
+
+    uninit_benchmark();
+}
+
+
 #ifdef __GNUC__
 #pragma GCC diagnostic pop
 #endif //__GNUC__
\ No newline at end of file
@@ -13,6 +13,9 @@
 #include "rtime.h"
 #include "rlist.h"
 #include "rdict.h"
+#include "rdict_typed.h"
+#include "rdict_sharded.h"
+#include "rthread.h"
 
 #include "rbase/common/test/rtest.h"
 
@@ -38,15 +41,32 @@
 //int result = 0;
 //result += cmocka_run_group_tests(test_group2, NULL, NULL);
 
+rdict_define_typed(rtest_u64_map, uint64_t, uint64_t)
+rdict_define_typed_full(rtest_str_map, const char*, int, rdict_typed_hash_string, rdict_typed_equal_string)
+
 static int init();
 static int uninit();
 
 static void rdict_int_test(void **state);
 static void rdict_string_test(void **state);
+static void rdict_engine_churn_test(void **state);
+static void rdict_engine_bench_test(void **state);
+static void rdict_rehash_test(void **state);
+static void rdict_typed_test(void **state);
+static void rdict_compact_test(void **state);
+static void rdict_sharded_test(void **state);
+static void rdict_string_hash_test(void **state);
 
 const static struct CMUnitTest tests[] = {
     cmocka_unit_test(rdict_int_test),
     cmocka_unit_test(rdict_string_test),
+    cmocka_unit_test(rdict_string_hash_test),
+    cmocka_unit_test(rdict_engine_churn_test),
+    cmocka_unit_test(rdict_engine_bench_test),
+    cmocka_unit_test(rdict_rehash_test),
+    cmocka_unit_test(rdict_typed_test),
+    cmocka_unit_test(rdict_compact_test),
+    cmocka_unit_test(rdict_sharded_test),
 };
 
 static int init() {
@@ -294,6 +314,604 @@ static void rdict_string_test(void **state) {// string类型 k-v
 }
 
 
+static void rdict_string_hash_test(void **state) {// 字符串hash和预算hash的key
+    (void)state;
+    int count = 100000;
+    int key_sizes[] = { 24, 272 };
+    char* key_names[] = { "short", "long" };
+    uint64_t hash_sum = 0;
+    int j;
+
+    init_benchmark(1024, "test rdict string hash(%d)", count);
+
+    assert_true(rhash_seed() != 0 && rhash_seed() == rhash_seed());
+    assert_true(rhash_func_bytes("funra", 5, 1) == rhash_func_bytes("funra", 5, 1));
+    assert_true(rhash_func_bytes("funra", 5, 1) != rhash_func_bytes("funra", 5, 2));
+    assert_true(rhash_func_bytes("funra", 5, 1) != rhash_func_bytes("funrb", 5, 1));
+    assert_true(rhash_func_bytes("funra", 5, 1) == 0xc6114a3f989039ceULL);//固定值，大小端结果一致
+    assert_true(rhash_func_bytes("funra-funra-funra-funra-funra-funra-funra-funra-funra-funra", 59, 1) == 0xcee288cd01ce8273ULL);
+    assert_true(rhash_func_string("funra") == rhash_func_bytes("funra", 5, rhash_seed()));
+
+    for (int k = 0; k < 2; k++) {
+        int key_size = key_sizes[k];
+        char* keys = (char*)rdata_new_size(count * key_size);
+        rstr_hkey_t* hkeys = rdata_new_type_array(rstr_hkey_t, count);
+        for (j = 0; j < count; j++) {//长key前缀相同，只有结尾不同
+            char* key = keys + j * key_size;
+            memset(key, 'k', key_size - 1);
+            snprintf(key + key_size - 17, 17, "session_%08d", j);
+        }
+        printf("%s key(%d), ", key_names[k], (int)strlen(keys));
+
+        start_benchmark(0);
+        for (j = 0; j < count; j++) {
+            hash_sum += rhash_func_murmur(keys + j * key_size);
+        }
+        end_benchmark("Hash with murmur.");
+
+        start_benchmark(0);
+        for (j = 0; j < count; j++) {
+            hash_sum += rhash_func_string(keys + j * key_size);
+        }
+        end_benchmark("Hash with wyhash.");
+
+        rdict_t* dict_str = NULL;
+        rdict_t* dict_hkey = NULL;
+        rdict_init(dict_str, rdata_type_string, rdata_type_uint64, 0, 0);
+        rdict_init(dict_hkey, rdata_type_hkey, rdata_type_uint64, 0, 0);
+        for (j = 0; j < count; j++) {
+            hkeys[j] = rstr_hkey_make(keys + j * key_size);
+            assert_true(rdict_add(dict_str, keys + j * key_size, j + 1) == rdict_code_ok);
+            assert_true(rdict_add(dict_hkey, &hkeys[j], j + 1) == rdict_code_ok);
+        }
+        assert_true(rdict_size(dict_str) == count && rdict_size(dict_hkey) == count);
+
+        start_benchmark(0);
+        for (j = 0; j < count; j++) {
+            rdict_entry_t* de = rdict_find(dict_str, keys + ((j * 7919) % count) * key_size);
+            assert_true(de != NULL && de->value.u64 == (j * 7919) % count + 1);
+        }
+        end_benchmark("Random access string keys.");
+
+        start_benchmark(0);
+        for (j = 0; j < count; j++) {
+            rdict_entry_t* de = rdict_find(dict_hkey, &hkeys[(j * 7919) % count]);
+            assert_true(de != NULL && de->value.u64 == (j * 7919) % count + 1);
+        }
+        end_benchmark("Random access prehashed keys.");
+
+        rstr_hkey_t hkey_missing = rstr_hkey_make("missing");
+        assert_true(rdict_find(dict_hkey, &hkey_missing) == NULL);
+        for (j = 0; j < count; j += 2) {
+            assert_true(rdict_remove(dict_hkey, &hkeys[j]) == rdict_code_ok);
+        }
+        assert_true(rdict_size(dict_hkey) == count / 2);
+        assert_true(rdict_find(dict_hkey, &hkeys[0]) == NULL && rdict_find(dict_hkey, &hkeys[1]) != NULL);
+
+        rdict_free(dict_str);
+        rdict_free(dict_hkey);
+        rdata_free_array(hkeys);
+        rdata_free(char, keys);
+    }
+    assert_true(hash_sum != 0);
+
+    uninit_benchmark();
+}
+
+
+static void rdict_engine_churn_test(void **state) {// 各引擎随机增删结果一致
+    (void)state;
+    int count = 200000;
+    int key_range = 5000;
+
+    init_benchmark(1024, "test rdict engine churn(%d)", count);
+
+    rdict_t* dict_bucket = NULL;
+    rdict_t* dict_swiss = NULL;
+    rdict_t* dict_compact = NULL;
+    rdict_init(dict_bucket, rdata_type_uint64, rdata_type_uint64, 0, 0);
+    rdict_init(dict_swiss, rdata_type_uint64, rdata_type_uint64, 0, 0);
+    rdict_init(dict_compact, rdata_type_uint64, rdata_type_uint64, 0, 0);
+    assert_true(rdict_set_engine(dict_bucket, rdict_engine_bucket) == rdict_code_ok);
+    assert_true(rdict_set_engine(dict_swiss, rdict_engine_swiss) == rdict_code_ok);
+    assert_true(rdict_set_engine(dict_compact, rdict_engine_compact) == rdict_code_ok);
+
+    start_benchmark(0);
+    for (int j = 0; j < count; j++) {
+        uint64_t key = (uint64_t)(rand() % key_range);
+        int op = rand() % 3;
+        if (op == 0) {
+            int code_remove = rdict_remove(dict_bucket, key);
+            assert_true(code_remove == rdict_remove(dict_swiss, key));
+            assert_true(code_remove == rdict_remove(dict_compact, key));
+        } else {
+            assert_true(rdict_add(dict_bucket, key, key + j) == rdict_code_ok);
+            assert_true(rdict_add(dict_swiss, key, key + j) == rdict_code_ok);
+            assert_true(rdict_add(dict_compact, key, key + j) == rdict_code_ok);
+        }
+        assert_true(rdict_size(dict_bucket) == rdict_size(dict_swiss));
+        assert_true(rdict_size(dict_bucket) == rdict_size(dict_compact));
+    }
+    for (uint64_t key = 0; key < key_range; key++) {
+        rdict_entry_t* de_bucket = rdict_find(dict_bucket, key);
+        rdict_entry_t* de_swiss = rdict_find(dict_swiss, key);
+        rdict_entry_t* de_compact = rdict_find(dict_compact, key);
+        assert_true((de_bucket == NULL) == (de_swiss == NULL));
+        assert_true((de_bucket == NULL) == (de_compact == NULL));
+        assert_true(de_bucket == NULL || de_bucket->value.u64 == de_swiss->value.u64);
+        assert_true(de_bucket == NULL || de_bucket->value.u64 == de_compact->value.u64);
+    }
+    int iter_count = 0;
+    rdict_iterator_t it = rdict_it(dict_swiss);
+    for (rdict_entry_t *de = NULL; (de = rdict_next(&it)) != NULL; ) {
+        assert_true(rdict_find(dict_bucket, de->key.u64) != NULL);
+        iter_count++;
+    }
+    assert_true(iter_count == rdict_size(dict_swiss));
+    iter_count = 0;
+    rdict_iterator_t it_compact = rdict_it(dict_compact);
+    for (rdict_entry_t *de = NULL; (de = rdict_next(&it_compact)) != NULL; ) {
+        assert_true(rdict_find(dict_bucket, de->key.u64) != NULL);
+        iter_count++;
+    }
+    assert_true(iter_count == rdict_size(dict_compact));
+    end_benchmark("Random add/remove on all engines.");
+
+    assert_true(rdict_set_engine(dict_swiss, rdict_engine_bucket) != rdict_code_ok);//非空不能切换
+
+    rdict_free(dict_bucket);
+    rdict_free(dict_swiss);
+    rdict_free(dict_compact);
+
+    uninit_benchmark();
+}
+
+static void rdict_engine_bench_test(void **state) {// 各引擎对比
+    (void)state;
+    int counts[] = { 1000000, 10000000 };
+    rdict_engine_t engines[] = { rdict_engine_bucket, rdict_engine_swiss, rdict_engine_compact };
+    char* engine_names[] = { "bucket", "swiss", "compact" };
+    uint64_t j;
+
+    init_benchmark(1024, "test rdict engine");
+
+    for (int c = 0; c < 2; c++) {
+        uint64_t count = (uint64_t)counts[c];
+
+        for (int e = 0; e < 3; e++) {
+            rdict_t* dict_ins = NULL;
+            rdict_init(dict_ins, rdata_type_uint64, rdata_type_uint64, 0, 0);
+            assert_true(rdict_set_engine(dict_ins, engines[e]) == rdict_code_ok);
+            printf("%s(%"PRIu64"), ", engine_names[e], count);
+
+            start_benchmark(0);
+            for (j = 1; j <= count; j++) {
+                rdict_add(dict_ins, j, j);
+            }
+            assert_true(rdict_size(dict_ins) == count);
+            end_benchmark("Fill map.");
+
+            start_benchmark(0);
+            for (j = 1; j <= count; j++) {
+                rdict_entry_t *de = rdict_find(dict_ins, (j * 7919) % count + 1);
+                assert_true(de != NULL);
+            }
+            end_benchmark("Random access existing elements");
+
+            start_benchmark(0);
+            for (j = count + 1; j <= count * 2; j++) {
+                assert_true(rdict_find(dict_ins, j) == NULL);
+            }
+            end_benchmark("Access missing keys");
+
+            start_benchmark(0);
+            uint64_t iter_count = 0;
+            rdict_iterator_t it = rdict_it(dict_ins);
+            for (rdict_entry_t *de = NULL; (de = rdict_next(&it)) != NULL; ) {
+                iter_count++;
+            }
+            assert_true(iter_count == count);
+            end_benchmark("Iterator map.");
+
+            start_benchmark(0);
+            for (j = 1; j <= count; j++) {
+                assert_true(rdict_remove(dict_ins, j) == rdict_code_ok);
+            }
+            assert_true(rdict_size(dict_ins) == 0);
+            end_benchmark("Remove all keys");
+
+            rdict_free(dict_ins);
+        }
+    }
+
+    uninit_benchmark();
+}
+
+static void rdict_rehash_test(void **state) {// 渐进rehash
+    (void)state;
+    uint64_t count = 1000000;
+    uint64_t j;
+    int64_t time_start = 0;
+    int64_t time_cost = 0;
+    int64_t time_max[2] = { 0, 0 };
+    rdict_engine_t engines[] = { rdict_engine_bucket, rdict_engine_swiss };
+
+    init_benchmark(1024, "test rdict rehash(%"PRIu64")", count);
+
+    rdict_t* dict_ins = NULL;
+    rdict_init(dict_ins, rdata_type_uint64, rdata_type_uint64, 0, 0);
+
+    start_benchmark(0);
+    for (j = 1; !rdict_rehashing(dict_ins); j++) {
+        assert_true(rdict_add(dict_ins, j, j) == rdict_code_ok);
+    }
+    uint64_t added = j - 1;
+    for (j = 1; j <= added; j++) {//新旧两表都能查到
+        rdict_entry_t* de = rdict_find(dict_ins, j);
+        assert_true(de != NULL && de->value.u64 == j);
+        if (j % 3 == 0) {
+            assert_true(rdict_remove(dict_ins, j) == rdict_code_ok);
+        }
+        if (!rdict_rehashing(dict_ins)) {
+            break;
+        }
+    }
+    end_benchmark("Find and remove while rehashing.");
+
+    rdict_clear(dict_ins);
+    assert_true(!rdict_rehashing(dict_ins));
+    for (j = 1; !rdict_rehashing(dict_ins); j++) {
+        rdict_add(dict_ins, j, j);
+    }
+    added = j - 1;
+    int64_t rehash_index = dict_ins->rehash_index;
+    rdict_entry_t* de_first = rdict_find(dict_ins, 1);
+    for (j = 1; j <= added; j++) {//find不迁移，之前返回的entry不失效
+        assert_true(rdict_find(dict_ins, j) != NULL);
+    }
+    assert_true(dict_ins->rehash_index == rehash_index && rdict_find(dict_ins, 1) == de_first);
+    uint64_t iter_count = 0;
+    rdict_iterator_t it = rdict_it(dict_ins);
+    for (rdict_entry_t *de = NULL; (de = rdict_next(&it)) != NULL; ) {
+        assert_true(de->key.u64 == de->value.u64);
+        iter_count++;
+    }
+    assert_true(iter_count == added);
+    assert_true(rdict_rehash_step(dict_ins, 1000000) == 0 && !rdict_rehashing(dict_ins));
+    rdict_free(dict_ins);
+
+    for (int e = 0; e < 2; e++) {
+        dict_ins = NULL;
+        rdict_init(dict_ins, rdata_type_uint64, rdata_type_uint64, 0, 0);
+        assert_true(rdict_set_engine(dict_ins, engines[e]) == rdict_code_ok);
+
+        start_benchmark(0);
+        for (j = 1; j <= count; j++) {
+            time_start = rtime_nanosec();
+            rdict_add(dict_ins, j, j);
+            time_cost = rtime_nanosec() - time_start;
+            if (time_cost > time_max[e]) {
+                time_max[e] = time_cost;
+            }
+        }
+        for (j = 1; j <= count; j++) {
+            assert_true(rdict_find(dict_ins, j) != NULL);
+        }
+        printf("engine(%d) max add cost: %"PRId64" us, ", engines[e], time_max[e] / 1000);
+        end_benchmark("Fill map.");
+
+        rdict_free(dict_ins);
+    }
+
+    uninit_benchmark();
+}
+
+static void rdict_typed_test(void **state) {// 特化类型与通用rdict对比
+    (void)state;
+    uint64_t count = 1000000;
+    uint64_t j;
+    int key_range = 5000;
+
+    init_benchmark(1024, "test rdict typed(%"PRIu64")", count);
+
+    rtest_u64_map_t* map_typed = rtest_u64_map_create(0);
+    rdict_t* dict_ins = NULL;
+    rdict_init(dict_ins, rdata_type_uint64, rdata_type_uint64, 0, 0);
+
+    for (j = 0; j < 200000; j++) {
+        uint64_t key = (uint64_t)(rand() % key_range) + 1;
+        if (rand() % 3 == 0) {
+            assert_true(rtest_u64_map_remove(map_typed, key) == rdict_remove(dict_ins, key));
+        } else {
+            assert_true(rtest_u64_map_add(map_typed, key, key + j) == rdict_code_ok);
+            rdict_add(dict_ins, key, key + j);
+        }
+        assert_true(rdict_typed_size(map_typed) == rdict_size(dict_ins));
+    }
+    int iter_count = 0;
+    rtest_u64_map_entry_t* entry = NULL;
+    rdict_typed_foreach(rtest_u64_map, map_typed, entry) {
+        rdict_entry_t* de = rdict_find(dict_ins, entry->key);
+        assert_true(de != NULL && de->value.u64 == entry->value);
+        iter_count++;
+    }
+    assert_true(iter_count == rdict_size(dict_ins));
+    rtest_u64_map_clear(map_typed);
+    rdict_clear(dict_ins);
+    assert_true(rdict_typed_size(map_typed) == 0 && rtest_u64_map_find(map_typed, 1) == NULL);
+
+    start_benchmark(0);
+    for (j = 1; j <= count; j++) {
+        rdict_add(dict_ins, j, j);
+    }
+    for (j = 1; j <= count; j++) {
+        assert_true(rdict_find(dict_ins, (j * 7919) % count + 1) != NULL);
+    }
+    end_benchmark("rdict fill and random access.");
+
+    start_benchmark(0);
+    for (j = 1; j <= count; j++) {
+        rtest_u64_map_add(map_typed, j, j);
+    }
+    for (j = 1; j <= count; j++) {
+        assert_true(rtest_u64_map_find(map_typed, (j * 7919) % count + 1) != NULL);
+    }
+    end_benchmark("typed fill and random access.");
+
+    rdict_free(dict_ins);
+    rtest_u64_map_release(map_typed);
+
+    rtest_str_map_t map_str;
+    assert_true(rtest_str_map_init(&map_str, 16) == rdict_code_ok);
+    assert_true(rtest_str_map_add(&map_str, "key1", 1) == rdict_code_ok);
+    assert_true(rtest_str_map_add(&map_str, "key2", 2) == rdict_code_ok);
+    assert_true(rtest_str_map_add(&map_str, "key1", 3) == rdict_code_ok);
+    assert_true(rdict_typed_size(&map_str) == 2 && rtest_str_map_find(&map_str, "key1")->value == 3);
+    assert_true(rtest_str_map_remove(&map_str, "key3") == rdict_code_not_exist);
+    rtest_str_map_uninit(&map_str);
+
+    uninit_benchmark();
+}
+
+static void rdict_compact_test(void **state) {// 插入顺序紧凑布局
+    (void)state;
+    int count = 1000000;
+    int keep = count / 100;
+    rdict_engine_t engines[] = { rdict_engine_swiss, rdict_engine_compact };
+    char* engine_names[] = { "swiss", "compact" };
+    uint64_t j;
+
+    init_benchmark(1024, "test rdict compact(%d)", count);
+
+    rdict_t* dict_ins = NULL;
+    rdict_init(dict_ins, rdata_type_uint64, rdata_type_uint64, 0, 0);
+    assert_true(rdict_set_engine(dict_ins, rdict_engine_compact) == rdict_code_ok);
+    for (j = 0; j < 1000; j++) {
+        assert_true(rdict_add(dict_ins, (j * 7919) % 1000 + 1, j) == rdict_code_ok);
+    }
+    assert_true(rdict_add(dict_ins, 1, 5000) == rdict_code_ok);//覆盖不改变顺序
+    for (j = 0; j < 1000; j += 3) {
+        assert_true(rdict_remove(dict_ins, (j * 7919) % 1000 + 1) == rdict_code_ok);
+    }
+    assert_true(rdict_remove(dict_ins, 1001) == rdict_code_not_exist);
+    uint64_t last = 0;
+    rdict_iterator_t it = rdict_it(dict_ins);
+    for (rdict_entry_t *de = NULL; (de = rdict_next(&it)) != NULL; ) {
+        assert_true(de->key.u64 == 1 ? de->value.u64 == 5000 : de->value.u64 > last);
+        assert_true(de->value.u64 % 3 != 0);
+        if (de->key.u64 != 1) {
+            last = de->value.u64;
+        }
+    }
+    rdict_free(dict_ins);
+
+    for (int e = 0; e < 2; e++) {//大量删除后遍历
+        rdict_init(dict_ins, rdata_type_uint64, rdata_type_uint64, 0, 0);
+        assert_true(rdict_set_engine(dict_ins, engines[e]) == rdict_code_ok);
+        for (j = 1; j <= count; j++) {
+            rdict_add(dict_ins, j, j);
+        }
+        uint64_t bytes_full = e == 0 ? (uint64_t)dict_ins->capacity * (sizeof(rdict_entry_t) + 1) :
+            (uint64_t)dict_ins->capacity * sizeof(rdict_entry_t) + dict_ins->indices_capacity * sizeof(int32_t);
+        for (j = keep + 1; j <= count; j++) {
+            assert_true(rdict_remove(dict_ins, j) == rdict_code_ok);
+        }
+        uint64_t bytes_keep = e == 0 ? (uint64_t)dict_ins->capacity * (sizeof(rdict_entry_t) + 1) :
+            (uint64_t)dict_ins->capacity * sizeof(rdict_entry_t) + dict_ins->indices_capacity * sizeof(int32_t);
+        printf("%s memory: %"PRIu64" -> %"PRIu64" bytes, ", engine_names[e], bytes_full, bytes_keep);
+        if (engines[e] == rdict_engine_compact) {
+            assert_true(bytes_keep * 10 < bytes_full);
+        }
+
+        start_benchmark(0);
+        uint64_t iter_count = 0;
+        for (int i = 0; i < 100; i++) {
+            rdict_iterator_t it_keep = rdict_it(dict_ins);
+            for (rdict_entry_t *de = NULL; (de = rdict_next(&it_keep)) != NULL; ) {
+                iter_count++;
+            }
+        }
+        assert_true(iter_count == (uint64_t)keep * 100);
+        end_benchmark("Iterator 100 times after mass removal.");
+
+        rdict_free(dict_ins);
+    }
+
+    rdict_init(dict_ins, rdata_type_string, rdata_type_string, 0, 0);
+    assert_true(rdict_set_engine(dict_ins, rdict_engine_compact) == rdict_code_ok);
+    char key[32];
+    for (j = 0; j < 200; j++) {
+        snprintf(key, sizeof(key), "key_%"PRIu64, j);
+        assert_true(rdict_add(dict_ins, key, "value") == rdict_code_ok);
+    }
+    for (j = 0; j < 200; j += 2) {
+        snprintf(key, sizeof(key), "key_%"PRIu64, j);
+        assert_true(rdict_remove(dict_ins, key) == rdict_code_ok);
+    }
+    assert_true(rdict_size(dict_ins) == 100);
+    assert_true(rdict_find(dict_ins, "key_1") != NULL && rdict_find(dict_ins, "key_2") == NULL);
+    rdict_clear(dict_ins);
+    assert_true(rdict_size(dict_ins) == 0 && rdict_find(dict_ins, "key_1") == NULL);
+    assert_true(rdict_add(dict_ins, "key_1", "value") == rdict_code_ok);
+    rdict_free(dict_ins);
+
+    uninit_benchmark();
+}
+
+#define rtest_sharded_thread_count 4
+
+typedef struct rtest_sharded_arg_s {
+    rdict_sharded_t* map_sharded;
+    rdict_t* map_locked;//对比用，整表一把锁
+    rmutex_t* lock;
+    uint64_t key_start;
+    uint64_t count;
+    uint64_t found;
+} rtest_sharded_arg_t;
+
+static void* rdict_sharded_thread_func(void* arg) {
+    rtest_sharded_arg_t* test_arg = (rtest_sharded_arg_t*)arg;
+    uint64_t key_end = test_arg->key_start + test_arg->count;
+    void* value = NULL;
+
+    for (uint64_t key = test_arg->key_start; key < key_end; key++) {
+        if (test_arg->map_sharded != NULL) {
+            rdict_sharded_add(test_arg->map_sharded, (void*)key, (void*)(key * 2));
+        } else {
+            rmutex_lock(test_arg->lock);
+            rdict_add(test_arg->map_locked, (void*)key, (void*)(key * 2));
+            rmutex_unlock(test_arg->lock);
+        }
+    }
+    for (uint64_t key = test_arg->key_start; key < key_end; key++) {
+        if (test_arg->map_sharded != NULL) {
+            if (rdict_sharded_find(test_arg->map_sharded, (void*)key, &value) == rdict_code_ok && (uint64_t)value == key * 2) {
+                test_arg->found++;
+            }
+        } else {
+            rmutex_lock(test_arg->lock);
+            rdict_entry_t* de = rdict_find(test_arg->map_locked, (void*)key);
+            if (de != NULL && de->value.u64 == key * 2) {
+                test_arg->found++;
+            }
+            rmutex_unlock(test_arg->lock);
+        }
+    }
+    for (uint64_t key = test_arg->key_start; key < key_end; key += 2) {
+        if (test_arg->map_sharded != NULL) {
+            rdict_sharded_remove(test_arg->map_sharded, (void*)key);
+        } else {
+            rmutex_lock(test_arg->lock);
+            rdict_remove(test_arg->map_locked, (void*)key);
+            rmutex_unlock(test_arg->lock);
+        }
+    }
+
+    return arg;
+}
+
+static void* rdict_sharded_take_func(void* arg) {//同一批key并发take，每个key只有一个线程取到
+    rtest_sharded_arg_t* test_arg = (rtest_sharded_arg_t*)arg;
+    uint64_t key_end = test_arg->key_start + test_arg->count;
+    void* value = NULL;
+
+    for (uint64_t key = test_arg->key_start; key < key_end; key++) {
+        if (rdict_sharded_find(test_arg->map_sharded, (void*)key, NULL) == rdict_code_ok &&
+            rdict_sharded_take(test_arg->map_sharded, (void*)key, &value) == rdict_code_ok) {
+            test_arg->found++;
+        }
+    }
+
+    return arg;
+}
+
+static void rdict_sharded_count_func(void* data_ext, const rdict_entry_t* de) {
+    if (de->value.u64 == de->key.u64 * 2) {
+        (*(uint64_t*)data_ext)++;
+    }
+}
+
+static void rdict_sharded_test(void **state) {// 多线程分片表
+    (void)state;
+    uint64_t count = 200000;
+    rthread_t threads[rtest_sharded_thread_count];
+    rtest_sharded_arg_t args[rtest_sharded_thread_count];
+    rmutex_t lock;
+    void* ret = NULL;
+
+    init_benchmark(1024, "test rdict sharded(%"PRIu64" * %d)", count, rtest_sharded_thread_count);
+
+    rdict_sharded_t* map_sharded = NULL;
+    rdict_sharded_init(map_sharded, rdata_type_uint64, rdata_type_uint64, 0, 0);
+    assert_true(map_sharded->shard_count == rdict_sharded_count_default);
+    rdict_t* map_locked = NULL;
+    rdict_init(map_locked, rdata_type_uint64, rdata_type_uint64, 0, 0);
+    rmutex_init(&lock);
+
+    for (int m = 0; m < 2; m++) {
+        start_benchmark(0);
+        for (int i = 0; i < rtest_sharded_thread_count; i++) {
+            args[i].map_sharded = m == 0 ? map_sharded : NULL;
+            args[i].map_locked = map_locked;
+            args[i].lock = &lock;
+            args[i].key_start = i * count + 1;
+            args[i].count = count;
+            args[i].found = 0;
+            rthread_init(&threads[i]);
+            assert_true(rthread_start(&threads[i], rdict_sharded_thread_func, &args[i]) == 0);
+        }
+        for (int i = 0; i < rtest_sharded_thread_count; i++) {
+            assert_true(rthread_join(&threads[i], &ret) == 0);
+            assert_true(args[i].found == count);
+        }
+        if (m == 0) {
+            end_benchmark("Add/find/remove with shard locks.");
+        } else {
+            end_benchmark("Add/find/remove with one lock.");
+        }
+    }
+    assert_true(rdict_sharded_size(map_sharded) == rdict_size(map_locked));
+    assert_true(rdict_sharded_size(map_sharded) == count / 2 * rtest_sharded_thread_count);
+
+    uint64_t scan_count = 0;
+    rdict_sharded_scan(map_sharded, rdict_sharded_count_func, &scan_count);
+    assert_true(scan_count == count / 2 * rtest_sharded_thread_count);
+
+    void* value = NULL;
+    assert_true(rdict_sharded_find(map_sharded, (void*)1, NULL) == rdict_code_not_exist);
+    assert_true(rdict_sharded_take(map_sharded, (void*)2, &value) == rdict_code_ok && (uint64_t)value == 4);
+    assert_true(rdict_sharded_find(map_sharded, (void*)2, &value) == rdict_code_not_exist);
+    assert_true(rdict_sharded_add(map_sharded, NULL, (void*)1) == rdict_code_ok);
+    assert_true(rdict_sharded_find(map_sharded, NULL, &value) == rdict_code_ok && (uint64_t)value == 1);
+
+    rdict_sharded_clear(map_sharded);
+    assert_true(rdict_sharded_size(map_sharded) == 0);
+
+    for (uint64_t key = 1; key <= count; key++) {
+        rdict_sharded_add(map_sharded, (void*)key, (void*)(key * 2));
+    }
+    uint64_t taken = 0;
+    for (int i = 0; i < rtest_sharded_thread_count; i++) {
+        args[i].map_sharded = map_sharded;
+        args[i].key_start = 1;
+        args[i].count = count;
+        args[i].found = 0;
+        rthread_init(&threads[i]);
+        assert_true(rthread_start(&threads[i], rdict_sharded_take_func, &args[i]) == 0);
+    }
+    for (int i = 0; i < rtest_sharded_thread_count; i++) {
+        assert_true(rthread_join(&threads[i], &ret) == 0);
+        taken += args[i].found;
+    }
+    assert_true(taken == count && rdict_sharded_size(map_sharded) == 0);
+
+    rdict_sharded_free(map_sharded);
+    rdict_free(map_locked);
+    rmutex_uninit(&lock);
+
+    uninit_benchmark();
+}
+
 #ifdef __GNUC__
 #pragma GCC diagnostic pop
-#endif //__GNUC__
\ No newline at end of file
+#endif //__GNUC__
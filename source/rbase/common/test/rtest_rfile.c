@@ -13,6 +13,7 @@
 #include "rtime.h"
 #include "rlist.h"
 #include "rfile.h"
+#include "rmapfile.h"
 
 #include "rbase/common/test/rtest.h"
 
@@ -72,6 +73,60 @@ static void rfile_full_test(void **state) {
 }
 
 
+static void rmapfile_test(void **state) {// 跨窗口写入，关闭后按实际长度截断
+    (void)state;
+    int count = 100000;
+    char* filepath = rfile_get_filepath(dir_path, "mapfile.data");
+    char line[64];
+    int64_t size = 0;
+
+    init_benchmark(1024, "test rmapfile (%d)", count);
+
+    rmapfile_t* map_file = rmapfile_open(filepath, 10000);//按页对齐
+#if defined(__linux__)
+    assert_true(map_file != NULL && map_file->window_size % 4096 == 0 && map_file->window_size >= 10000);
+
+    start_benchmark(0);
+    for (int i = 0; i < count; i++) {
+        int len = snprintf(line, sizeof(line), "rmapfile line %d\n", i);
+        assert_true(rmapfile_write(map_file, line, len) == rcode_ok);
+        size += len;
+    }
+    end_benchmark("rmapfile write lines.");
+    assert_true(rmapfile_size(map_file) == size && map_file->capacity >= size);
+    assert_true(rmapfile_write(map_file, line, 0) == rcode_ok);
+    assert_true(rmapfile_flush(map_file, true) == rcode_ok);
+    assert_true(rmapfile_close(map_file) == rcode_ok);
+
+    FILE* file_ptr = fopen(filepath, "rb");
+    assert_true(file_ptr != NULL);
+    fseek(file_ptr, 0, SEEK_END);
+    assert_true(ftell(file_ptr) == size);
+    rewind(file_ptr);
+    char read_line[64];
+    for (int i = 0; i < count; i++) {
+        snprintf(line, sizeof(line), "rmapfile line %d\n", i);
+        assert_true(fgets(read_line, sizeof(read_line), file_ptr) != NULL && rstr_eq(read_line, line));
+    }
+    assert_true(fgets(read_line, sizeof(read_line), file_ptr) == NULL);
+    fclose(file_ptr);
+
+    map_file = rmapfile_open(filepath, 0);//重新打开时清空
+    assert_true(map_file != NULL && rmapfile_size(map_file) == 0);
+    assert_true(rmapfile_close(map_file) == rcode_ok);
+    file_ptr = fopen(filepath, "rb");
+    fseek(file_ptr, 0, SEEK_END);
+    assert_true(ftell(file_ptr) == 0);
+    fclose(file_ptr);
+#else
+    assert_true(map_file == NULL);
+#endif
+    rfile_remove(filepath);
+    rstr_free(filepath);
+
+    uninit_benchmark();
+}
+
 static int setup(void **state) {
     int *answer = malloc(sizeof(int));
     assert_non_null(answer);
@@ -95,6 +150,7 @@ static int teardown(void **state) {
 }
 static struct CMUnitTest test_group2[] = {
     cmocka_unit_test_setup_teardown(rfile_full_test, NULL, NULL),
+    cmocka_unit_test_setup_teardown(rmapfile_test, NULL, NULL),
 };
 
 int run_rfile_tests(int benchmark_output) {
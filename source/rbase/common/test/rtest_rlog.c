@@ -14,6 +14,7 @@
 #include "rlist.h"
 #include "rdict.h"
 #include "rfile.h"
+#include "rtools.h"
 
 #include "rbase/common/test/rtest.h"
 
@@ -43,6 +44,613 @@ static void rlog_full_test(void **state) {
     uninit_benchmark();
 }
 
+#define rtest_rlog_async_threads 4
+#define rtest_rlog_async_count 10000
+#define rtest_rlog_async_prefix "rtest_async_"
+#define rtest_rlog_async_pad "0123456789abcdefghijklmnopqrstuvwxyz0123456789abcdefghijklmnopqrstuvwxyz0123456789abcdefghijklmnopqrstuvwxyz"
+
+static rlog_t* rtest_rlog_async_ins = NULL;
+static int rtest_rlog_async_phase = 0;
+
+static void* rlog_async_print_func(void* arg) {
+    int index = (int)(int64_t)arg;
+    for (int i = 0; i < rtest_rlog_async_count; i++) {
+        rlog_printf(rtest_rlog_async_ins, rlog_level_info, "async %d %d %d %s\n", rtest_rlog_async_phase, index, i, rtest_rlog_async_pad);
+    }
+    return NULL;
+}
+
+static void rlog_async_run_threads(int phase) {
+    rthread_t threads[rtest_rlog_async_threads];
+    void* ret = NULL;
+
+    rtest_rlog_async_phase = phase;
+    for (int i = 0; i < rtest_rlog_async_threads; i++) {
+        rthread_init(&threads[i]);
+        assert_true(rthread_start(&threads[i], rlog_async_print_func, (void*)(int64_t)i) == 0);
+    }
+    for (int i = 0; i < rtest_rlog_async_threads; i++) {
+        assert_true(rthread_join(&threads[i], &ret) == 0);
+    }
+}
+
+//统计目录下所有滚动文件中每条日志出现的次数
+static void rlog_async_read_files(const char* dir, char* seen, int* phase_counts) {
+    char line[256];
+    int phase, index, seq;
+    rlist_t* file_list = rdir_list(dir, true, false);
+    rlist_iterator_t it = rlist_it(file_list, rlist_dir_tail);
+    rlist_node_t* node = NULL;
+
+    while ((node = rlist_next(&it))) {
+        if (rstr_index((char*)(node->val), rtest_rlog_async_prefix) != 0) {
+            continue;
+        }
+        char* filepath = rfile_get_filepath(dir, (char*)(node->val));
+        FILE* file_ptr = fopen(filepath, "r");
+        assert_true(file_ptr != NULL);
+        while (fgets(line, sizeof(line), file_ptr) != NULL) {
+            char* data = strstr(line, "] async ");
+            if (data == NULL) {
+                continue;
+            }
+            assert_true(sscanf(data, "] async %d %d %d", &phase, &index, &seq) == 3);
+            seen[(phase * (rtest_rlog_async_threads + 1) + index) * rtest_rlog_async_count + seq]++;
+            phase_counts[phase]++;
+        }
+        fclose(file_ptr);
+        rstr_free(filepath);
+    }
+    rlist_destroy(file_list);
+}
+
+static void rlog_async_test(void **state) {// 多线程异步写，1M滚动，检查不丢不重
+    (void)state;
+    const char* dir = "./logs/local";
+    int seen_size = 3 * (rtest_rlog_async_threads + 1) * rtest_rlog_async_count;
+    char* seen = (char*)calloc(seen_size, 1);
+    int phase_counts[3] = { 0 };
+    rlog_async_stats_t stats;
+
+    init_benchmark(1024, "test rlog async (%d * %d)", rtest_rlog_async_threads, rtest_rlog_async_count);
+
+    rlist_t* file_list = rdir_list(dir, true, false);//清掉上次的文件
+    rlist_iterator_t it = rlist_it(file_list, rlist_dir_tail);
+    rlist_node_t* node = NULL;
+    while ((node = rlist_next(&it))) {
+        if (rstr_index((char*)(node->val), rtest_rlog_async_prefix) == 0) {
+            char* filepath = rfile_get_filepath(dir, (char*)(node->val));
+            rfile_remove(filepath);
+            rstr_free(filepath);
+        }
+    }
+    rlist_destroy(file_list);
+
+    rtest_rlog_async_ins = rdata_new(rlog_t);
+    memset(rtest_rlog_async_ins, 0, sizeof(rlog_t));
+    assert_true(rlog_init_log(rtest_rlog_async_ins, "./logs/local/"rtest_rlog_async_prefix"${index}.log", rlog_level_all, false, 1) == rcode_ok);
+    assert_true(rlog_async_stats(rtest_rlog_async_ins, &stats) == rcode_invalid);
+
+    start_benchmark(0);
+    for (int i = 0; i < rtest_rlog_async_count; i++) {
+        rlog_printf(rtest_rlog_async_ins, rlog_level_info, "async %d %d %d %s\n", 0, rtest_rlog_async_threads, i, rtest_rlog_async_pad);//同步模式下也会滚动
+    }
+    end_benchmark("sync print in main thread.");
+
+    assert_true(rlog_start_async(rtest_rlog_async_ins, rlog_overflow_block, false) == rcode_ok);
+    assert_true(rlog_start_async(rtest_rlog_async_ins, rlog_overflow_block, false) == rcode_invalid);
+    start_benchmark(0);
+    rlog_async_run_threads(1);
+    end_benchmark("async print in threads, block.");
+    assert_true(rlog_async_stats(rtest_rlog_async_ins, &stats) == rcode_ok);
+    assert_true(stats.dropped == 0 && stats.queues == rtest_rlog_async_threads);
+    assert_true(rlog_stop_async(rtest_rlog_async_ins) == rcode_ok);
+    assert_true(rtest_rlog_async_ins->async == NULL);
+
+    assert_true(rlog_start_async(rtest_rlog_async_ins, rlog_overflow_count, false) == rcode_ok);
+    rlog_async_run_threads(2);
+    for (int i = 0; i < 5000; i++) {//等写线程取完
+        rlog_async_stats(rtest_rlog_async_ins, &stats);
+        if (stats.records + stats.dropped == rtest_rlog_async_threads * rtest_rlog_async_count) {
+            break;
+        }
+        rtools_wait_mills(1);
+    }
+    assert_true(stats.records + stats.dropped == rtest_rlog_async_threads * rtest_rlog_async_count);
+    int64_t records = stats.records;
+
+    assert_true(rlog_uninit_log(rtest_rlog_async_ins) == rcode_ok);//自动停止异步
+    rtest_rlog_async_ins = NULL;
+
+    rlog_async_read_files(dir, seen, phase_counts);
+    assert_true(phase_counts[0] == rtest_rlog_async_count);
+    assert_true(phase_counts[1] == rtest_rlog_async_threads * rtest_rlog_async_count);
+    assert_true(phase_counts[2] == records);
+    for (int i = 0; i < seen_size; i++) {
+        assert_true(seen[i] <= 1);
+    }
+    for (int i = 0; i < 2 * (rtest_rlog_async_threads + 1) * rtest_rlog_async_count; i++) {
+        int index = (i / rtest_rlog_async_count) % (rtest_rlog_async_threads + 1);
+        int phase = i / ((rtest_rlog_async_threads + 1) * rtest_rlog_async_count);
+        assert_true(seen[i] == ((phase == 0) == (index == rtest_rlog_async_threads)));
+    }
+
+    free(seen);
+
+    uninit_benchmark();
+}
+
+#define rtest_rlog_binary_prefix "rtest_binary_"
+#define rtest_rlog_binary_count 100000
+
+//同时按文本格式化到expect，dump出来应完全一致
+#define rtest_rlog_binary_print(rlog, expect, format, ...) \
+    do { \
+        rlog_site_printf((rlog), rlog_level_info, format, ##__VA_ARGS__); \
+        snprintf((expect) + strlen(expect), 4096 - strlen(expect), format"\n", ##__VA_ARGS__); \
+    } while (0)
+
+static void rlog_binary_test(void **state) {// 二进制记录参数，rlog_binary_dump还原
+    (void)state;
+    const char* dir = "./logs/local";
+    char* expect = (char*)calloc(4096, 1);
+    char* got = (char*)calloc(4096, 1);
+    char line[4096];
+    const char* str_null = NULL;
+    rlog_async_stats_t stats;
+
+    init_benchmark(1024, "test rlog binary (%d)", rtest_rlog_binary_count);
+
+    rlist_t* file_list = rdir_list(dir, true, false);
+    rlist_iterator_t it = rlist_it(file_list, rlist_dir_tail);
+    rlist_node_t* node = NULL;
+    while ((node = rlist_next(&it))) {
+        if (rstr_index((char*)(node->val), rtest_rlog_binary_prefix) == 0) {
+            char* filepath = rfile_get_filepath(dir, (char*)(node->val));
+            rfile_remove(filepath);
+            rstr_free(filepath);
+        }
+    }
+    rlist_destroy(file_list);
+
+    rlog_t* binary_ins = rdata_new(rlog_t);
+    memset(binary_ins, 0, sizeof(rlog_t));
+    assert_true(rlog_init_log(binary_ins, "./logs/local/"rtest_rlog_binary_prefix"${index}.log", rlog_level_all, false, 1) == rcode_ok);
+    rlog_printf(binary_ins, rlog_level_info, "text before binary.\n");
+    assert_true(rlog_start_async(binary_ins, rlog_overflow_block, true) == rcode_ok);
+
+    rtest_rlog_binary_print(binary_ins, expect, "int %d %u %ld %lld %"PRId64" %x %hd %hhu %zu", -1, 3000000000u, -5L,
+        1LL << 40, (int64_t)-7, 255, (short)-2, (unsigned char)200, sizeof(rlog_site_t));
+    rtest_rlog_binary_print(binary_ins, expect, "float %5.2f %e %g %Lf", 3.14159, 1e-10, 0.5, (long double)2.5);
+    rtest_rlog_binary_print(binary_ins, expect, "str %s|%-8s|%.*s|%.3s|%10s|%s", "abc", "left", 2, "xyz", "truncate", "right",
+        str_null);
+    rtest_rlog_binary_print(binary_ins, expect, "misc %c %p %% %*d %-*.*f end", 'x', (void*)0x1234, 6, 42, 8, 2, 1.5);
+    rtest_rlog_binary_print(binary_ins, expect, "no args");
+    rtest_rlog_binary_print(binary_ins, expect, "wide %ls", L"fallback");//不支持的格式退回文本
+    rlog_printf(binary_ins, rlog_level_warn, "text in binary %d.\n", 7);
+
+    start_benchmark(0);
+    for (int i = 0; i < rtest_rlog_binary_count; i++) {
+        rlog_site_printf(binary_ins, rlog_level_info, "bench %d %s %f", i, "binary", i * 0.5);
+    }
+    end_benchmark("binary print in main thread.");
+    for (int i = 0; i < 5000; i++) {
+        rlog_async_stats(binary_ins, &stats);
+        if (stats.records >= rtest_rlog_binary_count + 7) {
+            break;
+        }
+        rtools_wait_mills(1);
+    }
+    int64_t binary_bytes = stats.bytes;
+    assert_true(rlog_stop_async(binary_ins) == rcode_ok);
+
+    assert_true(rlog_start_async(binary_ins, rlog_overflow_block, false) == rcode_ok);
+    start_benchmark(0);
+    for (int i = 0; i < rtest_rlog_binary_count; i++) {
+        rlog_site_printf(binary_ins, rlog_level_info, "bench %d %s %f", i, "text", i * 0.5);
+    }
+    end_benchmark("text print in main thread.");
+    for (int i = 0; i < 5000; i++) {
+        rlog_async_stats(binary_ins, &stats);
+        if (stats.records >= rtest_rlog_binary_count) {
+            break;
+        }
+        rtools_wait_mills(1);
+    }
+    printf("rlog queue bytes, binary: %"PRId64", text: %"PRId64"\n", binary_bytes, stats.bytes);
+    assert_true(binary_bytes < stats.bytes);
+    assert_true(rlog_uninit_log(binary_ins) == rcode_ok);
+
+    int binary_files = 0;
+    int text_files = 0;
+    int bench_count = 0;
+    int text_count = 0;
+    file_list = rdir_list(dir, true, false);
+    rlist_iterator_t it_dump = rlist_it(file_list, rlist_dir_tail);
+    while ((node = rlist_next(&it_dump))) {
+        if (rstr_index((char*)(node->val), rtest_rlog_binary_prefix) != 0) {
+            continue;
+        }
+        char* filepath = rfile_get_filepath(dir, (char*)(node->val));
+        FILE* out = tmpfile();
+        assert_true(out != NULL);
+        if (rlog_binary_dump(filepath, out) != rcode_ok) {
+            text_files++;
+            fclose(out);
+            rstr_free(filepath);
+            continue;
+        }
+        binary_files++;
+
+        rewind(out);
+        while (fgets(line, sizeof(line), out) != NULL) {
+            char* data = strstr(line, ":rlog_binary_test:");
+            if (strstr(line, " [WARN] text in binary 7.\n") != NULL) {
+                text_count++;
+            } else if (data != NULL && strstr(data, " bench ") != NULL) {
+                bench_count++;
+            } else if (data != NULL) {
+                assert_true(strstr(line, " [INFO] [") != NULL);
+                strcat(got, strchr(data, ' ') + 1);
+            }
+        }
+        fclose(out);
+        rstr_free(filepath);
+    }
+    rlist_destroy(file_list);
+
+    assert_true(strcmp(got, expect) == 0);
+    assert_true(text_count == 1 && bench_count == rtest_rlog_binary_count);
+    assert_true(binary_files >= 2 && text_files >= 2);//1M滚动，开启和停止时换文件
+
+    free(got);
+    free(expect);
+
+    uninit_benchmark();
+}
+
+#define rtest_rlog_mmap_prefix "rtest_mmap_"
+#define rtest_rlog_mmap_count 40000
+
+static void rlog_mmap_test(void **state) {// mmap写文件，同步和异步模式，1M滚动后不丢不重、无预分配的尾部
+    (void)state;
+    const char* dir = "./logs/local";
+    char line[1024];
+    char* seen = (char*)calloc(2 * rtest_rlog_mmap_count, 1);
+    rlog_async_stats_t stats;
+
+    init_benchmark(1024, "test rlog mmap (%d)", rtest_rlog_mmap_count);
+
+    rlist_t* file_list = rdir_list(dir, true, false);
+    rlist_iterator_t it = rlist_it(file_list, rlist_dir_tail);
+    rlist_node_t* node = NULL;
+    while ((node = rlist_next(&it))) {
+        if (rstr_index((char*)(node->val), rtest_rlog_mmap_prefix) == 0) {
+            char* filepath = rfile_get_filepath(dir, (char*)(node->val));
+            rfile_remove(filepath);
+            rstr_free(filepath);
+        }
+    }
+    rlist_destroy(file_list);
+
+    rlog_t* mmap_ins = rdata_new(rlog_t);
+    memset(mmap_ins, 0, sizeof(rlog_t));
+    assert_true(rlog_init_log(mmap_ins, "./logs/local/"rtest_rlog_mmap_prefix"${index}.log", rlog_level_all, false, 1) == rcode_ok);
+
+    start_benchmark(0);
+    for (int i = 0; i < rtest_rlog_mmap_count; i++) {
+        rlog_printf(mmap_ins, rlog_level_info, "bench %d %s\n", i, rtest_rlog_async_pad);
+    }
+    end_benchmark("sync print to FILE.");
+
+#if defined(__linux__)
+    assert_true(rlog_set_mmap(mmap_ins, true) == rcode_ok);
+    assert_true(mmap_ins->log_items[rlog_level_info]->map_file != NULL && mmap_ins->log_items[rlog_level_info]->file_ptr == NULL);
+    start_benchmark(0);
+    for (int i = 0; i < rtest_rlog_mmap_count; i++) {
+        rlog_printf(mmap_ins, rlog_level_info, "mmap %d %d %s\n", 0, i, rtest_rlog_async_pad);
+    }
+    end_benchmark("sync print to mmap.");
+
+    assert_true(rlog_start_async(mmap_ins, rlog_overflow_block, false) == rcode_ok);
+    for (int i = 0; i < rtest_rlog_mmap_count; i++) {
+        rlog_printf(mmap_ins, rlog_level_info, "mmap %d %d %s\n", 1, i, rtest_rlog_async_pad);
+    }
+    for (int i = 0; i < 5000; i++) {
+        rlog_async_stats(mmap_ins, &stats);
+        if (stats.records >= rtest_rlog_mmap_count) {
+            break;
+        }
+        rtools_wait_mills(1);
+    }
+    assert_true(rlog_stop_async(mmap_ins) == rcode_ok);
+    assert_true(rlog_flush_file(mmap_ins, rlog_level_all, false) == rcode_ok);
+#else
+    assert_true(rlog_set_mmap(mmap_ins, true) == rcode_invalid);
+#endif
+    assert_true(rlog_uninit_log(mmap_ins) == rcode_ok);
+
+    int mmap_count = 0;
+    file_list = rdir_list(dir, true, false);
+    rlist_iterator_t it_read = rlist_it(file_list, rlist_dir_tail);
+    while ((node = rlist_next(&it_read))) {
+        if (rstr_index((char*)(node->val), rtest_rlog_mmap_prefix) != 0) {
+            continue;
+        }
+        char* filepath = rfile_get_filepath(dir, (char*)(node->val));
+        FILE* file_ptr = fopen(filepath, "rb");
+        assert_true(file_ptr != NULL);
+        fseek(file_ptr, 0, SEEK_END);
+        assert_true(ftell(file_ptr) < 2 * 1024 * 1024);
+        rewind(file_ptr);
+        while (fgets(line, sizeof(line), file_ptr) != NULL) {
+            int phase = 0;
+            int index = 0;
+            assert_true(line[0] != '\0');//截断后没有0填充
+            char* data = strstr(line, "] mmap ");
+            if (data != NULL) {
+                assert_true(sscanf(data, "] mmap %d %d", &phase, &index) == 2);
+                seen[phase * rtest_rlog_mmap_count + index]++;
+                mmap_count++;
+            }
+        }
+        fclose(file_ptr);
+        rstr_free(filepath);
+    }
+    rlist_destroy(file_list);
+
+#if defined(__linux__)
+    assert_true(mmap_count == 2 * rtest_rlog_mmap_count);
+    for (int i = 0; i < 2 * rtest_rlog_mmap_count; i++) {
+        assert_true(seen[i] == 1);
+    }
+#else
+    assert_true(mmap_count == 0);
+#endif
+    free(seen);
+
+    uninit_benchmark();
+}
+
+#define rtest_rlog_head_count 1000000
+#define rtest_rlog_path_prefix "rtest_path_"
+
+static void rlog_head_path_test(void **state) {// 行头缓存与逐条格式化一致，路径模板滚动下标递增
+    (void)state;
+    const char* dir = "./logs/local";
+    char head[64];
+    char expect[64];
+    int time_datas[7];
+    int64_t time_base = rtime_millisec() / 1000 * 1000 - 2;
+    int len = 0;
+
+    init_benchmark(1024, "test rlog head (%d)", rtest_rlog_head_count);
+
+    for (int64_t time = time_base; time < time_base + 2010; time += 3) {//跨秒
+        rtime_from_time_millis_security(time, time_datas);
+        snprintf(expect, sizeof(expect), "%.4d-%.2d-%.2d %.2d:%.2d:%.2d %.3d [%s] ", time_datas[0], time_datas[1], time_datas[2],
+            time_datas[3], time_datas[4], time_datas[5], time_datas[6], "WARN");
+        len = rlog_format_head(head, time, rlog_level_warn);
+        assert_true(len == (int)strlen(expect));
+        assert_true(strcmp(head, expect) == 0);
+    }
+
+    start_benchmark(0);
+    for (int i = 0; i < rtest_rlog_head_count; i++) {
+        rtime_from_time_millis_security(time_base + i, time_datas);
+        len += snprintf(expect, sizeof(expect), "%.4d-%.2d-%.2d %.2d:%.2d:%.2d %.3d [%s] ", time_datas[0], time_datas[1], time_datas[2],
+            time_datas[3], time_datas[4], time_datas[5], time_datas[6], "INFO");
+    }
+    end_benchmark("format head per line.");
+
+    start_benchmark(0);
+    for (int i = 0; i < rtest_rlog_head_count; i++) {
+        len += rlog_format_head(head, time_base + i, rlog_level_info);
+    }
+    end_benchmark("format head cached.");
+
+    start_benchmark(0);
+    for (int i = 0; i < rtest_rlog_head_count; i++) {
+        len += (int)(rtime_millisec_coarse() & 1);
+    }
+    end_benchmark("coarse clock.");
+    assert_true(len > 0);
+    int64_t time_coarse = rtime_millisec_coarse();//不和精确时钟比较，只校验同一时间值下缓存的秒和毫秒字段
+    rtime_from_time_millis_security(time_coarse, time_datas);
+    snprintf(expect, sizeof(expect), "%.4d-%.2d-%.2d %.2d:%.2d:%.2d %.3d [%s] ", time_datas[0], time_datas[1], time_datas[2],
+        time_datas[3], time_datas[4], time_datas[5], time_datas[6], "INFO");
+    for (int i = 0; i < 2; i++) {//第一次换秒重建缓存，第二次命中缓存
+        assert_true(rlog_format_head(head, time_coarse, rlog_level_info) == (int)strlen(expect));
+        assert_true(strcmp(head, expect) == 0);
+    }
+
+    rlist_t* file_list = rdir_list(dir, true, false);
+    rlist_iterator_t it = rlist_it(file_list, rlist_dir_tail);
+    rlist_node_t* node = NULL;
+    while ((node = rlist_next(&it))) {
+        if (rstr_index((char*)(node->val), rtest_rlog_path_prefix) == 0) {
+            char* filepath = rfile_get_filepath(dir, (char*)(node->val));
+            rfile_remove(filepath);
+            rstr_free(filepath);
+        }
+    }
+    rlist_destroy(file_list);
+
+    rlog_t* path_ins = rdata_new(rlog_t);
+    memset(path_ins, 0, sizeof(rlog_t));
+    assert_true(rlog_init_log(path_ins, "./logs/local/"rtest_rlog_path_prefix"${level}_${index}.log", rlog_level_all, false, 1) == rcode_ok);
+    for (int i = 0; i < 3; i++) {
+        rlog_printf(path_ins, rlog_level_info, "path %d\n", i);
+        assert_true(rlog_rolling_file(path_ins, rlog_level_all) == rcode_ok);
+    }
+    assert_true(rlog_uninit_log(path_ins) == rcode_ok);
+
+    const char* expect_files[] = { rtest_rlog_path_prefix"ALL_.log", rtest_rlog_path_prefix"ALL_1.log",
+        rtest_rlog_path_prefix"ALL_2.log", rtest_rlog_path_prefix"ALL_3.log" };
+    for (int i = 0; i < 4; i++) {
+        char* filepath = rfile_get_filepath(dir, (char*)expect_files[i]);
+        assert_true(rfile_exists(filepath) == 1);
+        rstr_free(filepath);
+    }
+
+    uninit_benchmark();
+}
+
+#define rtest_rlog_level_count 1000000
+
+static int rtest_rlog_level_evals = 0;
+static int rtest_rlog_level_eval() {
+    return ++rtest_rlog_level_evals;
+}
+
+static void rlog_level_test(void **state) {// 级别不够时不求值参数，模块级别优先于默认级别
+    (void)state;
+    int expect = 0;
+    init_benchmark(1024, "test rlog level (%d)", rtest_rlog_level_count);
+
+    assert_true(rlog_reset(NULL, rlog_level_info, 0) == rcode_ok);
+    rdebug("level eval %d", rtest_rlog_level_eval());
+    assert_true(rtest_rlog_level_evals == expect);
+    rinfo("level eval %d", rtest_rlog_level_eval());
+    expect += rlog_level_info >= rlog_level_min;
+    assert_true(rtest_rlog_level_evals == expect);
+
+    assert_true(rlog_set_module_level("rtest_rlog.c", rlog_level_debug) == rcode_ok);
+    rdebug("level eval %d", rtest_rlog_level_eval());
+    expect += rlog_level_debug >= rlog_level_min;//编译期去掉的调用点不受运行时级别影响
+    assert_true(rtest_rlog_level_evals == expect);
+    rtrace("level eval %d", rtest_rlog_level_eval());
+    assert_true(rtest_rlog_level_evals == expect);
+    assert_true(rlog_set_module_level("rtest_rlog.c", rlog_level_error) == rcode_ok);
+    rwarn("level eval %d", rtest_rlog_level_eval());
+    assert_true(rtest_rlog_level_evals == expect);
+
+#undef rlog_module
+#define rlog_module "rtest_tag"
+    assert_true(rlog_set_module_level("rtest_tag", rlog_level_trace) == rcode_ok);
+    rtrace("level eval %d", rtest_rlog_level_eval());//标签优先于文件名
+    expect += rlog_level_trace >= rlog_level_min;
+    assert_true(rtest_rlog_level_evals == expect);
+    assert_true(rlog_remove_module_level("rtest_tag") == rcode_ok);
+    rtrace("level eval %d", rtest_rlog_level_eval());
+    assert_true(rtest_rlog_level_evals == expect);
+#undef rlog_module
+#define rlog_module NULL
+
+    assert_true(rlog_remove_module_level("rtest_rlog.c") == rcode_ok);
+    assert_true(rlog_remove_module_level("rtest_rlog.c") == rcode_invalid);
+    rwarn("level eval %d", rtest_rlog_level_eval());
+    expect += rlog_level_warn >= rlog_level_min;
+    assert_true(rtest_rlog_level_evals == expect);
+
+    char module[rlog_module_name_size];
+    for (int i = 0; i < rlog_module_max; i++) {
+        snprintf(module, sizeof(module), "rtest_module_%d", i);
+        assert_true(rlog_set_module_level(module, rlog_level_warn) == rcode_ok);
+    }
+    assert_true(rlog_set_module_level("rtest_module_full", rlog_level_warn) == rcode_invalid);
+    for (int i = 0; i < rlog_module_max; i++) {
+        snprintf(module, sizeof(module), "rtest_module_%d", i);
+        assert_true(rlog_remove_module_level(module) == rcode_ok);
+    }
+
+    start_benchmark(0);
+    for (int i = 0; i < rtest_rlog_level_count; i++) {
+        rdebug("level bench %d %s", i, rtest_rlog_async_pad);
+    }
+    end_benchmark("disabled rdebug.");
+    assert_true(rlog_reset(NULL, rlog_level_verb, 0) == rcode_ok);
+
+    uninit_benchmark();
+}
+
+#define rtest_rlog_limit_prefix "rtest_limit_"
+#define rtest_rlog_limit_count 1000000
+
+static void rtest_rlog_limit_print(rlog_t* rlog) {//同一个调用点
+    rlog_site_printf_limit(rlog, rlog_level_error, 10, 5, "limit %d", rtest_rlog_level_eval());
+}
+
+static void rlog_limit_test(void **state) {// 调用点限速只放过突发和按速率补充的条数，丢弃数汇总一行；采样每n条1条
+    (void)state;
+    const char* dir = "./logs/local";
+    char line[1024];
+    int64_t suppressed = 0;
+    int64_t summary = 0;
+    int evals = 0;
+
+    init_benchmark(1024, "test rlog limit (%d)", rtest_rlog_limit_count);
+
+    rlist_t* file_list = rdir_list(dir, true, false);
+    rlist_iterator_t it = rlist_it(file_list, rlist_dir_tail);
+    rlist_node_t* node = NULL;
+    while ((node = rlist_next(&it))) {
+        if (rstr_index((char*)(node->val), rtest_rlog_limit_prefix) == 0) {
+            char* filepath = rfile_get_filepath(dir, (char*)(node->val));
+            rfile_remove(filepath);
+            rstr_free(filepath);
+        }
+    }
+    rlist_destroy(file_list);
+
+    rlog_t* limit_ins = rdata_new(rlog_t);
+    memset(limit_ins, 0, sizeof(rlog_t));
+    assert_true(rlog_init_log(limit_ins, "./logs/local/"rtest_rlog_limit_prefix"${index}.log", rlog_level_all, false, 100) == rcode_ok);
+
+    rtest_rlog_level_evals = 0;
+    int64_t time_start = rtime_millisec();
+    start_benchmark(0);
+    for (int i = 0; i < rtest_rlog_limit_count; i++) {
+        rtest_rlog_limit_print(limit_ins);
+    }
+    end_benchmark("limited rerror flood.");
+    int64_t elapsed = rtime_millisec() - time_start;
+    evals = rtest_rlog_level_evals;
+    assert_true(evals >= 5 && evals <= 5 + elapsed / 100 + 2);//突发5条，之后每100ms一条
+
+    rtools_wait_mills(200);
+    rtest_rlog_limit_print(limit_ins);
+    assert_true(rtest_rlog_level_evals == evals + 1);
+
+    rtest_rlog_level_evals = 0;
+    for (int i = 0; i < 1000; i++) {
+        rlog_site_printf_sample(limit_ins, rlog_level_warn, 100, "sample %d", rtest_rlog_level_eval());
+    }
+    assert_true(rtest_rlog_level_evals == 10);
+
+    rtest_rlog_level_evals = 0;
+    for (int i = 0; i < 10; i++) {
+        rlog_site_printf_sample(limit_ins, rlog_level_warn, 0, "sample zero %d", rtest_rlog_level_eval());
+        rlog_site_printf_sample(limit_ins, rlog_level_warn, -3, "sample negative %d", rtest_rlog_level_eval());
+    }
+    assert_true(rtest_rlog_level_evals == 20);//n小于1每条都输出
+    assert_true(rlog_uninit_log(limit_ins) == rcode_ok);
+
+    file_list = rdir_list(dir, true, false);
+    rlist_iterator_t it_read = rlist_it(file_list, rlist_dir_tail);
+    while ((node = rlist_next(&it_read))) {
+        if (rstr_index((char*)(node->val), rtest_rlog_limit_prefix) != 0) {
+            continue;
+        }
+        char* filepath = rfile_get_filepath(dir, (char*)(node->val));
+        FILE* file_ptr = fopen(filepath, "rb");
+        assert_true(file_ptr != NULL);
+        while (fgets(line, sizeof(line), file_ptr) != NULL) {
+            char* data = strstr(line, " suppressed ");
+            if (data != NULL) {
+                assert_true(sscanf(data, " suppressed %"SCNd64" similar messages", &suppressed) == 1);
+                summary += suppressed;
+            }
+        }
+        fclose(file_ptr);
+        rstr_free(filepath);
+    }
+    rlist_destroy(file_list);
+    assert_true(summary == rtest_rlog_limit_count - evals);//最后一次输出前汇总了全部丢弃
+
+    uninit_benchmark();
+}
+
 static char* dir_path;
 static int setup(void **state) {
     int *answer = malloc(sizeof(int));
@@ -65,6 +673,12 @@ static int teardown(void **state) {
 }
 static struct CMUnitTest test_group2[] = {
     cmocka_unit_test_setup_teardown(rlog_full_test, NULL, NULL),
+    cmocka_unit_test_setup_teardown(rlog_async_test, NULL, NULL),
+    cmocka_unit_test_setup_teardown(rlog_binary_test, NULL, NULL),
+    cmocka_unit_test_setup_teardown(rlog_mmap_test, NULL, NULL),
+    cmocka_unit_test_setup_teardown(rlog_head_path_test, NULL, NULL),
+    cmocka_unit_test_setup_teardown(rlog_level_test, NULL, NULL),
+    cmocka_unit_test_setup_teardown(rlog_limit_test, NULL, NULL),
 };
 
 int run_rlog_tests(int benchmark_output) {
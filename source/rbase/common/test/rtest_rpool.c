@@ -8,12 +8,14 @@
  */
 
 #include "rpool.h"
+#include "rarena.h"
 
 #include "rlog.h"
 
 #include "rcommon.h"
 #include "rtime.h"
 #include "rstring.h"
+#include "rthread.h"
 
 #include "rbase/common/test/rtest.h"
 
@@ -32,6 +34,70 @@ typedef struct rtest_pool_struct_t {
 rpool_declare(rtest_pool_struct_t);// .h
 rdefine_pool(rtest_pool_struct_t, 100, 20); // .c
 
+typedef struct rtest_pool_bench_t {
+	int64_t id;
+	double value;
+} rtest_pool_bench_t;
+
+rpool_declare(rtest_pool_bench_t);
+rdefine_pool(rtest_pool_bench_t, 100, 100);
+
+typedef struct rtest_pool_ts_struct_t {
+	int index;
+	double value;
+} rtest_pool_ts_struct_t;
+
+rpool_declare_ts(rtest_pool_ts_struct_t);
+rdefine_pool_ts(rtest_pool_ts_struct_t, 100, 200);
+
+#define rtest_pool_ts_threads 4
+#define rtest_pool_ts_count 10000
+
+static rtest_pool_ts_struct_t* datas_ts[rtest_pool_ts_threads][rtest_pool_ts_count];
+
+static void* rpool_ts_new_func(void* arg) {
+    int index = (int)(int64_t)arg;
+
+    for (int i = 0; i < rtest_pool_ts_count; i++) {
+        datas_ts[index][i] = rpool_new_data(rtest_pool_ts_struct_t);
+        datas_ts[index][i]->index = i;
+        datas_ts[index][i]->value = index;
+    }
+    return NULL;
+}
+
+static void* rpool_ts_free_func(void* arg) {
+    int index = (int)(int64_t)arg;
+    int index_other = (index + 1) % rtest_pool_ts_threads;
+    rtest_pool_ts_struct_t* data = NULL;
+
+    for (int i = 0; i < rtest_pool_ts_count; i++) {
+        if (datas_ts[index_other][i]->value != index_other || datas_ts[index_other][i]->index != i) {
+            return arg;
+        }
+        rpool_free_data(rtest_pool_ts_struct_t, datas_ts[index_other][i]);//其他线程的数据，进remote链
+
+        data = rpool_new_data(rtest_pool_ts_struct_t);
+        data->index = i;
+        rpool_free_data(rtest_pool_ts_struct_t, data);
+    }
+    return NULL;
+}
+
+static void* rpool_ts_bench_func(void* arg) {
+    rtest_pool_ts_struct_t* datas[100];
+
+    for (int round = 0; round < (int)(int64_t)arg; round++) {
+        for (int i = 0; i < 100; i++) {
+            datas[i] = rpool_new_data(rtest_pool_ts_struct_t);
+        }
+        for (int i = 0; i < 100; i++) {
+            rpool_free_data(rtest_pool_ts_struct_t, datas[i]);
+        }
+    }
+    return NULL;
+}
+
 static void rpool_full_test(void **state) {
     (void)state;
 
@@ -83,6 +149,304 @@ static void rpool_full_test(void **state) {
     uninit_benchmark();
 }
 
+static void rpool_blocks_bench_test(void **state) {
+    (void)state;
+    int block_counts[] = { 1, 100, 10000 };
+    int64_t count = 0;
+    rtest_pool_bench_t** datas = NULL;
+
+    init_benchmark(1024, "test rpool blocks");
+
+    for (int k = 0; k < 3; k++) {
+        count = (int64_t)block_counts[k] * 100;
+        datas = rdata_new_type_array(rtest_pool_bench_t*, count);
+        assert_true(datas != NULL);
+
+        rget_pool(rtest_pool_bench_t) = rcreate_pool(rtest_pool_bench_t);
+        assert_true(rget_pool(rtest_pool_bench_t) != NULL);
+
+        start_benchmark(0);
+        for (int round = 0; round < 1000000 / count; round++) {
+            for (int64_t i = 0; i < count; i++) {
+                datas[i] = rpool_new_data(rtest_pool_bench_t);
+                datas[i]->id = i;
+            }
+            assert_true(rpool_get_capacity(rtest_pool_bench_t) == count);
+            for (int64_t i = 0; i < count; i++) {
+                rpool_free_data(rtest_pool_bench_t, datas[(i * 7919) % count]);//打散释放顺序
+            }
+        }
+        assert_true(rpool_get_capacity(rtest_pool_bench_t) == rpool_get_free_count(rtest_pool_bench_t));
+        printf("blocks: %d, ", block_counts[k]);
+        end_benchmark("rpool get/free 1000000 items.");
+
+        rdestroy_pool(rtest_pool_bench_t);
+        rdata_free_array(datas);
+    }
+
+    uninit_benchmark();
+}
+
+static void rdata_pool_test(void **state) {
+    (void)state;
+    unsigned int sizes[] = { 8, 24, 100 };
+    int count = 10000;
+    char** datas = rdata_new_type_array(char*, count);
+
+    init_benchmark(1024, "test rdata_pool (%d)", count);
+
+    for (int k = 0; k < 3; k++) {
+        rdata_pool* pool = rdata_pool_create(sizes[k], 128);
+        assert_true(pool != NULL);
+        assert_true(pool->capacity == 128 && pool->total_free == 128);
+
+        start_benchmark(0);
+        for (int i = 0; i < count; i++) {
+            datas[i] = rdata_pool_alloc(pool);
+            assert_true(datas[i] != NULL);
+            memset(datas[i], i & 0xFF, sizes[k]);
+        }
+        assert_true(pool->capacity - pool->total_free == count);
+        for (int i = 0; i < count; i++) {
+            assert_true((unsigned char)datas[i][sizes[k] - 1] == (i & 0xFF));
+        }
+        for (int i = 0; i < count; i += 2) {
+            assert_true(rdata_pool_free(pool, datas[i]) == rcode_ok);
+        }
+        assert_true(rdata_pool_free(pool, datas[0]) != rcode_ok);//重复释放
+        for (int i = 0; i < count; i += 2) {
+            datas[i] = rdata_pool_alloc(pool);
+        }
+        assert_true(pool->capacity - pool->total_free == count);
+        for (int i = 0; i < count; i++) {
+            assert_true(rdata_pool_free(pool, datas[(i * 7919) % count]) == rcode_ok);
+        }
+        assert_true(pool->capacity == 128 + pool_block_item_count && pool->total_free == pool->capacity);//空块已释放，留一个备用
+
+        int block_count = pool->block_count;
+        for (int round = 0; round < 1000; round++) {//在块边界来回分配释放，不反复申请整块
+            for (int i = 0; i < 129; i++) {
+                datas[i] = rdata_pool_alloc(pool);
+            }
+            for (int i = 0; i < 129; i++) {
+                assert_true(rdata_pool_free(pool, datas[i]) == rcode_ok);
+            }
+            assert_true(pool->block_count == block_count);
+        }
+        printf("size: %u, ", sizes[k]);
+        end_benchmark("rdata_pool alloc/free.");
+
+        rdata_pool_destroy(pool);
+    }
+
+    assert_true(rdata_pool_alloc(NULL) == NULL && rdata_pool_free(NULL, datas[0]) != rcode_ok);
+
+    rdata_pool* pool_small_block = rdata_pool_create_ext(1000, 0, 3);//每块3个槽
+    assert_true(pool_small_block != NULL && pool_small_block->block_align == 4096);
+    for (int i = 0; i < 7; i++) {
+        datas[i] = rdata_pool_alloc(pool_small_block);
+        assert_true(datas[i] != NULL);
+    }
+    assert_true(pool_small_block->block_count == 3 && pool_small_block->capacity == 9);
+    for (int i = 0; i < 7; i++) {
+        assert_true(rdata_pool_free(pool_small_block, datas[i]) == rcode_ok);
+    }
+    assert_true(pool_small_block->block_count == 1 && pool_small_block->total_free == 3);//空块只留一个备用
+    rdata_pool_destroy(pool_small_block);
+    assert_true(rdata_pool_create_ext(8, 0, pool_block_item_count + 1) == NULL);
+
+    start_benchmark(0);
+    for (int i = 0; i < count; i++) {
+        datas[i] = rdata_new_size(24);
+    }
+    for (int i = 0; i < count; i++) {
+        rdata_free(char, datas[(i * 7919) % count]);
+    }
+    end_benchmark("malloc/free compare.");
+
+    rdata_free_array(datas);
+    uninit_benchmark();
+}
+
+static void rmem_class_test(void **state) {
+    (void)state;
+    int count = 10000;
+    size_t sizes[] = { 1, 8, 9, 24, 100, 500, 2048, 4096 };
+    int size_count = (int)(sizeof(sizes) / sizeof(size_t));
+    char** datas = rdata_new_type_array(char*, count);
+    rmem_class_stat_t stats_old[rmem_class_count];
+    rmem_class_stat_t stats[rmem_class_count];
+    int64_t large_old = 0;
+    int64_t large = 0;
+
+    init_benchmark(1024, "test rmem_class (%d)", count);
+
+    assert_true(rmem_class_init() == rcode_ok);
+    assert_true(rmem_class_stat(stats_old, &large_old) == rmem_class_count);
+
+    start_benchmark(0);
+    for (int i = 0; i < count; i++) {
+        size_t size = sizes[i % size_count];
+        datas[i] = rmem_class_alloc(size);
+        assert_true(datas[i] != NULL);
+        assert_true(((uintptr_t)datas[i] & 15) == 0);
+        memset(datas[i], i & 0xFF, size);
+    }
+    rmem_class_stat(stats, &large);
+    assert_true(large - large_old == count / size_count);//4096走大块
+    assert_true(stats[0].size == 16 && stats[rmem_class_count - 1].size == 2048);
+    assert_true(stats[0].used - stats_old[0].used == (count / size_count) * 3);//1、8和9
+    assert_true(stats[1].used - stats_old[1].used == count / size_count);//24
+    assert_true(stats[rmem_class_count - 1].miss > stats_old[rmem_class_count - 1].miss);
+    for (int i = 0; i < count; i++) {
+        assert_true((unsigned char)datas[i][sizes[i % size_count] - 1] == (i & 0xFF));
+    }
+    for (int i = 0; i < count; i++) {
+        rmem_class_free(datas[(i * 7919) % count]);
+    }
+    end_benchmark("rmem_class alloc/free.");
+
+    rmem_class_stat(stats, &large);
+    for (int i = 0; i < rmem_class_count; i++) {
+        assert_true(stats[i].used == stats_old[i].used);
+    }
+
+    start_benchmark(0);
+    for (int i = 0; i < count; i++) {
+        datas[i] = rmem_class_alloc(24);
+    }
+    for (int i = 0; i < count; i++) {
+        rmem_class_free(datas[(i * 7919) % count]);
+    }
+    end_benchmark("rmem_class 24 alloc/free.");
+    rmem_class_stat(stats, &large);
+    assert_true(stats[1].hit - stats_old[1].hit >= count - 10);//slab复用
+
+    rmem_class_free(raymalloc(16));//非区间内指针直接释放
+    rmem_class_free(NULL);
+
+    rdata_free_array(datas);
+    uninit_benchmark();
+#ifndef RAY_USE_POOL
+    void* data_live = rmem_class_alloc(24);
+    assert_true(rmem_class_uninit() != rcode_ok);//还有未释放的分配，保留区间
+    rmem_class_free(data_live);
+    assert_true(rmem_class_uninit() == rcode_ok);
+#endif //RAY_USE_POOL
+}
+
+static void rarena_test(void **state) {
+    (void)state;
+    int count = 10000;
+    rarena_t* arena = NULL;
+
+    init_benchmark(1024, "test rarena (%d)", count);
+
+    rarena_init(arena, 4096);
+    assert_true(arena->chunk_count == 1 && arena->capacity == 4096);
+
+    char* data = rarena_alloc(arena, 3);
+    int64_t* nums = rarena_new_array(arena, int64_t, 4);
+    assert_true(((uintptr_t)nums & (rarena_align_default - 1)) == 0);
+    double* num_align = rarena_alloc_align(arena, sizeof(double), 64);
+    assert_true(((uintptr_t)num_align & 63) == 0);
+    data[0] = 'a';
+
+    rarena_mark_t mark = rarena_mark(arena);
+    size_t used = arena->used;
+    for (int i = 0; i < count; i++) {
+        nums = rarena_new_array(arena, int64_t, 4);
+        assert_true(nums != NULL);
+        nums[3] = i;
+    }
+    assert_true(arena->chunk_count > 1 && arena->used == used + count * sizeof(int64_t) * 4);
+    int chunk_count = arena->chunk_count;
+    rarena_rewind(arena, mark);
+    assert_true(arena->used == used && rarena_mark(arena).pos == mark.pos);
+    for (int i = 0; i < count; i++) {
+        nums = rarena_new_array(arena, int64_t, 4);
+    }
+    assert_true(arena->chunk_count == chunk_count);//rewind后的块复用
+    assert_true(data[0] == 'a');
+
+    char* data_large = rarena_alloc(arena, 10000);//超过块大小
+    memset(data_large, 1, 10000);
+    assert_true(arena->chunk_count == chunk_count + 1);
+    rarena_reset(arena);
+    assert_true(arena->used == 0 && arena->chunk_count == chunk_count);
+    rarena_reset(NULL);
+
+    start_benchmark(0);
+    for (int k = 0; k < 100; k++) {
+        for (int i = 0; i < count; i++) {
+            rarena_alloc(arena, 24);
+        }
+        rarena_reset(arena);
+    }
+    end_benchmark("rarena alloc/reset.");
+    rarena_free(arena);
+
+    arena = rarena_thread_default();
+    assert_true(arena != NULL && arena == rarena_thread_default());
+    rarena_thread_release();
+
+    uninit_benchmark();
+}
+
+static void rpool_ts_test(void **state) {
+    (void)state;
+    rthread_t threads[rtest_pool_ts_threads];
+    void* ret = NULL;
+
+    init_benchmark(1024, "test rpool ts (%d * %d)", rtest_pool_ts_threads, rtest_pool_ts_count);
+
+    rget_pool(rtest_pool_ts_struct_t) = rcreate_pool(rtest_pool_ts_struct_t);
+    assert_true(rget_pool(rtest_pool_ts_struct_t) != NULL);
+
+    start_benchmark(0);
+    for (int i = 0; i < rtest_pool_ts_threads; i++) {
+        rthread_init(&threads[i]);
+        assert_true(rthread_start(&threads[i], rpool_ts_new_func, (void*)(int64_t)i) == 0);
+    }
+    for (int i = 0; i < rtest_pool_ts_threads; i++) {
+        assert_true(rthread_join(&threads[i], &ret) == 0);
+    }
+    rpool_sync_stat(rtest_pool_ts_struct_t);
+    assert_true(rpool_get_capacity(rtest_pool_ts_struct_t) >= rtest_pool_ts_threads * rtest_pool_ts_count);
+    end_benchmark("rpool ts new data in threads.");
+
+    start_benchmark(0);
+    for (int i = 0; i < rtest_pool_ts_threads; i++) {
+        rthread_init(&threads[i]);
+        assert_true(rthread_start(&threads[i], rpool_ts_free_func, (void*)(int64_t)i) == 0);
+    }
+    for (int i = 0; i < rtest_pool_ts_threads; i++) {
+        assert_true(rthread_join(&threads[i], &ret) == 0);
+        assert_true(ret == NULL);
+    }
+    rpool_sync_stat(rtest_pool_ts_struct_t);
+    assert_true(rpool_get_capacity(rtest_pool_ts_struct_t) == rpool_get_free_count(rtest_pool_ts_struct_t));
+    end_benchmark("rpool ts free data cross threads.");
+
+    for (int count = 1; count <= rtest_pool_ts_threads; count *= 2) {
+        start_benchmark(0);
+        for (int i = 0; i < count; i++) {
+            rthread_init(&threads[i]);
+            assert_true(rthread_start(&threads[i], rpool_ts_bench_func, (void*)(int64_t)10000) == 0);
+        }
+        for (int i = 0; i < count; i++) {
+            assert_true(rthread_join(&threads[i], &ret) == 0);
+        }
+        printf("threads: %d, ", count);
+        end_benchmark("rpool ts get/free 1000000 per thread.");
+    }
+
+    rdestroy_pool(rtest_pool_ts_struct_t);
+    assert_true(rget_pool(rtest_pool_ts_struct_t) == NULL);
+
+    uninit_benchmark();
+}
+
 static int setup(void **state) {
     rpool_init_global();
 
@@ -95,6 +459,11 @@ static int teardown(void **state) {
 }
 static struct CMUnitTest test_group2[] = {
     cmocka_unit_test_setup_teardown(rpool_full_test, setup, teardown),
+    cmocka_unit_test_setup_teardown(rpool_blocks_bench_test, setup, teardown),
+    cmocka_unit_test_setup_teardown(rdata_pool_test, setup, teardown),
+    cmocka_unit_test_setup_teardown(rmem_class_test, setup, teardown),
+    cmocka_unit_test_setup_teardown(rarena_test, setup, teardown),
+    cmocka_unit_test_setup_teardown(rpool_ts_test, setup, teardown),
 };
 
 int run_rpool_tests(int benchmark_output) {
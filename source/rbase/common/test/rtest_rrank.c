@@ -0,0 +1,218 @@
+/**
+ * Copyright (c) 2014 ray
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the MIT license. See LICENSE for details.
+ *
+ * @author: Ray
+ */
+
+#include "rstring.h"
+#include "rlog.h"
+#include "rcommon.h"
+#include "rtime.h"
+#include "rrank.h"
+
+#include "rbase/common/test/rtest.h"
+
+static int init();
+static int uninit();
+
+static void rrank_full_test(void **state);
+static void rrank_bench_test(void **state);
+
+const static struct CMUnitTest tests[] = {
+    cmocka_unit_test(rrank_full_test),
+    cmocka_unit_test(rrank_bench_test),
+};
+
+static int init() {
+    int total;
+
+    rcount_array(tests, total);
+
+    fprintf(stdout, "total: %d\n", total);
+    fflush(stdout);
+
+    return rcode_ok;
+}
+
+static int uninit() {
+
+    return rcode_ok;
+}
+
+int run_rrank_tests(int benchmark_output) {
+    init();
+
+    int64_t timeNow = rtime_nanosec();
+
+    int result = 0;
+    result += cmocka_run_group_tests(tests, NULL, NULL);
+
+    printf("run_rrank_tests all time: %"PRId64" us\n", (rtime_nanosec() - timeNow));
+
+    uninit();
+
+    return result == 0 ? rcode_ok : -1;
+}
+
+typedef struct rtest_rank_item_s {
+    uint64_t id;
+    int64_t score;
+} rtest_rank_item_t;
+
+static int rtest_rank_item_cmp(const void* a, const void* b) {//分高在前，同分id小在前
+    const rtest_rank_item_t* item1 = (const rtest_rank_item_t*)a;
+    const rtest_rank_item_t* item2 = (const rtest_rank_item_t*)b;
+    if (item1->score != item2->score) {
+        return item1->score > item2->score ? -1 : 1;
+    }
+    return item1->id == item2->id ? 0 : (item1->id < item2->id ? -1 : 1);
+}
+
+static void rtest_rank_collect(void* data_ext, rrank_node_t* node, rrank_size_t rank) {
+    rtest_rank_item_t* items = (rtest_rank_item_t*)data_ext;
+    items[rank - 1].id = node->id;
+    items[rank - 1].score = node->score;
+}
+
+static void rrank_full_test(void **state) {// 和排序数组对照
+    (void)state;
+    int count = 2000;
+    int j;
+
+    init_benchmark(1024, "test rrank full(%d)", count);
+
+    rtest_rank_item_t* items = rdata_new_type_array(rtest_rank_item_t, count);
+    rtest_rank_item_t* sorted = rdata_new_type_array(rtest_rank_item_t, count);
+    rtest_rank_item_t* ranged = rdata_new_type_array(rtest_rank_item_t, count);
+    bool* exist = rdata_new_type_array(bool, count);
+
+    rrank_t* rank_ins = rrank_create(rrank_order_desc, 0);
+    assert_true(rank_ins != NULL && rrank_size(rank_ins) == 0 && rrank_at(rank_ins, 1) == NULL);
+    assert_true(rrank_rank_of(rank_ins, 1) == 0 && rrank_remove(rank_ins, 1) == rrank_code_not_exist);
+
+    srand(17);
+    start_benchmark(0);
+    for (j = 0; j < count * 20; j++) {
+        int id = rand() % count;
+        if (rand() % 5 == 0) {
+            assert_true(rrank_remove(rank_ins, id) == (exist[id] ? rrank_code_ok : rrank_code_not_exist));
+            exist[id] = false;
+        } else {
+            int64_t score = rand() % 100;//大量同分
+            if (rand() % 2 == 0 && exist[id]) {
+                score = items[id].score + rand() % 3 - 1;//小幅变动，走原地改分
+            }
+            assert_true(rrank_update(rank_ins, id, score) == rrank_code_ok);
+            items[id].id = id;
+            items[id].score = score;
+            exist[id] = true;
+        }
+
+        if (j % 2000 != 0) {
+            continue;
+        }
+        int sorted_size = 0;
+        for (int i = 0; i < count; i++) {
+            if (exist[i]) {
+                sorted[sorted_size++] = items[i];
+            }
+        }
+        qsort(sorted, sorted_size, sizeof(rtest_rank_item_t), rtest_rank_item_cmp);
+        assert_true(rrank_size(rank_ins) == (rrank_size_t)sorted_size);
+        for (int i = 0; i < sorted_size; i++) {
+            rrank_node_t* node = rrank_at(rank_ins, i + 1);
+            assert_true(node != NULL && node->id == sorted[i].id && node->score == sorted[i].score);
+            assert_true(rrank_rank_of(rank_ins, sorted[i].id) == (rrank_size_t)(i + 1));
+        }
+        assert_true(rrank_range(rank_ins, 1, count, rtest_rank_collect, ranged) == (rrank_size_t)sorted_size);
+        assert_true(sorted_size == 0 || memcmp(ranged, sorted, sorted_size * sizeof(rtest_rank_item_t)) == 0);
+        assert_true(sorted_size == 0 || rrank_last(rank_ins)->id == sorted[sorted_size - 1].id);
+    }
+    end_benchmark("rrank random update/remove, with checks.");
+
+    assert_true(rrank_range(rank_ins, rrank_size(rank_ins), 10, NULL, NULL) == 1);//最后一页不满
+    assert_true(rrank_range(rank_ins, rrank_size(rank_ins) + 1, 10, NULL, NULL) == 0);
+    assert_true(rrank_range(rank_ins, 0, 10, NULL, NULL) == 0);
+
+    rrank_clear(rank_ins);
+    assert_true(rrank_size(rank_ins) == 0 && rrank_find(rank_ins, items[0].id) == NULL);
+    assert_true(rrank_update(rank_ins, 5, 10) == rrank_code_ok && rrank_rank_of(rank_ins, 5) == 1);
+    rrank_free(rank_ins);
+
+    rank_ins = rrank_create(rrank_order_asc, 0);//分低在前，如通关耗时
+    rrank_update(rank_ins, 1, 300);
+    rrank_update(rank_ins, 2, 100);
+    rrank_update(rank_ins, 3, 200);
+    assert_true(rrank_at(rank_ins, 1)->id == 2 && rrank_rank_of(rank_ins, 1) == 3);
+    rrank_update(rank_ins, 1, 50);
+    assert_true(rrank_rank_of(rank_ins, 1) == 1 && rrank_last(rank_ins)->id == 3);
+    rrank_free(rank_ins);
+
+    rdata_free_array(exist);
+    rdata_free_array(ranged);
+    rdata_free_array(sorted);
+    rdata_free_array(items);
+
+    uninit_benchmark();
+}
+
+static void rrank_bench_test(void **state) {// 对比每次查询都重新排序
+    (void)state;
+    int count = 200000;
+    int query_times = 10000;
+    int sort_times = 10;
+    int j;
+    uint64_t sum = 0;
+
+    init_benchmark(1024, "test rrank bench(%d)", count);
+
+    rrank_t* rank_ins = rrank_create(rrank_order_desc, count);
+    srand(23);
+    start_benchmark(0);
+    for (j = 0; j < count; j++) {
+        rrank_update(rank_ins, j, rand() % 1000000);
+    }
+    end_benchmark("rrank insert.");
+
+    start_benchmark(0);
+    for (j = 0; j < count; j++) {
+        rrank_update(rank_ins, rand() % count, rand() % 1000000);
+    }
+    end_benchmark("rrank update score random.");
+
+    start_benchmark(0);
+    for (j = 0; j < query_times; j++) {
+        sum += rrank_rank_of(rank_ins, rand() % count);
+    }
+    end_benchmark("rrank rank of id.");
+
+    start_benchmark(0);
+    for (j = 0; j < query_times; j++) {
+        sum += rrank_range(rank_ins, rand() % count + 1, 20, NULL, NULL);
+    }
+    end_benchmark("rrank page by rank (20 per page).");
+
+    start_benchmark(0);
+    for (j = 0; j < query_times; j++) {
+        sum += rrank_range(rank_ins, 1, 100, NULL, NULL);
+    }
+    end_benchmark("rrank top 100.");
+    assert_true(sum > 0);
+
+    rtest_rank_item_t* items = rdata_new_type_array(rtest_rank_item_t, count);
+    rrank_range(rank_ins, 1, count, rtest_rank_collect, items);
+    start_benchmark(0);
+    for (j = 0; j < sort_times; j++) {
+        items[rand() % count].score = rand() % 1000000;
+        qsort(items, count, sizeof(rtest_rank_item_t), rtest_rank_item_cmp);
+    }
+    end_benchmark("array resort per query (10 times).");
+
+    rdata_free_array(items);
+    rrank_free(rank_ins);
+
+    uninit_benchmark();
+}
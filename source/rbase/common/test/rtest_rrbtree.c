@@ -0,0 +1,383 @@
+/**
+ * Copyright (c) 2014 ray
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the MIT license. See LICENSE for details.
+ *
+ * @author: Ray
+ */
+
+#include "rstring.h"
+#include "rlog.h"
+#include "rcommon.h"
+#include "rtime.h"
+#include "rdict.h"
+#include "rrbtree.h"
+
+#include "rbase/common/test/rtest.h"
+
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wint-conversion"
+#endif //__GNUC__
+
+static int init();
+static int uninit();
+
+static void rrbtree_int_test(void **state);
+static void rrbtree_range_test(void **state);
+static void rrbtree_string_test(void **state);
+static void rrbtree_bench_test(void **state);
+
+const static struct CMUnitTest tests[] = {
+    cmocka_unit_test(rrbtree_int_test),
+    cmocka_unit_test(rrbtree_range_test),
+    cmocka_unit_test(rrbtree_string_test),
+    cmocka_unit_test(rrbtree_bench_test),
+};
+
+static int init() {
+    int total;
+
+    rcount_array(tests, total);
+
+    fprintf(stdout, "total: %d\n", total);
+    fflush(stdout);
+
+    return rcode_ok;
+}
+
+static int uninit() {
+
+    return rcode_ok;
+}
+
+int run_rrbtree_tests(int benchmark_output) {
+    init();
+
+    int64_t timeNow = rtime_nanosec();
+
+    int result = 0;
+    result += cmocka_run_group_tests(tests, NULL, NULL);
+
+    printf("run_rrbtree_tests all time: %"PRId64" us\n", (rtime_nanosec() - timeNow));
+
+    uninit();
+
+    return result == 0 ? rcode_ok : -1;
+}
+
+/** 返回黑高，不满足红黑性质时返回-1 */
+static int rtest_rrbtree_check(rrbtree_t* d, rrbtree_node_t* node, rrbtree_node_t* parent) {
+    if (node == NULL) {
+        return 1;
+    }
+    if (node->parent != parent) {
+        return -1;
+    }
+    if (node->color == rrbtree_red && ((node->left != NULL && node->left->color == rrbtree_red) ||
+        (node->right != NULL && node->right->color == rrbtree_red))) {
+        return -1;
+    }
+    if ((node->left != NULL && node->left->key.s64 >= node->key.s64) ||
+        (node->right != NULL && node->right->key.s64 <= node->key.s64)) {
+        return -1;
+    }
+    int height_left = rtest_rrbtree_check(d, node->left, node);
+    int height_right = rtest_rrbtree_check(d, node->right, node);
+    if (height_left < 0 || height_left != height_right) {
+        return -1;
+    }
+    return height_left + (node->color == rrbtree_black ? 1 : 0);
+}
+
+static void rrbtree_int_test(void **state) {// 随机增删，和rdict对照
+    (void)state;
+    int count = 20000;
+    int64_t j;
+
+    init_benchmark(1024, "test rrbtree int(%d)", count);
+
+    rrbtree_t* tree = rrbtree_create(0, NULL);
+    rdict_t* dict_ins = NULL;
+    rdict_init(dict_ins, rdata_type_int64, rdata_type_int64, 0, 0);
+    assert_true(tree != NULL && rrbtree_first(tree) == NULL && rrbtree_last(tree) == NULL);
+
+    srand(7);
+    start_benchmark(0);
+    for (j = 0; j < count * 4; j++) {
+        int64_t key = rand() % count - count / 2;//包含负数
+        if (rand() % 3 == 0) {
+            int ret_code = rrbtree_remove(tree, key);
+            assert_true(ret_code == (rdict_find(dict_ins, key) != NULL ? rrbtree_code_ok : rrbtree_code_not_exist));
+            rdict_remove(dict_ins, key);
+        } else {
+            assert_true(rrbtree_add(tree, key, j) == rrbtree_code_ok);
+            rdict_add(dict_ins, key, j);
+        }
+        if (j % 1000 == 0) {
+            assert_true(rtest_rrbtree_check(tree, tree->root, NULL) > 0);
+        }
+    }
+    end_benchmark("rrbtree random add/remove, with checks.");
+    assert_true(tree->root->color == rrbtree_black && rtest_rrbtree_check(tree, tree->root, NULL) > 0);
+    assert_true(rrbtree_size(tree) == rdict_size(dict_ins));
+
+    rdict_iterator_t it = rdict_it(dict_ins);
+    for (rdict_entry_t *de = NULL; (de = rdict_next(&it)) != NULL; ) {
+        rrbtree_node_t* node = rrbtree_find(tree, de->key.s64);
+        assert_true(node != NULL && node->value.s64 == de->value.s64);
+    }
+
+    rrbtree_node_t* node = NULL;
+    rrbtree_size_t visited = 0;
+    int64_t last = INT64_MIN;
+    rrbtree_foreach(tree, node) {
+        assert_true(node->key.s64 > last);
+        last = node->key.s64;
+        visited++;
+    }
+    assert_true(visited == rrbtree_size(tree) && last == rrbtree_last(tree)->key.s64);
+    for (node = rrbtree_last(tree), visited = 0; node != NULL; node = rrbtree_prev(node)) {
+        visited++;
+    }
+    assert_true(visited == rrbtree_size(tree));
+
+    for (node = rrbtree_first(tree); node != NULL; ) {//遍历中删除
+        rrbtree_node_t* node_next = rrbtree_next(node);
+        if (node->key.s64 % 2 == 0) {
+            rrbtree_remove_node(tree, node);
+        }
+        node = node_next;
+    }
+    assert_true(rtest_rrbtree_check(tree, tree->root, NULL) > 0);
+    rrbtree_foreach(tree, node) {
+        assert_true(node->key.s64 % 2 != 0);
+    }
+
+    rrbtree_clear(tree);
+    assert_true(rrbtree_size(tree) == 0 && rrbtree_first(tree) == NULL);
+    assert_true(rrbtree_add(tree, 1, 1) == rrbtree_code_ok && rrbtree_first(tree)->key.s64 == 1);
+
+    rrbtree_free(tree);
+    rdict_free(dict_ins);
+
+    uninit_benchmark();
+}
+
+static void rtest_rrbtree_sum(void* data_ext, rrbtree_node_t* node) {
+    *(int64_t*)data_ext += node->key.s64;
+}
+
+static void rrbtree_range_test(void **state) {// 边界查找和区间遍历
+    (void)state;
+    int64_t j;
+
+    rrbtree_t* tree = rrbtree_create(0, NULL);
+    for (j = 0; j < 100; j++) {
+        rrbtree_add(tree, j * 10, j);
+    }
+
+    assert_true(rrbtree_lower_bound(tree, 0)->key.s64 == 0);
+    assert_true(rrbtree_lower_bound(tree, -5)->key.s64 == 0);
+    assert_true(rrbtree_lower_bound(tree, 15)->key.s64 == 20);
+    assert_true(rrbtree_lower_bound(tree, 20)->key.s64 == 20);
+    assert_true(rrbtree_upper_bound(tree, 20)->key.s64 == 30);
+    assert_true(rrbtree_lower_bound(tree, 990)->key.s64 == 990);
+    assert_true(rrbtree_upper_bound(tree, 990) == NULL);
+    assert_true(rrbtree_lower_bound(tree, 991) == NULL);
+
+    int64_t sum = 0;
+    assert_true(rrbtree_scan_range(tree, 100, 200, rtest_rrbtree_sum, &sum) == 10);
+    assert_true(sum == 1450);
+    assert_true(rrbtree_scan_range(tree, 105, 106, NULL, NULL) == 0);
+    assert_true(rrbtree_scan_range(tree, -100, 10000, NULL, NULL) == 100);
+
+    assert_true(rrbtree_add(tree, 20, 1000) == rrbtree_code_ok);//覆盖
+    assert_true(rrbtree_size(tree) == 100 && rrbtree_find(tree, 20)->value.s64 == 1000);
+
+    for (j = 0; j < 50; j++) {//删最小节点，first跟着移动
+        assert_true(rrbtree_first(tree)->key.s64 == j * 10);
+        rrbtree_remove_node(tree, rrbtree_first(tree));
+    }
+    assert_true(rrbtree_first(tree)->key.s64 == 500 && rtest_rrbtree_check(tree, tree->root, NULL) > 0);
+
+    rrbtree_free(tree);
+}
+
+static void rrbtree_string_test(void **state) {// 字符串key，拷贝和释放走rdict的类型函数
+    (void)state;
+    char key[32];
+    int j;
+
+    rrbtree_t* tree = NULL;
+    rrbtree_init(tree, rdata_type_string, rdata_type_string, 0);
+    for (j = 0; j < 200; j++) {
+        snprintf(key, sizeof(key), "key_%03d", j);
+        assert_true(rrbtree_add(tree, key, key) == rrbtree_code_ok);
+    }
+    assert_true(rrbtree_add(tree, "key_010", "value") == rrbtree_code_ok);
+    assert_true(rrbtree_size(tree) == 200);
+    assert_true(strcmp(rrbtree_find(tree, "key_010")->value.ptr, "value") == 0);
+
+    rrbtree_node_t* node = rrbtree_lower_bound(tree, "key_1");
+    assert_true(node != NULL && strcmp(node->key.ptr, "key_100") == 0);
+    assert_true(rrbtree_scan_range(tree, "key_050", "key_060", NULL, NULL) == 10);
+    assert_true(strcmp(rrbtree_first(tree)->key.ptr, "key_000") == 0);
+    assert_true(strcmp(rrbtree_last(tree)->key.ptr, "key_199") == 0);
+
+    for (j = 0; j < 200; j += 2) {
+        snprintf(key, sizeof(key), "key_%03d", j);
+        assert_true(rrbtree_remove(tree, key) == rrbtree_code_ok);
+    }
+    assert_true(rrbtree_size(tree) == 100 && rrbtree_find(tree, "key_000") == NULL);
+    assert_true(strcmp(rrbtree_first(tree)->key.ptr, "key_001") == 0);
+
+    rrbtree_free(tree);
+}
+
+static int rtest_int64_cmp(const void* a, const void* b) {
+    int64_t v1 = *(const int64_t*)a;
+    int64_t v2 = *(const int64_t*)b;
+    return v1 == v2 ? 0 : (v1 < v2 ? -1 : 1);
+}
+
+/** 有序数组，二分查找 + memmove插入 */
+static int64_t rtest_sorted_lower_bound(int64_t* arr, int64_t size, int64_t key) {
+    int64_t low = 0;
+    int64_t high = size;
+    while (low < high) {
+        int64_t mid = (low + high) >> 1;
+        if (arr[mid] < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+static void rrbtree_bench_test(void **state) {// 对比有序数组和rdict
+    (void)state;
+    int count = 200000;
+    int count_sorted = 50000;//有序数组插入O(n)，数量小一些
+    int range_times = 1000;
+    int64_t j;
+    int64_t sum = 0;
+    int64_t sum_check = 0;
+
+    init_benchmark(1024, "test rrbtree bench(%d)", count);
+
+    int64_t* keys = rdata_new_type_array(int64_t, count);
+    srand(11);
+    for (j = 0; j < count; j++) {
+        keys[j] = ((int64_t)rand() << 16) ^ rand();
+    }
+
+    rrbtree_t* tree = rrbtree_create(count, NULL);
+    start_benchmark(0);
+    for (j = 0; j < count; j++) {
+        rrbtree_add(tree, keys[j], j);
+    }
+    end_benchmark("rrbtree add random.");
+
+    rdict_t* dict_ins = NULL;
+    rdict_init(dict_ins, rdata_type_int64, rdata_type_int64, 0, 0);
+    start_benchmark(0);
+    for (j = 0; j < count; j++) {
+        rdict_add(dict_ins, keys[j], j);
+    }
+    end_benchmark("rdict add random.");
+
+    int64_t* sorted = rdata_new_type_array(int64_t, count);
+    int64_t sorted_size = 0;
+    start_benchmark(0);
+    for (j = 0; j < count_sorted; j++) {
+        int64_t pos = rtest_sorted_lower_bound(sorted, sorted_size, keys[j]);
+        if (pos < sorted_size && sorted[pos] == keys[j]) {
+            continue;
+        }
+        memmove(sorted + pos + 1, sorted + pos, (sorted_size - pos) * sizeof(int64_t));
+        sorted[pos] = keys[j];
+        sorted_size++;
+    }
+    end_benchmark("sorted array insert random (1/4 count).");
+    for (j = count_sorted; j < count; j++) {//剩余部分直接排序，用于后面的查找对比
+        sorted[sorted_size++] = keys[j];
+    }
+    qsort(sorted, sorted_size, sizeof(int64_t), rtest_int64_cmp);
+
+    start_benchmark(0);
+    for (j = 0; j < count; j++) {
+        sum += rrbtree_find(tree, keys[j]) != NULL ? 1 : 0;
+    }
+    end_benchmark("rrbtree find.");
+    assert_true(sum == count);
+
+    start_benchmark(0);
+    for (j = 0; j < count; j++) {
+        sum_check += rdict_find(dict_ins, keys[j]) != NULL ? 1 : 0;
+    }
+    end_benchmark("rdict find.");
+    assert_true(sum_check == count);
+
+    sum_check = 0;
+    start_benchmark(0);
+    for (j = 0; j < count; j++) {
+        int64_t pos = rtest_sorted_lower_bound(sorted, sorted_size, keys[j]);
+        sum_check += pos < sorted_size && sorted[pos] == keys[j] ? 1 : 0;
+    }
+    end_benchmark("sorted array binary search.");
+    assert_true(sum_check == count);
+
+    sum = 0;
+    sum_check = 0;
+    start_benchmark(0);
+    for (j = 0; j < range_times; j++) {
+        rrbtree_node_t* node = rrbtree_lower_bound(tree, keys[j]);
+        for (int i = 0; i < 100 && node != NULL; i++, node = rrbtree_next(node)) {
+            sum += node->key.s64;
+        }
+    }
+    end_benchmark("rrbtree range scan 100 from lower_bound.");
+
+    start_benchmark(0);
+    for (j = 0; j < range_times; j++) {
+        int64_t pos = rtest_sorted_lower_bound(sorted, sorted_size, keys[j]);
+        for (int i = 0; i < 100 && pos < sorted_size; i++, pos++) {
+            sum_check += sorted[pos];
+        }
+    }
+    end_benchmark("sorted array range scan 100 from lower_bound.");
+    assert_true(sum == sum_check);
+
+    sum_check = 0;
+    start_benchmark(0);
+    for (j = 0; j < range_times / 100; j++) {//rdict无序，区间只能全表扫描
+        rdict_iterator_t it = rdict_it(dict_ins);
+        for (rdict_entry_t *de = NULL; (de = rdict_next(&it)) != NULL; ) {
+            if (de->key.s64 >= keys[j] && de->key.s64 < keys[j] + 1000000) {
+                sum_check++;
+            }
+        }
+    }
+    end_benchmark("rdict range by full scan (1/100 times).");
+
+    start_benchmark(0);
+    for (j = 0; j < count; j++) {
+        rrbtree_remove(tree, keys[j]);
+    }
+    end_benchmark("rrbtree remove.");
+    assert_true(rrbtree_size(tree) == 0);
+
+    rrbtree_free(tree);
+    rdict_free(dict_ins);
+    rdata_free_array(sorted);
+    rdata_free_array(keys);
+
+    uninit_benchmark();
+}
+
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif //__GNUC__
@@ -35,6 +35,14 @@ static void rstring_index_test(void **state) {
     char* str_join = rstr_join("test", "_", "join", " string", rstr_array_end);
     assert_true(rstr_eq(str_join, "test_join string"));
     rstr_free(str_join);
+    rarena_t* arena = rarena_thread_default();
+    str_join = rstr_join_arena(arena, "test", "_", "join", " arena", rstr_array_end);
+    assert_true(rstr_eq(str_join, "test_join arena") && arena->used == rstr_len(str_join) + 1);
+    rarena_free_size(arena, str_join);
+    str_join = rstr_join_arena(NULL, "test", "_", "join", rstr_array_end);
+    assert_true(rstr_eq(str_join, "test_join"));
+    rarena_free_size(NULL, str_join);
+    rarena_reset(arena);
     end_benchmark("rstring join.");
 
     start_benchmark(0);
@@ -0,0 +1,31 @@
+/**
+ * Copyright (c) 2014 ray
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the MIT license. See LICENSE for details.
+ *
+ * @author: Ray
+ */
+
+#include <stdio.h>
+
+#include "rlog.h"
+
+/** 二进制日志转文本，按参数顺序输出到stdout: rlogdump file1 [file2 ...] */
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s file1 [file2 ...]\n", argv[0]);
+        return 1;
+    }
+
+    int ret_code = 0;
+    for (int i = 1; i < argc; i++) {
+        if (rlog_binary_dump(argv[i], stdout) != rcode_ok) {
+            fprintf(stderr, "dump failed: %s\n", argv[i]);
+            ret_code = 1;
+        }
+    }
+    fflush(stdout);
+
+    return ret_code;
+}
@@ -13,7 +13,9 @@
 #include "rcommon.h"
 #include "rarray.h"
 #include "rdict.h"
+#include "rdict_typed.h"
 #include "rstring.h"
+#include "rarena.h"
 
 #include "recs_component.h"
 #include "recs_entity.h"
@@ -24,6 +26,15 @@ extern "C" {
 
 /* ------------------------------- Macros ------------------------------------*/
 
+#ifndef recs_frame_arena_chunk_size
+#define recs_frame_arena_chunk_size (256 * 1024)
+#endif
+
+rdict_define_typed(recs_id_map, uint64_t, void*)
+
+/** system内的帧临时内存，recs_run结束时整体回收，不需要释放 */
+#define recs_frame_new_size(ctx, size) rarena_alloc((ctx)->frame_arena, (size))
+#define recs_frame_new_array(ctx, T, count) rarena_new_array((ctx)->frame_arena, T, (count))
 
 /* ------------------------------- Structs ------------------------------------*/
 
@@ -58,9 +69,10 @@ struct recs_context_s {
     recs_entity_t* admin_entity;
     recs_execute_state_t exec_state;
     
-    rdict_t* map_entities;
-    rdict_t* map_components;
+    recs_id_map_t* map_entities;
+    recs_id_map_t* map_components;
     rarray_t* systems;
+    rarena_t* frame_arena;
 
     recs_on_init_func on_init;
     recs_on_uninit_func on_uninit;
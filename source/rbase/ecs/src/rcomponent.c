@@ -43,20 +43,20 @@ R_API recs_cmp_t* recs_cmp_new(recs_context_t* ctx, recs_cmp_type_t data_type) {
     do {
         data->id = recs_get_next_id(ctx);
 
-        if likely(!rdict_exists(ctx->map_components, (const void*)data->id)) {
+        if likely(recs_id_map_find(ctx->map_components, data->id) == NULL) {
             break;
         } else {
             rwarn("id exists, value = %"PRIu64, data->id);
         }
     } while (true);
 
-    rdict_add(ctx->map_components, (void*)data->id, data);//统一下层数据接口
+    recs_id_map_add(ctx->map_components, data->id, data);//统一下层数据接口
 
     if (ctx->on_new_cmp != NULL) {
         ret_code = ctx->on_new_cmp(ctx, data);
 
         if (ret_code != rcode_ok) {
-            rdict_remove(ctx->map_components, (const void*)data->id);
+            recs_id_map_remove(ctx->map_components, data->id);
             rwarn("create item of (%d) failed.", data_type);
 
             recs_cmp_delete(ctx, data, true);
@@ -88,7 +88,7 @@ R_API int recs_cmp_delete(recs_context_t* ctx, recs_cmp_t* data, bool destroy) {
         break;
     }
 
-    rdict_remove(ctx->map_components, (const void*)data_id);
+    recs_id_map_remove(ctx->map_components, data_id);
 
     if (ctx->on_delete_cmp != NULL) {
         ret_code = ctx->on_delete_cmp(ctx, data);
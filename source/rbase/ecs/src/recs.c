@@ -22,15 +22,6 @@
 #define recs_sys_init_size 30
 #endif
 
-//在remove和clear的时候都会执行
-static void recs_entity_dict_free_value(void* data_ext, recs_entity_t* entity) {
-    rinfo("free entity, id = %"PRIu64, entity->id);
-}
-
-static void recs_cmp_dict_free_value(void* data_ext, recs_cmp_t* cmp) {
-    rinfo("free cmp, id = %"PRIu64, cmp->id);
-}
-
 static recs_system_t* rsystem_copy_value_func(const recs_system_t* obj) {
     //recs_system_t* dest = rdata_new_size(sizeof(*obj)); //todo Ray 柔性数组申请内存，内存池不好管理！
 
@@ -63,25 +54,23 @@ int recs_init(recs_context_t* ctx, const void* cfg_data) {
 
     ctx->exec_state = recs_execute_state_uninit;
 
-    rdict_t* dict_ins = NULL;
-    rdict_init(dict_ins, rdata_type_uint64, rdata_type_ptr, recs_entity_map_init_size, 0);
-    rassert_goto(dict_ins != NULL, "", 1);
-    (dict_ins)->free_value_func = (rdict_free_value_func_type)recs_entity_dict_free_value;
-    ctx->map_entities = dict_ins;
+    ctx->map_entities = recs_id_map_create(recs_entity_map_init_size);
+    rassert_goto(ctx->map_entities != NULL, "", 1);
 
-    dict_ins = NULL;
-    rdict_init(dict_ins, rdata_type_uint64, rdata_type_ptr, recs_cmp_map_init_size, 0);
-    rassert_goto(dict_ins != NULL, "", 1);
-    (dict_ins)->free_value_func = (rdict_free_value_func_type)recs_cmp_dict_free_value;
-    ctx->map_components = dict_ins;
+    ctx->map_components = recs_id_map_create(recs_cmp_map_init_size);
+    rassert_goto(ctx->map_components != NULL, "", 1);
 
     rarray_t* array_ins = NULL;
     rarray_init(array_ins, rdata_type_ptr, recs_sys_init_size);
     array_ins->copy_value_func = (rarray_type_copy_value_func)rsystem_copy_value_func;
     array_ins->free_value_func = (rarray_type_free_value_func)rsystem_free_value_func;
     rassert_goto(array_ins != NULL, "", 1);
+    rarray_enable_index(array_ins);//system唯一，增删前的判重走索引
     ctx->systems = array_ins;
 
+    ctx->frame_arena = rarena_create(recs_frame_arena_chunk_size);
+    rassert_goto(ctx->frame_arena != NULL, "", 1);
+
     if (ctx->on_init != NULL) {
         ret_code = ctx->on_init(ctx, cfg_data);
 
@@ -118,31 +107,34 @@ int recs_uninit(recs_context_t* ctx, const void* cfg_data) {
     }
 
     rarray_release(ctx->systems);
+    rarena_free(ctx->frame_arena);
 
-    if (ctx->map_entities && rdict_size(ctx->map_entities) > 0) {
+    if (ctx->map_entities) {
         recs_entity_t* entity = NULL;
-        rdict_iterator_t it = rdict_it(ctx->map_entities);
-        for (rdict_entry_t *de = NULL; (de = rdict_next(&it)) != NULL; ) {
-            entity = (recs_entity_t*)(de->value.ptr);
+        recs_id_map_entry_t* de = NULL;
+        rdict_typed_foreach(recs_id_map, ctx->map_entities, de) {
+            entity = (recs_entity_t*)(de->value);
+            rinfo("free entity, id = %"PRIu64, de->key);
             if (entity != NULL && ctx->on_delete_entity != NULL) {
                 ctx->on_delete_entity(ctx, entity);
             }
         }
-        rdict_clear(ctx->map_entities);
+        recs_id_map_release(ctx->map_entities);
         ctx->map_entities = NULL;
     }
 
     //最后释放，避免sys，entity引用
-    if (ctx->map_components && rdict_size(ctx->map_components) > 0) {
+    if (ctx->map_components) {
         recs_cmp_t* cmp = NULL;
-        rdict_iterator_t it = rdict_it(ctx->map_components);
-        for (rdict_entry_t *de = NULL; (de = rdict_next(&it)) != NULL; ) {
-            cmp = (recs_cmp_t*)(de->value.ptr);
+        recs_id_map_entry_t* de = NULL;
+        rdict_typed_foreach(recs_id_map, ctx->map_components, de) {
+            cmp = (recs_cmp_t*)(de->value);
+            rinfo("free cmp, id = %"PRIu64, de->key);
             if (cmp != NULL && ctx->on_delete_cmp != NULL) {
                 ctx->on_delete_cmp(ctx, cmp);
             }
         }
-        rdict_clear(ctx->map_components);
+        recs_id_map_release(ctx->map_components);
         ctx->map_components = NULL;
     }
 
@@ -210,6 +202,8 @@ R_API int recs_run(recs_context_t* ctx, const void* cfg_data) {
         cur_system->late_update(ctx, cfg_data);
     }
 
+    rarena_reset(ctx->frame_arena);
+
     return ret_code;
 }
 
@@ -223,18 +217,18 @@ R_API uint64_t recs_get_next_id(recs_context_t* ctx) {
 }
 
 R_API int recs_get_entity(recs_context_t* ctx, uint64_t entity_id, recs_entity_t** ret_entity) {
-    rdict_entry_t* item = rdict_find(ctx->map_entities, (const void*)entity_id);
+    recs_id_map_entry_t* item = recs_id_map_find(ctx->map_entities, entity_id);
     if (item != NULL) {
-        *ret_entity = rdict_get_value(item);
+        *ret_entity = item->value;
     }
 
     return rcode_ok;
 }
 
 R_API int recs_get_cmp(recs_context_t* ctx, uint64_t cmp_id, recs_cmp_t** ret_cmp) {
-    rdict_entry_t* item = rdict_find(ctx->map_components, (const void*)cmp_id);
+    recs_id_map_entry_t* item = recs_id_map_find(ctx->map_components, cmp_id);
     if (item != NULL) {
-        *ret_cmp = rdict_get_value(item);
+        *ret_cmp = item->value;
     }
 
     return rcode_ok;
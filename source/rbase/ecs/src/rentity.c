@@ -36,20 +36,20 @@ R_API recs_entity_t* recs_entity_new(recs_context_t* ctx, recs_entity_type_t dat
     do {
         data->id = recs_get_next_id(ctx);
 
-        if likely(!rdict_exists(ctx->map_entities, (const void*)data->id)) {
+        if likely(recs_id_map_find(ctx->map_entities, data->id) == NULL) {
             break;
         } else {
             rwarn("id exists, value = %"PRIu64, data->id);
         }
     } while (true);
 
-    rdict_add(ctx->map_entities, (void*)data->id, data);//统一下层数据接口
+    recs_id_map_add(ctx->map_entities, data->id, data);//统一下层数据接口
 
     if (ctx->on_new_entity != NULL) {
         ret_code = ctx->on_new_entity(ctx, data);
 
         if (ret_code != rcode_ok) {
-            rdict_remove(ctx->map_entities, (const void*)data->id);
+            recs_id_map_remove(ctx->map_entities, data->id);
             rwarn("create item of (%d) failed.", data_type);
 
 			recs_entity_delete(ctx, data, true);
@@ -83,7 +83,7 @@ R_API int recs_entity_delete(recs_context_t* ctx, recs_entity_t* data, bool dest
 
     recs_cmp_remove_all(ctx, data);
 
-    rdict_remove(ctx->map_entities, (const void*)data_id);
+    recs_id_map_remove(ctx->map_entities, data_id);
 
     if (ctx->on_delete_entity != NULL) {
         ret_code = ctx->on_delete_entity(ctx, data);
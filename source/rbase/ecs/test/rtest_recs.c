@@ -49,6 +49,7 @@ static void recs_full_test(void **state) {
     for (int i = 0; i < count; i++) {
         recs_run(ctx, NULL);
         assert_true(ret_code == rcode_ok);
+        assert_true(ctx->frame_arena->used == 0 && ctx->frame_arena->peak >= sizeof(int64_t) * 100);
     }
     end_benchmark("test running recs.");
 
@@ -46,6 +46,11 @@ static int update(recs_context_t* ctx, const void* cfg_data) {
 
     rinfo("test update");
 
+    int64_t* temp_ids = recs_frame_new_array(ctx, int64_t, 100);
+    for (int i = 0; i < 100; i++) {
+        temp_ids[i] = i;
+    }
+
     return ret_code;
 }
 
@@ -12,7 +12,8 @@
 
 #include "rcommon.h"
 #include "rinterface.h"
-#include "rbuffer.h"
+#include "rchainbuf.h"
+#include "rdict_typed.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -20,6 +21,9 @@ extern "C" {
 
 /* ------------------------------- Macros ------------------------------------*/
 
+#ifndef ripc_buffer_stats_interval
+#define ripc_buffer_stats_interval 60000 //运行中输出缓冲统计的间隔，毫秒
+#endif
 
 /* ------------------------------- Structs ------------------------------------*/
 
@@ -78,18 +82,29 @@ typedef enum {
 typedef struct ripc_data_raw_s {
     uint32_t len;
     char* data;
+    rchainbuf_t* buff;//本次收到的数据所在缓冲，loop共享缓冲或连接的read_cache，NULL为read_cache
 } ripc_data_raw_t;
 
 typedef struct ripc_data_source_s {
     uint64_t ds_id;
     ripc_data_source_type_t ds_type;
     ripc_state_t state;
-    rbuffer_t* read_cache;
-    rbuffer_t* write_buff;
+    rchainbuf_t* read_cache;
+    rchainbuf_t* write_buff;
     void* ctx;
     void* stream;
 } ripc_data_source_t;
 
+rdict_define_typed(ripc_session_map, uint64_t, ripc_data_source_t*)//ds_id -> session
+
+/** 按loop线程统计 */
+typedef struct ripc_buffer_stats_s {
+    int64_t read_shared;//连接没有残留数据，读进共享缓冲的次数
+    int64_t read_private;//有残留半帧，直接读进连接read_cache的次数
+    int64_t leftover;//共享缓冲解码后剩下半帧，转给连接read_cache的次数
+    rchainbuf_stats_t slabs;//本线程slab占用，包括所有连接的read_cache/write_buff
+} ripc_buffer_stats_t;
+
 typedef int (*ripc_init_func)(void* ctx, const void* cfg_data);
 typedef int (*ripc_uninit_func)(void* ctx);
 typedef int (*ripc_open_func)(void* ctx);
@@ -119,6 +134,20 @@ typedef struct ripc_entry_s {
 
 int ripc_on_code(rdata_handler_t* handler, void* ds, void* data, int code);
 
+/** 本次收包用的缓冲：连接read_cache为空时用本线程(loop)的共享缓冲，空闲连接不占slab */
+rchainbuf_t* ripc_read_buff(ripc_data_source_t* ds);
+/** 解码后调用，共享缓冲里剩下的半帧转给连接read_cache，从池里借slab */
+int ripc_read_buff_done(ripc_data_source_t* ds, rchainbuf_t* read_buff);
+/** 处理中连接已关闭(ds已释放)时代替ripc_read_buff_done，只清空共享缓冲 */
+void ripc_read_buff_abandon(rchainbuf_t* read_buff);
+void ripc_buffer_stats(ripc_buffer_stats_t* stats);
+/** rinfo输出本线程统计，用于确定池的大小 */
+void ripc_buffer_stats_log(const char* name);
+/** loop线程收包时调用，每ripc_buffer_stats_interval毫秒输出一次统计 */
+void ripc_buffer_stats_tick(const char* name);
+/** loop线程关闭所有连接后调用，释放共享缓冲；本线程已无slab在用时再释放slab池 */
+void ripc_buffer_release();
+
 #ifdef __cplusplus
 }
 #endif
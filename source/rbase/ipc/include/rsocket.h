@@ -35,6 +35,8 @@ extern "C" {
 #include <sys/types.h>
 /* socket function */
 #include <sys/socket.h>
+/* readv/writev */
+#include <sys/uio.h>
 /* struct timeval */
 #include <sys/time.h>
 /* gethostbyname and gethostbyaddr functions */
@@ -205,6 +207,9 @@ int rsocket_send(rsocket_t* rsock_item, const char *data, size_t count, size_t *
 int rsocket_sendto(rsocket_t* rsock_item, const char *data, size_t count, size_t *sent,
         rsockaddr_t *addr, rsocket_len_t len, rtimeout_t* tm);
 int rsocket_recv(rsocket_t* rsock_item, char *data, size_t count, size_t *got, rtimeout_t* tm);
+/** 分段收发，iov一般来自rchainbuf_read_iov/rchainbuf_write_iov，一次系统调用处理多个slab，最多rchainbuf_iov_max段 */
+int rsocket_sendv(rsocket_t* rsock_item, const rchainbuf_iov_t* iov, int iov_count, size_t *sent, rtimeout_t* tm);
+int rsocket_recvv(rsocket_t* rsock_item, rchainbuf_iov_t* iov, int iov_count, size_t *got, rtimeout_t* tm);
 int rsocket_recvfrom(rsocket_t* rsock_item, char *data, int count, int *got, 
         rsockaddr_t *addr, rsocket_len_t *len, rtimeout_t* tm);
 
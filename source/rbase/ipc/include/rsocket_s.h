@@ -24,7 +24,7 @@ typedef struct rsocket_server_ctx_s {
 
     uint64_t sid_cur;
 
-    rdict_t* map_clients;
+    ripc_session_map_t* map_clients;
 } rsocket_server_ctx_t;
 
 
@@ -23,12 +23,8 @@ static int encode_on_before(rdata_handler_t* handler, void* ds, void* data) {
     static int header_len = ripc_head_default_version_len + ripc_head_default_magic_len + ripc_head_default_len_len
         + ripc_head_default_cmd_len + ripc_head_default_sid_len + ripc_head_default_crc_len + ripc_head_default_reserve0_len;
 
-    if (rbuffer_size(datasource->write_buff) == 0) {
-        rbuffer_rewind(datasource->write_buff);//只有全写完才能rewind
-    }
-    
-    if (rbuffer_left(datasource->write_buff) < (ipc_data->len + header_len)) {
-        rerror("error on handler before, is full, left: %d", rbuffer_left(datasource->write_buff));
+    if (rchainbuf_left(datasource->write_buff) < (ipc_data->len + header_len)) {//链式缓冲按需增长，只受上限约束
+        rerror_limit("error on handler before, is full, left: %u", rchainbuf_left(datasource->write_buff));
         return rcode_err_ipc_cache_full;
     }
 
@@ -53,7 +49,7 @@ static int encode_process(rdata_handler_t* handler, void* ds, void* data) {
     ripc_data_source_t* datasource = (ripc_data_source_t*)(ds);
     ripc_data_default_t* ipc_data = (ripc_data_default_t*)data;
     payload_len = ipc_data->len;
-    rbuffer_t* buffer = datasource->write_buff;
+    rchainbuf_t* buffer = datasource->write_buff;
 
     ipc_data->version = 0;
     rstr_set(ipc_data->magic, ripc_head_default_magic, ripc_head_default_magic_len);//0溢出，le覆盖
@@ -63,33 +59,33 @@ static int encode_process(rdata_handler_t* handler, void* ds, void* data) {
     ipc_data->crc = htonl(ipc_data->crc);
     ipc_data->reserve0 = htonl(ipc_data->reserve0);
 	
-    write_len = rbuffer_write(buffer, (char*)(ipc_data), header_len);
-    if (write_len != header_len) {
-        rbuffer_read_ext(buffer, -write_len);
+    ret_code = rchainbuf_write(buffer, (char*)(ipc_data), header_len);//不做部分写入
+    if (ret_code != rchainbuf_code_ok) {
         ipc_data->len = (uint32_t)ntohl(ipc_data->len);
         ipc_data->cmd = (int32_t)ntohl(ipc_data->cmd);
         ipc_data->sid = (uint64_t)ntohll(ipc_data->sid);
         ipc_data->crc = (int32_t)ntohl(ipc_data->crc);
         ipc_data->reserve0 = (uint64_t)ntohll(ipc_data->reserve0);
-        rerror("error on handler process head: %d", write_len);
+        rerror("error on handler process head: %d", ret_code);
         return rcode_err_ipc_cache_full;
     }
 
-    write_len = rbuffer_write(buffer, (char*)(ipc_data->data), payload_len);//data部分逻辑保证字节序，比如pb
-    if (write_len != payload_len) {
-        rbuffer_read_ext(buffer, -write_len - header_len);
-        rerror("error on handler process payload: %d", write_len);
+    ret_code = rchainbuf_write(buffer, (char*)(ipc_data->data), payload_len);//data部分逻辑保证字节序，比如pb
+    if (ret_code != rchainbuf_code_ok) {
+        rchainbuf_write_revert(buffer, header_len);
+        rerror("error on handler process payload: %d", ret_code);
         return rcode_err_ipc_cache_full;
     }
 
+    write_len = header_len + payload_len;
     ret_code = handler->on_after(handler, ds, data);
     if (ret_code != rcode_err_ok) {
-        rbuffer_read_ext(buffer, -write_len - header_len);
+        rchainbuf_write_revert(buffer, write_len);
         rerror("error on handler after, code: %d", ret_code);
         return ret_code;
     }
 
-    rdebug("encode, process buffer size: %d", rbuffer_size(buffer));
+    rdebug("encode, process buffer size: %u", rchainbuf_size(buffer));
 
     return ret_code;
 }
@@ -127,9 +123,10 @@ static void encode_notify(rdata_handler_t* handler, void* ds, void* data) {
 
 static int decode_on_before(rdata_handler_t* handler, void* ds, void* data) {
     ripc_data_source_t* datasource = (ripc_data_source_t*)(ds);
-    ripc_data_raw_t* data_raw = (ripc_data_raw_t*)data;
 
-    rbuffer_write_ext(datasource->read_cache, data_raw->len);//数据已经写进去了，设置正确的pos即可
+    if (datasource->read_cache == NULL) {//数据已由transport读入并提交到read_cache
+        return rcode_err_ipc_cache_null;
+    }
 
     return rcode_err_ok;
 }
@@ -150,7 +147,8 @@ static int decode_process(rdata_handler_t* handler, void* ds, void* data) {
     }
 	
     ripc_data_source_t* datasource = (ripc_data_source_t*)(ds);
-    rbuffer_t* buffer = datasource->read_cache;
+    ripc_data_raw_t* data_raw = (ripc_data_raw_t*)data;
+    rchainbuf_t* buffer = data_raw->buff != NULL ? data_raw->buff : datasource->read_cache;//共享缓冲里的半帧由transport转给read_cache
 
     //char read_temp[8];
     //require_len = ripc_head_version_len;
@@ -160,20 +158,25 @@ static int decode_process(rdata_handler_t* handler, void* ds, void* data) {
     //}
     //int8_t version = (int8_t)read_temp[0];
 
-    rdebug("process buffer...... %d", rbuffer_size(buffer));
+    rdebug("process buffer...... %u", rchainbuf_size(buffer));
 
     ripc_data_default_t ipc_data;
+    rarena_t* arena = rarena_thread_default();//消息体和回包只在本次循环内使用
+    rarena_mark_t arena_mark;
+    rchainbuf_slice_t frame;
+    static const char* response_suffix = " - server response.";
+    int response_suffix_len = (int)strlen(response_suffix);
 	while (true) {
+        arena_mark = rarena_mark(arena);
 		require_len = full_head_len;
-		read_len = rbuffer_read(buffer, (char*)(&ipc_data), require_len);
+		read_len = rchainbuf_peek(buffer, (char*)(&ipc_data), require_len);//整包到齐前不消费，不用回退
 		if (read_len != require_len) {
-			rbuffer_read_ext(buffer, -read_len);
 			break;//长度不够，返回去继续读
 		}
 
 		if (!rmem_eq(ipc_data.magic, ripc_head_default_magic, ripc_head_default_magic_len)) {
-			rerror("error on handler process, magic error: %d", rcode_err_ipc_magic);
-			rbuffer_clear(buffer);
+			rerror_limit("error on handler process, magic error: %d", rcode_err_ipc_magic);
+			rchainbuf_clear(buffer);
 			return rcode_err_ipc_magic;
 		}
 
@@ -184,33 +187,45 @@ static int decode_process(rdata_handler_t* handler, void* ds, void* data) {
         ipc_data.reserve0 = (uint64_t)ntohll(ipc_data.reserve0);
 
 		require_len = ipc_data.len - data_head_len;
-		ipc_data.data = rdata_new_size(require_len + 1);
-		read_len = rbuffer_read(buffer, (char*)(ipc_data.data), require_len);
-
-		rdebug("received msg: %d - %d - %d", require_len, read_len, rbuffer_size(buffer));
-		if (read_len != require_len) {
-			rbuffer_read_ext(buffer, -read_len);
+		rdebug("received msg: %d - %u", require_len, rchainbuf_size(buffer));
+		if (rchainbuf_size(buffer) < (rchainbuf_size_t)(full_head_len + require_len)) {
+			if (rchainbuf_size_max(buffer) < (rchainbuf_size_t)(full_head_len + require_len)) {
+				rerror("error on handler process, msg too large: %d", require_len);
+				rchainbuf_clear(buffer);
+				return rcode_err_ipc_cache_full;
+			}
 			break;//长度不够，返回去继续读
 		}
 
-		ipc_data.data[require_len] = rstr_end;
-        rdebug("received(ds_type=%d, cmd=%d) msg(len=%d): %s", datasource->ds_type, ipc_data.cmd, require_len, ipc_data.data);
+		//整帧在一个slab内时零拷贝引用，跨slab时拷贝成连续块；data不以'\0'结尾，按长度使用
+		if (rchainbuf_slice(buffer, full_head_len + require_len, &frame) != rchainbuf_code_ok) {
+			rerror("error on handler process, slice failed: %d", require_len);
+			rchainbuf_clear(buffer);
+			return rcode_err_ipc_cache_full;
+		}
+		ipc_data.data = frame.data + full_head_len;
+
+        rdebug("received(ds_type=%d, cmd=%d) msg(len=%d): %.*s", datasource->ds_type, ipc_data.cmd, require_len,
+            require_len > 128 ? 128 : require_len, ipc_data.data);//大消息只打印开头
         
         if (datasource->ds_type == ripc_data_source_type_session) {
 			rsocket_ctx_t* rsocket_ctx = datasource->ctx;
             ripc_data_default_t data_send;
 			data_send.cmd = 101;
-			data_send.data = rstr_join(ipc_data.data, " - server response.", rstr_array_end);//未释放
-            data_send.len = rstr_len(data_send.data);
+            data_send.len = require_len + response_suffix_len;
+			data_send.data = rarena_new_size(arena, data_send.len + 1);
+            memcpy(data_send.data, ipc_data.data, require_len);
+            memcpy(data_send.data + require_len, response_suffix, response_suffix_len + 1);
             rsocket_ctx->ipc_entry->send(datasource, &data_send);
-            rdata_free(char*, data_send.data);
+            rarena_free_size(arena, data_send.data);
 
             if (ipc_data.cmd == 999) {
                 rsocket_ctx->ipc_entry->stop(rsocket_ctx);
 			}
 		}
 
-        rdata_free(char*, ipc_data.data);
+        rchainbuf_slice_release(&frame);
+        rarena_rewind(arena, arena_mark);
 	}
 
     ret_code = handler->on_after(handler, ds, data);
@@ -224,15 +239,10 @@ static int decode_process(rdata_handler_t* handler, void* ds, void* data) {
 
 static int decode_on_after(rdata_handler_t* handler, void* ds, void* data) {
     ripc_data_source_t* datasource = (ripc_data_source_t*)(ds);
-    rbuffer_t* buffer = datasource->read_cache;
-    int left_size = rbuffer_left(buffer);
-
-    if (rbuffer_size(buffer) == 0 || left_size < rbuffer_capacity(buffer) / 2) {
-        rbuffer_rewind(buffer);
-    }
+    ripc_data_raw_t* data_raw = (ripc_data_raw_t*)data;
+    rchainbuf_t* buffer = data_raw->buff != NULL ? data_raw->buff : datasource->read_cache;
 
-    left_size = rbuffer_left(buffer);
-    if (left_size < 1 || left_size > rbuffer_capacity(buffer)) {
+    if (rchainbuf_left(buffer) == 0) {//链式缓冲不需要rewind
         return rcode_err_ipc_cache_full;
     }
 
@@ -8,10 +8,16 @@
  */
 
 #include "rcommon.h"
+#include "rthread.h"
 #include "rlog.h"
+#include "rtime.h"
 #include "ripc.h"
 #include "rsocket.h"
 
+static rthread_local rchainbuf_t* ripc_read_shared = NULL;
+static rthread_local ripc_buffer_stats_t ripc_buffer_stats_local;
+static rthread_local int64_t ripc_buffer_stats_next = 0;
+
 int ripc_init(const void* cfg_data) {
 
     return rcode_ok;
@@ -44,3 +50,82 @@ int ripc_on_code(rdata_handler_t* handler, void* ds, void* data, int code) {
 
     return code_ret;
 }
+
+rchainbuf_t* ripc_read_buff(ripc_data_source_t* ds) {
+    if (!rchainbuf_empty(ds->read_cache)) {
+        return ds->read_cache;
+    }
+
+    if (unlikely(ripc_read_shared == NULL)) {
+        rchainbuf_init(ripc_read_shared, rchainbuf_size_max(ds->read_cache));//和read_cache同样的上限，超长帧在解码时拒绝
+        rchainbuf_set_slab_large(ripc_read_shared);
+    }
+    return ripc_read_shared;
+}
+
+int ripc_read_buff_done(ripc_data_source_t* ds, rchainbuf_t* read_buff) {
+    if (read_buff == ds->read_cache) {
+        ripc_buffer_stats_local.read_private++;
+        return rcode_ok;
+    }
+
+    ripc_buffer_stats_local.read_shared++;
+    if (rchainbuf_empty(read_buff)) {
+        return rcode_ok;
+    }
+
+    ripc_buffer_stats_local.leftover++;
+    if (rchainbuf_splice(ds->read_cache, read_buff) != rchainbuf_code_ok) {
+        rerror("move leftover to read_cache failed, size: %u", rchainbuf_size(read_buff));
+        rchainbuf_clear(read_buff);
+        return rcode_err_ipc_cache_full;
+    }
+    return rcode_ok;
+}
+
+void ripc_read_buff_abandon(rchainbuf_t* read_buff) {
+    if (read_buff == ripc_read_shared) {
+        rchainbuf_clear(read_buff);
+    }
+}
+
+void ripc_buffer_stats(ripc_buffer_stats_t* stats) {
+    if (stats != NULL) {
+        *stats = ripc_buffer_stats_local;
+        rchainbuf_thread_stats(&stats->slabs);
+    }
+}
+
+void ripc_buffer_stats_log(const char* name) {
+    ripc_buffer_stats_t stats;
+    ripc_buffer_stats(&stats);
+    rinfo("%s buffer stats, read shared: %"PRId64", read private: %"PRId64", leftover: %"PRId64
+        ", slabs 4K: %"PRId64", 64K: %"PRId64", huge: %"PRId64", bytes: %"PRId64,
+        name, stats.read_shared, stats.read_private, stats.leftover,
+        stats.slabs.slab_small_used, stats.slabs.slab_large_used, stats.slabs.slab_huge_used, stats.slabs.bytes_used);
+}
+
+void ripc_buffer_stats_tick(const char* name) {
+    int64_t now = rtime_millisec_coarse();
+    if (likely(now < ripc_buffer_stats_next)) {
+        return;
+    }
+    if (ripc_buffer_stats_next > 0) {//启动后第一次只定时，不输出
+        ripc_buffer_stats_log(name);
+    }
+    ripc_buffer_stats_next = now + ripc_buffer_stats_interval;
+}
+
+void ripc_buffer_release() {
+    rchainbuf_stats_t slabs;
+
+    rchainbuf_free(ripc_read_shared);
+    ripc_buffer_stats_next = 0;
+
+    rchainbuf_thread_stats(&slabs);
+    if (slabs.bytes_used > 0) {//本线程还有别的连接在用slab，池留给它们
+        rinfo("rchainbuf slabs still in use, keep pools, bytes: %"PRId64, slabs.bytes_used);
+        return;
+    }
+    rchainbuf_thread_release();
+}
@@ -476,6 +476,87 @@ int rsocket_recv(rsocket_t* rsock_item, char *data, size_t count, size_t *got, r
     return rcode_io_unknown;
 }
 
+int rsocket_sendv(rsocket_t* rsock_item, const rchainbuf_iov_t* iov, int iov_count, size_t *sent, rtimeout_t* tm) {
+    int ret_code;
+    *sent = 0;
+    long sent_len = 0;
+
+    if (rsock_item->fd == SOCKET_INVALID) {
+        return rcode_io_closed;
+    }
+    if (iov_count <= 0) {
+        return rcode_io_done;
+    }
+
+    for ( ;; ) {
+        sent_len = (long) writev(rsock_item->fd, (const struct iovec*)iov, iov_count);//rchainbuf_iov_t与iovec布局一致
+
+        if (sent_len >= 0) {
+            *sent = sent_len;
+            return rcode_io_done;
+        }
+        ret_code = rerror_get_osnet_err();
+
+        if (rtimeout_done(tm)) {
+            rerror("sendv timeout. code = %d", ret_code);
+            return rcode_io_timeout;
+        }
+        if (ret_code == EPIPE) {
+            return rcode_io_closed;
+        }
+        if (ret_code == EPROTOTYPE || ret_code == EINTR) {
+            continue;
+        }
+        if (ret_code != EAGAIN && ret_code != EINPROGRESS) {//INPROGRESS
+            return ret_code;
+        }
+        return rcode_io_done;//下次外层触发
+    }
+
+    return rcode_io_unknown;
+}
+
+int rsocket_recvv(rsocket_t* rsock_item, rchainbuf_iov_t* iov, int iov_count, size_t *got, rtimeout_t* tm) {
+    int ret_code = 0;
+    *got = 0;
+    long read_len = 0;
+
+    if (rsock_item->fd == SOCKET_INVALID) {
+        return rcode_io_closed;
+    }
+    if (iov_count <= 0) {
+        return rcode_io_done;//缓冲区满，上层处理后再读
+    }
+
+    for ( ;; ) {
+        read_len = (long) readv(rsock_item->fd, (struct iovec*)iov, iov_count);
+
+        if (read_len > 0) {
+            *got = read_len;
+            return rcode_io_done;
+        }
+        if (read_len == 0) {
+            rtrace("closed by peer.");
+            return rcode_io_closed;
+        }
+
+        ret_code = rerror_get_osnet_err();
+
+        if (rtimeout_done(tm)) {
+            rtrace("recvv timeout. code = %d", ret_code);
+            return rcode_io_timeout;
+        }
+        if (ret_code == EINTR) {
+            continue;
+        }
+        if (ret_code != EAGAIN && ret_code != EINPROGRESS) {//INPROGRESS
+            return ret_code;
+        }
+        return rcode_io_done;//下次外层触发
+    }
+    return rcode_io_unknown;
+}
+
 int rsocket_recvfrom(rsocket_t* rsock_item, char *data, int count, int *got, rsockaddr_t *addr, rsocket_len_t *len, rtimeout_t* tm) {
     int ret_code;
     *got = 0;
@@ -1144,6 +1225,75 @@ int rsocket_recv(rsocket_t* rsock_item, char *data, int count, int *got, rtimeou
     }
 }
 
+/** WSABUF字段顺序和iovec不同，逐段转换 **/
+int rsocket_sendv(rsocket_t* rsock_item, const rchainbuf_iov_t* iov, int iov_count, size_t *sent, rtimeout_t* tm) {
+    int ret_code = 0;
+    WSABUF bufs[rchainbuf_iov_max];
+    DWORD sent_once = 0;
+
+    *sent = 0;
+    if (rsock_item->fd == SOCKET_INVALID) {
+        return rcode_io_closed;
+    }
+    if (iov_count <= 0) {
+        return rcode_io_done;
+    }
+    iov_count = iov_count > rchainbuf_iov_max ? rchainbuf_iov_max : iov_count;
+    for (int i = 0; i < iov_count; i++) {
+        bufs[i].buf = (CHAR*)iov[i].base;
+        bufs[i].len = (ULONG)iov[i].len;
+    }
+
+    for (;; ) {
+        if (WSASend(rsock_item->fd, bufs, (DWORD)iov_count, &sent_once, 0, NULL, NULL) == 0 && sent_once > 0) {
+            *sent = sent_once;
+            return rcode_io_done;
+        }
+
+        ret_code = rerror_get_osnet_err();
+        if (ret_code != WSAEWOULDBLOCK) {
+            return ret_code;
+        }
+        if ((ret_code = rsocket_waitfd(rsock_item, WAITFD_W, tm)) != rcode_io_done) {
+            return ret_code;
+        }
+    }
+}
+
+int rsocket_recvv(rsocket_t* rsock_item, rchainbuf_iov_t* iov, int iov_count, size_t *got, rtimeout_t* tm) {
+    int ret_code = 0;
+    WSABUF bufs[rchainbuf_iov_max];
+    DWORD recv_once = 0;
+    DWORD flags = 0;
+
+    *got = 0;
+    if (rsock_item->fd == SOCKET_INVALID) {
+        return rcode_io_closed;
+    }
+    if (iov_count <= 0) {
+        return rcode_io_done;
+    }
+    iov_count = iov_count > rchainbuf_iov_max ? rchainbuf_iov_max : iov_count;
+    for (int i = 0; i < iov_count; i++) {
+        bufs[i].buf = (CHAR*)iov[i].base;
+        bufs[i].len = (ULONG)iov[i].len;
+    }
+
+    if (WSARecv(rsock_item->fd, bufs, (DWORD)iov_count, &recv_once, &flags, NULL, NULL) == 0) {
+        if (recv_once == 0) {
+            return rcode_io_closed;
+        }
+        *got = recv_once;
+        return rcode_io_done;
+    }
+
+    ret_code = rerror_get_osnet_err();
+    if (ret_code == WSAEWOULDBLOCK) {
+        return rcode_io_done;
+    }
+    return ret_code;
+}
+
 int rsocket_recvfrom(rsocket_t* rsock_item, char *data, int count, int *got,
     rsockaddr_t *addr, rsocket_len_t *len, rtimeout_t* tm) {
     int ret_code, prev = rcode_io_done;
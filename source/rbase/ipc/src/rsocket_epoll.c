@@ -10,6 +10,7 @@
 #include "rstring.h"
 #include "rlog.h"
 #include "rtime.h"
+#include "rarena.h"
 #include "rdict.h"
 #include "rsocket_c.h"
 #include "rsocket_s.h"
@@ -24,8 +25,8 @@
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-variable"
 
-static int read_cache_size = 64 * 1024;
-static int write_buff_size = 64 * 1024;
+static int read_cache_max = 4 * 1024 * 1024;//链式缓冲按需增长，上限能放下ripc_data_default_len_max的整帧
+static int write_buff_max = 4 * 1024 * 1024;
 
 static int ripc_close_c(void* ctx);
 static int ripc_on_error_c(ripc_data_source_t* ds, void* data);
@@ -207,8 +208,8 @@ static int ripc_close_c(void* ctx) {
         return rcode_ok;
     }
 
-    rbuffer_release(ds_client->read_cache);
-    rbuffer_release(ds_client->write_buff);
+    rchainbuf_release(ds_client->read_cache);
+    rchainbuf_release(ds_client->write_buff);
 
     //从epoll移除，销毁socket对象
     if (rsock_item != NULL) {
@@ -273,9 +274,9 @@ static int ripc_start_c(void* ctx) {
                         }
 
                         ds->read_cache = NULL;
-                        rbuffer_init(ds->read_cache, read_cache_size);
+                        rchainbuf_init(ds->read_cache, read_cache_max);
                         ds->write_buff = NULL;
-                        rbuffer_init(ds->write_buff, write_buff_size);
+                        rchainbuf_init(ds->write_buff, write_buff_max);
 
                         ds->state = ripc_state_start;
                         rinfo("epoll socket client start.");
@@ -324,7 +325,7 @@ static int ripc_send_data_2buffer_c(ripc_data_source_t* ds_client, void* data) {
         ret_code = rcode_io_done;
     }
 
-    if (rbuffer_size(ds_client->write_buff) > 0) {
+    if (!rchainbuf_empty(ds_client->write_buff)) {
         repoll_item = (repoll_item_t*)rsock_item->userdata.data;
         repoll_set_event_out(repoll_item->event_val_req);
 
@@ -347,25 +348,26 @@ static int ripc_send_data_c(ripc_data_source_t* ds_client, void* data) {
     rsocket_t* rsock_item = (rsocket_t*)ds_client->stream;
     repoll_item_t* repoll_item = NULL;
 
-    const char* data_buff = rbuffer_read_start_dest(ds_client->write_buff);
-    int count = rbuffer_size(ds_client->write_buff);
-    int sent_len = 0;//立即处理
+    rchainbuf_iov_t iov[rchainbuf_iov_max];
+    int iov_count = rchainbuf_read_iov(ds_client->write_buff, iov, rchainbuf_iov_max);
+    int count = rchainbuf_size(ds_client->write_buff);
+    size_t sent_len = 0;//立即处理，多个slab一次writev
 
     rtimeout_t tm;
     rtimeout_init_millisec(&tm, 3, 3);
     rtimeout_start(&tm);
 
-    ret_code = rsocket_send(rsock_item, data_buff, (size_t)count, (size_t*)&sent_len, &tm);
+    ret_code = rsocket_sendv(rsock_item, iov, iov_count, &sent_len, &tm);
 
     if (ret_code != rcode_io_done) {
-        rwarn("end send_data, code: %d, sent_len: %d, buff_size: %d", ret_code, sent_len, count);
+        rwarn("end send_data, code: %d, sent_len: %d, buff_size: %d", ret_code, (int)sent_len, count);
         ripc_on_error_c(ds_client, NULL);
         return rcode_io_closed;//所有未知错误都断开
     }
-    rdebug("end send_data, code: %d, sent_len: %d", ret_code, sent_len);
+    rdebug("end send_data, code: %d, sent_len: %d", ret_code, (int)sent_len);
 
-    rbuffer_skip(ds_client->write_buff, sent_len);
-    if (rbuffer_size(ds_client->write_buff) == 0) {
+    rchainbuf_read_ext(ds_client->write_buff, (rchainbuf_size_t)sent_len);
+    if (rchainbuf_empty(ds_client->write_buff)) {
         repoll_item = (repoll_item_t*)rsock_item->userdata.data;
         repoll_unset_event_out(repoll_item->event_val_req);
 
@@ -391,31 +393,35 @@ static int ripc_receive_data_c(ripc_data_source_t* ds_client, void* data) {
         return rcode_err_ipc_disconnect;
     }
     
-    char* data_buff = rbuffer_write_start_dest(ds_client->read_cache);
-    int count = rbuffer_left(ds_client->read_cache);
+    rchainbuf_iov_t iov[rchainbuf_iov_max];
+    int iov_count = rchainbuf_write_iov(ds_client->read_cache, iov);
+    int count = rchainbuf_left(ds_client->read_cache);
 
-    int received_len = 0;
+    size_t received_len = 0;
 
     rtimeout_t tm;
     rtimeout_init_millisec(&tm, 1, 1);
     rtimeout_start(&tm);
 
-    ret_code = rsocket_recv(rsock_item, data_buff, (size_t)count, (size_t*)&received_len, &tm);
+    ret_code = rsocket_recvv(rsock_item, iov, iov_count, &received_len, &tm);
 
     if (ret_code == rcode_io_timeout) {
         ret_code = rcode_io_done;
     } 
 
     if (ret_code != rcode_io_done) {
-        rwarn("end client receive_data, code: %d, received_len: %d, buff_size: %d", ret_code, received_len, count);
+        rwarn("end client receive_data, code: %d, received_len: %d, buff_size: %d", ret_code, (int)received_len, count);
 
         ripc_on_error_c(ds_client, NULL);
 
         return rcode_io_closed;//所有未知错误都断开
     }
 
+    rchainbuf_write_ext(ds_client->read_cache, (rchainbuf_size_t)received_len);//readv已直接写入，提交；没读到时归还预留的空slab
+
     if(received_len > 0 && rsocket_ctx->in_handler) {
         data_raw.len = received_len;
+        data_raw.buff = ds_client->read_cache;//客户端单连接，直接读进read_cache
 
         ret_code = rsocket_ctx->in_handler->process(rsocket_ctx->in_handler, ds_client, &data_raw);
         if (ret_code != rcode_err_ok) {
@@ -529,8 +535,7 @@ static int ripc_init_server(void* ctx, const void* cfg_data) {
 
     int ret_code = rcode_ok;
 
-    rdict_t* dict_ins = NULL;
-    rdict_init(dict_ins, rdata_type_uint64, rdata_type_ptr, 2000, 0);
+    ripc_session_map_t* dict_ins = ripc_session_map_create(2000);
     rassert(dict_ins != NULL, "");
     rsocket_ctx->map_clients = dict_ins;
 
@@ -547,7 +552,8 @@ static int ripc_uninit_server(void* ctx) {
     int ret_code = rcode_ok;
 
     if (rsocket_ctx->map_clients != NULL) {
-        rdict_free(rsocket_ctx->map_clients);
+        ripc_session_map_release(rsocket_ctx->map_clients);
+        rsocket_ctx->map_clients = NULL;
     }
 
     ds_server->state = ripc_state_uninit;
@@ -712,16 +718,18 @@ static int ripc_close_server(void* ctx) {
         rsocket_destroy(rsock_item);
     }
 
-    if (rsocket_ctx->map_clients && rdict_size(rsocket_ctx->map_clients) > 0) {
-        ripc_data_source_t* ds_client = NULL;
-        rdict_iterator_t it = rdict_it(rsocket_ctx->map_clients);
-        for (rdict_entry_t *de = NULL; (de = rdict_next(&it)) != NULL; ) {
-            ds_client = (ripc_data_source_t*)(de->value.ptr);
-            close_session(ds_client);
+    if (rsocket_ctx->map_clients && rdict_typed_size(rsocket_ctx->map_clients) > 0) {
+        ripc_session_map_entry_t* de = NULL;
+        rdict_typed_foreach(ripc_session_map, rsocket_ctx->map_clients, de) {//close_session只删除当前项，不会resize
+            close_session(de->value);
         }
-        rdict_clear(rsocket_ctx->map_clients);
+        ripc_session_map_clear(rsocket_ctx->map_clients);
     }
 
+    ripc_buffer_stats_log("socket server");
+    ripc_buffer_release();//连接都已关闭，loop线程内释放共享缓冲
+    rarena_thread_release();//解码用的线程arena
+
     ds_server->state = ripc_state_closed;
 
     return rcode_ok;
@@ -760,10 +768,10 @@ static int close_session(ripc_data_source_t* ds_client) {
         return rcode_ok;
     }
 
-    rdict_remove(rsocket_ctx->map_clients, (const void*)ds_client->ds_id);
+    ripc_session_map_remove(rsocket_ctx->map_clients, ds_client->ds_id);
 
-    rbuffer_release(ds_client->read_cache);
-    rbuffer_release(ds_client->write_buff);
+    rchainbuf_release(ds_client->read_cache);
+    rchainbuf_release(ds_client->write_buff);
 
     //从epoll移除，销毁socket对象
     if (rsock_item != NULL) {
@@ -806,7 +814,7 @@ static int ripc_send_data_2buffer_server(ripc_data_source_t* ds_client, void* da
         ret_code = rcode_io_done;
     }
 
-    if (rbuffer_size(ds_client->write_buff) > 0) {
+    if (!rchainbuf_empty(ds_client->write_buff)) {
         repoll_item = (repoll_item_t*)rsock_item->userdata.data;
         repoll_set_event_out(repoll_item->event_val_req);
 
@@ -829,18 +837,19 @@ static int ripc_send_data_server(ripc_data_source_t* ds_client, void* data) {
     rsocket_t* rsock_item = (rsocket_t*)ds_client->stream;
     repoll_item_t* repoll_item = NULL;
 
-    const char* data_buff = rbuffer_read_start_dest(ds_client->write_buff);
-    int count = rbuffer_size(ds_client->write_buff);
-    int sent_len = 0;//立即处理
+    rchainbuf_iov_t iov[rchainbuf_iov_max];
+    int iov_count = rchainbuf_read_iov(ds_client->write_buff, iov, rchainbuf_iov_max);
+    int count = rchainbuf_size(ds_client->write_buff);
+    size_t sent_len = 0;//立即处理，多个slab一次writev
     
     rtimeout_t tm;
     rtimeout_init_millisec(&tm, 3, 3);
     rtimeout_start(&tm);
 
-    ret_code = rsocket_send(rsock_item, data_buff, (size_t)count, (size_t*)&sent_len, &tm);
+    ret_code = rsocket_sendv(rsock_item, iov, iov_count, &sent_len, &tm);
 
     if (ret_code != rcode_io_done) {
-        rwarn("end send_data, code: %d, sent_len: %d, buff_size: %d", ret_code, sent_len, count);
+        rwarn("end send_data, code: %d, sent_len: %d, buff_size: %d", ret_code, (int)sent_len, count);
 
         if (ret_code == rcode_io_timeout) {
             return rcode_err_ipc_timeout;
@@ -850,8 +859,8 @@ static int ripc_send_data_server(ripc_data_source_t* ds_client, void* data) {
         }
     }
 
-    rbuffer_skip(ds_client->write_buff, sent_len);
-    if (rbuffer_size(ds_client->write_buff) == 0) {
+    rchainbuf_read_ext(ds_client->write_buff, (rchainbuf_size_t)sent_len);
+    if (rchainbuf_empty(ds_client->write_buff)) {
         repoll_item = (repoll_item_t*)rsock_item->userdata.data;
         repoll_unset_event_out(repoll_item->event_val_req);
 
@@ -862,7 +871,7 @@ static int ripc_send_data_server(ripc_data_source_t* ds_client, void* data) {
         }
     }
 
-    rtrace("end send_data, code: %d, sent_len: %d", ret_code, sent_len);
+    rtrace("end send_data, code: %d, sent_len: %d", ret_code, (int)sent_len);
 
     return rcode_ok;
 }
@@ -879,38 +888,53 @@ static int ripc_receive_data_server(ripc_data_source_t* ds_client, void* data) {
         return rcode_err_ipc_disconnect;
     }
     
-    char* data_buff = rbuffer_write_start_dest(ds_client->read_cache);
-    int count = rbuffer_left(ds_client->read_cache);
+    rchainbuf_t* read_buff = ripc_read_buff(ds_client);//没有残留半帧时读进loop共享缓冲
+    rchainbuf_iov_t iov[rchainbuf_iov_max];
+    int iov_count = rchainbuf_write_iov(read_buff, iov);
+    int count = rchainbuf_left(ds_client->read_cache);
 
-    int received_len = 0;
+    size_t received_len = 0;
 
     rtimeout_t tm;
     rtimeout_init_millisec(&tm, 1, 1);
     rtimeout_start(&tm);
 
-    ret_code = rsocket_recv(rsock_item, data_buff, (size_t)count, (size_t*)&received_len, &tm);
+    ret_code = rsocket_recvv(rsock_item, iov, iov_count, &received_len, &tm);
 
     if (ret_code == rcode_io_timeout) {
         ret_code = rcode_io_done;
     }
 
     if (ret_code != rcode_io_done) {
-        rtrace("end client recv_data, code: %d, received_len: %d, buff_size: %d", ret_code, received_len, count);
+        rtrace("end client recv_data, code: %d, received_len: %d, buff_size: %d", ret_code, (int)received_len, count);
 
         ripc_on_error_server(ds_client, NULL);
 
         return rcode_io_closed;//所有未知错误都断开
     }
 
+    rchainbuf_write_ext(read_buff, (rchainbuf_size_t)received_len);//readv已直接写入，提交；没读到时归还预留的空slab
+
     if(received_len > 0 && rsocket_ctx->in_handler) {
         data_raw.len = received_len;
+        data_raw.buff = read_buff;
 
+        uint64_t ds_id = ds_client->ds_id;//回包失败会在process里关闭并释放ds_client
         ret_code = rsocket_ctx->in_handler->process(rsocket_ctx->in_handler, ds_client, &data_raw);
+        if (ripc_session_map_find(((rsocket_server_ctx_t*)rsocket_ctx)->map_clients, ds_id) == NULL) {
+            ripc_read_buff_abandon(read_buff);
+            return rcode_io_closed;
+        }
+        if (ripc_read_buff_done(ds_client, read_buff) != rcode_ok) {//剩下的半帧转给read_cache，共享缓冲留给下一个连接
+            ret_code = rcode_err_ipc_cache_full;
+        }
         if (ret_code != rcode_err_ok) {
             rerror("error on handler process, code: %d", ret_code);
             return rcode_err_ipc_decode;
         }
         ret_code = rcode_io_done;
+    } else if (received_len > 0) {
+        ripc_read_buff_done(ds_client, read_buff);
     }
 
     return rcode_ok;
@@ -989,12 +1013,12 @@ static int ripc_accept_server(ripc_data_source_t* ds_server, void* data) {
     ds_client->ds_type = ripc_data_source_type_session;
     ds_client->ds_id = ++ rsocket_ctx->sid_cur;
     ds_client->read_cache = NULL;
-    rbuffer_init(ds_client->read_cache, read_cache_size);
+    rchainbuf_init(ds_client->read_cache, read_cache_max);
     ds_client->write_buff = NULL;
-    rbuffer_init(ds_client->write_buff, write_buff_size);
+    rchainbuf_init(ds_client->write_buff, write_buff_max);
     ds_client->ctx = rsocket_ctx;
 
-    rdict_add(rsocket_ctx->map_clients, (void*)ds_client->ds_id, ds_client);
+    ripc_session_map_add(rsocket_ctx->map_clients, ds_client->ds_id, ds_client);
 
     if (rsocket_setopt(rsock_item, RSO_NONBLOCK, true) != rcode_ok) {
         rgoto(1);
@@ -1032,10 +1056,10 @@ static int ripc_accept_server(ripc_data_source_t* ds_server, void* data) {
 
 exit1:
     if (ds_client != NULL) {
-        rdict_remove(rsocket_ctx->map_clients, (const void*)ds_client->ds_id);
+        ripc_session_map_remove(rsocket_ctx->map_clients, ds_client->ds_id);
 
-        rbuffer_release(ds_client->read_cache);
-        rbuffer_release(ds_client->write_buff);
+        rchainbuf_release(ds_client->read_cache);
+        rchainbuf_release(ds_client->write_buff);
 
         rdata_free(ripc_data_source_t, ds_client);
     }
@@ -1070,9 +1094,10 @@ static int ripc_check_data_server(ripc_data_source_t* ds_server, void* data) {
 
     ret_code = repoll_poll(container, 0);//不要用边缘触发模式，可能会调用多次，单进程单线程不会惊群，不等待
     if (ret_code != rcode_ok){
-        rerror("epoll_wait failed. code = %d", ret_code);
+        rerror_limit("epoll_wait failed. code = %d", ret_code);
         return ret_code;
     }
+    ripc_buffer_stats_tick("socket server");
     
     if (container->fd_dest_count > 0) {
         rtrace("fd count = %d", container->fd_dest_count);
@@ -1087,7 +1112,7 @@ static int ripc_check_data_server(ripc_data_source_t* ds_server, void* data) {
             //监听端口事件处理
             if (dest_item->ds == ds_server){
                 if (repoll_check_event_err(dest_item->event_val_rsp)) {
-                    rerror("error of socket, fd = ", dest_item->fd);
+                    rerror_limit("error of socket, fd = %d", dest_item->fd);
                     ripc_close_server(rsocket_ctx);//直接关闭
                     continue;
                 }
@@ -1096,7 +1121,7 @@ static int ripc_check_data_server(ripc_data_source_t* ds_server, void* data) {
                     if likely(ds_server->state == ripc_state_start) {
                         ripc_append_server(ds_server, data);
                     } else {
-                        rwarn("server not on service, state = %d", ds_server->state);
+                        rwarn_limit("server not on service, state = %d", ds_server->state);
                     }
                 }
 
@@ -1107,7 +1132,7 @@ static int ripc_check_data_server(ripc_data_source_t* ds_server, void* data) {
                             
                         }
                     } else {
-                        rwarn("server not on service, state = %d", ds_server->state);
+                        rwarn_limit("server not on service, state = %d", ds_server->state);
                     }
                 }
 
@@ -17,8 +17,8 @@
 #include <sys/poll.h>
 
 
-static int read_cache_size = 64 * 1024;
-static int write_buff_size = 64 * 1024;
+static int read_cache_max = 4 * 1024 * 1024;//链式缓冲按需增长，上限能放下ripc_data_default_len_max的整帧
+static int write_buff_max = 4 * 1024 * 1024;
 
 #define wait_read POLLIN
 #define wait_write POLLOUT
@@ -221,9 +221,9 @@ static int ripc_open_c(void* ctx) {
     }
 
     ds_client->read_cache = NULL;
-    rbuffer_init(ds_client->read_cache, read_cache_size);
+    rchainbuf_init(ds_client->read_cache, read_cache_max);
     ds_client->write_buff = NULL;
-    rbuffer_init(ds_client->write_buff, write_buff_size);
+    rchainbuf_init(ds_client->write_buff, write_buff_max);
 
     ds_client->stream = rsock_item;
     ds_client->state = ripc_state_ready;
@@ -250,8 +250,8 @@ static int ripc_close_c(void* ctx) {
             ds_client->state == ripc_state_disconnect || 
             ds_client->state == ripc_state_start || 
             ds_client->state == ripc_state_stop) {
-    	rbuffer_release(ds_client->read_cache);
-    	rbuffer_release(ds_client->write_buff);
+    	rchainbuf_release(ds_client->read_cache);
+    	rchainbuf_release(ds_client->write_buff);
 
         rsocket_close(ds_client->stream);
         rsocket_destroy(ds_client->stream);
@@ -301,9 +301,10 @@ static int ripc_send_data_c(ripc_data_source_t* ds_client, void* data) {
         ret_code = rcode_io_done;
     }
 
-    const char* data_buff = rbuffer_read_start_dest(ds_client->write_buff);
-    int count = rbuffer_size(ds_client->write_buff);
-    int sent_len = 0;//立即处理
+    rchainbuf_iov_t iov[rchainbuf_iov_max];
+    int iov_count = 0;
+    int count = rchainbuf_size(ds_client->write_buff);
+    size_t sent_len = 0;//立即处理
     int total = 0;
     
     rtimeout_t tm;
@@ -317,7 +318,9 @@ static int ripc_send_data_c(ripc_data_source_t* ds_client, void* data) {
             break;
         }
 
-        ret_code = rsocket_send((rsocket_t*)(ds_client->stream), data_buff + total, (size_t)count, (size_t*)&sent_len, &tm);
+        iov_count = rchainbuf_read_iov(ds_client->write_buff, iov, rchainbuf_iov_max);
+        ret_code = rsocket_sendv((rsocket_t*)(ds_client->stream), iov, iov_count, &sent_len, &tm);
+        rchainbuf_read_ext(ds_client->write_buff, (rchainbuf_size_t)sent_len);//已发送的立即出队，下一轮iov从新位置开始
         total += sent_len;
 
         if (total >= count) {
@@ -326,7 +329,7 @@ static int ripc_send_data_c(ripc_data_source_t* ds_client, void* data) {
         }
 
         if (ret_code != rcode_io_done) {
-            rwarn("end client send_data, code: %d, sent_len: %d, total: %d", ret_code, sent_len, total);
+            rwarn("end client send_data, code: %d, sent_len: %d, total: %d", ret_code, (int)sent_len, total);
 
             // ripc_close_c(rsocket_ctx);//直接关闭
             if (ret_code == rcode_io_timeout) {
@@ -338,9 +341,8 @@ static int ripc_send_data_c(ripc_data_source_t* ds_client, void* data) {
             }
         }
     }
-	rdebug("end client send_data, code: %d, sent_len: %d", ret_code, sent_len);
+	rdebug("end client send_data, code: %d, sent_len: %d", ret_code, (int)sent_len);
 
-	rbuffer_skip(ds_client->write_buff, total);
     return ret_code;
 }
 
@@ -355,10 +357,10 @@ static int ripc_receive_data_c(ripc_data_source_t* ds_client, void* data) {
         return rcode_err_ipc_disconnect;
     }
     
-    char* data_buff = rbuffer_write_start_dest(ds_client->read_cache);
-    int count = rbuffer_left(ds_client->read_cache);
+    rchainbuf_iov_t iov[rchainbuf_iov_max];
+    int iov_count = 0;
 
-    int received_len = 0;
+    size_t received_len = 0;
     int total = 0;
 
     rtimeout_t tm;
@@ -373,7 +375,9 @@ static int ripc_receive_data_c(ripc_data_source_t* ds_client, void* data) {
             break;
         }
 
-        ret_code = rsocket_recv((rsocket_t*)(ds_client->stream), data_buff + total, (size_t)count, (size_t*)&received_len, &tm);
+        iov_count = rchainbuf_write_iov(ds_client->read_cache, iov);
+        ret_code = rsocket_recvv((rsocket_t*)(ds_client->stream), iov, iov_count, &received_len, &tm);
+        rchainbuf_write_ext(ds_client->read_cache, (rchainbuf_size_t)received_len);//readv已直接写入，提交
         total += received_len;
 
         if (received_len == 0) {//读不到直接下次再读
@@ -393,7 +397,7 @@ static int ripc_receive_data_c(ripc_data_source_t* ds_client, void* data) {
     }
 
     if (ret_code != rcode_io_done) {
-        rwarn("end client send_data, code: %d, received_len: %d, total: %d", ret_code, received_len, total);
+        rwarn("end client send_data, code: %d, received_len: %d, total: %d", ret_code, (int)received_len, total);
 
         ripc_close_c(rsocket_ctx);//直接关闭
         if (ret_code == rcode_io_timeout) {
@@ -406,6 +410,7 @@ static int ripc_receive_data_c(ripc_data_source_t* ds_client, void* data) {
 
     if(total > 0 && rsocket_ctx->in_handler) {
         data_raw.len = total;
+        data_raw.buff = ds_client->read_cache;//客户端单连接，直接读进read_cache
 
         ret_code = rsocket_ctx->in_handler->process(rsocket_ctx->in_handler, ds_client, &data_raw);
         if (ret_code != rcode_err_ok) {
@@ -25,8 +25,8 @@ typedef struct {
 } local_write_req_t;
 
 
-static int read_cache_size = 64 * 1024;
-static int write_buff_size = 64 * 1024;
+static int read_cache_max = 4 * 1024 * 1024;//链式缓冲按需增长，上限能放下ripc_data_default_len_max的整帧
+static int write_buff_max = 4 * 1024 * 1024;
 
 static int ripc_close(void* ctx);
 
@@ -53,11 +53,11 @@ static void after_write(uv_write_t *req, int status) {
 
     local_write_req_t* wr = (local_write_req_t*)req->data;
     ripc_data_source_t* ds = wr->ds;
-    rbuffer_skip(ds->write_buff, wr->write_size);
+    rchainbuf_read_ext(ds->write_buff, wr->write_size);//发送完成才出队，期间这段数据不会被覆盖
     rdata_free(local_write_req_t, wr);
     rdata_free(uv_write_t, req);
 
-    rdebug("writing buff left bytes: %d - %d", rbuffer_write_start_pos(ds->write_buff), rbuffer_size(ds->write_buff));
+    rdebug("writing buff left bytes: %u", rchainbuf_size(ds->write_buff));
 }
 static int send_data(ripc_data_source_t* ds_client, void* data) {
     int ret_code = rcode_ok;
@@ -73,21 +73,26 @@ static int send_data(ripc_data_source_t* ds_client, void* data) {
         }
     }
 
-    uv_buf_t buf;
-    //buf = uv_buf_init(data->data, data->len);//结构体内容复制
-    buf.base = rbuffer_read_start_dest(ds_client->write_buff);
-    buf.len = rbuffer_size(ds_client->write_buff);
+    uv_buf_t buf[rchainbuf_iov_max];
+    rchainbuf_iov_t iov[rchainbuf_iov_max];
+    int iov_count = rchainbuf_read_iov(ds_client->write_buff, iov, rchainbuf_iov_max);
+    for (int i = 0; i < iov_count; i++) {//多个slab一次uv_write，win下uv_buf_t字段顺序不同，不能强转
+        buf[i] = uv_buf_init((char*)iov[i].base, (unsigned int)iov[i].len);//结构体内容复制
+    }
 
     wr = rdata_new(local_write_req_t);
     wr->ds = ds_client;
-    wr->write_size = buf.len;
+    wr->write_size = 0;
+    for (int i = 0; i < iov_count; i++) {//超过rchainbuf_iov_max段时剩余部分下次发送
+        wr->write_size += (int)iov[i].len;
+    }
 
     req = rdata_new(uv_write_t);
     req->data = wr;
 
     //unix间接调用uv_write2 malloc了buf放到req里再cb，但是win里tcp实现是直接WSASend！操蛋
-    ret_code = uv_write(req, (uv_stream_t*)(ds_client->stream), &buf, 1, after_write);
-    rtrace("end client send_data, req: %p, buf: %p", req, &buf);
+    ret_code = uv_write(req, (uv_stream_t*)(ds_client->stream), buf, iov_count, after_write);
+    rtrace("end client send_data, req: %p, buf: %p", req, buf);
     //rdebug("send_data, len: %d, dest_len: %p, data_buf: %p", data->len, data->data, buf.base);
 
     if (ret_code != rcode_ok) {
@@ -104,8 +109,8 @@ static void on_close(uv_handle_t* peer) {
     rsocket_ctx_uv_t* rsocket_ctx = (rsocket_ctx_uv_t*)(ds_client->ctx);
     rtrace("on client close, id = %"PRIu64", ", ds_client->ds_id);
 
-    rbuffer_release(ds_client->read_cache);
-    rbuffer_release(ds_client->write_buff);
+    rchainbuf_release(ds_client->read_cache);
+    rchainbuf_release(ds_client->write_buff);
     //rdata_free(ripc_data_source_t, ds_client);//外面释放
     //rdata_free(uv_tcp_t, peer);
     
@@ -144,10 +149,12 @@ static void after_read(uv_stream_t* handle, ssize_t nread, const uv_buf_t* buf)
 
     if (nread == 0) {
         /* Everything OK, but nothing read. */
-        //rstr_free(((uv_buf_t*)buf)->base);//buffer
+        rchainbuf_write_ext(ds_client->read_cache, 0);//归还alloc时预留的空slab
         return;
     }
 
+    rchainbuf_write_ext(ds_client->read_cache, (rchainbuf_size_t)nread);//数据已直接收进read_cache，提交
+
     if (ctx->in_handler) {
         //if (ds->read_type == append_new) { //每一次都是new一个空间去读
             //data_raw.len = nread;
@@ -155,6 +162,7 @@ static void after_read(uv_stream_t* handle, ssize_t nread, const uv_buf_t* buf)
         //} else if (append_cache) {//
 
         data_raw.len = nread;
+        data_raw.buff = ds_client->read_cache;//客户端单连接，直接读进read_cache
         //data_raw.data = ds->read_cache;
         //}
 
@@ -172,8 +180,14 @@ static void read_alloc_static(uv_handle_t* handle, size_t suggested_size, uv_buf
     //static char slab[16 * 1024];
     //todo Ray 多线程收发会有问题
     ripc_data_source_t* ds_client = (ripc_data_source_t*)(handle->data);
-    buf->base = rbuffer_write_start_dest(ds_client->read_cache);
-    buf->len = rbuffer_left(ds_client->read_cache);
+    rchainbuf_iov_t iov[rchainbuf_iov_max];
+    if (rchainbuf_write_iov(ds_client->read_cache, iov) > 0) {//uv每次只收一段，新追加的slab下次回调再用
+        buf->base = (char*)iov[0].base;
+        buf->len = iov[0].len;
+    } else {
+        buf->base = NULL;
+        buf->len = 0;
+    }
 }
 static void connect_cb(uv_connect_t* req, int status) {
     if (req == NULL || status != 0) {
@@ -189,9 +203,9 @@ static void connect_cb(uv_connect_t* req, int status) {
     //req->handle->data = ds_client;
 
     ds_client->read_cache = NULL;
-    rbuffer_init(ds_client->read_cache, read_cache_size);
+    rchainbuf_init(ds_client->read_cache, read_cache_max);
     ds_client->write_buff = NULL;
-    rbuffer_init(ds_client->write_buff, write_buff_size);
+    rchainbuf_init(ds_client->write_buff, write_buff_max);
 
     ds_client->state = ripc_state_ready;
 
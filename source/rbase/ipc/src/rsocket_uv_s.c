@@ -12,6 +12,7 @@
 #include "rstring.h"
 #include "rlog.h"
 #include "rdict.h"
+#include "rarena.h"
 #include "rsocket_uv_s.h"
 #include "rcodec_default.h"
 
@@ -28,8 +29,8 @@ typedef struct {
 } local_write_req_t;
 
 
-static int read_cache_size = 64 * 1024;
-static int write_buff_size = 64 * 1024;
+static int read_cache_max = 4 * 1024 * 1024;//链式缓冲按需增长，上限能放下ripc_data_default_len_max的整帧
+static int write_buff_max = 4 * 1024 * 1024;
 
 static int send_data(ripc_data_source_t* ds, void* data);
 static void after_read(uv_stream_t*, ssize_t nread, const uv_buf_t* buf);
@@ -48,8 +49,14 @@ static void read_alloc_static(uv_handle_t* handle, size_t suggested_size, uv_buf
     //static char slab[16 * 1024];
     //todo Ray 多线程收发会有问题
     ripc_data_source_t* ds = (ripc_data_source_t*)(handle->data);
-    buf->base = rbuffer_write_start_dest(ds->read_cache);
-    buf->len = rbuffer_left(ds->read_cache);
+    rchainbuf_iov_t iov[rchainbuf_iov_max];
+    if (rchainbuf_write_iov(ripc_read_buff(ds), iov) > 0) {//没有残留半帧时读进loop共享缓冲，after_read里同样判断//uv每次只收一段，新追加的slab下次回调再用
+        buf->base = (char*)iov[0].base;
+        buf->len = iov[0].len;
+    } else {
+        buf->base = NULL;
+        buf->len = 0;
+    }
 }
 
 //static void send_data(uv_stream_t* handle, ripc_data_default_t* data) {
@@ -134,16 +141,16 @@ static int on_connection(uv_stream_t* server, int status) {
         ds_client->ds_type = ripc_data_source_type_session;
         ds_client->ds_id = ++rsocket_ctx->sid_cur;
         ds_client->read_cache = NULL;
-        rbuffer_init(ds_client->read_cache, read_cache_size);
+        rchainbuf_init(ds_client->read_cache, read_cache_max);
         ds_client->write_buff = NULL;
-        rbuffer_init(ds_client->write_buff, write_buff_size);
+        rchainbuf_init(ds_client->write_buff, write_buff_max);
         ds_client->ctx = rsocket_ctx;
         ds_client->stream = stream;
 
         /* client关联到ds对象，ds->ctx = context*/
         stream->data = ds_client;
 
-        rdict_add(rsocket_ctx->map_clients, (void*)ds_client->ds_id, ds_client);
+        ripc_session_map_add(rsocket_ctx->map_clients, ds_client->ds_id, ds_client);
 
         ret_code = uv_read_start(stream, read_alloc_static, after_read);
         if (ret_code != 0) {
@@ -180,10 +187,10 @@ exit1:
         }
 
         if (ds_client != NULL) {
-            rdict_remove(rsocket_ctx->map_clients, (const void*)ds_client->ds_id);
+            ripc_session_map_remove(rsocket_ctx->map_clients, ds_client->ds_id);
 
-            rbuffer_release(ds_client->read_cache);
-            rbuffer_release(ds_client->write_buff);
+            rchainbuf_release(ds_client->read_cache);
+            rchainbuf_release(ds_client->write_buff);
 
             rdata_free(ripc_data_source_t, ds_client);
         }
@@ -211,6 +218,7 @@ static void after_read(uv_stream_t* handle, ssize_t nread, const uv_buf_t* buf)
     ripc_data_source_t* ds = (ripc_data_source_t*)(handle->data);
     rsocket_ctx_uv_t* rsocket_ctx = (rsocket_ctx_uv_t*)(ds->ctx);
     ripc_data_raw_t data_raw;//直接在栈上
+    rchainbuf_t* read_buff = ripc_read_buff(ds);//和alloc时是同一个缓冲
 
     local_write_req_t *wr;
     uv_shutdown_t* sreq;
@@ -241,10 +249,13 @@ static void after_read(uv_stream_t* handle, ssize_t nread, const uv_buf_t* buf)
 
     if (nread == 0) {
         /* Everything OK, but nothing read. */
-        //rstr_free(((uv_buf_t*)buf)->base);//buffer
+        rchainbuf_write_ext(read_buff, 0);//归还alloc时预留的空slab
         return;
     }
 
+    rchainbuf_write_ext(read_buff, (rchainbuf_size_t)nread);//数据已直接收进缓冲，提交
+    ripc_buffer_stats_tick("socket server");
+
     if (rsocket_ctx->in_handler) {
         //if (ds->read_type == append_new) { //每一次都是new一个空间去读
             //data_raw.len = nread;
@@ -252,15 +263,26 @@ static void after_read(uv_stream_t* handle, ssize_t nread, const uv_buf_t* buf)
         //} else if (append_cache) {//
 
         data_raw.len = nread;
+        data_raw.buff = read_buff;
         //data_raw.data = ds->read_cache;
         //}
 
+        uint64_t ds_id = ds->ds_id;//process里可能关闭连接(stop等)，之后不再碰ds
         ret_code = rsocket_ctx->in_handler->process(rsocket_ctx->in_handler, ds, &data_raw);
+        if (ripc_session_map_find(((rsocket_server_ctx_uv_t*)rsocket_ctx)->map_clients, ds_id) == NULL) {
+            ripc_read_buff_abandon(read_buff);
+            return;
+        }
+        if (ripc_read_buff_done(ds, read_buff) != rcode_ok) {//剩下的半帧转给read_cache，共享缓冲留给下一个连接
+            ret_code = rcode_err_ipc_cache_full;
+        }
         if (ret_code != rcode_err_ok) {
             rerror("error on handler process, code: %d", ret_code);
             return;
         }
 
+    } else {
+        ripc_read_buff_done(ds, read_buff);
     }
 }
 
@@ -279,12 +301,12 @@ static void after_write(uv_write_t *req, int status) {
         }
     }
 
-    rbuffer_skip(ds->write_buff, wr->write_size);
+    rchainbuf_read_ext(ds->write_buff, wr->write_size);//发送完成才出队，期间这段数据不会被覆盖
     rdata_free(local_write_req_t, wr);
     rdata_free(uv_write_t, req);
     //free_write_req(req);
 
-    rdebug("writing buff left bytes: %d - %d", rbuffer_write_start_pos(ds->write_buff), rbuffer_size(ds->write_buff));
+    rdebug("writing buff left bytes: %u", rchainbuf_size(ds->write_buff));
 }
 static int send_data(ripc_data_source_t* ds, void* data) {
     int ret_code = rcode_ok;
@@ -302,21 +324,26 @@ static int send_data(ripc_data_source_t* ds, void* data) {
         }
     }
 
-    uv_buf_t buf;
-    //buf = uv_buf_init(data->data, data->len);//结构体内容复制
-    buf.base = rbuffer_read_start_dest(ds->write_buff);
-    buf.len = rbuffer_size(ds->write_buff);
+    uv_buf_t buf[rchainbuf_iov_max];
+    rchainbuf_iov_t iov[rchainbuf_iov_max];
+    int iov_count = rchainbuf_read_iov(ds->write_buff, iov, rchainbuf_iov_max);
+    for (int i = 0; i < iov_count; i++) {//多个slab一次uv_write，win下uv_buf_t字段顺序不同，不能强转
+        buf[i] = uv_buf_init((char*)iov[i].base, (unsigned int)iov[i].len);//结构体内容复制
+    }
 
     wr = rdata_new(local_write_req_t);
     wr->ds = ds;
-    wr->write_size = buf.len;
+    wr->write_size = 0;
+    for (int i = 0; i < iov_count; i++) {//超过rchainbuf_iov_max段时剩余部分下次发送
+        wr->write_size += (int)iov[i].len;
+    }
 
     req = rdata_new(uv_write_t);
     req->data = wr;
 
     //unix间接调用uv_write2 malloc了buf放到req里再cb，但是win里tcp实现是直接WSASend！操蛋
-    ret_code = uv_write(req, (uv_stream_t*)(ds->stream), &buf, 1, after_write);
-    rtrace("end server send_data, req: %p, buf: %p", req, &buf);
+    ret_code = uv_write(req, (uv_stream_t*)(ds->stream), buf, iov_count, after_write);
+    rtrace("end server send_data, req: %p, buf: %p", req, buf);
     //rtrace("send_data, len: %d, dest_len: %p, data_buf: %p", data->len, data->data, buf.base);
 
     if (ret_code != rcode_ok) {
@@ -333,15 +360,15 @@ static void on_session_close(uv_handle_t* peer) {
     rsocket_server_ctx_uv_t* rsocket_ctx = (rsocket_server_ctx_uv_t*)(ds->ctx);
     rinfo("on session close, id = %"PRIu64", peer = %p", ds->ds_id, peer);
 
-    if (ds->ds_type == ripc_data_source_type_session && rdict_exists(rsocket_ctx->map_clients, (const void*)ds->ds_id)) {
+    if (ds->ds_type == ripc_data_source_type_session && ripc_session_map_find(rsocket_ctx->map_clients, ds->ds_id) != NULL) {
         if (rsocket_ctx->in_handler) {
             rsocket_ctx->in_handler->on_code(rsocket_ctx->in_handler, ds, NULL, rcode_err_ipc_disconnect);
         }
 
-        rdict_remove(rsocket_ctx->map_clients, (const void*)ds->ds_id);
+        ripc_session_map_remove(rsocket_ctx->map_clients, ds->ds_id);
 
-        rbuffer_release(ds->read_cache);
-        rbuffer_release(ds->write_buff);
+        rchainbuf_release(ds->read_cache);
+        rchainbuf_release(ds->write_buff);
         rdata_free(uv_tcp_t, ds->stream);
         rdata_free(ripc_data_source_t, ds);
     } else if (ds->ds_type == ripc_data_source_type_server) {
@@ -563,8 +590,7 @@ static int ripc_init(void* ctx, const void* cfg_data) {
     rsocket_server_ctx_uv_t* rsocket_ctx = (rsocket_server_ctx_uv_t*)ctx;
     ripc_data_source_t* ds_server = (ripc_data_source_t*)rsocket_ctx->ds;
 
-    rdict_t* dict_ins = NULL;
-    rdict_init(dict_ins, rdata_type_uint64, rdata_type_ptr, 2000, 0);
+    ripc_session_map_t* dict_ins = ripc_session_map_create(2000);
     rassert(dict_ins != NULL, "");
 	rsocket_ctx->map_clients = dict_ins;
 
@@ -580,7 +606,8 @@ static int ripc_uninit(void* ctx) {
     ripc_data_source_t* ds_server = (ripc_data_source_t*)rsocket_ctx->ds;
 
     if (rsocket_ctx->map_clients != NULL) {
-        rdict_free(rsocket_ctx->map_clients);
+        ripc_session_map_release(rsocket_ctx->map_clients);
+        rsocket_ctx->map_clients = NULL;
     }
 
     ds_server->state = ripc_state_uninit;
@@ -656,6 +683,9 @@ static int ripc_start(void* ctx) {
         return ret_code;
     }
     rinfo("end, socket server start.");
+    ripc_buffer_stats_log("socket server");//loop线程内统计
+    ripc_buffer_release();//uv_run返回时所有session已经close
+    rarena_thread_release();//解码用的线程arena
 
     return rcode_ok;
 }
@@ -668,14 +698,12 @@ static int ripc_stop(void* ctx) {
     rsocket_server_ctx_uv_t* rsocket_ctx = (rsocket_server_ctx_uv_t*)ctx;
     ripc_data_source_t* ds_server = (ripc_data_source_t*)rsocket_ctx->ds;
 
-    if (rsocket_ctx->map_clients && rdict_size(rsocket_ctx->map_clients) > 0) {
-        ripc_data_source_t* ds_client = NULL;
-        rdict_iterator_t it = rdict_it(rsocket_ctx->map_clients);
-        for (rdict_entry_t *de = NULL; (de = rdict_next(&it)) != NULL; ) {
-            ds_client = (ripc_data_source_t*)(de->value.ptr);
-            uv_close((uv_handle_t*)ds_client->stream, on_session_close);
+    if (rsocket_ctx->map_clients && rdict_typed_size(rsocket_ctx->map_clients) > 0) {
+        ripc_session_map_entry_t* de = NULL;
+        rdict_typed_foreach(ripc_session_map, rsocket_ctx->map_clients, de) {
+            uv_close((uv_handle_t*)de->value->stream, on_session_close);
         }
-        rdict_clear(rsocket_ctx->map_clients);
+        ripc_session_map_clear(rsocket_ctx->map_clients);
     }
 
     uv_close((uv_handle_t*)ds_server->stream, on_server_close);
@@ -33,7 +33,7 @@ extern "C" {
 #include "rlog.h"
 #include "rpool.h"
 #include "rdict.h"
-#include "rlist.h"
+#include "rilist.h"
 #include "rfile.h"
 
 #ifdef ros_windows
@@ -41,7 +41,7 @@ extern "C" {
 #endif
 
 static rdict_t* all_data = NULL;
-static rlist_t* travel_list = NULL;
+static rilist_t travel_list;//按层广度遍历，节点嵌在rprofiler_mem_data_t里
 
 #define key_len_max 64
 
@@ -69,6 +69,7 @@ struct rprofiler_mem_data_s {
     rprofiler_data_child_t* children;
     rprofiler_data_child_t* parent;//仅临时当前，可能有多个
     void* self;//仅临时
+    rilist_node_t travel_link;
 
     char desc[0];
 };
@@ -134,6 +135,7 @@ static rprofiler_mem_data_t* init_node_data(int level, void* p, int size, char*
     data->children = NULL;
     data->parent = NULL;
     data->self = NULL;
+    rilist_node_init(&data->travel_link);
     // rstr_fmt(data->desc, "%d-%p-%s", size_desc - 1, level, p, desc == NULL ? rstr_empty : desc);
     // rstr_fmt(data->desc, "%s", size_desc - 1, desc == NULL ? rstr_empty : desc);
     data->desc[0] = rstr_end;
@@ -344,7 +346,7 @@ static const rprofiler_mem_data_t* read_object(lua_State *L, rprofiler_mem_data_
         } else {
             data->parent = parent_data;
             data->self = h;
-            rlist_rpush(travel_list, data);
+            rilist_push_back(&travel_list, &data->travel_link);
         }
 
         break;
@@ -452,15 +454,12 @@ static int rprofiler(lua_State *L) {
         if (all_data == NULL) {
             rdict_init(all_data, rdata_type_uint64, rdata_type_ptr, 20000, 256);
         }
-        if (travel_list == NULL) {
-            rlist_init(travel_list, rdata_type_ptr);
-        }
-
         inited = 1;
 
         rinfo("Load rprofiler finished.");
     }
     rdict_clear(all_data);
+    rilist_init(&travel_list);//上次按层数提前结束时的残留直接丢弃
 
     rpool_init_global();
     if (rget_pool(rprofiler_data_child_t) == NULL) {
@@ -487,13 +486,13 @@ static int rprofiler(lua_State *L) {
     
     rprofiler_mem_data_t* root_data = read_object(L, NULL, type, root_obj, 0, "[root]", true);
 
-    rlist_node_t* table_node = NULL;
+    rilist_node_t* table_node = NULL;
     rprofiler_mem_data_t* table_data = NULL;
-    int level_size = rlist_size(travel_list);
+    int level_size = rilist_size(&travel_list);
     int level_cur = 1;
     int total_count = 1;
-    while ((table_node = rlist_lpop(travel_list)) != NULL) {
-        table_data = table_node->val;
+    while ((table_node = rilist_pop_front(&travel_list)) != NULL) {
+        table_data = rilist_entry(table_node, rprofiler_mem_data_t, travel_link);
         travel_table(L, table_data, (Table*)table_data->self, table_data->desc, level_cur);
 
         if (total_count++ % 1000 == 0) {
@@ -501,10 +500,9 @@ static int rprofiler(lua_State *L) {
         }
 
         // rdata_free(rprofiler_mem_data_t, table_data);
-        rdata_free(rlist_node_t, table_node);
 
         if (--level_size == 0) {
-            level_size = rlist_size(travel_list);
+            level_size = rilist_size(&travel_list);
 
             if (table_level_max > 0 && ++level_cur > table_level_max) {
                 break;
@@ -23,6 +23,7 @@ extern "C" {
 
 #include "rlog.h"
 #include "rfile.h"
+#include "rrank.h"
 
 #include "rscript_context.h"
 #include "rscript.h"
@@ -152,6 +153,25 @@ static int lua_log(lua_State* L) {
 
     return ret_code;
 }
+// SetLogLevel(nLevel, sModule)，不带模块时改默认级别，模块为C文件名或rlog_module标签
+static int lua_set_log_level(lua_State* L) {
+    int log_level = (int)luaL_checkinteger(L, 1);
+    const char* module = luaL_optstring(L, 2, NULL);
+    if (log_level < rlog_level_verb || log_level > rlog_level_all) {
+        return luaL_error(L, "invalid level, log_level = %d", log_level);
+    }
+
+    int ret_code = module == NULL ? rlog_reset(NULL, (rlog_level_t)log_level, 0) : rlog_set_module_level(module, (rlog_level_t)log_level);
+    lua_pushboolean(L, ret_code == rcode_ok);
+    return 1;
+}
+
+// RemoveLogLevel(sModule)，模块恢复为默认级别
+static int lua_remove_log_level(lua_State* L) {
+    lua_pushboolean(L, rlog_remove_module_level(luaL_checkstring(L, 1)) == rcode_ok);
+    return 1;
+}
+
 static int lua_get_exe_root(lua_State* L) {
     int ret_code = 1;
     
@@ -175,15 +195,148 @@ static int rtime_mills(lua_State *L) {
      return 1;
 }
 
+#define rscript_lua_rank_meta "funra.rank"
+
+static rrank_t* _check_rank(lua_State* L) {
+    rrank_t** ud = (rrank_t**)luaL_checkudata(L, 1, rscript_lua_rank_meta);
+    luaL_argcheck(L, *ud != NULL, 1, "rank released");
+    return *ud;
+}
+
+// 创建排行榜，funra.RankCreate(bAsc, nCapacity)，默认分高在前
+static int lua_rank_create(lua_State* L) {
+    rrank_order_t order = lua_toboolean(L, 1) ? rrank_order_asc : rrank_order_desc;
+    lua_Integer capacity = luaL_optinteger(L, 2, 0);
+
+    rrank_t** ud = (rrank_t**)lua_newuserdata(L, sizeof(rrank_t*));
+    *ud = rrank_create(order, (rrank_size_t)capacity);
+    if (*ud == NULL) {
+        return luaL_error(L, "create rank failed.");
+    }
+    luaL_setmetatable(L, rscript_lua_rank_meta);
+
+    return 1;
+}
+
+static int lua_rank_gc(lua_State* L) {
+    rrank_t** ud = (rrank_t**)luaL_checkudata(L, 1, rscript_lua_rank_meta);
+    rrank_free(*ud);
+    return 0;
+}
+
+static int lua_rank_update(lua_State* L) {
+    rrank_t* rank = _check_rank(L);
+    int ret_code = rrank_update(rank, (uint64_t)luaL_checkinteger(L, 2), (int64_t)luaL_checkinteger(L, 3));
+    lua_pushboolean(L, ret_code == rrank_code_ok);
+    return 1;
+}
+
+static int lua_rank_remove(lua_State* L) {
+    rrank_t* rank = _check_rank(L);
+    lua_pushboolean(L, rrank_remove(rank, (uint64_t)luaL_checkinteger(L, 2)) == rrank_code_ok);
+    return 1;
+}
+
+// 名次从1开始，不在榜返回nil
+static int lua_rank_rank(lua_State* L) {
+    rrank_t* rank = _check_rank(L);
+    rrank_size_t index = rrank_rank_of(rank, (uint64_t)luaL_checkinteger(L, 2));
+    if (index == 0) {
+        lua_pushnil(L);
+    } else {
+        lua_pushinteger(L, index);
+    }
+    return 1;
+}
+
+static int lua_rank_score(lua_State* L) {
+    rrank_t* rank = _check_rank(L);
+    rrank_node_t* node = rrank_find(rank, (uint64_t)luaL_checkinteger(L, 2));
+    if (node == NULL) {
+        lua_pushnil(L);
+    } else {
+        lua_pushinteger(L, node->score);
+    }
+    return 1;
+}
+
+// 按名次取，返回 id, score
+static int lua_rank_at(lua_State* L) {
+    rrank_t* rank = _check_rank(L);
+    rrank_node_t* node = rrank_at(rank, (rrank_size_t)luaL_checkinteger(L, 2));
+    if (node == NULL) {
+        lua_pushnil(L);
+        return 1;
+    }
+    lua_pushinteger(L, (lua_Integer)node->id);
+    lua_pushinteger(L, node->score);
+    return 2;
+}
+
+// 分页，Range(nRank, nCount)，返回 tbIds, tbScores；前K名为 Range(1, K)
+static int lua_rank_range(lua_State* L) {
+    rrank_t* rank = _check_rank(L);
+    lua_Integer from = luaL_checkinteger(L, 2);
+    lua_Integer count = luaL_checkinteger(L, 3);
+    if (from < 1 || count < 0) {
+        return luaL_error(L, "invalid range, rank = %d, count = %d", (int)from, (int)count);
+    }
+
+    rrank_node_t* node = rrank_at(rank, (rrank_size_t)from);
+    int size = node == NULL ? 0 : (int)rmacro_min(count, (lua_Integer)rrank_size(rank) - from + 1);
+    lua_createtable(L, size, 0);
+    lua_createtable(L, size, 0);
+    for (int i = 1; i <= size; i++, node = rrank_next(node)) {
+        lua_pushinteger(L, (lua_Integer)node->id);
+        lua_rawseti(L, -3, i);
+        lua_pushinteger(L, node->score);
+        lua_rawseti(L, -2, i);
+    }
+    return 2;
+}
+
+static int lua_rank_size(lua_State* L) {
+    lua_pushinteger(L, rrank_size(_check_rank(L)));
+    return 1;
+}
+
+static int lua_rank_clear(lua_State* L) {
+    rrank_clear(_check_rank(L));
+    return 0;
+}
+
+const struct luaL_Reg rank_funcs[] = {
+    {"Update", lua_rank_update},
+    {"Remove", lua_rank_remove},
+    {"Rank", lua_rank_rank},
+    {"Score", lua_rank_score},
+    {"At", lua_rank_at},
+    {"Range", lua_rank_range},
+    {"Size", lua_rank_size},
+    {"Clear", lua_rank_clear},
+    {"__len", lua_rank_size},
+    {"__gc", lua_rank_gc},
+    {NULL, NULL},
+};
+
 const struct luaL_Reg funra_funcs[] = {
     {"Log", lua_log},
+    {"SetLogLevel", lua_set_log_level},
+    {"RemoveLogLevel", lua_remove_log_level},
     {"GetWorkRoot", lua_get_exe_root},
     {"GetTimeMicroS", rtime_micros},
     {"GetTimeMS", rtime_mills},
+    {"RankCreate", lua_rank_create},
     {NULL, NULL},
 };
 
 static int _load_funra(lua_State* L) {
+    luaL_newmetatable(L, rscript_lua_rank_meta);
+    luaL_setfuncs(L, rank_funcs, 0);
+    lua_pushvalue(L, -1);
+    lua_setfield(L, -2, "__index");
+    lua_pop(L, 1);
+
     lua_createtable(L, 0, sizeof(funra_funcs) / sizeof((funra_funcs)[0]) - 1);
     luaL_setfuncs(L, funra_funcs, 0);
     lua_setglobal(L, "funra");
@@ -46,3 +46,11 @@ end
 function LogFatal(...)
     funra.Log(rlog_level_fatal, 1, _TableConcat(table.pack(...)))
 end
+
+-- 运行时调级别，sModule为C文件名(如"ripc.c")或rlog_module标签，不带时改默认级别
+function SetLogLevel(nLevel, sModule)
+    return funra.SetLogLevel(nLevel, sModule)
+end
+function RemoveLogLevel(sModule)
+    return funra.RemoveLogLevel(sModule)
+end
@@ -46,4 +46,17 @@ local tbTestMemProfiler = {
 }
 require("rprofiler")(tbTestMemProfiler, 5)
 
-LogInfo("rprofiler测试结束")
\ No newline at end of file
+LogInfo("rprofiler测试结束")
+
+LogInfo("排行榜测试开始")
+
+local tbRank = funra.RankCreate()
+for i = 1, 100 do
+    tbRank:Update(i, i % 10)
+end
+tbRank:Update(5, 1000)
+local tbIds, tbScores = tbRank:Range(1, 3)
+assert(tbRank:Size() == 100 and tbRank:Rank(5) == 1 and tbIds[2] == 9 and tbScores[3] == 9, "Invalid rank.")
+assert(tbRank:Remove(5) and tbRank:Rank(5) == nil and tbRank:At(1) == 9, "Invalid rank remove.")
+
+LogInfo("排行榜测试结束")
\ No newline at end of file